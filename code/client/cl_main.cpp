@@ -1250,6 +1250,7 @@ void CL_InitRef()
 	rit.WIN_Present = WIN_Present;
 	rit.GL_GetProcAddress = WIN_GL_GetProcAddress;
 	rit.GL_ExtensionSupported = WIN_GL_ExtensionSupported;
+	rit.GL_MakeCurrent = WIN_GL_MakeCurrent;
 
 	rit.PD_Load = PD_Load;
 	rit.PD_Store = PD_Store;
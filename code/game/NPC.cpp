@@ -30,6 +30,8 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "say.h"
 #include "Q3_Interface.h"
 #include "g_vehicles.h"
+#include "g_navigator.h"
+#include "../qcommon/timing.h"
 #include "../cgame/cg_local.h"
 
 extern vec3_t playerMins;
@@ -79,6 +81,9 @@ cvar_t* d_SaberactionInfo;
 cvar_t* d_blockinfo;
 cvar_t* d_attackinfo;
 cvar_t* d_saberinfo;
+cvar_t* g_aiLod;
+cvar_t* g_aiLodNear;
+cvar_t* g_aiLodFar;
 
 extern qboolean stop_icarus;
 
@@ -2105,6 +2110,9 @@ void NPC_ExecuteBState(const gentity_t* self) //, int msec )
 	//cliff and wall avoidance
 	NPC_AvoidWallsAndCliffs();
 
+	//steer around other npcs
+	STEER::AvoidCrowd(NPC, &ucmd);
+
 	// run the bot through the server like it was a real client
 	//=== Save the ucmd for the second no-think Pmove ============================
 	ucmd.serverTime = level.time - 50;
@@ -2159,6 +2167,118 @@ void NPC_CheckInSolid()
 	}
 }
 
+/*
+===============
+AI level of detail
+
+NPCs far from the player, out of sight and with nothing to do don't need to
+run their behavior state every frame.  Between thinks they keep replaying
+their last command through Pmove, so they keep moving smoothly, they just
+react a little later.
+===============
+*/
+enum
+{
+	AI_LOD_FULL,	// fighting, scripted, navigating, following, close to the player
+	AI_LOD_NEAR,	// idle in the player's PVS, thinks as often as full
+	AI_LOD_FAR,		// idle out of the PVS but within g_aiLodFar
+	AI_LOD_DORMANT,	// idle out of the PVS beyond g_aiLodFar
+	AI_LOD_NUM
+};
+
+static const char* aiLodNames[AI_LOD_NUM] = { "full", "near", "far", "dormant" };
+// full and near use the normal think rate
+static const int aiLodInterval[AI_LOD_NUM] = { 0, 0, FRAMETIME * 4, FRAMETIME * 10 };
+
+static struct
+{
+	int framenum;
+	int count[AI_LOD_NUM];
+	int lastCount[AI_LOD_NUM];
+	int thinks[AI_LOD_NUM];
+	long long usec[AI_LOD_NUM];
+} aiLodStats;
+
+static byte aiLodTier[MAX_GENTITIES];
+
+// any script task, a navgoal or a wait, replays badly from the last ucmd
+static qboolean NPC_AILodScripted(const gentity_t* ent)
+{
+	for (int i = TID_CHAN_VOICE; i < NUM_TIDS; i++)
+	{
+		if (Q3_TaskIDPending(ent, static_cast<taskID_t>(i)))
+		{
+			return qtrue;
+		}
+	}
+	return qfalse;
+}
+
+static int NPC_AILodTier(const gentity_t* ent)
+{
+	if (!g_aiLod->integer || !player || !player->client)
+	{
+		return AI_LOD_FULL;
+	}
+
+	if (ent->enemy
+		|| ent->client->leader
+		|| NPCInfo->behaviorState == BS_CINEMATIC
+		|| NPCInfo->goalEntity
+		|| NPC_AILodScripted(ent)
+		|| player->client->ps.viewEntity == ent->s.number
+		|| ent->painDebounceTime > level.time)
+	{
+		return AI_LOD_FULL;
+	}
+
+	const float dist_sq = DistanceSquared(ent->currentOrigin, player->currentOrigin);
+	if (dist_sq <= g_aiLodNear->value * g_aiLodNear->value)
+	{
+		return AI_LOD_FULL;
+	}
+
+	if (gi.inPVS(ent->currentOrigin, player->currentOrigin))
+	{
+		return AI_LOD_NEAR;
+	}
+
+	if (dist_sq <= g_aiLodFar->value * g_aiLodFar->value)
+	{
+		return AI_LOD_FAR;
+	}
+
+	return AI_LOD_DORMANT;
+}
+
+static void NPC_AILodCount(const gentity_t* ent)
+{
+	if (aiLodStats.framenum != level.framenum)
+	{
+		memcpy(aiLodStats.lastCount, aiLodStats.count, sizeof aiLodStats.count);
+		memset(aiLodStats.count, 0, sizeof aiLodStats.count);
+		aiLodStats.framenum = level.framenum;
+	}
+	aiLodStats.count[aiLodTier[ent->s.number]]++;
+}
+
+void NPC_PrintLodStats()
+{
+	gi.Printf("AI LOD %s (near %d, far %d):\n", g_aiLod->integer ? "on" : "off", g_aiLodNear->integer,
+		g_aiLodFar->integer);
+	for (int i = 0; i < AI_LOD_NUM; i++)
+	{
+		gi.Printf(" %-8s %4d npcs %8d thinks %8.2f ms total %6.1f us/think\n", aiLodNames[i],
+			aiLodStats.lastCount[i], aiLodStats.thinks[i], aiLodStats.usec[i] / 1000.0f,
+			aiLodStats.thinks[i] ? static_cast<float>(aiLodStats.usec[i]) / aiLodStats.thinks[i] : 0.0f);
+	}
+}
+
+void NPC_ResetLodStats()
+{
+	memset(&aiLodStats, 0, sizeof aiLodStats);
+}
+
 /*
 ===============
 NPC_Think
@@ -2226,6 +2346,8 @@ void NPC_Think(gentity_t* ent) //, int msec )
 		return;
 	}
 
+	NPC_AILodCount(ent);
+
 	// TODO! Tauntaun's (and other creature vehicles?) think, we'll need to make an exception here to allow that.
 
 	if (ent->client
@@ -2310,7 +2432,15 @@ void NPC_Think(gentity_t* ent) //, int msec )
 			return;
 		}
 
-		if (NPC->s.weapon == WP_SABER && NPC->client->ps.SaberActive())
+		const int lod = NPC_AILodTier(ent);
+		aiLodTier[ent->s.number] = lod;
+
+		if (aiLodInterval[lod])
+		{
+			//far away and nothing much going on, think less often
+			NPCInfo->nextBStateThink = level.time + aiLodInterval[lod];
+		}
+		else if (NPC->s.weapon == WP_SABER && NPC->client->ps.SaberActive())
 		{
 			//Jedi think faster
 			NPCInfo->nextBStateThink = level.time + FRAMETIME / 4;
@@ -2323,7 +2453,10 @@ void NPC_Think(gentity_t* ent) //, int msec )
 		}
 
 		//nextthink is set before this so something in here can override it
+		const timingUsec_c lodTimer;
 		NPC_ExecuteBState(ent);
+		aiLodStats.thinks[lod]++;
+		aiLodStats.usec[lod] += lodTimer.End();
 
 #if	AI_TIMERS
 		int addTime = GetTime(startTime);
@@ -2395,6 +2528,11 @@ void NPC_InitAI()
 	d_saberCombat = gi.cvar("d_saberCombat", "0", CVAR_CHEAT);
 
 	d_slowmoaction = gi.cvar("d_slowmoaction", "0", CVAR_ARCHIVE); //save this setting
+
+	g_aiLod = gi.cvar("g_aiLod", "0", CVAR_ARCHIVE);
+	g_aiLodNear = gi.cvar("g_aiLodNear", "1024", CVAR_ARCHIVE);
+	g_aiLodFar = gi.cvar("g_aiLodFar", "3072", CVAR_ARCHIVE);
+	NPC_ResetLodStats();
 }
 
 /*
@@ -5370,6 +5370,9 @@ void NPC_PrintScore(const gentity_t* ent)
 	gi.Printf("%s: %d\n", ent->targetname, ent->client->ps.persistant[PERS_SCORE]);
 }
 
+extern void NPC_PrintLodStats();
+extern void NPC_ResetLodStats();
+
 /*
 Svcmd_NPC_f
 
@@ -5390,6 +5393,7 @@ void Svcmd_NPC_f()
 		gi.Printf(" kill [NPC targetname] or [all(kills all NPCs)] or 'team [teamname]'\n");
 		gi.Printf(" showbounds (draws exact bounding boxes of NPCs)\n");
 		gi.Printf(" score [NPC targetname] (prints number of kills per NPC)\n");
+		gi.Printf(" lod [reset] (prints NPC think counts and time per AI level of detail)\n");
 	}
 	else if (Q_stricmp(cmd, "spawn") == 0)
 	{
@@ -5399,6 +5403,17 @@ void Svcmd_NPC_f()
 	{
 		NPC_Kill_f();
 	}
+	else if (Q_stricmp(cmd, "lod") == 0)
+	{
+		if (Q_stricmp(gi.argv(2), "reset") == 0)
+		{
+			NPC_ResetLodStats();
+		}
+		else
+		{
+			NPC_PrintLodStats();
+		}
+	}
 	else if (Q_stricmp(cmd, "showbounds") == 0)
 	{
 		//Toggle on and off
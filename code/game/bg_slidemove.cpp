@@ -359,6 +359,41 @@ qboolean PM_SlideMove(const float grav_mod)
 	return static_cast<qboolean>(bumpcount != 0);
 }
 
+/*
+==================
+PM_StepProbes
+
+The ground probe below start_o and the step up move above it both start from
+the same spot, so they go to the engine as one batch of traces.
+==================
+*/
+static void PM_StepProbes(const vec3_t start_o, const vec3_t down, const vec3_t up, traceJob_t* probes)
+{
+	for (int i = 0; i < 2; i++)
+	{
+		VectorCopy(start_o, probes[i].start);
+		VectorCopy(pm->mins, probes[i].mins);
+		VectorCopy(pm->maxs, probes[i].maxs);
+		probes[i].pass_entity_num = pm->ps->client_num;
+		probes[i].contentmask = pm->tracemask;
+		probes[i].e_g2_trace_type = static_cast<EG2_Collision>(0);
+		probes[i].use_lod = 0;
+	}
+	VectorCopy(down, probes[0].end);
+	VectorCopy(up, probes[1].end);
+
+	if (pm->traceBatch)
+	{
+		pm->traceBatch(probes, 2);
+		return;
+	}
+	for (int i = 0; i < 2; i++)
+	{
+		pm->trace(&probes[i].trace, probes[i].start, probes[i].mins, probes[i].maxs, probes[i].end,
+			probes[i].pass_entity_num, probes[i].contentmask, probes[i].e_g2_trace_type, probes[i].use_lod);
+	}
+}
+
 /*
 ==================
 PM_StepSlideMove
@@ -423,19 +458,6 @@ void PM_StepSlideMove(float grav_mod)
 		step_size = 4;
 	}
 
-	//Q3Final addition...
-	VectorCopy(start_o, down);
-	down[2] -= step_size;
-	pm->trace(&trace, start_o, pm->mins, pm->maxs, down, pm->ps->client_num, pm->tracemask,
-		static_cast<EG2_Collision>(0), 0);
-	VectorSet(up, 0, 0, 1);
-	// never step up when you still have up velocity
-	if (pm->ps->velocity[2] > 0 && (trace.fraction == 1.0 ||
-		DotProduct(trace.plane.normal, up) < 0.7))
-	{
-		return;
-	}
-
 	if (!pm->ps->velocity[0] && !pm->ps->velocity[1])
 	{
 		//All our velocity was cancelled sliding
@@ -448,10 +470,29 @@ void PM_StepSlideMove(float grav_mod)
 	VectorCopy(start_o, up);
 	up[2] += step_size;
 
-	// test the player position if they were a stepheight higher
+	//Q3Final addition...
+	//the ground probe only matters while moving up, so don't trace it otherwise
+	if (pm->ps->velocity[2] > 0)
+	{
+		const vec3_t up_dir = { 0, 0, 1 };
+		traceJob_t probes[2];
 
-	pm->trace(&trace, start_o, pm->mins, pm->maxs, up, pm->ps->client_num, pm->tracemask, static_cast<EG2_Collision>(0),
-		0);
+		VectorCopy(start_o, down);
+		down[2] -= step_size;
+		PM_StepProbes(start_o, down, up, probes);
+		// never step up when you still have up velocity
+		if (probes[0].trace.fraction == 1.0 || DotProduct(probes[0].trace.plane.normal, up_dir) < 0.7)
+		{
+			return;
+		}
+		trace = probes[1].trace;
+	}
+	else
+	{
+		// test the player position if they were a stepheight higher
+		pm->trace(&trace, start_o, pm->mins, pm->maxs, up, pm->ps->client_num, pm->tracemask,
+			static_cast<EG2_Collision>(0), 0);
+	}
 	if (trace.allsolid || trace.startsolid || trace.fraction == 0)
 	{
 		if (pm->debugLevel)
@@ -28,6 +28,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "wp_saber.h"
 #include "g_vehicles.h"
 #include "b_local.h"
+#include "../qcommon/timing.h"
 
 constexpr auto SLOWDOWN_DIST = 128.0f;
 constexpr auto MIN_NPC_SPEED = 16.0f;
@@ -8064,6 +8065,291 @@ extern void Ent_CheckBarrierIsAllowed(gentity_t* ent);
 extern void Ent_CheckBarrierIsAllowed_WithSaber(gentity_t* ent);
 extern qboolean droideka_npc(const gentity_t* ent);
 
+/*
+==================
+Pmove recording
+
+The player's usercmds are recorded from a starting player state so the same
+movement can be replayed with pmove_bench on the same map, to measure the
+cost of a move and the number of traces it takes.
+==================
+*/
+constexpr int PMREC_IDENT = 'P' << 24 | 'M' << 16 | 'R' << 8 | 'C';
+constexpr int PMREC_VERSION = 1;
+constexpr int PMREC_MAX_CMDS = 16384;
+
+using pmoveRecordHeader_t = struct pmoveRecordHeader_s
+{
+	int ident;
+	int version;
+	int playerStateSize; // the recording is only valid for the same build
+	int usercmdSize;
+	int numCmds;
+	char mapname[MAX_QPATH];
+};
+
+using pmoveRecord_t = struct pmoveRecord_s
+{
+	pmoveRecordHeader_t header;
+	playerState_t start;
+	usercmd_t cmds[PMREC_MAX_CMDS];
+};
+
+static pmoveRecord_t* pmRecord = nullptr;
+static char pmRecordName[MAX_QPATH];
+static int pmBenchTraces;
+
+static void G_PmoveRecordCmd(const gentity_t* ent, const usercmd_t* ucmd)
+{
+	if (!pmRecord || ent->s.number != 0)
+	{
+		return;
+	}
+
+	if (!pmRecord->header.numCmds)
+	{
+		pmRecord->start = ent->client->ps;
+	}
+
+	if (pmRecord->header.numCmds < PMREC_MAX_CMDS)
+	{
+		pmRecord->cmds[pmRecord->header.numCmds++] = *ucmd;
+	}
+}
+
+static void G_PmoveRecordStop()
+{
+	fileHandle_t f = 0;
+
+	if (pmRecord->header.numCmds)
+	{
+		gi.FS_FOpenFile(va("pmove/%s.pmr", pmRecordName), &f, FS_WRITE);
+	}
+
+	if (!pmRecord->header.numCmds)
+	{
+		gi.Printf("Nothing recorded\n");
+	}
+	else if (!f)
+	{
+		gi.Printf(S_COLOR_RED "Couldn't write pmove/%s.pmr\n", pmRecordName);
+	}
+	else
+	{
+		gi.FS_Write(&pmRecord->header, sizeof pmRecord->header, f);
+		gi.FS_Write(&pmRecord->start, sizeof pmRecord->start, f);
+		gi.FS_Write(pmRecord->cmds, pmRecord->header.numCmds * sizeof(usercmd_t), f);
+		gi.FS_FCloseFile(f);
+		gi.Printf("Recorded %d usercmds to pmove/%s.pmr\n", pmRecord->header.numCmds, pmRecordName);
+	}
+
+	gi.Free(pmRecord);
+	pmRecord = nullptr;
+}
+
+void Svcmd_PmoveRecord_f()
+{
+	if (pmRecord)
+	{
+		G_PmoveRecordStop();
+		return;
+	}
+
+	if (gi.argc() < 2)
+	{
+		gi.Printf("usage: pmove_record <name>, run again to stop\n");
+		return;
+	}
+
+	pmRecord = static_cast<pmoveRecord_t*>(gi.Malloc(sizeof(pmoveRecord_t), TAG_TEMP_WORKSPACE, qtrue));
+	pmRecord->header.ident = PMREC_IDENT;
+	pmRecord->header.version = PMREC_VERSION;
+	pmRecord->header.playerStateSize = sizeof(playerState_t);
+	pmRecord->header.usercmdSize = sizeof(usercmd_t);
+	Q_strncpyz(pmRecord->header.mapname, level.mapname, sizeof pmRecord->header.mapname);
+	Q_strncpyz(pmRecordName, gi.argv(1), sizeof pmRecordName);
+
+	gi.Printf("Recording player movement, run pmove_record again to stop\n");
+}
+
+// the real trace imports while pmove_bench has its counting ones in gi
+static void (*pmBenchRealTrace)(trace_t* results, const vec3_t start, const vec3_t mins, const vec3_t maxs,
+	const vec3_t end, int pass_entity_num, int contentmask, EG2_Collision e_g2_trace_type, int use_lod);
+static void (*pmBenchRealTraceBatch)(traceJob_t* jobs, int num_jobs);
+
+static void G_PmoveBenchTrace(trace_t* results, const vec3_t start, const vec3_t mins, const vec3_t maxs,
+	const vec3_t end, const int pass_entity_num, const int content_mask, const EG2_Collision e_g2_trace_type,
+	const int use_lod)
+{
+	pmBenchTraces++;
+	pmBenchRealTrace(results, start, mins, maxs, end, pass_entity_num, content_mask, e_g2_trace_type, use_lod);
+}
+
+static void G_PmoveBenchTraceBatch(traceJob_t* jobs, const int num_jobs)
+{
+	pmBenchTraces += num_jobs;
+	pmBenchRealTraceBatch(jobs, num_jobs);
+}
+
+/*
+==================
+G_PmoveBenchRestore
+
+Puts the benchmarked player back to the snapshot taken before the run.  The
+Ghoul2 models keep their current bone and vertex caches, which are marked stale
+rather than swapped for the old pointers.
+==================
+*/
+static void G_PmoveBenchRestore(gentity_t* ent, const gentity_t* saved_ent, const gclient_t* saved_client,
+	const std::vector<CGhoul2Info>& saved_g2)
+{
+	memcpy(static_cast<void*>(ent), saved_ent, sizeof(gentity_t));
+	memcpy(static_cast<void*>(ent->client), saved_client, sizeof(gclient_t));
+
+	for (int i = 0; i < ent->ghoul2.size() && i < static_cast<int>(saved_g2.size()); i++)
+	{
+		CGhoul2Info& g2 = ent->ghoul2[i];
+		CBoneCache* bone_cache = g2.mBoneCache;
+		intptr_t* transformed_verts = g2.mTransformedVertsArray;
+
+		g2 = saved_g2[i];
+		g2.mBoneCache = bone_cache;
+		g2.mTransformedVertsArray = transformed_verts;
+		g2.mSkelFrameNum = 0;
+		g2.mMeshFrameNum = 0;
+	}
+}
+
+void Svcmd_PmoveBench_f()
+{
+	fileHandle_t f;
+	gentity_t* ent = &g_entities[0];
+
+	if (gi.argc() < 2)
+	{
+		gi.Printf("usage: pmove_bench <name> [loops]\n");
+		return;
+	}
+
+	if (!ent->client || pmRecord)
+	{
+		gi.Printf("Can't benchmark while recording\n");
+		return;
+	}
+
+	const int len = gi.FS_FOpenFile(va("pmove/%s.pmr", gi.argv(1)), &f, FS_READ);
+
+	if (!f)
+	{
+		gi.Printf(S_COLOR_RED "Couldn't open pmove/%s.pmr\n", gi.argv(1));
+		return;
+	}
+
+	const auto rec = static_cast<pmoveRecord_t*>(gi.Malloc(sizeof(pmoveRecord_t), TAG_TEMP_WORKSPACE, qtrue));
+	const int fixed_size = sizeof rec->header + sizeof rec->start;
+
+	if (len > fixed_size)
+	{
+		gi.FS_Read(&rec->header, sizeof rec->header, f);
+		gi.FS_Read(&rec->start, sizeof rec->start, f);
+	}
+
+	if (len <= fixed_size
+		|| rec->header.ident != PMREC_IDENT
+		|| rec->header.version != PMREC_VERSION
+		|| rec->header.playerStateSize != sizeof(playerState_t)
+		|| rec->header.usercmdSize != sizeof(usercmd_t)
+		|| rec->header.numCmds <= 0
+		|| rec->header.numCmds > PMREC_MAX_CMDS
+		|| len != fixed_size + rec->header.numCmds * static_cast<int>(sizeof(usercmd_t)))
+	{
+		gi.Printf(S_COLOR_RED "pmove/%s.pmr is not a valid recording for this build\n", gi.argv(1));
+		gi.FS_FCloseFile(f);
+		gi.Free(rec);
+		return;
+	}
+
+	gi.FS_Read(rec->cmds, rec->header.numCmds * sizeof(usercmd_t), f);
+	gi.FS_FCloseFile(f);
+
+	if (Q_stricmp(rec->header.mapname, level.mapname))
+	{
+		gi.Printf(S_COLOR_RED "pmove/%s.pmr was recorded on %s\n", gi.argv(1), rec->header.mapname);
+		gi.Free(rec);
+		return;
+	}
+
+	const int loops = gi.argc() > 2 ? Com_Clampi(1, 1000, atoi(gi.argv(2))) : 1;
+	pmove_t pm;
+	int moves = 0;
+
+	// Pmove changes a lot more than the playerState (ground entity, anim timers,
+	// the Ghoul2 bone anims it sets...), so every loop starts from a snapshot of
+	// the whole entity, client and Ghoul2 models, and the player is put back
+	// the way they were afterwards.  The structs are copied as raw memory since
+	// the entity owns its Ghoul2 handle.
+	const auto saved_ent = static_cast<gentity_t*>(gi.Malloc(sizeof(gentity_t), TAG_TEMP_WORKSPACE, qfalse));
+	const auto saved_client = static_cast<gclient_t*>(gi.Malloc(sizeof(gclient_t), TAG_TEMP_WORKSPACE, qfalse));
+	std::vector<CGhoul2Info> saved_g2;
+
+	memcpy(static_cast<void*>(saved_ent), ent, sizeof(gentity_t));
+	memcpy(static_cast<void*>(saved_client), ent->client, sizeof(gclient_t));
+	for (int i = 0; i < ent->ghoul2.size(); i++)
+	{
+		saved_g2.push_back(ent->ghoul2[i]);
+	}
+
+	// count every trace the move makes, not just the ones through pm->trace
+	pmBenchRealTrace = gi.trace;
+	pmBenchRealTraceBatch = gi.traceBatch;
+	gi.trace = G_PmoveBenchTrace;
+	gi.traceBatch = G_PmoveBenchTraceBatch;
+	pmBenchTraces = 0;
+
+	int64_t bench_usec = 0;
+
+	for (int loop = 0; loop <= loops; loop++)
+	{
+		G_PmoveBenchRestore(ent, saved_ent, saved_client, saved_g2);
+		if (loop == loops)
+		{
+			break;
+		}
+		ent->client->ps = rec->start;
+		VectorCopy(rec->start.origin, ent->currentOrigin);
+		gi.linkentity(ent);
+
+		const timingUsec_c loop_timer;
+
+		for (int i = 0; i < rec->header.numCmds; i++)
+		{
+			memset(&pm, 0, sizeof pm);
+			pm.gent = ent;
+			pm.ps = &ent->client->ps;
+			pm.cmd = rec->cmds[i];
+			pm.tracemask = ent->clipmask;
+			pm.trace = gi.trace;
+			pm.traceBatch = gi.traceBatch;
+			pm.pointcontents = gi.pointcontents;
+			Pmove(&pm);
+			moves++;
+		}
+
+		bench_usec += loop_timer.End();
+	}
+
+	gi.trace = pmBenchRealTrace;
+	gi.traceBatch = pmBenchRealTraceBatch;
+	gi.linkentity(ent);
+
+	gi.Printf("%d moves in %.2f ms: %.2f us/move, %.2f traces/move\n", moves, bench_usec / 1000.0,
+		static_cast<double>(bench_usec) / moves, static_cast<float>(pmBenchTraces) / moves);
+
+	gi.Free(saved_client);
+	gi.Free(saved_ent);
+	gi.Free(rec);
+}
+
 void ClientThink_real(gentity_t* ent, usercmd_t* ucmd)
 {
 	gclient_t* client;
@@ -9355,6 +9641,7 @@ void ClientThink_real(gentity_t* ent, usercmd_t* ucmd)
 	//	pm.tracemask = MASK_PLAYERSOLID;	// used differently for navgen
 	pm.tracemask = ent->clipmask;
 	pm.trace = gi.trace;
+	pm.traceBatch = gi.traceBatch;
 	pm.pointcontents = gi.pointcontents;
 	pm.debugLevel = g_debugMove->integer;
 	pm.noFootsteps = qfalse; //( g_dmflags->integer & DF_NO_FOOTSTEPS ) > 0;
@@ -9366,6 +9653,8 @@ void ClientThink_real(gentity_t* ent, usercmd_t* ucmd)
 
 	VectorCopy(client->ps.origin, old_origin);
 
+	G_PmoveRecordCmd(ent, &pm.cmd);
+
 	// perform a pmove
 	Pmove(&pm);
 	pm.gent = nullptr;
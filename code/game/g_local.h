@@ -512,6 +512,13 @@ void G_Throw(gentity_t* targ, const vec3_t new_dir, float push);
 //
 void G_RunMissile(gentity_t* ent);
 
+//
+// g_missilebatch.cpp
+//
+qboolean G_MissileBatchTrace(const gentity_t* ent, vec3_t origin, trace_t* tr);
+void G_MissileBenchStartFrame();
+void G_MissileBenchEndFrame();
+
 //
 // g_mover.c
 //
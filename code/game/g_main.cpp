@@ -51,6 +51,9 @@ extern void Troop_Reset();
 extern void Pilot_Reset();
 extern void Pilot_Update();
 
+extern void WP_SaberBroadphaseHookLink(game_import_t* imports);
+extern void WP_SaberBroadphaseReset();
+
 extern void G_ASPreCacheFree();
 extern qboolean PM_RestAnim(int anim);
 extern qboolean PM_CrouchAnim(int anim);
@@ -172,6 +175,10 @@ cvar_t* g_noFootSlideWalkScale;
 
 cvar_t* g_nav1;
 cvar_t* g_nav2;
+cvar_t* g_navPathCache;
+cvar_t* g_navFlowFields;
+cvar_t* g_navEdgeValidate;
+cvar_t* g_navCrowd;
 cvar_t* g_bobaDebug;
 
 cvar_t* g_delayedShutdown;
@@ -192,6 +199,9 @@ cvar_t* g_numEntities;
 
 cvar_t* g_saberAutoBlocking;
 cvar_t* g_saberRealisticCombat;
+cvar_t* g_saberBroadphase;
+cvar_t* g_saberSweepTest;
+cvar_t* g_missileBatch;
 cvar_t* debug_subdivision;
 cvar_t* g_saberDamageCapping;
 cvar_t* g_saberMoveSpeed;
@@ -765,11 +775,18 @@ void G_InitCvars()
 
 	g_nav1 = gi.cvar("g_nav1", "", 0);
 	g_nav2 = gi.cvar("g_nav2", "", 0);
+	g_navPathCache = gi.cvar("g_navPathCache", "1", CVAR_ARCHIVE);
+	g_navFlowFields = gi.cvar("g_navFlowFields", "0", CVAR_ARCHIVE);
+	g_navEdgeValidate = gi.cvar("g_navEdgeValidate", "2", CVAR_ARCHIVE);
+	g_navCrowd = gi.cvar("g_navCrowd", "0", CVAR_ARCHIVE);
 
 	g_bobaDebug = gi.cvar("g_bobaDebug", "", 0);
 
 	g_delayedShutdown = gi.cvar("g_delayedShutdown", "0", 0);
 
+	g_missileBatch = gi.cvar("g_missileBatch", "1", CVAR_ARCHIVE);
+	//trace runs of missiles in flight as one batch
+
 	g_inactivity = gi.cvar("g_inactivity", "0", 0);
 	g_debugMove = gi.cvar("g_debugMove", "0", CVAR_CHEAT);
 	g_debugDamage = gi.cvar("g_debugDamage", "0", CVAR_CHEAT);
@@ -785,6 +802,10 @@ void G_InitCvars()
 	//must press +block button to do any blocking
 	g_saberRealisticCombat = gi.cvar("g_saberMoreRealistic", "1", CVAR_ARCHIVE);
 	//makes collision more precise, increases damage
+	g_saberBroadphase = gi.cvar("g_saberBroadphase", "1", CVAR_ARCHIVE);
+	//skip blade vs blade tests for blades whose swept bounds don't overlap
+	g_saberSweepTest = gi.cvar("g_saberSweepTest", "1", CVAR_ARCHIVE);
+	//skip the damage traces for swings that can't reach anything
 	debug_subdivision = gi.cvar("debug_subdivision", "0", CVAR_ARCHIVE); //debug for dismemberment
 	g_dismemberProbabilities = gi.cvar("g_dismemberProbabilities", "1", CVAR_ARCHIVE);
 	//0 = ignore probabilities, 1 = use probabilities
@@ -1029,6 +1050,7 @@ void InitGame(const char* mapname, const char* spawntarget, const int checkSum,
 	Rail_Reset();
 	Troop_Reset();
 	Pilot_Reset();
+	WP_SaberBroadphaseReset();
 
 	IT_LoadItemParms();
 
@@ -1128,6 +1150,8 @@ extern "C" Q_EXPORT game_export_t * QDECL GetGameAPI(const game_import_t * impor
 	gameinfo_import_t gameinfo_import;
 
 	gi = *import;
+	// bodies relinked in the middle of a frame have to reach the saber broadphase
+	WP_SaberBroadphaseHookLink(&gi);
 
 	globals.apiversion = GAME_API_VERSION;
 	globals.Init = InitGame;
@@ -2352,8 +2376,12 @@ void G_RunFrame(const int level_time)
 	level.time = level_time;
 	g_entities[0].nearAllies = ENTITYNUM_NONE;
 
+	G_MissileBenchStartFrame();
+
 	//ResetTeamCounters();
 	NAV::DecayDangerSenses();
+	NAV::ValidateEdges();
+	STEER::UpdateCrowd();
 	Rail_Update();
 	Troop_Update();
 	Pilot_Update();
@@ -2680,6 +2708,8 @@ void G_RunFrame(const int level_time)
 	}
 #endif//	AI_TIMERS
 
+	G_MissileBenchEndFrame();
+
 	extern int delayedShutDown;
 	if (g_delayedShutdown->integer && delayedShutDown != 0 && delayedShutDown < level.time)
 	{
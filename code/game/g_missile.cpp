@@ -3168,11 +3168,14 @@ void G_RunMissile(gentity_t* ent)
 	else
 	{
 		vec3_t origin;
-		EvaluateTrajectory(&ent->s.pos, level.time, origin);
-		// trace a line from the previous position to the current position,
-		// ignoring interactions with the missile owner
-		gi.trace(&tr, ent->currentOrigin, ent->mins, ent->maxs, origin,
-			ent->owner ? ent->owner->s.number : ent->s.number, ent->clipmask, G2_COLLIDE, 10);
+		if (!G_MissileBatchTrace(ent, origin, &tr))
+		{
+			EvaluateTrajectory(&ent->s.pos, level.time, origin);
+			// trace a line from the previous position to the current position,
+			// ignoring interactions with the missile owner
+			gi.trace(&tr, ent->currentOrigin, ent->mins, ent->maxs, origin,
+				ent->owner ? ent->owner->s.number : ent->s.number, ent->clipmask, G2_COLLIDE, 10);
+		}
 
 		if (tr.entity_num != ENTITYNUM_NONE)
 		{
@@ -0,0 +1,397 @@
+/*
+===========================================================================
+Copyright (C) 2013 - 2015, OpenJK contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+// g_missilebatch.cpp -- batched flight for runs of missiles, and "missile_bench".
+//
+// When G_RunMissile gets to a missile with nothing in the batch for it, the run of
+// missiles right after it in the entity list is gathered, their trajectories are
+// integrated in one pass over flat arrays and their flight traces go to the engine
+// in one traceBatch.  Each missile then takes its trace from the batch, as long as
+// it is still the way it was when the batch was traced.
+
+#include "g_local.h"
+#include "w_local.h"
+#include "Q3_Interface.h"
+
+#include "../qcommon/timing.h"
+
+extern cvar_t* g_missileBatch;
+
+#define MISSILEBATCH_MAX	128		// trace_t is big, so keep this modest
+
+using missileBatch_t = struct missileBatch_s
+{
+	int framenum;
+	int count;
+	int next; // slot of the next missile to run
+	int entNum[MISSILEBATCH_MAX];
+	int trType[MISSILEBATCH_MAX];
+	int trTime[MISSILEBATCH_MAX];
+	float dt[MISSILEBATCH_MAX];
+	float gravity[MISSILEBATCH_MAX];
+	float base[3][MISSILEBATCH_MAX];
+	float delta[3][MISSILEBATCH_MAX];
+	float origin[3][MISSILEBATCH_MAX];
+	traceJob_t jobs[MISSILEBATCH_MAX];
+};
+
+static missileBatch_t missileBatch;
+
+static struct
+{
+	int batched;
+	int single;
+} missileBatchStats;
+
+/*
+==================
+G_MissileBatchable
+
+Only plain flying missiles nothing else can collide with go in a batch, so
+moving one can't change the trace of another one later in the run.
+==================
+*/
+static qboolean G_MissileBatchable(const gentity_t* ent)
+{
+	return static_cast<qboolean>(ent->s.eType == ET_MISSILE
+		&& !ent->freeAfterEvent
+		&& !(ent->s.eFlags & EF_HELD_BY_SAND_CREATURE)
+		&& (ent->s.pos.trType == TR_LINEAR || ent->s.pos.trType == TR_GRAVITY)
+		&& !ent->contents
+		&& !ent->next_roff_time
+		&& ent->m_iIcarusID == IIcarusInterface::ICARUS_INVALID);
+}
+
+/*
+==================
+G_MissileBatchBuild
+
+Gathers the run of missiles starting at entity first and traces them.  The run
+stops at anything else, and right after a missile that will think or touch push
+triggers this frame, or whose trace hits something, since that can change the
+world for the ones after it.
+==================
+*/
+static void G_MissileBatchBuild(const int first)
+{
+	missileBatch_t& mb = missileBatch;
+
+	mb.framenum = level.framenum;
+	mb.count = 0;
+	mb.next = 0;
+
+	for (int i = first; i < globals.num_entities && mb.count < MISSILEBATCH_MAX; i++)
+	{
+		if (!PInUse(i))
+		{
+			continue;
+		}
+		const gentity_t* ent = &g_entities[i];
+
+		if (!G_MissileBatchable(ent))
+		{
+			break;
+		}
+
+		const int n = mb.count++;
+		traceJob_t& job = mb.jobs[n];
+
+		mb.entNum[n] = i;
+		mb.trType[n] = ent->s.pos.trType;
+		mb.trTime[n] = ent->s.pos.trTime;
+		mb.dt[n] = (level.time - ent->s.pos.trTime) * 0.001F; // milliseconds to seconds
+		mb.gravity[n] = ent->s.pos.trType == TR_GRAVITY ? g_gravity->value : 0.0f;
+		for (int j = 0; j < 3; j++)
+		{
+			mb.base[j][n] = ent->s.pos.trBase[j];
+			mb.delta[j][n] = ent->s.pos.trDelta[j];
+		}
+
+		// same trace G_RunMissile would do
+		VectorCopy(ent->currentOrigin, job.start);
+		VectorCopy(ent->mins, job.mins);
+		VectorCopy(ent->maxs, job.maxs);
+		job.pass_entity_num = ent->owner ? ent->owner->s.number : ent->s.number;
+		job.contentmask = ent->clipmask;
+		job.e_g2_trace_type = G2_COLLIDE;
+		job.use_lod = 10;
+
+		if ((ent->nextthink > 0 && ent->nextthink <= level.time) || ent->mass)
+		{
+			break;
+		}
+	}
+
+	if (mb.count < 2)
+	{
+		mb.count = 0;
+		return;
+	}
+
+	// same math as EvaluateTrajectory, laid out so each axis is one straight loop
+	for (int j = 0; j < 3; j++)
+	{
+		const float* base = mb.base[j];
+		const float* delta = mb.delta[j];
+		float* origin = mb.origin[j];
+
+		for (int n = 0; n < mb.count; n++)
+		{
+			origin[n] = base[n] + mb.dt[n] * delta[n];
+		}
+	}
+	for (int n = 0; n < mb.count; n++)
+	{
+		mb.origin[2][n] -= 0.5F * mb.gravity[n] * mb.dt[n] * mb.dt[n];
+		mb.jobs[n].end[0] = mb.origin[0][n];
+		mb.jobs[n].end[1] = mb.origin[1][n];
+		mb.jobs[n].end[2] = mb.origin[2][n];
+	}
+
+	gi.traceBatch(mb.jobs, mb.count);
+
+	for (int n = 0; n < mb.count; n++)
+	{
+		const trace_t& tr = mb.jobs[n].trace;
+
+		if (tr.fraction < 1.0f || tr.startsolid || tr.allsolid)
+		{
+			mb.count = n + 1;
+			break;
+		}
+	}
+}
+
+/*
+==================
+G_MissileBatchTrace
+
+Fills in this frame's position and flight trace for a missile from the batch,
+building a new batch if there's nothing left in this one.  Returns qfalse if the
+missile has to be moved on its own.
+==================
+*/
+qboolean G_MissileBatchTrace(const gentity_t* ent, vec3_t origin, trace_t* tr)
+{
+	missileBatch_t& mb = missileBatch;
+
+	if (!g_missileBatch->integer)
+	{
+		return qfalse;
+	}
+	if (mb.framenum != level.framenum)
+	{
+		mb.count = 0;
+		mb.next = 0;
+	}
+
+	// skip any that didn't run, like missiles freed after their event
+	while (mb.next < mb.count && mb.entNum[mb.next] < ent->s.number)
+	{
+		mb.next++;
+	}
+	if (mb.next >= mb.count)
+	{
+		G_MissileBatchBuild(ent->s.number);
+	}
+	if (mb.next >= mb.count || mb.entNum[mb.next] != ent->s.number)
+	{
+		missileBatchStats.single++;
+		return qfalse;
+	}
+
+	const int n = mb.next++;
+	const traceJob_t& job = mb.jobs[n];
+
+	if (ent->s.pos.trType != mb.trType[n]
+		|| ent->s.pos.trTime != mb.trTime[n]
+		|| ent->s.pos.trBase[0] != mb.base[0][n] || ent->s.pos.trBase[1] != mb.base[1][n]
+		|| ent->s.pos.trBase[2] != mb.base[2][n]
+		|| ent->s.pos.trDelta[0] != mb.delta[0][n] || ent->s.pos.trDelta[1] != mb.delta[1][n]
+		|| ent->s.pos.trDelta[2] != mb.delta[2][n]
+		|| !VectorCompare(ent->currentOrigin, job.start)
+		|| !VectorCompare(ent->mins, job.mins)
+		|| !VectorCompare(ent->maxs, job.maxs)
+		|| (ent->owner ? ent->owner->s.number : ent->s.number) != job.pass_entity_num
+		|| ent->clipmask != job.contentmask)
+	{
+		// changed since the batch was traced, and its own trace might hit
+		// something, so the rest of the run can't be trusted either
+		mb.count = 0;
+		missileBatchStats.single++;
+		return qfalse;
+	}
+
+	origin[0] = mb.origin[0][n];
+	origin[1] = mb.origin[1][n];
+	origin[2] = mb.origin[2][n];
+	*tr = job.trace;
+	missileBatchStats.batched++;
+	return qtrue;
+}
+
+using missileBench_t = struct missileBench_s
+{
+	qboolean active;
+	int endTime;
+	int frames;
+	int missiles;
+	int64_t frameUsec;
+	int64_t maxFrameUsec;
+	timingUsec_c frameTimer;
+};
+
+static missileBench_t missileBench;
+
+/*
+==================
+G_MissileBenchStartFrame
+
+Called at the start of every frame, once level.time is set.
+==================
+*/
+void G_MissileBenchStartFrame()
+{
+	if (missileBench.active)
+	{
+		missileBench.frameTimer.Start();
+	}
+}
+
+static void G_MissileBenchReport()
+{
+	missileBench_t& bench = missileBench;
+
+	bench.active = qfalse;
+	if (!bench.frames)
+	{
+		return;
+	}
+	gi.Printf("missile_bench: %d frames, %.1f missiles per frame\n", bench.frames,
+		static_cast<float>(bench.missiles) / bench.frames);
+	gi.Printf(" game frame %.3f ms average, %.3f ms worst (g_missileBatch %d)\n",
+		bench.frameUsec / 1000.0 / bench.frames, bench.maxFrameUsec / 1000.0, g_missileBatch->integer);
+	gi.Printf(" %d flight traces from batches, %d traced on their own\n", missileBatchStats.batched,
+		missileBatchStats.single);
+}
+
+/*
+==================
+G_MissileBenchEndFrame
+
+Called at the end of every frame, times it while a benchmark is running.
+==================
+*/
+void G_MissileBenchEndFrame()
+{
+	missileBench_t& bench = missileBench;
+
+	if (!bench.active)
+	{
+		return;
+	}
+
+	const int64_t usec = bench.frameTimer.End();
+	int missiles = 0;
+
+	for (int i = 0; i < globals.num_entities; i++)
+	{
+		if (PInUse(i) && g_entities[i].s.eType == ET_MISSILE)
+		{
+			missiles++;
+		}
+	}
+
+	bench.frames++;
+	bench.missiles += missiles;
+	bench.frameUsec += usec;
+	if (usec > bench.maxFrameUsec)
+	{
+		bench.maxFrameUsec = usec;
+	}
+
+	if (!missiles || level.time >= bench.endTime)
+	{
+		G_MissileBenchReport();
+	}
+}
+
+/*
+==================
+Svcmd_MissileBench_f
+
+Fires a fan of blaster bolts from the player and times the game frames until
+they're all gone.
+==================
+*/
+void Svcmd_MissileBench_f()
+{
+	gentity_t* ent = &g_entities[0];
+
+	if (gi.argc() < 2)
+	{
+		gi.Printf("usage: missile_bench <count> [seconds]\n");
+		return;
+	}
+	if (!ent->inuse || !ent->client || ent->health <= 0)
+	{
+		gi.Printf("missile_bench needs a live player\n");
+		return;
+	}
+
+	int free_ents = MAX_GENTITIES - 1;
+	for (int i = 0; i < globals.num_entities; i++)
+	{
+		if (PInUse(i))
+		{
+			free_ents--;
+		}
+	}
+	// leave room for the impact effects and whatever else the level spawns
+	const int count = Com_Clampi(1, Q_max(1, free_ents - 128), atoi(gi.argv(1)));
+	const int seconds = gi.argc() > 2 ? Com_Clampi(1, 60, atoi(gi.argv(2))) : 10;
+
+	vec3_t start;
+	VectorCopy(ent->currentOrigin, start);
+	start[2] += ent->client->ps.viewheight;
+
+	// spread the bolts over a 90 degree fan, a few rows high
+	const int rows = Q_max(1, static_cast<int>(sqrtf(count / 4.0f)));
+	const int per_row = (count + rows - 1) / rows;
+
+	for (int i = 0; i < count; i++)
+	{
+		vec3_t angles, dir, muzzle;
+
+		VectorCopy(ent->client->ps.viewangles, angles);
+		angles[YAW] += (i % per_row - per_row * 0.5f) * 90.0f / per_row;
+		angles[PITCH] += (i / per_row - rows * 0.5f) * 20.0f / rows;
+		AngleVectors(angles, dir, nullptr, nullptr);
+		VectorCopy(start, muzzle);
+		WP_FireBlasterMissile(ent, muzzle, dir, qfalse);
+	}
+
+	memset(&missileBatchStats, 0, sizeof missileBatchStats);
+	missileBench = {};
+	missileBench.active = qtrue;
+	missileBench.endTime = level.time + seconds * 1000;
+	missileBench.frameTimer.Start();
+	gi.Printf("missile_bench: fired %d bolts\n", count);
+}
@@ -26,6 +26,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "g_functions.h"
 #include "objectives.h"
 #include "g_local.h"
+#include "g_navigator.h"
 
 #include "../icarus/IcarusInterface.h"
 
@@ -656,6 +657,12 @@ void SetMoverState(gentity_t* ent, const moverState_t moverState, const int time
 
 	ent->moverState = moverState;
 
+	// Nav edges through this mover may have just opened or closed
+	if (ent->wayedge)
+	{
+		NAV::InvalidatePathCache();
+	}
+
 	ent->s.pos.trTime = time;
 
 	if (ent->s.pos.trDuration <= 0)
@@ -67,6 +67,10 @@ extern qboolean G_CheckInSolidTeleport(const vec3_t& teleport_pos, const gentity
 
 extern cvar_t* g_nav1;
 extern cvar_t* g_nav2;
+extern cvar_t* g_navPathCache;
+extern cvar_t* g_navFlowFields;
+extern cvar_t* g_navEdgeValidate;
+extern cvar_t* g_navCrowd;
 extern cvar_t* g_developer;
 extern int delayedShutDown;
 extern vec3_t playerMinsStep;
@@ -87,6 +91,12 @@ extern cvar_t* com_outcast;
 #if !defined(RATL_VECTOR_VS_INC)
 #include "../Ratl/vector_vs.h"
 #endif
+#if !defined(RATL_HEAP_VS_INC)
+#include "../Ratl/heap_vs.h"
+#endif
+#if !defined(RATL_QUEUE_VS_INC)
+#include "../Ratl/queue_vs.h"
+#endif
 #if !defined(RUFL_HSTRING_INC)
 #include "../Rufl/hstring.h"
 #endif
@@ -150,6 +160,16 @@ namespace NAV
 		MIN_WAY_NEIGHBORS = 4,
 		MAX_NONWP_NEIGHBORS = 1,
 
+		PATH_CACHE_SIZE = 64,
+		PATH_CACHE_LIFETIME = 2000,
+
+		NUM_FLOW_FIELDS = 4,
+		FLOW_FIELD_LIFETIME = 3000,
+		FLOW_FIELD_WINDOW = 1000,
+		FLOW_FIELD_MIN_REQUESTS = 3,
+
+		MAX_EDGE_VALIDATIONS = 256,
+
 		// Human Sized
 		//-------------
 		SC_MEDIUM_RADIUS = 20,
@@ -177,7 +197,16 @@ namespace STEER
 		Z_CULL_OFFSET = 60,
 		SIDE_LOCKED_TIMER = 2000,
 		NEIGHBOR_RANGE = 60,
+
+		MAX_CROWD = 256,
+		MAX_CROWD_NEIGHBORS = 10,
+		CROWD_NEIGHBOR_RANGE = 160,
+		CROWD_TIME_HORIZON = 2,
+		CROWD_GRID_SIZE = 32,
+		CROWD_CELL_SIZE = 128,
 	};
+
+	constexpr float CROWD_EPSILON = 0.00001f;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////
@@ -260,6 +289,7 @@ public:
 		WE_JUMPING,
 		WE_CANBEINVAL,
 		WE_DESIGNERPLACED,
+		WE_VALIDATING,
 
 		WE_MAX
 	};
@@ -376,6 +406,7 @@ using TNameToNodeMap = ratl::map_vs<hstring, TNamedNodeList, NAV::NUM_NODES>;
 
 using TEdgesPerEnt = ratl::vector_vs<NAV::TEdgeHandle, NAV::MAX_EDGES_PER_ENT>;
 using TEntEdgeMap = ratl::map_vs<int, TEdgesPerEnt, NAV::MAX_BLOCKING_ENTS>;
+using TEdgeValidations = ratl::queue_vs<NAV::TEdgeHandle, NAV::MAX_EDGE_VALIDATIONS>;
 
 ////////////////////////////////////////////////////////////////////////////////////////
 // Path Point
@@ -413,6 +444,63 @@ struct SPathUser
 using TPathUsers = ratl::pool_vs<SPathUser, NAV::MAX_PATH_USERS>;
 using TPathUserIndex = ratl::array_vs<int, MAX_GENTITIES>;
 
+////////////////////////////////////////////////////////////////////////////////////////
+// Path Cache Entry
+//
+// A recent search result, keyed on start node, goal node, danger threshold and the
+// actor traits that change which edges are valid.  Nodes are stored goal first, the
+// same order A* hands them back in.
+////////////////////////////////////////////////////////////////////////////////////////
+using TPathNodes = ratl::vector_vs<NAV::TNodeHandle, NAV::MAX_PATH_SIZE>;
+
+struct SPathCacheEntry
+{
+	int mStart;
+	int mEnd;
+	int mDangerKey;
+	int mTraits;
+	int mGeneration;
+	int mExpireTime;
+	int mLastUseTime;
+	bool mSuccess;
+	TPathNodes mNodes;
+};
+
+using TPathCache = ratl::array_vs<SPathCacheEntry, NAV::PATH_CACHE_SIZE>;
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Flow Field
+//
+// One reverse Dijkstra from a popular goal.  For every node that can reach the goal,
+// mNext holds the neighbor to step to and mCost the remaining path cost, so any
+// number of followers can be served without running their own search.
+////////////////////////////////////////////////////////////////////////////////////////
+struct SFlowField
+{
+	int mGoal;
+	int mTraits;
+	int mGeneration;
+	int mExpireTime;
+	int mLastUseTime;
+	ratl::array_vs<short, NAV::NUM_NODES> mNext;
+	ratl::array_vs<float, NAV::NUM_NODES> mCost;
+};
+
+struct SFlowOpen
+{
+	int mNode;
+	float mCost;
+
+	bool operator <(const SFlowOpen& other) const
+	{
+		return mCost > other.mCost; // Reversed, So The Cheapest Node Sits On Top Of The Heap
+	}
+};
+
+using TFlowFields = ratl::array_vs<SFlowField, NAV::NUM_FLOW_FIELDS>;
+using TFlowOpen = ratl::heap_vs<SFlowOpen, NAV::NUM_EDGES * 2>;
+using TGoalRequests = ratl::array_vs<int, NAV::NUM_NODES>;
+
 using TNeighbors = ratl::vector_vs<gentity_t*, STEER::MAX_NEIGHBORS>;
 
 ////////////////////////////////////////////////////////////////////////////////////////
@@ -468,10 +556,66 @@ using TSteerUsers = ratl::pool_vs<SSteerUser, 4>;
 using TSteerUserIndex = ratl::array_vs<int, MAX_GENTITIES>;
 using TEntBits = ratl::bits_vs<MAX_GENTITIES>;
 
+////////////////////////////////////////////////////////////////////////////////////////
+// Crowd
+//
+// Flat per-frame copies of every body on the ground, laid out so the neighbor query and
+// the ORCA solve (see STEER::UpdateCrowd) walk straight through contiguous floats.
+////////////////////////////////////////////////////////////////////////////////////////
+struct SCrowdLine
+{
+	float mPointX;
+	float mPointY;
+	float mDirX;
+	float mDirY;
+};
+
+struct SCrowdPref
+{
+	float mX;
+	float mY;
+	int mTime;
+};
+
+struct SCrowd
+{
+	int mCount;
+	int mAgents;
+
+	float mPosX[STEER::MAX_CROWD];
+	float mPosY[STEER::MAX_CROWD];
+	float mPosZ[STEER::MAX_CROWD];
+	float mVelX[STEER::MAX_CROWD];
+	float mVelY[STEER::MAX_CROWD];
+	float mPrefX[STEER::MAX_CROWD];
+	float mPrefY[STEER::MAX_CROWD];
+	float mNewX[STEER::MAX_CROWD];
+	float mNewY[STEER::MAX_CROWD];
+	float mRadius[STEER::MAX_CROWD];
+	float mMaxSpeed[STEER::MAX_CROWD];
+	int mEntity[STEER::MAX_CROWD];
+	bool mAgent[STEER::MAX_CROWD];
+
+	// Bodies bucketed into a grid over the crowd's bounds, mCellBody holds each cell's
+	// bodies from mCellStart[cell] up to mCellStart[cell + 1]
+	float mGridX;
+	float mGridY;
+	float mCellSize;
+	int mGridW;
+	int mGridH;
+	short mCellStart[STEER::CROWD_GRID_SIZE * STEER::CROWD_GRID_SIZE + 1];
+	short mCellBody[STEER::MAX_CROWD];
+};
+
+using TCrowdLines = ratl::vector_vs<SCrowdLine, STEER::MAX_CROWD_NEIGHBORS>;
+using TCrowdSlots = ratl::array_vs<short, MAX_GENTITIES>;
+using TCrowdPrefs = ratl::array_vs<SCrowdPref, MAX_GENTITIES>;
+
 TAlertList& GetAlerts(const gentity_t* actor);
 TGraph& GetGraph();
 int GetAirRegion();
 int GetIslandRegion();
+void QueueEdgeValidation(CWayEdge& Edge, NAV::TEdgeHandle EdgeHandle);
 
 ////////////////////////////////////////////////////////////////////////////////////////
 // The Graph User
@@ -638,13 +782,9 @@ public:
 		}
 		else if (Edge.BlockingBreakable())
 		{
-			//we had a breakable in our way, now it's gone, see if there is anything else in the way
-			if (NAV::TestEdge(Edge.mNodeA, Edge.mNodeB, qfalse))
-			{
-				//clear it
-				Edge.mFlags.clear_bit(CWayEdge::WE_BLOCKING_BREAK);
-			}
-			//NOTE: if this fails with the SC_LARGE size
+			//we had a breakable in our way, now it's gone, the edge stays closed until the
+			//queued retest gets to it and makes sure there is nothing else in the way
+			QueueEdgeValidation(Edge, GetGraph().edge_index(Edge));
 		}
 
 		return Edge.mFlags.get_bit(CWayEdge::WE_VALID);
@@ -743,6 +883,7 @@ CGraphUser mUser;
 
 TNameToNodeMap mNodeNames;
 TEntEdgeMap mEntEdgeMap;
+TEdgeValidations mEdgeValidations;
 
 TNearestNavSort mNearestNavSort;
 
@@ -753,8 +894,23 @@ SPathUser mPathUserMaster;
 TSteerUsers mSteerUsers;
 TSteerUserIndex mSteerUserIndex;
 
+SCrowd mCrowd;
+TCrowdSlots mCrowdSlot;
+TCrowdPrefs mCrowdPref;
+TCrowdLines mCrowdLines;
+TCrowdLines mCrowdProjLines;
+int mCrowdSolveTime = 0;
+
 TEntityAlertList mEntityAlertList;
 
+TPathCache mPathCache;
+TFlowFields mFlowFields;
+TFlowOpen mFlowOpen;
+TGoalRequests mGoalRequests;
+TPathNodes mPathNodes;
+int mGoalRequestsWindow = 0;
+int mPathCacheGeneration = 1;
+
 vec3_t mZeroVec;
 trace_t mMoveTrace;
 trace_t mViewTrace;
@@ -766,6 +922,12 @@ int mConnectTime = 0;
 int mIslandCount = 0;
 int mIslandRegion = 0;
 int mAirRegion = 0;
+int mPathCacheHits = 0;
+int mPathCacheMisses = 0;
+int mPathCacheInvalidations = 0;
+int mFlowFieldBuilds = 0;
+int mFlowFieldServed = 0;
+int mEdgeValidationCount = 0;
 char mLocStringA[256] = { 0 };
 char mLocStringB[256] = { 0 };
 
@@ -814,6 +976,265 @@ int GetIslandRegion()
 	return mIslandRegion;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////
+// Path Cache : Actor Traits
+//
+// Packs everything about the actor that CGraphUser looks at into one key.  Returns -1
+// when the search also depends on per actor state that is not in the key (personal
+// danger alerts, smashing through breakables), so that actor must run its own A*.
+////////////////////////////////////////////////////////////////////////////////////////
+int PathCacheTraits(gentity_t* actor)
+{
+	if (!actor->NPC || actor->NPC->aiFlags & NPCAI_NAV_THROUGH_BREAKABLES)
+	{
+		return -1;
+	}
+
+	TAlertList& al = GetAlerts(actor);
+	for (int alIndex = 0; alIndex < TAlertList::CAPACITY; alIndex++)
+	{
+		if (al[alIndex].mHandle != 0)
+		{
+			return -1;
+		}
+	}
+
+	int traits = NAV::ClassifyEntSize(actor);
+	if (actor->NPC->scriptFlags & SCF_NAV_CAN_FLY)
+	{
+		traits |= 1 << 4;
+	}
+	if (actor->NPC->scriptFlags & SCF_NAV_CAN_JUMP)
+	{
+		traits |= 1 << 5;
+	}
+	if (INV_GoodieKeyCheck(actor))
+	{
+		traits |= 1 << 6;
+	}
+	return traits;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Path Cache : Find
+////////////////////////////////////////////////////////////////////////////////////////
+SPathCacheEntry* PathCacheFind(const int start, const int end, const int dangerKey, const int traits)
+{
+	for (int i = 0; i < TPathCache::CAPACITY; i++)
+	{
+		SPathCacheEntry& entry = mPathCache[i];
+		if (entry.mGeneration == mPathCacheGeneration &&
+			entry.mExpireTime > level.time &&
+			entry.mStart == start &&
+			entry.mEnd == end &&
+			entry.mDangerKey == dangerKey &&
+			entry.mTraits == traits)
+		{
+			entry.mLastUseTime = level.time;
+			return &entry;
+		}
+	}
+	return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Path Cache : Store
+//
+// Takes the first stale slot, or failing that the least recently used one.
+////////////////////////////////////////////////////////////////////////////////////////
+void PathCacheStore(const int start, const int end, const int dangerKey, const int traits, const bool success,
+	const TPathNodes& nodes)
+{
+	int replaceIndex = 0;
+	for (int i = 0; i < TPathCache::CAPACITY; i++)
+	{
+		const SPathCacheEntry& entry = mPathCache[i];
+		if (entry.mGeneration != mPathCacheGeneration || entry.mExpireTime <= level.time)
+		{
+			replaceIndex = i;
+			break;
+		}
+		if (entry.mLastUseTime < mPathCache[replaceIndex].mLastUseTime)
+		{
+			replaceIndex = i;
+		}
+	}
+
+	SPathCacheEntry& entry = mPathCache[replaceIndex];
+	entry.mStart = start;
+	entry.mEnd = end;
+	entry.mDangerKey = dangerKey;
+	entry.mTraits = traits;
+	entry.mGeneration = mPathCacheGeneration;
+	entry.mExpireTime = level.time + NAV::PATH_CACHE_LIFETIME;
+	entry.mLastUseTime = level.time;
+	entry.mSuccess = success;
+	entry.mNodes = nodes;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Flow Field : Find
+////////////////////////////////////////////////////////////////////////////////////////
+SFlowField* FlowFieldFind(const int goal, const int traits)
+{
+	for (int i = 0; i < TFlowFields::CAPACITY; i++)
+	{
+		SFlowField& field = mFlowFields[i];
+		if (field.mGeneration == mPathCacheGeneration &&
+			field.mExpireTime > level.time &&
+			field.mGoal == goal &&
+			field.mTraits == traits)
+		{
+			field.mLastUseTime = level.time;
+			return &field;
+		}
+	}
+	return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Flow Field : Build
+//
+// Runs a reverse Dijkstra out from the goal using the current graph user, so mUser
+// must already be set up with an actor that has the given traits.  Edge costs are
+// charged against the node nearer the goal, matching what A* charges walking forward.
+////////////////////////////////////////////////////////////////////////////////////////
+SFlowField& FlowFieldBuild(const int goal, const int traits, const CGraphUser& user)
+{
+	int replaceIndex = 0;
+	for (int i = 0; i < TFlowFields::CAPACITY; i++)
+	{
+		const SFlowField& field = mFlowFields[i];
+		if (field.mGeneration != mPathCacheGeneration || field.mExpireTime <= level.time)
+		{
+			replaceIndex = i;
+			break;
+		}
+		if (field.mLastUseTime < mFlowFields[replaceIndex].mLastUseTime)
+		{
+			replaceIndex = i;
+		}
+	}
+
+	SFlowField& field = mFlowFields[replaceIndex];
+	field.mGoal = goal;
+	field.mTraits = traits;
+	field.mGeneration = mPathCacheGeneration;
+	field.mExpireTime = level.time + NAV::FLOW_FIELD_LIFETIME;
+	field.mLastUseTime = level.time;
+	field.mNext.fill(0);
+	field.mCost.fill(-1.0f);
+	field.mCost[goal] = 0.0f;
+
+	SFlowOpen open;
+	open.mNode = goal;
+	open.mCost = 0.0f;
+	mFlowOpen.clear();
+	mFlowOpen.push(open);
+
+	while (!mFlowOpen.empty())
+	{
+		const SFlowOpen cur = mFlowOpen.top();
+		mFlowOpen.pop();
+
+		// Skip Entries That Were Improved After They Were Pushed
+		//--------------------------------------------------------
+		if (cur.mCost > field.mCost[cur.mNode])
+		{
+			continue;
+		}
+
+		const CWayNode& curNode = mGraph.get_node(cur.mNode);
+		TGraph::TNodeNeighbors& neighbors = mGraph.get_node_neighbors(cur.mNode);
+		for (int n = 0; n < neighbors.size(); n++)
+		{
+			const int edgeHandle = neighbors[n].mEdge;
+			const int nextNode = neighbors[n].mNode;
+			float edgeCost;
+
+			if (edgeHandle > 0)
+			{
+				CWayEdge& edge = mGraph.get_edge(edgeHandle);
+				if (!user.is_valid(edge, goal))
+				{
+					continue;
+				}
+				edgeCost = user.cost(edge, curNode);
+			}
+			else
+			{
+				edgeCost = user.cost(mGraph.get_node(nextNode), curNode);
+			}
+
+			const float nextCost = cur.mCost + edgeCost;
+			if (nextNode != goal && (field.mCost[nextNode] < 0.0f || nextCost < field.mCost[nextNode]))
+			{
+				field.mCost[nextNode] = nextCost;
+				field.mNext[nextNode] = static_cast<short>(cur.mNode);
+				if (!mFlowOpen.full())
+				{
+					open.mNode = nextNode;
+					open.mCost = nextCost;
+					mFlowOpen.push(open);
+				}
+			}
+		}
+	}
+
+	mFlowFieldBuilds++;
+	return field;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Flow Field : Path
+//
+// Follows the next hops from start to the goal and flips the result into goal first
+// order.  Fails if start can't reach the goal or the route won't fit in a path, in
+// which case the caller should fall back to A*.
+////////////////////////////////////////////////////////////////////////////////////////
+bool FlowFieldPath(const SFlowField& field, const int start, TPathNodes& nodes)
+{
+	nodes.clear();
+	if (start != field.mGoal && field.mNext[start] == 0)
+	{
+		return false;
+	}
+
+	for (int at = start; ; at = field.mNext[at])
+	{
+		if (nodes.full())
+		{
+			nodes.clear();
+			return false;
+		}
+		nodes.push_back(at);
+		if (at == field.mGoal)
+		{
+			break;
+		}
+	}
+
+	for (int lo = 0, hi = nodes.size() - 1; lo < hi; lo++, hi--)
+	{
+		const NAV::TNodeHandle swap = nodes[lo];
+		nodes[lo] = nodes[hi];
+		nodes[hi] = swap;
+	}
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Invalidate Path Cache
+//
+// Call whenever edge validity changes.  Bumping the generation retires every cached
+// path and flow field at once.
+////////////////////////////////////////////////////////////////////////////////////////
+void NAV::InvalidatePathCache()
+{
+	mPathCacheGeneration++;
+	mPathCacheInvalidations++;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////
 // Helper Function : View Trace
 ////////////////////////////////////////////////////////////////////////////////////////
@@ -1172,6 +1593,24 @@ bool NAV::LoadFromFile(const char* filename, int checksum)
 
 	memset(&mEntityAlertList, 0, sizeof mEntityAlertList);
 
+	mPathCacheGeneration = 1;
+	mPathCacheHits = 0;
+	mPathCacheMisses = 0;
+	mPathCacheInvalidations = 0;
+	mFlowFieldBuilds = 0;
+	mFlowFieldServed = 0;
+	mGoalRequestsWindow = 0;
+	memset(&mPathCache, 0, sizeof mPathCache);
+	memset(&mFlowFields, 0, sizeof mFlowFields);
+
+	mEdgeValidations.clear();
+	mEdgeValidationCount = 0;
+
+	mCrowd.mCount = 0;
+	mCrowd.mAgents = 0;
+	mCrowdSlot.fill(-1);
+	memset(&mCrowdPref, 0, sizeof mCrowdPref);
+
 #if !defined(FINAL_BUILD)
 	ratl::ratl_base::OutputPrint = stupid_print;
 #endif
@@ -2198,13 +2637,104 @@ void NAV::WayEdgesNowClear(gentity_t* ent)
 				if (EdgeHandle != 0)
 				{
 					CWayEdge& edge = mGraph.get_edge(EdgeHandle);
-					edge.mFlags.set_bit(CWayEdge::WE_VALID);
 					edge.mEntityNum = ENTITYNUM_NONE;
 					edge.mOwnerNum = ENTITYNUM_NONE;
+
+					// Breakables Were Only Traced Up To The Breakable Itself, So Retest Just These Edges
+					//------------------------------------------------------------------------------------
+					if (edge.BlockingBreakable())
+					{
+						QueueEdgeValidation(edge, EdgeHandle);
+					}
+					else
+					{
+						edge.mFlags.set_bit(CWayEdge::WE_VALID);
+					}
 				}
 			}
 			mEntEdgeMap.erase(EntNum);
+			InvalidatePathCache();
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Queue Edge Validation
+//
+// Edges are indexed by the entity their swept trace ran into (mEntEdgeMap), so when that
+// entity goes away only its own edges need to be traced again.  The edge is held closed
+// until NAV::ValidateEdges() gets to it, which spreads the traces over several frames.
+////////////////////////////////////////////////////////////////////////////////////////
+void QueueEdgeValidation(CWayEdge& Edge, const NAV::TEdgeHandle EdgeHandle)
+{
+	Edge.mFlags.clear_bit(CWayEdge::WE_VALID);
+	if (Edge.mFlags.get_bit(CWayEdge::WE_VALIDATING))
+	{
+		return;
+	}
+
+	// If The Queue Is Full, Fall Back To Testing It Right Now
+	//---------------------------------------------------------
+	if (mEdgeValidations.full())
+	{
+		Edge.mFlags.clear_bit(CWayEdge::WE_BLOCKING_BREAK);
+		if (NAV::TestEdge(Edge.mNodeA, Edge.mNodeB, qfalse))
+		{
+			Edge.mFlags.set_bit(CWayEdge::WE_VALID);
 		}
+		mEdgeValidationCount++;
+		NAV::InvalidatePathCache();
+		return;
+	}
+
+	Edge.mFlags.set_bit(CWayEdge::WE_VALIDATING);
+	mEdgeValidations.push(EdgeHandle);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Validate Edges
+//
+// Runs once a frame, retesting at most g_navEdgeValidate of the queued edges (zero empties
+// the whole queue).
+////////////////////////////////////////////////////////////////////////////////////////
+void NAV::ValidateEdges()
+{
+	int budget = g_navEdgeValidate->integer;
+	if (budget <= 0)
+	{
+		budget = mEdgeValidations.size();
+	}
+
+	bool changed = false;
+	while (budget-- > 0 && !mEdgeValidations.empty())
+	{
+		const TEdgeHandle EdgeHandle = mEdgeValidations.top();
+		mEdgeValidations.pop();
+
+		CWayEdge& edge = mGraph.get_edge(EdgeHandle);
+		edge.mFlags.clear_bit(CWayEdge::WE_VALIDATING);
+
+		// Already Resolved Some Other Way?
+		//----------------------------------
+		if (!edge.BlockingBreakable() || edge.mEntityNum != ENTITYNUM_NONE)
+		{
+			continue;
+		}
+
+		// See If There Is Anything Else In The Way, TestEdge Re-Registers Any New Blocker
+		//---------------------------------------------------------------------------------
+		edge.mFlags.clear_bit(CWayEdge::WE_BLOCKING_BREAK);
+		if (TestEdge(edge.mNodeA, edge.mNodeB, qfalse) && !edge.BlockingBreakable())
+		{
+			edge.mFlags.set_bit(CWayEdge::WE_VALID);
+		}
+		mEdgeValidationCount++;
+		changed = true;
+	}
+
+	if (changed)
+	{
+		InvalidatePathCache();
 	}
 }
 
@@ -2759,26 +3289,94 @@ bool NAV::FindPath(gentity_t* actor, TNodeHandle target, const float MaxDangerLe
 		return puser.mSuccess;
 	}
 
-	// Now, Run A*
-	//-------------
+	// Set Up Any Danger Spot For This Actor
+	//---------------------------------------
+	bool hasDangerSpot = false;
 	if (actor->enemy && actor->enemy->client)
 	{
 		if (actor->enemy->client->ps.weapon == WP_SABER)
 		{
 			mUser.SetDangerSpot(actor->enemy->currentOrigin, 200.0f);
+			hasDangerSpot = true;
 		}
 		else if (
 			actor->enemy->client->NPC_class == CLASS_RANCOR ||
 			actor->enemy->client->NPC_class == CLASS_WAMPA)
 		{
 			mUser.SetDangerSpot(actor->enemy->currentOrigin, 400.0f);
+			hasDangerSpot = true;
+		}
+	}
+
+	// Only Share Results Between Actors Whose Searches Would Come Out The Same
+	//--------------------------------------------------------------------------
+	const int traits = g_navPathCache->integer && !hasDangerSpot ? PathCacheTraits(actor) : -1;
+	const int dangerKey = static_cast<int>(MaxDangerLevel * 100.0f);
+	bool found = false;
+
+	if (traits != -1)
+	{
+		// Try A Recent Result For The Same Start And Goal
+		//-------------------------------------------------
+		const SPathCacheEntry* entry = PathCacheFind(start, target, dangerKey, traits);
+		if (entry)
+		{
+			mPathCacheHits++;
+			puser.mSuccess = entry->mSuccess;
+			mPathNodes = entry->mNodes;
+			found = true;
+		}
+
+		// Try A Flow Field If Enough Actors Are Heading For This Goal
+		//-------------------------------------------------------------
+		else if (g_navFlowFields->integer)
+		{
+			if (level.time >= mGoalRequestsWindow)
+			{
+				mGoalRequests.fill(0);
+				mGoalRequestsWindow = level.time + FLOW_FIELD_WINDOW;
+			}
+			mGoalRequests[target]++;
+
+			const SFlowField* field = FlowFieldFind(target, traits);
+			if (!field && mGoalRequests[target] >= FLOW_FIELD_MIN_REQUESTS)
+			{
+				field = &FlowFieldBuild(target, traits, mUser);
+			}
+			if (field && FlowFieldPath(*field, start, mPathNodes))
+			{
+				mFlowFieldServed++;
+				puser.mSuccess = true;
+				found = true;
+			}
+		}
+	}
+
+	// Now, Run A*
+	//-------------
+	if (!found)
+	{
+		mGraph.astar(mSearch, mUser);
+
+		puser.mSuccess = mSearch.success();
+		mPathNodes.clear();
+		if (puser.mSuccess)
+		{
+			for (mSearch.path_begin(); !mSearch.path_end() && !mPathNodes.full(); mSearch.path_inc())
+			{
+				mPathNodes.push_back(mSearch.path_at());
+			}
+		}
+
+		if (traits != -1)
+		{
+			mPathCacheMisses++;
+			PathCacheStore(start, target, dangerKey, traits, puser.mSuccess, mPathNodes);
 		}
 	}
-	mGraph.astar(mSearch, mUser);
 	mUser.ClearDangerSpot();
 
 	puser.mLastAStarTime = level.time + Q_irand(3000, 6000);
-	puser.mSuccess = mSearch.success();
 	if (!puser.mSuccess)
 	{
 		return puser.mSuccess;
@@ -2817,7 +3415,7 @@ bool NAV::FindPath(gentity_t* actor, TNodeHandle target, const float MaxDangerLe
 	{
 		SPathPoint PPoint = {};
 		puser.mPath.clear();
-		for (mSearch.path_begin(); !mSearch.path_end() && !puser.mPath.full(); mSearch.path_inc())
+		for (int nodeIndex = 0; nodeIndex < mPathNodes.size() && !puser.mPath.full(); nodeIndex++)
 		{
 			if (puser.mPath.full())
 			{
@@ -2830,7 +3428,7 @@ bool NAV::FindPath(gentity_t* actor, TNodeHandle target, const float MaxDangerLe
 				return false;
 			}
 
-			PPoint.mNode = mSearch.path_at();
+			PPoint.mNode = mPathNodes[nodeIndex];
 			PPoint.mPoint = mGraph.get_node(PPoint.mNode).mPoint;
 			PPoint.mSpeed = AtSpeed;
 			PPoint.mSlowingRadius = 0.0f;
@@ -3869,6 +4467,7 @@ void NAV::ShowStats()
 	mGraph.ProfilePrint("Path   : (%d)", (sizeof(mPathUsers) + sizeof(mPathUserIndex)));
 	mGraph.ProfilePrint("Steer  : (%d)", (sizeof(mSteerUsers) + sizeof(mSteerUserIndex)));
 	mGraph.ProfilePrint("Alerts : (%d)", (sizeof(mEntityAlertList)));
+	mGraph.ProfilePrint("PCache : (%d)", (sizeof(mPathCache) + sizeof(mFlowFields) + sizeof(mFlowOpen)));
 	float totalBytes = (
 		sizeof(mCells) +
 		sizeof(mGraph) +
@@ -3877,7 +4476,10 @@ void NAV::ShowStats()
 		sizeof(mPathUserIndex) +
 		sizeof(mSteerUsers) +
 		sizeof(mSteerUserIndex) +
-		sizeof(mEntityAlertList));
+		sizeof(mEntityAlertList) +
+		sizeof(mPathCache) +
+		sizeof(mFlowFields) +
+		sizeof(mFlowOpen));
 
 	mGraph.ProfilePrint("TOTAL :  (KiloBytes): (%5.3f)  MeggaBytes(%3.3f)",
 		((float)(totalBytes) / 1024.0f),
@@ -3889,6 +4491,11 @@ void NAV::ShowStats()
 	mGraph.ProfilePrint("");
 	mGraph.ProfilePrint("Move Trace: Count(%d) PerFrame(%f)", mMoveTraceCount, (float)(mMoveTraceCount) / (float)(level.time));
 	mGraph.ProfilePrint("View Trace: Count(%d) PerFrame(%f)", mViewTraceCount, (float)(mViewTraceCount) / (float)(level.time));
+	mGraph.ProfilePrint("");
+	mGraph.ProfilePrint("Path Cache: Hits(%d) Misses(%d) Invalidations(%d)", mPathCacheHits, mPathCacheMisses, mPathCacheInvalidations);
+	mGraph.ProfilePrint("Flow Field: Builds(%d) Served(%d)", mFlowFieldBuilds, mFlowFieldServed);
+	mGraph.ProfilePrint("Edge Retests: Count(%d) Pending(%d)", mEdgeValidationCount, mEdgeValidations.size());
+	mGraph.ProfilePrint("Crowd: Bodies(%d) Agents(%d) Milliseconds(%d)", mCrowd.mCount, mCrowd.mAgents, mCrowdSolveTime);
 
 #endif
 }
@@ -5235,6 +5842,589 @@ float STEER::AvoidCollisions(gentity_t* actor, const gentity_t* leader)
 	return 0.0f;
 }
 
+////////////////////////////////////////////////////////////////////////////////////
+// Crowd Avoidance
+//
+// Optimal reciprocal collision avoidance (ORCA) on the ground plane.  Every living
+// client is copied into flat arrays once a frame, and each moving NPC solves a small
+// linear program against the velocity obstacles of its nearest neighbors.  Moving NPCs
+// take half the responsibility for avoiding each other, everything else (the player,
+// idle NPCs) is treated as a body that will not get out of the way.
+//
+// NPCs only know what velocity they want once their behavior state has run, so the
+// velocity each NPC asked for last frame is what goes into this frame's solve, and
+// AvoidCrowd() applies the difference between the solved and preferred velocities to
+// whatever the NPC wants this frame.
+////////////////////////////////////////////////////////////////////////////////////
+inline float CrowdDet(const float ax, const float ay, const float bx, const float by)
+{
+	return ax * by - ay * bx;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// Solve along a single constraint line, clipped by all the lines before it
+////////////////////////////////////////////////////////////////////////////////////
+bool CrowdLinearProgram1(const TCrowdLines& lines, const int lineNo, const float radius, const float optX,
+	const float optY, const bool directionOpt, float& resultX, float& resultY)
+{
+	const SCrowdLine& line = lines[lineNo];
+	const float dotProduct = line.mPointX * line.mDirX + line.mPointY * line.mDirY;
+	const float discriminant = dotProduct * dotProduct + radius * radius - (line.mPointX * line.mPointX + line.mPointY *
+		line.mPointY);
+
+	// Max Speed Circle Fully Invalidates This Line
+	//----------------------------------------------
+	if (discriminant < 0.0f)
+	{
+		return false;
+	}
+
+	const float sqrtDiscriminant = sqrtf(discriminant);
+	float tLeft = -dotProduct - sqrtDiscriminant;
+	float tRight = -dotProduct + sqrtDiscriminant;
+
+	for (int i = 0; i < lineNo; i++)
+	{
+		const SCrowdLine& other = lines[i];
+		const float denominator = CrowdDet(line.mDirX, line.mDirY, other.mDirX, other.mDirY);
+		const float numerator = CrowdDet(other.mDirX, other.mDirY, line.mPointX - other.mPointX,
+			line.mPointY - other.mPointY);
+
+		// Lines Are (Almost) Parallel
+		//-----------------------------
+		if (fabsf(denominator) <= STEER::CROWD_EPSILON)
+		{
+			if (numerator < 0.0f)
+			{
+				return false;
+			}
+			continue;
+		}
+
+		const float t = numerator / denominator;
+		if (denominator >= 0.0f)
+		{
+			tRight = Q_min(tRight, t);
+		}
+		else
+		{
+			tLeft = Q_max(tLeft, t);
+		}
+
+		if (tLeft > tRight)
+		{
+			return false;
+		}
+	}
+
+	float t;
+	if (directionOpt)
+	{
+		t = optX * line.mDirX + optY * line.mDirY > 0.0f ? tRight : tLeft;
+	}
+	else
+	{
+		t = line.mDirX * (optX - line.mPointX) + line.mDirY * (optY - line.mPointY);
+		t = Com_Clamp(tLeft, tRight, t);
+	}
+
+	resultX = line.mPointX + t * line.mDirX;
+	resultY = line.mPointY + t * line.mDirY;
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// Find the velocity closest to the optimal one that satisfies every line, returns the
+// index of the first line that could not be satisfied (or the number of lines)
+////////////////////////////////////////////////////////////////////////////////////
+int CrowdLinearProgram2(const TCrowdLines& lines, const float radius, const float optX, const float optY,
+	const bool directionOpt, float& resultX, float& resultY)
+{
+	const float optLenSq = optX * optX + optY * optY;
+	if (directionOpt)
+	{
+		resultX = optX * radius;
+		resultY = optY * radius;
+	}
+	else if (optLenSq > radius * radius)
+	{
+		const float scale = radius / sqrtf(optLenSq);
+		resultX = optX * scale;
+		resultY = optY * scale;
+	}
+	else
+	{
+		resultX = optX;
+		resultY = optY;
+	}
+
+	for (int i = 0; i < lines.size(); i++)
+	{
+		const SCrowdLine& line = lines[i];
+		if (CrowdDet(line.mDirX, line.mDirY, line.mPointX - resultX, line.mPointY - resultY) > 0.0f)
+		{
+			const float tempX = resultX;
+			const float tempY = resultY;
+			if (!CrowdLinearProgram1(lines, i, radius, optX, optY, directionOpt, resultX, resultY))
+			{
+				resultX = tempX;
+				resultY = tempY;
+				return i;
+			}
+		}
+	}
+	return lines.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// Too crowded to satisfy everything, so minimize the worst penetration instead
+////////////////////////////////////////////////////////////////////////////////////
+void CrowdLinearProgram3(const TCrowdLines& lines, const int beginLine, const float radius, float& resultX,
+	float& resultY)
+{
+	float distance = 0.0f;
+
+	for (int i = beginLine; i < lines.size(); i++)
+	{
+		const SCrowdLine& line = lines[i];
+		if (CrowdDet(line.mDirX, line.mDirY, line.mPointX - resultX, line.mPointY - resultY) <= distance)
+		{
+			continue;
+		}
+
+		mCrowdProjLines.clear();
+		for (int j = 0; j < i; j++)
+		{
+			const SCrowdLine& other = lines[j];
+			SCrowdLine proj;
+
+			const float determinant = CrowdDet(line.mDirX, line.mDirY, other.mDirX, other.mDirY);
+			if (fabsf(determinant) <= STEER::CROWD_EPSILON)
+			{
+				// Parallel And Pointing The Same Way
+				//------------------------------------
+				if (line.mDirX * other.mDirX + line.mDirY * other.mDirY > 0.0f)
+				{
+					continue;
+				}
+				proj.mPointX = 0.5f * (line.mPointX + other.mPointX);
+				proj.mPointY = 0.5f * (line.mPointY + other.mPointY);
+			}
+			else
+			{
+				const float t = CrowdDet(other.mDirX, other.mDirY, line.mPointX - other.mPointX,
+					line.mPointY - other.mPointY) / determinant;
+				proj.mPointX = line.mPointX + t * line.mDirX;
+				proj.mPointY = line.mPointY + t * line.mDirY;
+			}
+
+			proj.mDirX = other.mDirX - line.mDirX;
+			proj.mDirY = other.mDirY - line.mDirY;
+			const float dirLen = sqrtf(proj.mDirX * proj.mDirX + proj.mDirY * proj.mDirY);
+			if (dirLen <= STEER::CROWD_EPSILON)
+			{
+				continue;
+			}
+			proj.mDirX /= dirLen;
+			proj.mDirY /= dirLen;
+			mCrowdProjLines.push_back(proj);
+		}
+
+		const float tempX = resultX;
+		const float tempY = resultY;
+		if (CrowdLinearProgram2(mCrowdProjLines, radius, -line.mDirY, line.mDirX, true, resultX, resultY) <
+			mCrowdProjLines.size())
+		{
+			// Only Happens Through Floating Point Error, Keep The Old Result
+			//-----------------------------------------------------------------
+			resultX = tempX;
+			resultY = tempY;
+		}
+
+		distance = CrowdDet(line.mDirX, line.mDirY, line.mPointX - resultX, line.mPointY - resultY);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// Grid cell along one axis, clamped to the grid
+////////////////////////////////////////////////////////////////////////////////////
+inline int CrowdCell(const float pos, const float gridMin, const int gridCells)
+{
+	return Com_Clampi(0, gridCells - 1, static_cast<int>((pos - gridMin) / mCrowd.mCellSize));
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// Bucket the crowd into a grid over its bounds so the neighbor query only looks at
+// bodies in nearby cells.  Cells grow past CROWD_CELL_SIZE when the crowd is spread
+// wider than the grid.
+////////////////////////////////////////////////////////////////////////////////////
+void CrowdBuildGrid()
+{
+	float minX = mCrowd.mPosX[0];
+	float minY = mCrowd.mPosY[0];
+	float maxX = minX;
+	float maxY = minY;
+
+	for (int i = 1; i < mCrowd.mCount; i++)
+	{
+		minX = Q_min(minX, mCrowd.mPosX[i]);
+		minY = Q_min(minY, mCrowd.mPosY[i]);
+		maxX = Q_max(maxX, mCrowd.mPosX[i]);
+		maxY = Q_max(maxY, mCrowd.mPosY[i]);
+	}
+
+	mCrowd.mGridX = minX;
+	mCrowd.mGridY = minY;
+	mCrowd.mCellSize = Q_max(static_cast<float>(STEER::CROWD_CELL_SIZE),
+		Q_max(maxX - minX, maxY - minY) / STEER::CROWD_GRID_SIZE + 1.0f);
+	mCrowd.mGridW = static_cast<int>((maxX - minX) / mCrowd.mCellSize) + 1;
+	mCrowd.mGridH = static_cast<int>((maxY - minY) / mCrowd.mCellSize) + 1;
+
+	// Count, Then Turn The Counts Into Start Offsets
+	//------------------------------------------------
+	short cellOf[STEER::MAX_CROWD];
+	const int numCells = mCrowd.mGridW * mCrowd.mGridH;
+	memset(mCrowd.mCellStart, 0, (numCells + 1) * sizeof(mCrowd.mCellStart[0]));
+
+	for (int i = 0; i < mCrowd.mCount; i++)
+	{
+		cellOf[i] = CrowdCell(mCrowd.mPosY[i], minY, mCrowd.mGridH) * mCrowd.mGridW +
+			CrowdCell(mCrowd.mPosX[i], minX, mCrowd.mGridW);
+		mCrowd.mCellStart[cellOf[i] + 1]++;
+	}
+	for (int cell = 0; cell < numCells; cell++)
+	{
+		mCrowd.mCellStart[cell + 1] += mCrowd.mCellStart[cell];
+	}
+
+	// Fill The Cells, Walking Back So Each Cell Keeps Its Bodies In Order
+	//---------------------------------------------------------------------
+	short fill[STEER::CROWD_GRID_SIZE * STEER::CROWD_GRID_SIZE + 1];
+	memcpy(fill, mCrowd.mCellStart + 1, numCells * sizeof(fill[0]));
+	for (int i = mCrowd.mCount - 1; i >= 0; i--)
+	{
+		mCrowd.mCellBody[--fill[cellOf[i]]] = i;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// Build the ORCA half planes for one agent and solve for its new velocity
+////////////////////////////////////////////////////////////////////////////////////
+void CrowdSolveAgent(const int agent, const float invTimeStep)
+{
+	constexpr float invTimeHorizon = 1.0f / STEER::CROWD_TIME_HORIZON;
+
+	const float posX = mCrowd.mPosX[agent];
+	const float posY = mCrowd.mPosY[agent];
+	const float posZ = mCrowd.mPosZ[agent];
+	const float velX = mCrowd.mVelX[agent];
+	const float velY = mCrowd.mVelY[agent];
+	const float radius = mCrowd.mRadius[agent];
+	const float rangeSq = (radius + STEER::CROWD_NEIGHBOR_RANGE) * (radius + STEER::CROWD_NEIGHBOR_RANGE);
+
+	// Find The Nearest Neighbors (Insertion Sorted By Distance)
+	//-----------------------------------------------------------
+	int neighbors[STEER::MAX_CROWD_NEIGHBORS];
+	float neighborDistSq[STEER::MAX_CROWD_NEIGHBORS];
+	int numNeighbors = 0;
+
+	const float range = radius + STEER::CROWD_NEIGHBOR_RANGE;
+	const int minCellX = CrowdCell(posX - range, mCrowd.mGridX, mCrowd.mGridW);
+	const int maxCellX = CrowdCell(posX + range, mCrowd.mGridX, mCrowd.mGridW);
+	const int minCellY = CrowdCell(posY - range, mCrowd.mGridY, mCrowd.mGridH);
+	const int maxCellY = CrowdCell(posY + range, mCrowd.mGridY, mCrowd.mGridH);
+
+	for (int cellY = minCellY; cellY <= maxCellY; cellY++)
+	{
+		for (int cellX = minCellX; cellX <= maxCellX; cellX++)
+		{
+			const int cell = cellY * mCrowd.mGridW + cellX;
+			for (int body = mCrowd.mCellStart[cell]; body < mCrowd.mCellStart[cell + 1]; body++)
+			{
+				const int other = mCrowd.mCellBody[body];
+				const float dx = mCrowd.mPosX[other] - posX;
+				const float dy = mCrowd.mPosY[other] - posY;
+				const float distSq = dx * dx + dy * dy;
+
+				if (other == agent || distSq > rangeSq || fabsf(mCrowd.mPosZ[other] - posZ) > STEER::Z_CULL_OFFSET)
+				{
+					continue;
+				}
+				if (numNeighbors == STEER::MAX_CROWD_NEIGHBORS && distSq >= neighborDistSq[numNeighbors - 1])
+				{
+					continue;
+				}
+
+				int slot = numNeighbors < STEER::MAX_CROWD_NEIGHBORS ? numNeighbors++ : numNeighbors - 1;
+				while (slot > 0 && neighborDistSq[slot - 1] > distSq)
+				{
+					neighbors[slot] = neighbors[slot - 1];
+					neighborDistSq[slot] = neighborDistSq[slot - 1];
+					slot--;
+				}
+				neighbors[slot] = other;
+				neighborDistSq[slot] = distSq;
+			}
+		}
+	}
+
+	// Build One Half Plane Per Neighbor
+	//-----------------------------------
+	mCrowdLines.clear();
+	for (int n = 0; n < numNeighbors; n++)
+	{
+		const int other = neighbors[n];
+		const float relPosX = mCrowd.mPosX[other] - posX;
+		const float relPosY = mCrowd.mPosY[other] - posY;
+		const float relVelX = velX - mCrowd.mVelX[other];
+		const float relVelY = velY - mCrowd.mVelY[other];
+		const float distSq = neighborDistSq[n];
+		const float combinedRadius = radius + mCrowd.mRadius[other];
+		const float combinedRadiusSq = combinedRadius * combinedRadius;
+
+		SCrowdLine line;
+		float uX, uY;
+
+		if (distSq > combinedRadiusSq)
+		{
+			// No Collision Yet, Vector From Cutoff Center To Relative Velocity
+			//------------------------------------------------------------------
+			const float wX = relVelX - invTimeHorizon * relPosX;
+			const float wY = relVelY - invTimeHorizon * relPosY;
+			const float wLenSq = wX * wX + wY * wY;
+			const float dotProduct = wX * relPosX + wY * relPosY;
+
+			if (dotProduct < 0.0f && dotProduct * dotProduct > combinedRadiusSq * wLenSq)
+			{
+				// Project On The Cutoff Circle
+				//------------------------------
+				const float wLen = sqrtf(wLenSq);
+				const float unitWX = wX / wLen;
+				const float unitWY = wY / wLen;
+
+				line.mDirX = unitWY;
+				line.mDirY = -unitWX;
+				uX = (combinedRadius * invTimeHorizon - wLen) * unitWX;
+				uY = (combinedRadius * invTimeHorizon - wLen) * unitWY;
+			}
+			else
+			{
+				// Project On The Legs
+				//---------------------
+				const float leg = sqrtf(distSq - combinedRadiusSq);
+
+				if (CrowdDet(relPosX, relPosY, wX, wY) > 0.0f)
+				{
+					line.mDirX = (relPosX * leg - relPosY * combinedRadius) / distSq;
+					line.mDirY = (relPosX * combinedRadius + relPosY * leg) / distSq;
+				}
+				else
+				{
+					line.mDirX = -(relPosX * leg + relPosY * combinedRadius) / distSq;
+					line.mDirY = -(-relPosX * combinedRadius + relPosY * leg) / distSq;
+				}
+
+				const float dotProduct2 = relVelX * line.mDirX + relVelY * line.mDirY;
+				uX = dotProduct2 * line.mDirX - relVelX;
+				uY = dotProduct2 * line.mDirY - relVelY;
+			}
+		}
+		else
+		{
+			// Already Overlapping, Push Apart Within One Time Step
+			//------------------------------------------------------
+			const float wX = relVelX - invTimeStep * relPosX;
+			const float wY = relVelY - invTimeStep * relPosY;
+			const float wLen = sqrtf(wX * wX + wY * wY);
+			if (wLen <= STEER::CROWD_EPSILON)
+			{
+				continue;
+			}
+			const float unitWX = wX / wLen;
+			const float unitWY = wY / wLen;
+
+			line.mDirX = unitWY;
+			line.mDirY = -unitWX;
+			uX = (combinedRadius * invTimeStep - wLen) * unitWX;
+			uY = (combinedRadius * invTimeStep - wLen) * unitWY;
+		}
+
+		// Moving NPCs Share The Work, Everything Else Has To Be Avoided Entirely
+		//------------------------------------------------------------------------
+		const float responsibility = mCrowd.mAgent[other] ? 0.5f : 1.0f;
+		line.mPointX = velX + responsibility * uX;
+		line.mPointY = velY + responsibility * uY;
+		mCrowdLines.push_back(line);
+	}
+
+	float newX, newY;
+	const float maxSpeed = mCrowd.mMaxSpeed[agent];
+	const int lineFail = CrowdLinearProgram2(mCrowdLines, maxSpeed, mCrowd.mPrefX[agent], mCrowd.mPrefY[agent],
+		false, newX, newY);
+	if (lineFail < mCrowdLines.size())
+	{
+		CrowdLinearProgram3(mCrowdLines, lineFail, maxSpeed, newX, newY);
+	}
+
+	mCrowd.mNewX[agent] = newX;
+	mCrowd.mNewY[agent] = newY;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// Update Crowd
+//
+// Gathers everything that takes up space on the ground into the crowd arrays and
+// solves new velocities for all moving NPCs in one pass.  Called once a frame.
+////////////////////////////////////////////////////////////////////////////////////
+void STEER::UpdateCrowd()
+{
+	mCrowd.mCount = 0;
+	mCrowd.mAgents = 0;
+	mCrowdSlot.fill(-1);
+
+	if (!g_navCrowd->integer)
+	{
+		return;
+	}
+
+	const int startTime = gi.Milliseconds();
+
+	// Gather
+	//--------
+	for (int i = 0; i < globals.num_entities && mCrowd.mCount < MAX_CROWD; i++)
+	{
+		const gentity_t* ent = &g_entities[i];
+		if (!ent->inuse ||
+			!ent->client ||
+			ent->health <= 0 ||
+			ent->client->moveType == MT_FLYSWIM ||
+			ent->client->ps.groundEntityNum == ENTITYNUM_NONE)
+		{
+			continue;
+		}
+
+		const int slot = mCrowd.mCount++;
+		const SCrowdPref& pref = mCrowdPref[i];
+		const bool isAgent =
+			ent->NPC != nullptr &&
+			pref.mTime >= level.previousTime &&
+			(pref.mX != 0.0f || pref.mY != 0.0f);
+
+		mCrowd.mPosX[slot] = ent->currentOrigin[0];
+		mCrowd.mPosY[slot] = ent->currentOrigin[1];
+		mCrowd.mPosZ[slot] = ent->currentOrigin[2];
+		mCrowd.mVelX[slot] = ent->client->ps.velocity[0];
+		mCrowd.mVelY[slot] = ent->client->ps.velocity[1];
+		mCrowd.mRadius[slot] = Q_max(ent->maxs[0], ent->maxs[1]);
+		mCrowd.mEntity[slot] = i;
+		mCrowd.mAgent[slot] = isAgent;
+
+		if (isAgent)
+		{
+			mCrowd.mPrefX[slot] = pref.mX;
+			mCrowd.mPrefY[slot] = pref.mY;
+			mCrowd.mMaxSpeed[slot] = Q_max(static_cast<float>(ent->NPC->stats.runSpeed), sqrtf(pref.mX * pref.mX +
+				pref.mY * pref.mY));
+			mCrowd.mAgents++;
+		}
+		else
+		{
+			mCrowd.mPrefX[slot] = mCrowd.mVelX[slot];
+			mCrowd.mPrefY[slot] = mCrowd.mVelY[slot];
+			mCrowd.mMaxSpeed[slot] = 0.0f;
+		}
+		mCrowd.mNewX[slot] = mCrowd.mPrefX[slot];
+		mCrowd.mNewY[slot] = mCrowd.mPrefY[slot];
+		mCrowdSlot[i] = slot;
+	}
+
+	// Solve
+	//-------
+	if (mCrowd.mAgents)
+	{
+		CrowdBuildGrid();
+
+		const float invTimeStep = 1000.0f / Q_max(level.time - level.previousTime, 1);
+		for (int agent = 0; agent < mCrowd.mCount; agent++)
+		{
+			if (mCrowd.mAgent[agent])
+			{
+				CrowdSolveAgent(agent, invTimeStep);
+			}
+		}
+	}
+
+	mCrowdSolveTime = gi.Milliseconds() - startTime;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+// Avoid Crowd
+//
+// Called with the final movement command for an NPC.  Records the velocity the NPC
+// wants for the next solve, and bends this frame's command by the avoidance the crowd
+// solve worked out for it.
+////////////////////////////////////////////////////////////////////////////////////
+void STEER::AvoidCrowd(const gentity_t* actor, usercmd_t* ucmd)
+{
+	if (!g_navCrowd->integer || !actor || !actor->client || !actor->NPC)
+	{
+		return;
+	}
+
+	// Turn The Movement Command Back Into A Desired Velocity
+	//--------------------------------------------------------
+	vec3_t forward, right;
+	AngleVectors(actor->currentAngles, forward, right, nullptr);
+	forward[2] = right[2] = 0.0f;
+	VectorNormalize(forward);
+	VectorNormalize(right);
+
+	const float speed = actor->client->ps.speed > 0 ? actor->client->ps.speed : actor->NPC->stats.runSpeed;
+	const float fMove = ucmd->forwardmove / 127.0f;
+	const float rMove = ucmd->rightmove / 127.0f;
+	const float desiredX = (forward[0] * fMove + right[0] * rMove) * speed;
+	const float desiredY = (forward[1] * fMove + right[1] * rMove) * speed;
+
+	SCrowdPref& pref = mCrowdPref[actor->s.number];
+	pref.mX = desiredX;
+	pref.mY = desiredY;
+	pref.mTime = level.time;
+
+	const int slot = mCrowdSlot[actor->s.number];
+	if (slot < 0 || !mCrowd.mAgent[slot] || ucmd->upmove > 0 || !speed)
+	{
+		return;
+	}
+
+	// Apply The Solved Correction To What We Want Now
+	//-------------------------------------------------
+	const float correctX = mCrowd.mNewX[slot] - mCrowd.mPrefX[slot];
+	const float correctY = mCrowd.mNewY[slot] - mCrowd.mPrefY[slot];
+	if (correctX * correctX + correctY * correctY < 1.0f)
+	{
+		return;
+	}
+
+	float velX = desiredX + correctX;
+	float velY = desiredY + correctY;
+	const float velLen = sqrtf(velX * velX + velY * velY);
+	if (velLen > speed)
+	{
+		velX *= speed / velLen;
+		velY *= speed / velLen;
+	}
+
+	ucmd->forwardmove = floor(Com_Clamp(-127.0f, 127.0f, (forward[0] * velX + forward[1] * velY) / speed * 127.0f));
+	ucmd->rightmove = floor(Com_Clamp(-127.0f, 127.0f, (right[0] * velX + right[1] * velY) / speed * 127.0f));
+
+	if (NAVDEBUG_showCollision)
+	{
+		CVec3 Start(actor->currentOrigin);
+		CVec3 EndVelocity(Start[0] + velX, Start[1] + velY, Start[2]);
+		CG_DrawEdge(Start.v, EndVelocity.v, EDGE_VELOCITY);
+	}
+}
+
 ////////////////////////////////////////////////////////////////////////////////////
 // Reached
 ////////////////////////////////////////////////////////////////////////////////////
@@ -5328,4 +6518,6 @@ void ClearAllNavStructures()
 		i->clear();
 	}
 	mEntEdgeMap.clear();
-}
\ No newline at end of file
+	mEdgeValidations.clear();
+	NAV::InvalidatePathCache();
+}
@@ -138,6 +138,8 @@ namespace NAV
 	// Update One Or More Edges As A Result Of An Entity Getting Removed
 	////////////////////////////////////////////////////////////////////////////////////
 	void WayEdgesNowClear(gentity_t* ent);
+	void ValidateEdges();
+	void InvalidatePathCache();
 
 	////////////////////////////////////////////////////////////////////////////////////
 	// How Big Is The Given Ent
@@ -246,6 +248,16 @@ namespace STEER
 	float AvoidCollisions(gentity_t* actor, const gentity_t* leader = nullptr);
 	gentity_t* SelectLeader(const gentity_t* actor);
 
+	////////////////////////////////////////////////////////////////////////////////////
+	// Crowd Avoidance
+	//
+	// Reciprocal velocity obstacle avoidance between NPCs.  UpdateCrowd solves every
+	// moving NPC once a frame, AvoidCrowd adjusts an NPC's final movement command by
+	// its share of the result.  Enabled with g_navCrowd.
+	////////////////////////////////////////////////////////////////////////////////////
+	void UpdateCrowd();
+	void AvoidCrowd(const gentity_t* actor, usercmd_t* ucmd);
+
 	////////////////////////////////////////////////////////////////////////////////////
 	// Blocked
 	//
@@ -25,7 +25,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #define __G_PUBLIC_H__
 // g_public.h -- game module information visible to server
 
-#define	GAME_API_VERSION	10
+#define	GAME_API_VERSION	11
 
 // entity->svFlags
 // the server does not know how to interpret most of the values
@@ -222,6 +222,9 @@ using game_import_t = struct
 	void (*trace)(trace_t* results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end,
 		int pass_entity_num, int contentmask, EG2_Collision e_g2_trace_type, int use_lod);
 
+	// runs a batch of traces, same results as calling trace on each job in turn
+	void (*traceBatch)(traceJob_t* jobs, int num_jobs);
+
 	// point contents against all linked entities
 	int (*pointcontents)(const vec3_t point, int pass_entity_num);
 	// what contents are on the map?
@@ -45,6 +45,9 @@ extern void G_RemoveWeather();
 extern void RemoveBarrier(gentity_t* ent);
 
 extern void G_SetWeapon(gentity_t* self, int wp);
+extern void Svcmd_PmoveRecord_f();
+extern void Svcmd_PmoveBench_f();
+extern void Svcmd_MissileBench_f();
 extern stringID_table_t WPTable[];
 
 extern cvar_t* g_char_model;
@@ -1234,6 +1237,8 @@ static svcmd_t svcmds[] = {
 	{"saberColor", Svcmd_SaberColor_f, CMD_NONE},
 	{"saber", Svcmd_Saber_f, CMD_NONE},
 	{"saberBlade", Svcmd_SaberBlade_f, CMD_NONE},
+	{"saberBroadphase", WP_SaberBroadphaseStats_f, CMD_NONE},
+	{"saberSweep", WP_SaberSweepStats_f, CMD_NONE},
 
 	{"setForceJump", Svcmd_ForceSetLevel_f<FP_LEVITATION>, CMD_CHEAT},
 	{"setSaberThrow", Svcmd_ForceSetLevel_f<FP_SABERTHROW>, CMD_CHEAT},
@@ -1288,6 +1293,10 @@ static svcmd_t svcmds[] = {
 	{"difficulty", Svcmd_Difficulty_f, CMD_NONE},
 
 	{"scale", Svcmd_Scale_f, CMD_NONE},
+
+	{"pmove_record", Svcmd_PmoveRecord_f, CMD_CHEAT},
+	{"pmove_bench", Svcmd_PmoveBench_f, CMD_CHEAT},
+	{"missile_bench", Svcmd_MissileBench_f, CMD_CHEAT},
 };
 static constexpr size_t numsvcmds = std::size(svcmds);
 
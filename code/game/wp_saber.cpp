@@ -3901,9 +3901,10 @@ qboolean WP_SabersIntersect(const gentity_t* ent1, const int ent1_saber_num, con
 		for (int ent2_blade_num = 0; ent2_blade_num < ent2_saber_num.numBlades; ent2_blade_num++)
 		{
 			if (ent2_saber_num.type != SABER_NONE
-				&& ent2_saber_num.blade[ent2_blade_num].length > 0)
+				&& ent2_saber_num.blade[ent2_blade_num].length > 0
+				&& WP_SaberBroadphaseBladesMayTouch(ent1, ent1_saber_num, ent1_blade_num, ent2,
+					static_cast<int>(&ent2_saber_num - ent2->client->ps.saber), ent2_blade_num))
 			{
-				vec3_t dir;
 				vec3_t saber_tip_next2;
 				vec3_t saber_base_next2;
 				vec3_t saber_tip2;
@@ -3913,45 +3914,10 @@ qboolean WP_SabersIntersect(const gentity_t* ent1, const int ent1_saber_num, con
 				vec3_t saber_tip1;
 				vec3_t saber_base1;
 
-				{
-					VectorCopy(ent1->client->ps.saber[ent1_saber_num].blade[ent1_blade_num].muzzlePointOld,
-						saber_base1);
-					VectorCopy(ent1->client->ps.saber[ent1_saber_num].blade[ent1_blade_num].muzzlePoint,
-						saber_base_next1);
-
-					VectorSubtract(ent1->client->ps.saber[ent1_saber_num].blade[ent1_blade_num].muzzlePoint,
-						ent1->client->ps.saber[ent1_saber_num].blade[ent1_blade_num].muzzlePointOld, dir);
-					VectorNormalize(dir);
-					VectorMA(saber_base_next1, SABER_EXTRAPOLATE_DIST, dir, saber_base_next1);
-
-					VectorMA(saber_base1, ent1->client->ps.saber[ent1_saber_num].blade[ent1_blade_num].length,
-						ent1->client->ps.saber[ent1_saber_num].blade[ent1_blade_num].muzzleDirOld, saber_tip1);
-					VectorMA(saber_base_next1, ent1->client->ps.saber[ent1_saber_num].blade[ent1_blade_num].length,
-						ent1->client->ps.saber[ent1_saber_num].blade[ent1_blade_num].muzzleDir, saber_tip_next1);
-
-					VectorSubtract(saber_tip_next1, saber_tip1, dir);
-					VectorNormalize(dir);
-					VectorMA(saber_tip_next1, SABER_EXTRAPOLATE_DIST, dir, saber_tip_next1);
-				}
-
-				{
-					VectorCopy(ent2_saber_num.blade[ent2_blade_num].muzzlePointOld, saber_base2);
-					VectorCopy(ent2_saber_num.blade[ent2_blade_num].muzzlePoint, saber_base_next2);
-
-					VectorSubtract(ent2_saber_num.blade[ent2_blade_num].muzzlePoint,
-						ent2_saber_num.blade[ent2_blade_num].muzzlePointOld, dir);
-					VectorNormalize(dir);
-					VectorMA(saber_base_next2, SABER_EXTRAPOLATE_DIST, dir, saber_base_next2);
-
-					VectorMA(saber_base2, ent2_saber_num.blade[ent2_blade_num].length,
-						ent2_saber_num.blade[ent2_blade_num].muzzleDirOld, saber_tip2);
-					VectorMA(saber_base_next2, ent2_saber_num.blade[ent2_blade_num].length,
-						ent2_saber_num.blade[ent2_blade_num].muzzleDir, saber_tip_next2);
-
-					VectorSubtract(saber_tip_next2, saber_tip2, dir);
-					VectorNormalize(dir);
-					VectorMA(saber_tip_next2, SABER_EXTRAPOLATE_DIST, dir, saber_tip_next2);
-				}
+				WP_SaberSweptQuad(&ent1->client->ps.saber[ent1_saber_num].blade[ent1_blade_num], saber_base1,
+					saber_tip1, saber_base_next1, saber_tip_next1);
+				WP_SaberSweptQuad(&ent2_saber_num.blade[ent2_blade_num], saber_base2, saber_tip2, saber_base_next2,
+					saber_tip_next2);
 
 				if (check_dir)
 				{
@@ -7191,7 +7157,8 @@ int G_CostForSpecialMove(const int cost, const qboolean kata_move)
 
 extern qboolean G_EntIsBreakable(int entity_num, const gentity_t* breaker);
 
-void WP_SaberRadiusDamage(gentity_t* ent, vec3_t point, const float radius, const int damage, const float knock_back)
+void WP_SaberRadiusDamage(gentity_t* ent, const int saber_num, const int blade_num, vec3_t point, const float radius,
+	const int damage, const float knock_back)
 {
 	if (!ent || !ent->client)
 	{
@@ -7212,8 +7179,8 @@ void WP_SaberRadiusDamage(gentity_t* ent, vec3_t point, const float radius, cons
 		maxs[i] = point[i] + radius;
 	}
 
-	//Get the number of entities in a given space
-	const int num_ents = gi.EntitiesInBox(mins, maxs, radius_ents, 128);
+	//Get the number of entities in a given space, the blade's body pairs cover its splash
+	const int num_ents = WP_SaberBroadphaseBodies(ent, saber_num, blade_num, mins, maxs, radius_ents, 128);
 
 	for (i = 0; i < num_ents; i++)
 	{
@@ -7778,8 +7745,17 @@ void WP_SaberDamageTrace(gentity_t* ent, int saber_num, int blade_num)
 			qfalse, ent->client->ps.saber[saber_num].type, qfalse, saber_num,
 			blade_num);
 	}
+	else if (WP_SaberSweepClear(ent, saber_num, blade_num, base_old, base_new, md1, md2))
+	{
+		//nothing the blade can reach along its whole swing, no need to trace it
+	}
 	else
 	{
+		//the sweep may have cut the swing down to the part where something is in reach
+		VectorCopy(base_old, mp1);
+		VectorCopy(base_new, mp2);
+		VectorMA(base_old, ent->client->ps.saber[saber_num].blade[blade_num].length, md1, end_old);
+		VectorMA(base_new, ent->client->ps.saber[saber_num].blade[blade_num].length, md2, end_new);
 		float tip_dmg_mod = 1.0f;
 		vec3_t base_diff;
 		float aveLength, step = 8, stepsize = 8;
@@ -8660,13 +8636,13 @@ void WP_SaberDamageTrace(gentity_t* ent, int saber_num, int blade_num)
 			//do radius damage/knockback, if any
 			if (!WP_SaberBladeUseSecondBladeStyle(&ent->client->ps.saber[saber_num], blade_num))
 			{
-				WP_SaberRadiusDamage(ent, saberHitLocation, ent->client->ps.saber[saber_num].splashRadius,
+				WP_SaberRadiusDamage(ent, saber_num, blade_num, saberHitLocation, ent->client->ps.saber[saber_num].splashRadius,
 					ent->client->ps.saber[saber_num].splashDamage,
 					ent->client->ps.saber[saber_num].splashKnockback);
 			}
 			else
 			{
-				WP_SaberRadiusDamage(ent, saberHitLocation, ent->client->ps.saber[saber_num].splashRadius2,
+				WP_SaberRadiusDamage(ent, saber_num, blade_num, saberHitLocation, ent->client->ps.saber[saber_num].splashRadius2,
 					ent->client->ps.saber[saber_num].splashDamage2,
 					ent->client->ps.saber[saber_num].splashKnockback2);
 			}
@@ -9589,8 +9565,17 @@ void wp_saber_damage_trace_amd(gentity_t* ent, int saber_num, int blade_num)
 			qfalse, ent->client->ps.saber[saber_num].type, qfalse, saber_num,
 			blade_num);
 	}
+	else if (WP_SaberSweepClear(ent, saber_num, blade_num, base_old, base_new, md1, md2))
+	{
+		//nothing the blade can reach along its whole swing, no need to trace it
+	}
 	else
 	{
+		//the sweep may have cut the swing down to the part where something is in reach
+		VectorCopy(base_old, mp1);
+		VectorCopy(base_new, mp2);
+		VectorMA(base_old, ent->client->ps.saber[saber_num].blade[blade_num].length, md1, end_old);
+		VectorMA(base_new, ent->client->ps.saber[saber_num].blade[blade_num].length, md2, end_new);
 		float tip_dmg_mod = 1.0f;
 		vec3_t base_diff;
 		float ave_length, step = 8, stepsize = 8;
@@ -10360,13 +10345,13 @@ void wp_saber_damage_trace_amd(gentity_t* ent, int saber_num, int blade_num)
 			//do radius damage/knockback, if any
 			if (!WP_SaberBladeUseSecondBladeStyle(&ent->client->ps.saber[saber_num], blade_num))
 			{
-				WP_SaberRadiusDamage(ent, saberHitLocation, ent->client->ps.saber[saber_num].splashRadius,
+				WP_SaberRadiusDamage(ent, saber_num, blade_num, saberHitLocation, ent->client->ps.saber[saber_num].splashRadius,
 					ent->client->ps.saber[saber_num].splashDamage,
 					ent->client->ps.saber[saber_num].splashKnockback);
 			}
 			else
 			{
-				WP_SaberRadiusDamage(ent, saberHitLocation, ent->client->ps.saber[saber_num].splashRadius2,
+				WP_SaberRadiusDamage(ent, saber_num, blade_num, saberHitLocation, ent->client->ps.saber[saber_num].splashRadius2,
 					ent->client->ps.saber[saber_num].splashDamage2,
 					ent->client->ps.saber[saber_num].splashKnockback2);
 			}
@@ -10406,13 +10391,13 @@ void wp_saber_damage_trace_amd(gentity_t* ent, int saber_num, int blade_num)
 			//do radius damage/knockback, if any
 			if (!WP_SaberBladeUseSecondBladeStyle(&ent->client->ps.saber[saber_num], blade_num))
 			{
-				WP_SaberRadiusDamage(ent, saberHitLocation, ent->client->ps.saber[saber_num].splashRadius,
+				WP_SaberRadiusDamage(ent, saber_num, blade_num, saberHitLocation, ent->client->ps.saber[saber_num].splashRadius,
 					ent->client->ps.saber[saber_num].splashDamage,
 					ent->client->ps.saber[saber_num].splashKnockback);
 			}
 			else
 			{
-				WP_SaberRadiusDamage(ent, saberHitLocation, ent->client->ps.saber[saber_num].splashRadius2,
+				WP_SaberRadiusDamage(ent, saber_num, blade_num, saberHitLocation, ent->client->ps.saber[saber_num].splashRadius2,
 					ent->client->ps.saber[saber_num].splashDamage2,
 					ent->client->ps.saber[saber_num].splashKnockback2);
 			}
@@ -10977,8 +10962,17 @@ void WP_SaberDamageTrace_MD(gentity_t* ent, int saber_num, int blade_num)
 			qfalse, ent->client->ps.saber[saber_num].type, qfalse, saber_num,
 			blade_num);
 	}
+	else if (WP_SaberSweepClear(ent, saber_num, blade_num, base_old, base_new, md1, md2))
+	{
+		//nothing the blade can reach along its whole swing, no need to trace it
+	}
 	else
 	{
+		//the sweep may have cut the swing down to the part where something is in reach
+		VectorCopy(base_old, mp1);
+		VectorCopy(base_new, mp2);
+		VectorMA(base_old, ent->client->ps.saber[saber_num].blade[blade_num].length, md1, end_old);
+		VectorMA(base_new, ent->client->ps.saber[saber_num].blade[blade_num].length, md2, end_new);
 		float tip_dmg_mod = 1.0f;
 		vec3_t base_diff;
 		float ave_length, step = 8, stepsize = 8;
@@ -11745,13 +11739,13 @@ void WP_SaberDamageTrace_MD(gentity_t* ent, int saber_num, int blade_num)
 			//do radius damage/knockback, if any
 			if (!WP_SaberBladeUseSecondBladeStyle(&ent->client->ps.saber[saber_num], blade_num))
 			{
-				WP_SaberRadiusDamage(ent, saberHitLocation, ent->client->ps.saber[saber_num].splashRadius,
+				WP_SaberRadiusDamage(ent, saber_num, blade_num, saberHitLocation, ent->client->ps.saber[saber_num].splashRadius,
 					ent->client->ps.saber[saber_num].splashDamage,
 					ent->client->ps.saber[saber_num].splashKnockback);
 			}
 			else
 			{
-				WP_SaberRadiusDamage(ent, saberHitLocation, ent->client->ps.saber[saber_num].splashRadius2,
+				WP_SaberRadiusDamage(ent, saber_num, blade_num, saberHitLocation, ent->client->ps.saber[saber_num].splashRadius2,
 					ent->client->ps.saber[saber_num].splashDamage2,
 					ent->client->ps.saber[saber_num].splashKnockback2);
 			}
@@ -11791,13 +11785,13 @@ void WP_SaberDamageTrace_MD(gentity_t* ent, int saber_num, int blade_num)
 			//do radius damage/knockback, if any
 			if (!WP_SaberBladeUseSecondBladeStyle(&ent->client->ps.saber[saber_num], blade_num))
 			{
-				WP_SaberRadiusDamage(ent, saberHitLocation, ent->client->ps.saber[saber_num].splashRadius,
+				WP_SaberRadiusDamage(ent, saber_num, blade_num, saberHitLocation, ent->client->ps.saber[saber_num].splashRadius,
 					ent->client->ps.saber[saber_num].splashDamage,
 					ent->client->ps.saber[saber_num].splashKnockback);
 			}
 			else
 			{
-				WP_SaberRadiusDamage(ent, saberHitLocation, ent->client->ps.saber[saber_num].splashRadius2,
+				WP_SaberRadiusDamage(ent, saber_num, blade_num, saberHitLocation, ent->client->ps.saber[saber_num].splashRadius2,
 					ent->client->ps.saber[saber_num].splashDamage2,
 					ent->client->ps.saber[saber_num].splashKnockback2);
 			}
@@ -565,4 +565,17 @@ using saberMoveData_t = struct
 
 extern saberMoveData_t saberMoveData[LS_MOVE_MAX];
 
+// wp_saberbroadphase.cpp
+void WP_SaberSweptQuad(const bladeInfo_t* blade, vec3_t base, vec3_t tip, vec3_t base_next, vec3_t tip_next);
+qboolean WP_SaberBroadphaseBladesMayTouch(const gentity_t* ent1, int saber_num1, int blade_num1,
+	const gentity_t* ent2, int saber_num2, int blade_num2);
+int WP_SaberBroadphaseBodies(const gentity_t* ent, int saber_num, int blade_num, const vec3_t mins,
+	const vec3_t maxs, gentity_t** list, int max_list);
+void WP_SaberBroadphaseStats_f();
+
+// wp_sabersweep.cpp
+qboolean WP_SaberSweepClear(const gentity_t* ent, int saber_num, int blade_num, vec3_t base_old, vec3_t base_new,
+	vec3_t md1, vec3_t md2);
+void WP_SaberSweepStats_f();
+
 #endif	// __WP_SABER_H
@@ -0,0 +1,628 @@
+/*
+===========================================================================
+Copyright (C) 2013 - 2015, OpenJK contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+// wp_saberbroadphase.cpp -- per frame sweep and prune of the active saber blades
+// and the bodies they can hit, so the blade vs blade tests only run on pairs whose
+// swept volumes can touch and the blade vs body tests only see the bodies in reach.
+
+#include "g_local.h"
+#include "wp_saber.h"
+
+#include "../qcommon/timing.h"
+
+#include <algorithm>
+
+extern cvar_t* g_saberBroadphase;
+
+constexpr int SABER_BP_MAX_BLADES = 256;
+constexpr int SABER_BP_MAX_BODIES = 256;
+constexpr int SABER_BP_MAX_PROXIES = SABER_BP_MAX_BLADES + SABER_BP_MAX_BODIES;
+constexpr int SABER_BP_MATRIX_WORDS = SABER_BP_MAX_BLADES * SABER_BP_MAX_PROXIES / 32;
+constexpr int SABER_BP_BODY_CONTENTS = CONTENTS_BODY | CONTENTS_CORPSE | CONTENTS_LIGHTSABER;
+constexpr float SABER_BP_BODY_MARGIN = 16.0f; // bodies relinked inside their grown bounds keep their pairs
+constexpr float SABER_BP_BLADE_MARGIN = 32.0f; // how far a blade may move before its body pairs are useless
+
+using saberProxy_t = struct saberProxy_s
+{
+	int entNum;
+	int saberNum; // -1 for a body
+	int bladeNum;
+	int index; // blade or body number in the pair matrix
+	vec3_t mins; // swept blade, or the grown body bounds
+	vec3_t maxs;
+	vec3_t reachMins; // everything a blade's damage can reach, the body bounds again for a body
+	vec3_t reachMaxs;
+	// blade state the bounds were made from, so stale proxies can be spotted
+	vec3_t muzzlePoint;
+	vec3_t muzzlePointOld;
+	vec3_t muzzleDir;
+	vec3_t muzzleDirOld;
+	float length;
+};
+
+static struct
+{
+	int framenum;
+	int numProxies;
+	int numBlades;
+	int numBodies;
+	qboolean bodiesFull; // a body had no proxy, body queries can't trust the pairs
+	saberProxy_t proxies[SABER_BP_MAX_PROXIES];
+	int order[SABER_BP_MAX_PROXIES];
+	short bladeProxy[MAX_GENTITIES][MAX_SABERS][MAX_BLADES]; // valid when bladeFrame matches framenum
+	int bladeFrame[MAX_GENTITIES];
+	short bodyProxy[MAX_GENTITIES]; // valid when bodyFrame matches framenum
+	int bodyFrame[MAX_GENTITIES];
+	short bodyProxies[SABER_BP_MAX_BODIES]; // body number to proxy
+	unsigned int pairs[SABER_BP_MATRIX_WORDS]; // blade number x (blade number, or SABER_BP_MAX_BLADES + body number)
+	int numBladePairs;
+	int numBodyPairs;
+	int buildUsec;
+} saberBP = { -1 };
+
+static struct
+{
+	int frames;
+	int proxies;
+	int bladePairs;
+	int bodyPairs;
+	int buildUsec;
+	int tests;
+	int culled;
+	int stale;
+	int bodyQueries;
+	int bodyFallbacks;
+	int bodiesFound;
+	int relinks;
+} saberBPStats;
+
+static void (*saberBPLinkEntity)(gentity_t* ent);
+
+/*
+==================
+WP_SaberSweptQuad
+
+The four corners of the area a blade swept through since its old position,
+extrapolated the same way the blade vs blade intersection tests do it
+==================
+*/
+void WP_SaberSweptQuad(const bladeInfo_t* blade, vec3_t base, vec3_t tip, vec3_t base_next, vec3_t tip_next)
+{
+	vec3_t dir;
+
+	VectorCopy(blade->muzzlePointOld, base);
+	VectorCopy(blade->muzzlePoint, base_next);
+
+	VectorSubtract(blade->muzzlePoint, blade->muzzlePointOld, dir);
+	VectorNormalize(dir);
+	VectorMA(base_next, SABER_EXTRAPOLATE_DIST, dir, base_next);
+
+	VectorMA(base, blade->length, blade->muzzleDirOld, tip);
+	VectorMA(base_next, blade->length, blade->muzzleDir, tip_next);
+
+	VectorSubtract(tip_next, tip, dir);
+	VectorNormalize(dir);
+	VectorMA(tip_next, SABER_EXTRAPOLATE_DIST, dir, tip_next);
+}
+
+static void WP_SaberSweptBounds(const bladeInfo_t* blade, vec3_t mins, vec3_t maxs)
+{
+	vec3_t corners[4];
+
+	WP_SaberSweptQuad(blade, corners[0], corners[1], corners[2], corners[3]);
+
+	ClearBounds(mins, maxs);
+	for (const auto& corner : corners)
+	{
+		AddPointToBounds(corner, mins, maxs);
+	}
+	for (int i = 0; i < 3; i++)
+	{
+		// a little slack so touching bounds still count after float rounding
+		mins[i] -= 1.0f;
+		maxs[i] += 1.0f;
+	}
+}
+
+static qboolean WP_SaberBladeOn(const saberInfo_t* saber, const int blade_num)
+{
+	return static_cast<qboolean>(saber->type != SABER_NONE && saber->blade[blade_num].length > 0);
+}
+
+static qboolean WP_SaberProxyStale(const saberProxy_t* proxy, const bladeInfo_t* blade)
+{
+	return static_cast<qboolean>(!VectorCompare(proxy->muzzlePoint, blade->muzzlePoint)
+		|| !VectorCompare(proxy->muzzlePointOld, blade->muzzlePointOld)
+		|| !VectorCompare(proxy->muzzleDir, blade->muzzleDir)
+		|| !VectorCompare(proxy->muzzleDirOld, blade->muzzleDirOld)
+		|| proxy->length != blade->length);
+}
+
+static qboolean WP_SaberBoundsOverlap(const vec3_t mins1, const vec3_t maxs1, const vec3_t mins2, const vec3_t maxs2)
+{
+	return static_cast<qboolean>(mins1[0] <= maxs2[0] && maxs1[0] >= mins2[0]
+		&& mins1[1] <= maxs2[1] && maxs1[1] >= mins2[1]
+		&& mins1[2] <= maxs2[2] && maxs1[2] >= mins2[2]);
+}
+
+static qboolean WP_SaberBoundsInside(const vec3_t mins, const vec3_t maxs, const vec3_t outer_mins,
+	const vec3_t outer_maxs)
+{
+	return static_cast<qboolean>(mins[0] >= outer_mins[0] && maxs[0] <= outer_maxs[0]
+		&& mins[1] >= outer_mins[1] && maxs[1] <= outer_maxs[1]
+		&& mins[2] >= outer_mins[2] && maxs[2] <= outer_maxs[2]);
+}
+
+/*
+==================
+WP_SaberReachBounds
+
+Bounds of everything the blade's damage traces and splash damage can touch
+this frame, with some room for the blade to move before it gets its turn
+==================
+*/
+static void WP_SaberReachBounds(const saberInfo_t* saber, const bladeInfo_t* blade, vec3_t mins, vec3_t maxs)
+{
+	const float reach = Q_max(blade->length, blade->lengthOld) + Q_max(2.0f, blade->radius)
+		+ SABER_EXTRAPOLATE_DIST + Q_max(saber->splashRadius, saber->splashRadius2) + SABER_BP_BLADE_MARGIN;
+
+	ClearBounds(mins, maxs);
+	AddPointToBounds(blade->muzzlePointOld, mins, maxs);
+	AddPointToBounds(blade->muzzlePoint, mins, maxs);
+	for (int i = 0; i < 3; i++)
+	{
+		mins[i] -= reach;
+		maxs[i] += reach;
+	}
+}
+
+static qboolean WP_SaberBroadphaseIsBody(const gentity_t* ent)
+{
+	return static_cast<qboolean>(ent->inuse && ent->linked
+		&& (ent->client || ent->takedamage || ent->contents & SABER_BP_BODY_CONTENTS));
+}
+
+static void WP_SaberBodyBounds(const gentity_t* ent, saberProxy_t* proxy)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		proxy->mins[i] = ent->absmin[i] - SABER_BP_BODY_MARGIN;
+		proxy->maxs[i] = ent->absmax[i] + SABER_BP_BODY_MARGIN;
+	}
+	VectorCopy(proxy->mins, proxy->reachMins);
+	VectorCopy(proxy->maxs, proxy->reachMaxs);
+}
+
+static int WP_SaberBroadphaseColumn(const saberProxy_t* proxy)
+{
+	return proxy->saberNum < 0 ? SABER_BP_MAX_BLADES + proxy->index : proxy->index;
+}
+
+static void WP_SaberBroadphaseAddPair(const saberProxy_t* blade, const saberProxy_t* other)
+{
+	const int bit = blade->index * SABER_BP_MAX_PROXIES + WP_SaberBroadphaseColumn(other);
+
+	saberBP.pairs[bit >> 5] |= 1u << (bit & 31);
+}
+
+static qboolean WP_SaberBroadphasePaired(const saberProxy_t* blade, const saberProxy_t* other)
+{
+	const int bit = blade->index * SABER_BP_MAX_PROXIES + WP_SaberBroadphaseColumn(other);
+
+	return static_cast<qboolean>((saberBP.pairs[bit >> 5] & 1u << (bit & 31)) != 0);
+}
+
+static void WP_SaberBroadphasePairBody(const saberProxy_t* blade, const saberProxy_t* body)
+{
+	if (blade->entNum == body->entNum
+		|| !WP_SaberBoundsOverlap(blade->reachMins, blade->reachMaxs, body->mins, body->maxs))
+	{
+		return;
+	}
+	WP_SaberBroadphaseAddPair(blade, body);
+	saberBP.numBodyPairs++;
+}
+
+static saberProxy_t* WP_SaberBroadphaseAddBody(const gentity_t* ent)
+{
+	if (saberBP.numBodies >= SABER_BP_MAX_BODIES)
+	{
+		saberBP.bodiesFull = qtrue;
+		return nullptr;
+	}
+
+	saberProxy_t* proxy = &saberBP.proxies[saberBP.numProxies];
+
+	proxy->entNum = ent->s.number;
+	proxy->saberNum = -1;
+	proxy->bladeNum = -1;
+	proxy->index = saberBP.numBodies;
+	WP_SaberBodyBounds(ent, proxy);
+
+	saberBP.bodyFrame[ent->s.number] = saberBP.framenum;
+	saberBP.bodyProxy[ent->s.number] = static_cast<short>(saberBP.numProxies);
+	saberBP.bodyProxies[saberBP.numBodies++] = static_cast<short>(saberBP.numProxies++);
+	return proxy;
+}
+
+/*
+==================
+WP_SaberBroadphaseBuild
+
+Collects the swept bounds of every active blade and the bounds of every
+body, sorts them along x and sweeps them to find the pairs that overlap
+==================
+*/
+static void WP_SaberBroadphaseBuild()
+{
+	const timingUsec_c build_timer;
+
+	saberBP.framenum = level.framenum;
+	saberBP.numProxies = 0;
+	saberBP.numBlades = 0;
+	saberBP.numBodies = 0;
+	saberBP.bodiesFull = qfalse;
+	saberBP.numBladePairs = 0;
+	saberBP.numBodyPairs = 0;
+	memset(saberBP.pairs, 0, sizeof saberBP.pairs);
+
+	for (int i = 0; i < globals.num_entities; i++)
+	{
+		const gentity_t* ent = &g_entities[i];
+
+		if (!ent->inuse)
+		{
+			continue;
+		}
+
+		if (WP_SaberBroadphaseIsBody(ent))
+		{
+			WP_SaberBroadphaseAddBody(ent);
+		}
+
+		if (!ent->client)
+		{
+			continue;
+		}
+
+		if (ent->client->ps.weapon != WP_SABER || ent->client->ps.SaberLength() <= 0)
+		{
+			continue;
+		}
+
+		saberBP.bladeFrame[i] = level.framenum;
+
+		for (int saber_num = 0; saber_num < MAX_SABERS; saber_num++)
+		{
+			const saberInfo_t* saber = &ent->client->ps.saber[saber_num];
+
+			for (int blade_num = 0; blade_num < MAX_BLADES; blade_num++)
+			{
+				saberBP.bladeProxy[i][saber_num][blade_num] = -1;
+
+				if (blade_num >= saber->numBlades || !WP_SaberBladeOn(saber, blade_num)
+					|| saberBP.numBlades >= SABER_BP_MAX_BLADES)
+				{
+					continue;
+				}
+
+				const bladeInfo_t* blade = &saber->blade[blade_num];
+				saberProxy_t* proxy = &saberBP.proxies[saberBP.numProxies];
+
+				proxy->entNum = i;
+				proxy->saberNum = saber_num;
+				proxy->bladeNum = blade_num;
+				proxy->index = saberBP.numBlades++;
+				WP_SaberSweptBounds(blade, proxy->mins, proxy->maxs);
+				WP_SaberReachBounds(saber, blade, proxy->reachMins, proxy->reachMaxs);
+				VectorCopy(blade->muzzlePoint, proxy->muzzlePoint);
+				VectorCopy(blade->muzzlePointOld, proxy->muzzlePointOld);
+				VectorCopy(blade->muzzleDir, proxy->muzzleDir);
+				VectorCopy(blade->muzzleDirOld, proxy->muzzleDirOld);
+				proxy->length = blade->length;
+
+				saberBP.bladeProxy[i][saber_num][blade_num] = static_cast<short>(saberBP.numProxies++);
+			}
+		}
+	}
+
+	for (int i = 0; i < saberBP.numProxies; i++)
+	{
+		saberBP.order[i] = i;
+	}
+	std::sort(saberBP.order, saberBP.order + saberBP.numProxies, [](const int a, const int b)
+		{
+			return saberBP.proxies[a].reachMins[0] < saberBP.proxies[b].reachMins[0];
+		});
+
+	// sweep along x on the reach bounds, which hold the swept blade bounds,
+	// everything after a proxy in the order that starts before it ends
+	// overlaps it on x
+	for (int i = 0; i < saberBP.numProxies; i++)
+	{
+		const saberProxy_t* a = &saberBP.proxies[saberBP.order[i]];
+
+		for (int j = i + 1; j < saberBP.numProxies; j++)
+		{
+			const saberProxy_t* b = &saberBP.proxies[saberBP.order[j]];
+
+			if (b->reachMins[0] > a->reachMaxs[0])
+			{
+				break;
+			}
+			if (a->entNum == b->entNum || (a->saberNum < 0 && b->saberNum < 0))
+			{
+				// own blades and body, or two bodies
+				continue;
+			}
+
+			if (a->saberNum >= 0 && b->saberNum >= 0)
+			{
+				if (WP_SaberBoundsOverlap(a->mins, a->maxs, b->mins, b->maxs))
+				{
+					WP_SaberBroadphaseAddPair(a, b);
+					WP_SaberBroadphaseAddPair(b, a);
+					saberBP.numBladePairs++;
+				}
+			}
+			else if (a->saberNum >= 0)
+			{
+				WP_SaberBroadphasePairBody(a, b);
+			}
+			else
+			{
+				WP_SaberBroadphasePairBody(b, a);
+			}
+		}
+	}
+
+	saberBP.buildUsec = static_cast<int>(build_timer.End());
+
+	saberBPStats.frames++;
+	saberBPStats.proxies += saberBP.numProxies;
+	saberBPStats.bladePairs += saberBP.numBladePairs;
+	saberBPStats.bodyPairs += saberBP.numBodyPairs;
+	saberBPStats.buildUsec += saberBP.buildUsec;
+}
+
+static const saberProxy_t* WP_SaberBroadphaseBlade(const gentity_t* ent, const int saber_num, const int blade_num)
+{
+	if (saberBP.bladeFrame[ent->s.number] != saberBP.framenum)
+	{
+		return nullptr;
+	}
+
+	const int proxy = saberBP.bladeProxy[ent->s.number][saber_num][blade_num];
+
+	if (proxy < 0)
+	{
+		return nullptr;
+	}
+	return &saberBP.proxies[proxy];
+}
+
+/*
+==================
+WP_SaberBroadphaseLinkEntity
+
+Every relink goes through here.  A body that leaves the grown bounds it was
+paired with (or turns up after the build) is paired again against the blades.
+==================
+*/
+static void WP_SaberBroadphaseLinkEntity(gentity_t* ent)
+{
+	saberBPLinkEntity(ent);
+
+	if (saberBP.framenum != level.framenum || !WP_SaberBroadphaseIsBody(ent))
+	{
+		return;
+	}
+
+	saberProxy_t* body;
+
+	if (saberBP.bodyFrame[ent->s.number] == saberBP.framenum)
+	{
+		body = &saberBP.proxies[saberBP.bodyProxy[ent->s.number]];
+		if (WP_SaberBoundsInside(ent->absmin, ent->absmax, body->mins, body->maxs))
+		{
+			return;
+		}
+		WP_SaberBodyBounds(ent, body);
+	}
+	else
+	{
+		body = WP_SaberBroadphaseAddBody(ent);
+		if (!body)
+		{
+			return;
+		}
+	}
+
+	saberBPStats.relinks++;
+
+	const int column = WP_SaberBroadphaseColumn(body);
+	for (int i = 0; i < saberBP.numProxies; i++)
+	{
+		const saberProxy_t* blade = &saberBP.proxies[i];
+
+		if (blade->saberNum < 0)
+		{
+			continue;
+		}
+		const int bit = blade->index * SABER_BP_MAX_PROXIES + column;
+		if (saberBP.pairs[bit >> 5] & 1u << (bit & 31))
+		{
+			saberBP.numBodyPairs--;
+			saberBP.pairs[bit >> 5] &= ~(1u << (bit & 31));
+		}
+		WP_SaberBroadphasePairBody(blade, body);
+	}
+}
+
+void WP_SaberBroadphaseHookLink(game_import_t* imports)
+{
+	saberBPLinkEntity = imports->linkentity;
+	imports->linkentity = WP_SaberBroadphaseLinkEntity;
+}
+
+void WP_SaberBroadphaseReset()
+{
+	saberBP.framenum = -1;
+}
+
+/*
+==================
+WP_SaberBroadphaseBladesMayTouch
+
+Whether the swept volumes of two blades overlap this frame.  Blades that moved
+since the broadphase was built this frame are checked directly, so a qfalse
+always means the blade vs blade tests can't hit.
+==================
+*/
+qboolean WP_SaberBroadphaseBladesMayTouch(const gentity_t* ent1, const int saber_num1, const int blade_num1,
+	const gentity_t* ent2, const int saber_num2, const int blade_num2)
+{
+	if (!g_saberBroadphase->integer || !ent1->client || !ent2->client)
+	{
+		return qtrue;
+	}
+
+	if (saberBP.framenum != level.framenum)
+	{
+		WP_SaberBroadphaseBuild();
+	}
+
+	saberBPStats.tests++;
+
+	const bladeInfo_t* blade1 = &ent1->client->ps.saber[saber_num1].blade[blade_num1];
+	const bladeInfo_t* blade2 = &ent2->client->ps.saber[saber_num2].blade[blade_num2];
+	const saberProxy_t* proxy1 = WP_SaberBroadphaseBlade(ent1, saber_num1, blade_num1);
+	const saberProxy_t* proxy2 = WP_SaberBroadphaseBlade(ent2, saber_num2, blade_num2);
+	qboolean touch;
+
+	if (proxy1 && proxy2 && !WP_SaberProxyStale(proxy1, blade1) && !WP_SaberProxyStale(proxy2, blade2))
+	{
+		touch = WP_SaberBroadphasePaired(proxy1, proxy2);
+	}
+	else
+	{
+		vec3_t mins1, maxs1, mins2, maxs2;
+
+		saberBPStats.stale++;
+		WP_SaberSweptBounds(blade1, mins1, maxs1);
+		WP_SaberSweptBounds(blade2, mins2, maxs2);
+		touch = WP_SaberBoundsOverlap(mins1, maxs1, mins2, maxs2);
+	}
+
+	if (!touch)
+	{
+		saberBPStats.culled++;
+	}
+	return touch;
+}
+
+/*
+==================
+WP_SaberBroadphaseBodies
+
+Lists the bodies (clients, anything that takes damage or has body, corpse
+or saber contents) whose bounds touch mins/maxs, for a box inside what the
+blade can reach this frame.  They come off the blade's row of the pair
+matrix.  Boxes the pairs can't answer for go to the world's area query,
+so callers filter the list the same way either way.
+==================
+*/
+int WP_SaberBroadphaseBodies(const gentity_t* ent, const int saber_num, const int blade_num, const vec3_t mins,
+	const vec3_t maxs, gentity_t** list, const int max_list)
+{
+	if (!g_saberBroadphase->integer || !ent->client)
+	{
+		return gi.EntitiesInBox(mins, maxs, list, max_list);
+	}
+
+	if (saberBP.framenum != level.framenum)
+	{
+		WP_SaberBroadphaseBuild();
+	}
+
+	saberBPStats.bodyQueries++;
+
+	const saberProxy_t* blade = WP_SaberBroadphaseBlade(ent, saber_num, blade_num);
+
+	if (!blade || saberBP.bodiesFull || !WP_SaberBoundsInside(mins, maxs, blade->reachMins, blade->reachMaxs))
+	{
+		saberBPStats.bodyFallbacks++;
+		return gi.EntitiesInBox(mins, maxs, list, max_list);
+	}
+
+	const unsigned int* row = &saberBP.pairs[(blade->index * SABER_BP_MAX_PROXIES + SABER_BP_MAX_BLADES) >> 5];
+	int num = 0;
+
+	for (int word = 0; word < SABER_BP_MAX_BODIES / 32 && num < max_list; word++)
+	{
+		for (unsigned int bits = row[word], body = word * 32; bits && num < max_list; bits >>= 1, body++)
+		{
+			if (!(bits & 1))
+			{
+				continue;
+			}
+
+			gentity_t* touch = &g_entities[saberBP.proxies[saberBP.bodyProxies[body]].entNum];
+
+			// the pair was made from grown bounds, check the real ones
+			if (!touch->inuse || !touch->linked || !WP_SaberBoundsOverlap(touch->absmin, touch->absmax, mins, maxs))
+			{
+				continue;
+			}
+			list[num++] = touch;
+		}
+	}
+
+	saberBPStats.bodiesFound += num;
+	return num;
+}
+
+void WP_SaberBroadphaseStats_f()
+{
+	if (gi.argc() > 1 && !Q_stricmp(gi.argv(1), "reset"))
+	{
+		memset(&saberBPStats, 0, sizeof saberBPStats);
+		return;
+	}
+
+	gi.Printf("Saber broadphase %s\n", g_saberBroadphase->integer ? "on" : "off");
+	gi.Printf(" last frame: %d proxies (%d blades, %d bodies), %d blade pairs, %d body pairs, %d us\n",
+		saberBP.numProxies, saberBP.numBlades, saberBP.numBodies, saberBP.numBladePairs, saberBP.numBodyPairs,
+		saberBP.buildUsec);
+
+	if (saberBPStats.frames)
+	{
+		gi.Printf(" %d frames: %.1f proxies, %.1f blade pairs, %.1f body pairs, %.1f us per frame\n",
+			saberBPStats.frames,
+			static_cast<float>(saberBPStats.proxies) / saberBPStats.frames,
+			static_cast<float>(saberBPStats.bladePairs) / saberBPStats.frames,
+			static_cast<float>(saberBPStats.bodyPairs) / saberBPStats.frames,
+			static_cast<float>(saberBPStats.buildUsec) / saberBPStats.frames);
+	}
+	gi.Printf(" %d blade pair tests, %d culled, %d checked against moved blades\n", saberBPStats.tests,
+		saberBPStats.culled, saberBPStats.stale);
+	gi.Printf(" %d body queries, %d bodies found, %d sent to the area query, %d bodies paired again\n",
+		saberBPStats.bodyQueries, saberBPStats.bodiesFound, saberBPStats.bodyFallbacks, saberBPStats.relinks);
+}
@@ -0,0 +1,292 @@
+/*
+===========================================================================
+Copyright (C) 2013 - 2015, OpenJK contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+// wp_sabersweep.cpp -- continuous test of a blade's whole swing for the frame.
+// The swing is treated as the surface swept by the blade segment between its
+// old and new positions, and checked once against the world and against capsules
+// around the bodies near it.  The damage code skips the interpolated traces along
+// the blade when nothing can be reached, and otherwise only traces the part of
+// the swing between the first and last time something is in reach.
+
+#include "g_local.h"
+#include "wp_saber.h"
+#include "../qcommon/tri_coll_test.h"
+
+#include "../qcommon/timing.h"
+
+extern cvar_t* g_saberSweepTest;
+
+constexpr int SABER_SWEEP_MAX_SAMPLES = 32;
+constexpr float SABER_SWEEP_SAMPLE_ANGLE = 10.0f; // degrees of blade turn between samples
+constexpr float SABER_SWEEP_TRACE_RADIUS = 2.0f; // SABER_RADIUS_DAMAGE_DIST
+constexpr int SABER_SWEEP_BODY_CONTENTS = CONTENTS_BODY | CONTENTS_CORPSE | CONTENTS_LIGHTSABER;
+
+static struct
+{
+	int sweeps;
+	int clear;
+	int worldBlocked;
+	int bodyBlocked;
+	int bodiesTested;
+	int narrowed;
+	float swingSkipped;
+	int tracesSaved;
+	int usec;
+} saberSweepStats;
+
+/*
+==================
+WP_SaberSweepSkipEntity
+
+Mirrors the pass entity rules of the server trace, so the sweep ignores
+exactly what the damage traces would.
+==================
+*/
+static qboolean WP_SaberSweepSkipEntity(const gentity_t* ent, const gentity_t* touch)
+{
+	if (touch == ent)
+	{
+		return qtrue;
+	}
+	if (touch->owner && touch->owner == ent)
+	{
+		return qtrue;
+	}
+	if (ent->owner && (ent->owner == touch || touch->owner == ent->owner))
+	{
+		return qtrue;
+	}
+	return qfalse;
+}
+
+/*
+==================
+WP_SaberSweepTOI
+
+Finds the first and last sample at which the blade can reach the capsule around
+touch, or returns qfalse if it never gets there.  Each sample is grown by how far
+the blade moves to the next one, so reaching it at sample i covers the whole
+interval from sample i to i + 1 and no contact between samples is missed.
+==================
+*/
+static qboolean WP_SaberSweepTOI(const gentity_t* touch, vec3_t bases[], vec3_t tips[], const int num_samples,
+	const float margin, int* first, int* last)
+{
+	vec3_t bottom, top;
+	const float half_x = (touch->absmax[0] - touch->absmin[0]) * 0.5f;
+	const float half_y = (touch->absmax[1] - touch->absmin[1]) * 0.5f;
+	const float radius = sqrtf(half_x * half_x + half_y * half_y) + margin;
+
+	bottom[0] = top[0] = touch->absmin[0] + half_x;
+	bottom[1] = top[1] = touch->absmin[1] + half_y;
+	bottom[2] = touch->absmin[2];
+	top[2] = touch->absmax[2];
+
+	*first = *last = -1;
+	for (int i = 0; i <= num_samples; i++)
+	{
+		vec3_t blade_point, body_point;
+		float move = 0.0f;
+
+		if (i < num_samples)
+		{
+			move = Q_max(Distance(bases[i], bases[i + 1]), Distance(tips[i], tips[i + 1]));
+		}
+		if (ShortestLineSegBewteen2LineSegs(bases[i], tips[i], bottom, top, blade_point, body_point) <= radius + move)
+		{
+			if (*first < 0)
+			{
+				*first = i;
+			}
+			*last = i;
+		}
+	}
+	return *first >= 0 ? qtrue : qfalse;
+}
+
+/*
+==================
+WP_SaberSweepClear
+
+Returns qtrue if nothing the damage traces could hit is within reach of the
+blade anywhere along its swing from (base_old, md1) to (base_new, md2).
+
+Otherwise, if only bodies are in reach, cuts the swing down in place to the
+samples between the earliest time of impact with any of them and the latest
+sample any of them is still in reach, so the damage traces skip the rest.
+==================
+*/
+qboolean WP_SaberSweepClear(const gentity_t* ent, const int saber_num, const int blade_num, vec3_t base_old,
+	vec3_t base_new, vec3_t md1, vec3_t md2)
+{
+	if (!g_saberSweepTest->integer || !ent->client)
+	{
+		return qfalse;
+	}
+
+	const timingUsec_c timer;
+	const bladeInfo_t* blade = &ent->client->ps.saber[saber_num].blade[blade_num];
+	const float length = Q_max(blade->length, blade->lengthOld);
+	vec3_t bases[SABER_SWEEP_MAX_SAMPLES + 1], tips[SABER_SWEEP_MAX_SAMPLES + 1], dirs[SABER_SWEEP_MAX_SAMPLES + 1];
+	vec3_t ma1, ma2, end_old, end_new, base_diff, end_diff, mins, maxs;
+	qboolean clear = qtrue;
+
+	saberSweepStats.sweeps++;
+
+	// sample the swing the same way the damage traces lerp it
+	const float swing = RAD2DEG(acosf(Com_Clamp(-1.0f, 1.0f, DotProduct(md1, md2))));
+	const int num_samples = Q_min(SABER_SWEEP_MAX_SAMPLES, 1 + static_cast<int>(swing / SABER_SWEEP_SAMPLE_ANGLE));
+
+	vectoangles(md1, ma1);
+	vectoangles(md2, ma2);
+	VectorMA(base_old, length, md1, end_old);
+	VectorMA(base_new, length, md2, end_new);
+	VectorSubtract(base_new, base_old, base_diff);
+	VectorSubtract(end_new, end_old, end_diff);
+
+	// the traces run along chords between points of the swing, so grow the
+	// sweep by how far the tip strays from the straight old to new chord
+	float chord_dist = 0.0f;
+	for (int i = 0; i <= num_samples; i++)
+	{
+		const float frac = static_cast<float>(i) / num_samples;
+		vec3_t angles, chord;
+
+		for (int xx = 0; xx < 3; xx++)
+		{
+			angles[xx] = LerpAngle(ma1[xx], ma2[xx], frac);
+		}
+		AngleVectors(angles, dirs[i], nullptr, nullptr);
+		VectorMA(base_old, frac, base_diff, bases[i]);
+		VectorMA(bases[i], length, dirs[i], tips[i]);
+		VectorMA(end_old, frac, end_diff, chord);
+		chord_dist = Q_max(chord_dist, Distance(tips[i], chord));
+	}
+
+	const float margin = Q_max(SABER_SWEEP_TRACE_RADIUS, blade->radius) + SABER_EXTRAPOLATE_DIST + chord_dist;
+
+	ClearBounds(mins, maxs);
+	for (int i = 0; i <= num_samples; i++)
+	{
+		AddPointToBounds(bases[i], mins, maxs);
+		AddPointToBounds(tips[i], mins, maxs);
+	}
+	for (int i = 0; i < 3; i++)
+	{
+		mins[i] -= margin;
+		maxs[i] += margin;
+	}
+
+	// one position test of the whole swept box against everything but bodies
+	trace_t tr;
+	vec3_t center, box_mins, box_maxs;
+	VectorAdd(mins, maxs, center);
+	VectorScale(center, 0.5f, center);
+	VectorSubtract(mins, center, box_mins);
+	VectorSubtract(maxs, center, box_maxs);
+	gi.trace(&tr, center, box_mins, box_maxs, center, ent->s.number,
+		(MASK_SHOT | CONTENTS_LIGHTSABER) & ~SABER_SWEEP_BODY_CONTENTS, G2_NOCOLLIDE, 0);
+	if (tr.startsolid || tr.allsolid || tr.fraction < 1.0f)
+	{
+		saberSweepStats.worldBlocked++;
+		clear = qfalse;
+	}
+
+	int first = num_samples + 1, last = -1;
+	if (clear)
+	{
+		gentity_t* entity_list[MAX_GENTITIES];
+		const int num_listed_entities = WP_SaberBroadphaseBodies(ent, saber_num, blade_num, mins, maxs,
+			entity_list, MAX_GENTITIES);
+
+		for (int i = 0; i < num_listed_entities; i++)
+		{
+			const gentity_t* touch = entity_list[i];
+
+			if (!touch || !touch->inuse || !(touch->contents & SABER_SWEEP_BODY_CONTENTS))
+			{
+				continue;
+			}
+			if (WP_SaberSweepSkipEntity(ent, touch))
+			{
+				continue;
+			}
+			saberSweepStats.bodiesTested++;
+			int touch_first, touch_last;
+			if (WP_SaberSweepTOI(touch, bases, tips, num_samples, margin, &touch_first, &touch_last))
+			{
+				first = Q_min(first, touch_first);
+				last = Q_max(last, touch_last);
+			}
+		}
+	}
+
+	if (clear && last >= 0)
+	{
+		// trace from the earliest time of impact to the end of the last interval
+		// anything is in reach, always keeping at least one interval to sweep
+		const int start = Q_min(first, num_samples - 1);
+		const int end = Q_min(last + 1, num_samples);
+
+		saberSweepStats.bodyBlocked++;
+		clear = qfalse;
+		if (start > 0 || end < num_samples)
+		{
+			VectorCopy(bases[start], base_old);
+			VectorCopy(dirs[start], md1);
+			VectorCopy(bases[end], base_new);
+			VectorCopy(dirs[end], md2);
+			saberSweepStats.narrowed++;
+			saberSweepStats.swingSkipped += 1.0f - static_cast<float>(end - start) / num_samples;
+		}
+	}
+	else if (clear)
+	{
+		// base and tip traces plus one per step up the blade
+		saberSweepStats.clear++;
+		saberSweepStats.tracesSaved += 2 + static_cast<int>(length / 12.0f);
+	}
+	saberSweepStats.usec += static_cast<int>(timer.End());
+	return clear;
+}
+
+void WP_SaberSweepStats_f()
+{
+	if (gi.argc() > 1 && !Q_stricmp(gi.argv(1), "reset"))
+	{
+		memset(&saberSweepStats, 0, sizeof saberSweepStats);
+		return;
+	}
+
+	gi.Printf("Saber sweep test %s\n", g_saberSweepTest->integer ? "on" : "off");
+	gi.Printf(" %d swings: %d clear, %d blocked by world, %d by bodies (%d body tests)\n", saberSweepStats.sweeps,
+		saberSweepStats.clear, saberSweepStats.worldBlocked, saberSweepStats.bodyBlocked,
+		saberSweepStats.bodiesTested);
+	if (saberSweepStats.sweeps)
+	{
+		gi.Printf(" ~%d damage traces skipped, %.1f us per swing\n", saberSweepStats.tracesSaved,
+			static_cast<float>(saberSweepStats.usec) / saberSweepStats.sweeps);
+	}
+	if (saberSweepStats.narrowed)
+	{
+		gi.Printf(" %d body swings cut down, %.1f%% of their arc left untraced\n", saberSweepStats.narrowed,
+			100.0f * saberSweepStats.swingSkipped / saberSweepStats.narrowed);
+	}
+}
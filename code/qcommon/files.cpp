@@ -1618,7 +1618,7 @@ CONVENIENCE FUNCTIONS FOR ENTIRE FILES
 ======================================================================================
 */
 
-int	FS_FileIsInPAK(const char* filename) {
+int	FS_FileIsInPAK(const char* filename, int* pChecksum) {
 	long			hash = 0;
 
 	FS_AssertInitialised();
@@ -1656,6 +1656,9 @@ int	FS_FileIsInPAK(const char* filename) {
 			do {
 				// case and separator insensitive comparisons
 				if (!FS_FilenameCompare(pakFile->name, filename)) {
+					if (pChecksum) {
+						*pChecksum = pak->checksum;
+					}
 					return 1;
 				}
 				pakFile = pakFile->next;
@@ -612,6 +612,20 @@ using trace_t = struct
 // trace->entity_num can also be 0 to (MAX_GENTITIES-1)
 // or ENTITYNUM_NONE, ENTITYNUM_WORLD
 
+// one trace of a batch run with traceBatch
+using traceJob_t = struct
+{
+	vec3_t start;
+	vec3_t mins;
+	vec3_t maxs;
+	vec3_t end;
+	int pass_entity_num;
+	int contentmask;
+	EG2_Collision e_g2_trace_type;
+	int use_lod;
+	trace_t trace; // filled in with the result
+};
+
 // markfragments are returned by CM_MarkFragments()
 using markFragment_t = struct
 {
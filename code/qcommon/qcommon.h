@@ -492,12 +492,7 @@ long FS_FOpenFileRead(const char* filename, fileHandle_t* file, qboolean uniqueF
 // file IO goes through FS_ReadFile, which Does The Right Thing already.
 
 // returns 1 if a file is in the PAK file, otherwise -1
-int FS_FileIsInPAK(const char* filename);
-
-static inline int FS_FileIsInPAK(const char* filename, int* checksum)
-{
-	return FS_FileIsInPAK(filename);
-}
+int FS_FileIsInPAK(const char* filename, int* pChecksum);
 
 int FS_Write(const void* buffer, int len, fileHandle_t h);
 
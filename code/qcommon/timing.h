@@ -24,8 +24,11 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #if defined(_WIN32) && defined(__GNUC__)
 #include <x86intrin.h>  /* for __rdtsc() */
 #endif
-#include <cstdint>
+#ifdef _MSC_VER
 #include <intrin.h>
+#endif
+#include <chrono>
+#include <cstdint>
 
 class timing_c
 {
@@ -67,4 +70,26 @@ public:
 	}
 };
 
+// Wall clock microseconds since construction or the last Start(), for profiling
+// counters that add up many short spans
+class timingUsec_c
+{
+	std::chrono::steady_clock::time_point start;
+
+public:
+	timingUsec_c() : start(std::chrono::steady_clock::now())
+	{
+	}
+
+	void Start()
+	{
+		start = std::chrono::steady_clock::now();
+	}
+
+	int64_t End() const
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+	}
+};
+
 // end
@@ -26,6 +26,8 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "../rd-common/tr_public.h"
 #include "../rd-common/tr_font.h"
 
+#include <vector>
+
 extern refimport_t ri;
 
 /*
@@ -52,13 +54,45 @@ void R_ImageLoader_Init();
 
 typedef void (*ImageLoaderFn)(const char* filename, byte** pic, int* width, int* height);
 
+// Image decoded from a file that has already been read.
+struct DecodedImage
+{
+	std::vector<byte> pic;
+	int width = 0;
+	int height = 0;
+	char error[256] = "";
+};
+
+// Decodes an image from memory. Decoders may run on any thread, so they only
+// allocate from the system heap and never print or raise errors; when they
+// fail the reason is left in image->error.
+typedef qboolean (*ImageDecoderFn)(const byte* buffer, int len, DecodedImage* image);
+
 // Adds a new image loader to handle a new image type. The extension should not
-// begin with a period (a full stop).
-qboolean R_ImageLoader_Add(const char* extension, ImageLoaderFn imageLoader);
+// begin with a period (a full stop). The decoder is optional.
+qboolean R_ImageLoader_Add(const char* extension, ImageLoaderFn imageLoader, ImageDecoderFn imageDecoder = nullptr);
 
 // Load an image from file.
 void R_LoadImage(const char* shortname, byte** pic, int* width, int* height);
 
+// Read the file R_LoadImage would load, trying the extensions in the same
+// order, without decoding it. Returns the length, or -1 if there is no file.
+// The buffer has to be freed with FS_FreeFile, the decoder is null if the
+// loader for the file doesn't have one.
+int R_ReadImage(const char* shortname, byte** buffer, ImageDecoderFn* decoder);
+
+// Copy a decoded image into memory from R_Malloc, like the loaders return.
+byte* R_CopyDecodedImage(const DecodedImage& image, int* width, int* height);
+
+// Decode a TGA image.
+qboolean DecodeTGA(const byte* buffer, int len, DecodedImage* image);
+
+// Decode a JPEG image.
+qboolean DecodeJPG(const byte* buffer, int len, DecodedImage* image);
+
+// Decode a PNG image.
+qboolean DecodePNG(const byte* buffer, int len, DecodedImage* image);
+
 // Load raw image data from TGA image.
 void LoadTGA(const char* name, byte** pic, int* width, int* height);
 
@@ -34,6 +34,8 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
  * You may also wish to include "jerror.h".
  */
 
+#include <csetjmp>
+
 #include <jpeglib.h>
 
 static void R_JPGErrorExit(const j_common_ptr cinfo)
@@ -59,7 +61,30 @@ static void R_JPGOutputMessage(const j_common_ptr cinfo)
 	Com_Printf("%s\n", buffer);
 }
 
-void LoadJPG(const char* filename, unsigned char** pic, int* width, int* height) {
+/* Error handler for decoding, which can happen on any thread: the message is
+ * kept for the caller and the decoder jumps back out instead of printing.
+ */
+struct R_JPGDecodeError
+{
+	jpeg_error_mgr pub;
+	jmp_buf setjmp_buffer;
+	DecodedImage* image;
+};
+
+static void R_JPGDecodeErrorExit(const j_common_ptr cinfo)
+{
+	const auto err = reinterpret_cast<R_JPGDecodeError*>(cinfo->err);
+
+	(*cinfo->err->format_message) (cinfo, err->image->error);
+
+	longjmp(err->setjmp_buffer, 1);
+}
+
+static void R_JPGDecodeOutputMessage(j_common_ptr cinfo)
+{
+}
+
+qboolean DecodeJPG(const byte* buffer, const int len, DecodedImage* image) {
 	/* This struct contains the JPEG decompression parameters and pointers to
 	* working space (which is allocated as needed by the JPEG library).
 	*/
@@ -68,36 +93,10 @@ void LoadJPG(const char* filename, unsigned char** pic, int* width, int* height)
 	* Note that this struct must live as long as the main JPEG parameter
 	* struct, to avoid dangling-pointer problems.
 	*/
-	/* This struct represents a JPEG error handler.  It is declared separately
-	* because applications often want to supply a specialized error handler
-	* (see the second half of this file for an example).  But here we just
-	* take the easy way out and use the standard error handler, which will
-	* print a message on stderr and call exit() if compression fails.
-	* Note that this struct must live as long as the main JPEG parameter
-	* struct, to avoid dangling-pointer problems.
-	*/
-	jpeg_error_mgr jerr;
+	R_JPGDecodeError jerr;
 	/* More stuff */
-	JSAMPARRAY buffer;		/* Output row buffer */
-	unsigned int row_stride;  /* physical row width in output buffer */
-	unsigned int pixelcount, memcount;
-	unsigned int sindex, dindex;
-	byte* out;
-	union {
-		byte* b;
-		void* v;
-	} fbuffer;
+	JSAMPARRAY rows;		/* Output row buffer */
 	byte* buf;
-	/* In this example we want to open the input file before doing anything else,
-	* so that the setjmp() error recovery below can assume the file is open.
-	* VERY IMPORTANT: use "b" option to fopen() if you are on a machine that
-	* requires it in order to read binary files.
-	*/
-
-	int len = ri.FS_ReadFile(const_cast<char*>(filename), &fbuffer.v);
-	if (!fbuffer.b || len < 0) {
-		return;
-	}
 
 	/* Step 1: allocate and initialize JPEG decompression object */
 
@@ -106,22 +105,28 @@ void LoadJPG(const char* filename, unsigned char** pic, int* width, int* height)
 	* This routine fills in the contents of struct jerr, and returns jerr's
 	* address which we place into the link field in cinfo.
 	*/
-	cinfo.err = jpeg_std_error(&jerr);
-	cinfo.err->error_exit = R_JPGErrorExit;
-	cinfo.err->output_message = R_JPGOutputMessage;
+	cinfo.err = jpeg_std_error(&jerr.pub);
+	cinfo.err->error_exit = R_JPGDecodeErrorExit;
+	cinfo.err->output_message = R_JPGDecodeOutputMessage;
+	jerr.image = image;
+
+	if (setjmp(jerr.setjmp_buffer)) {
+		jpeg_destroy_decompress(&cinfo);
+		return qfalse;
+	}
 
 	/* Now we can initialize the JPEG decompression object. */
 	jpeg_create_decompress(&cinfo);
 
 	/* Step 2: specify data source (eg, a file) */
 
-	jpeg_mem_src(&cinfo, fbuffer.b, len);
+	jpeg_mem_src(&cinfo, const_cast<byte*>(buffer), len);
 
 	/* Step 3: read file parameters with jpeg_read_header() */
 
 	(void)jpeg_read_header(&cinfo, TRUE);
 	/* We can ignore the return value from jpeg_read_header since
-	*   (a) suspension is not possible with the stdio data source, and
+	*   (a) suspension is not possible with the memory data source, and
 	*   (b) we passed TRUE to reject a tables-only JPEG file as an error.
 	* See libjpeg.doc for more info.
 	*/
@@ -135,40 +140,28 @@ void LoadJPG(const char* filename, unsigned char** pic, int* width, int* height)
 	/* Step 5: Start decompressor */
 
 	(void)jpeg_start_decompress(&cinfo);
-	/* We can ignore the return value since suspension is not possible
-	* with the stdio data source.
-	*/
 
-	/* We may need to do some setup of our own at this point before reading
-	* the data.  After jpeg_start_decompress() we have the correct scaled
-	* output image dimensions available, as well as the output colormap
-	* if we asked for color quantization.
-	* In this example, we need to make an output work buffer of the right size.
-	*/
 	/* JSAMPLEs per row in output buffer */
-	pixelcount = cinfo.output_width * cinfo.output_height;
+	const unsigned int pixelcount = cinfo.output_width * cinfo.output_height;
 
 	if (!cinfo.output_width || !cinfo.output_height
 		|| pixelcount * 4 / cinfo.output_width / 4 != cinfo.output_height
 		|| pixelcount > 0x1FFFFFFF || cinfo.output_components != 3
 		)
 	{
+		Com_sprintf(image->error, sizeof image->error, "invalid image format: %dx%d*4=%d, components: %d",
+			cinfo.output_width, cinfo.output_height, pixelcount * 4, cinfo.output_components);
+
 		// Free the memory to make sure we don't leak memory
-		ri.FS_FreeFile(fbuffer.v);
 		jpeg_destroy_decompress(&cinfo);
-
-		ri.Printf(PRINT_ALL, "LoadJPG: %s has an invalid image format: %dx%d*4=%d, components: %d", filename,
-			cinfo.output_width, cinfo.output_height, pixelcount * 4, cinfo.output_components);
-		return;
+		return qfalse;
 	}
 
-	memcount = pixelcount * 4;
-	row_stride = cinfo.output_width * cinfo.output_components;
+	const unsigned int memcount = pixelcount * 4;
+	const unsigned int row_stride = cinfo.output_width * cinfo.output_components;
 
-	out = static_cast<byte*>(R_Malloc(memcount, TAG_TEMP_WORKSPACE, qfalse));
-
-	*width = cinfo.output_width;
-	*height = cinfo.output_height;
+	image->pic.resize(memcount);
+	byte* out = image->pic.data();
 
 	/* Step 6: while (scan lines remain to be read) */
 	/*           jpeg_read_scanlines(...); */
@@ -177,19 +170,15 @@ void LoadJPG(const char* filename, unsigned char** pic, int* width, int* height)
 	* loop counter, so that we don't have to keep track ourselves.
 	*/
 	while (cinfo.output_scanline < cinfo.output_height) {
-		/* jpeg_read_scanlines expects an array of pointers to scanlines.
-		* Here the array is only one element long, but you could ask for
-		* more than one scanline at a time if that's more convenient.
-		*/
 		buf = out + row_stride * cinfo.output_scanline;
-		buffer = &buf;
-		(void)jpeg_read_scanlines(&cinfo, buffer, 1);
+		rows = &buf;
+		(void)jpeg_read_scanlines(&cinfo, rows, 1);
 	}
 
 	buf = out;
 	// Expand from RGB to RGBA
-	sindex = pixelcount * cinfo.output_components;
-	dindex = memcount;
+	unsigned int sindex = pixelcount * cinfo.output_components;
+	unsigned int dindex = memcount;
 
 	do {
 		buf[--dindex] = 255;
@@ -198,181 +187,59 @@ void LoadJPG(const char* filename, unsigned char** pic, int* width, int* height)
 		buf[--dindex] = buf[--sindex];
 	} while (sindex);
 
-	*pic = out;
+	image->width = cinfo.output_width;
+	image->height = cinfo.output_height;
 
 	/* Step 7: Finish decompression */
 
 	(void)jpeg_finish_decompress(&cinfo);
-	/* We can ignore the return value since suspension is not possible
-	* with the stdio data source.
-	*/
 
 	/* Step 8: Release JPEG decompression object */
 
 	/* This is an important step since it will release a good deal of memory. */
 	jpeg_destroy_decompress(&cinfo);
 
-	/* After finish_decompress, we can close the input file.
-	* Here we postpone it until after no more JPEG errors are possible,
-	* so as to simplify the setjmp error logic above.  (Actually, I don't
-	* think that jpeg_destroy can do an error exit, but why assume anything...)
-	*/
-	ri.FS_FreeFile(fbuffer.v);
-	/* At this point you may want to check to see whether any corrupt-data
-	* warnings occurred (test whether jerr.pub.num_warnings is nonzero).
-	*/
-
 	/* And we're done! */
+	return qtrue;
 }
 
-#ifdef JK2_MODE
-void LoadJPGFromBuffer(byte* inputBuffer, size_t len, unsigned char** pic, int* width, int* height) {
-	/* This struct contains the JPEG decompression parameters and pointers to
-	 * working space (which is allocated as needed by the JPEG library).
-	 */
-	struct jpeg_decompress_struct cinfo = { NULL };
-	/* We use our private extension JPEG error handler.
-	 * Note that this struct must live as long as the main JPEG parameter
-	 * struct, to avoid dangling-pointer problems.
-	 */
-	 /* This struct represents a JPEG error handler.  It is declared separately
-	  * because applications often want to supply a specialized error handler
-	  * (see the second half of this file for an example).  But here we just
-	  * take the easy way out and use the standard error handler, which will
-	  * print a message on stderr and call exit() if compression fails.
-	  * Note that this struct must live as long as the main JPEG parameter
-	  * struct, to avoid dangling-pointer problems.
-	  */
-	struct jpeg_error_mgr jerr;
-	/* More stuff */
-	JSAMPARRAY buffer;		/* Output row buffer */
-	unsigned int row_stride;  /* physical row width in output buffer */
-	unsigned int pixelcount, memcount;
-	unsigned int sindex, dindex;
-	byte* out;
-	byte* buf;
+void LoadJPG(const char* filename, unsigned char** pic, int* width, int* height) {
+	union {
+		byte* b;
+		void* v;
+	} fbuffer;
 
-	if (!inputBuffer) {
+	const int len = ri.FS_ReadFile(const_cast<char*>(filename), &fbuffer.v);
+	if (!fbuffer.b || len < 0) {
 		return;
 	}
 
-	/* Step 1: allocate and initialize JPEG decompression object */
-
-	/* We have to set up the error handler first, in case the initialization
-	 * step fails.  (Unlikely, but it could happen if you are out of memory.)
-	 * This routine fills in the contents of struct jerr, and returns jerr's
-	 * address which we place into the link field in cinfo.
-	 */
-	cinfo.err = jpeg_std_error(&jerr);
-	cinfo.err->error_exit = R_JPGErrorExit;
-	cinfo.err->output_message = R_JPGOutputMessage;
-
-	/* Now we can initialize the JPEG decompression object. */
-	jpeg_create_decompress(&cinfo);
-
-	/* Step 2: specify data source (eg, a file) */
-
-	jpeg_mem_src(&cinfo, inputBuffer, len);
-
-	/* Step 3: read file parameters with jpeg_read_header() */
-
-	(void)jpeg_read_header(&cinfo, TRUE);
-	/* We can ignore the return value from jpeg_read_header since
-	 *   (a) suspension is not possible with the stdio data source, and
-	 *   (b) we passed TRUE to reject a tables-only JPEG file as an error.
-	 * See libjpeg.doc for more info.
-	 */
-
-	 /* Step 4: set parameters for decompression */
+	DecodedImage image;
+	const qboolean decoded = DecodeJPG(fbuffer.b, len, &image);
 
-	 /* Make sure it always converts images to RGB color space. This will
-	  * automatically convert 8-bit greyscale images to RGB as well.	*/
-	cinfo.out_color_space = JCS_RGB;
-
-	/* Step 5: Start decompressor */
-
-	(void)jpeg_start_decompress(&cinfo);
-	/* We can ignore the return value since suspension is not possible
-	 * with the stdio data source.
-	 */
-
-	 /* We may need to do some setup of our own at this point before reading
-	  * the data.  After jpeg_start_decompress() we have the correct scaled
-	  * output image dimensions available, as well as the output colormap
-	  * if we asked for color quantization.
-	  * In this example, we need to make an output work buffer of the right size.
-	  */
-	  /* JSAMPLEs per row in output buffer */
-	pixelcount = cinfo.output_width * cinfo.output_height;
-
-	if (!cinfo.output_width || !cinfo.output_height
-		|| ((pixelcount * 4) / cinfo.output_width) / 4 != cinfo.output_height
-		|| pixelcount > 0x1FFFFFFF || cinfo.output_components != 3
-		)
-	{
-		// Free the memory to make sure we don't leak memory
-		jpeg_destroy_decompress(&cinfo);
+	ri.FS_FreeFile(fbuffer.v);
 
-		ri.Printf(PRINT_ALL, "LoadJPG: invalid image format: %dx%d*4=%d, components: %d",
-			cinfo.output_width, cinfo.output_height, pixelcount * 4, cinfo.output_components);
+	if (!decoded) {
+		ri.Printf(PRINT_ALL, "LoadJPG: %s (%s)\n", image.error, filename);
 		return;
 	}
 
-	memcount = pixelcount * 4;
-	row_stride = cinfo.output_width * cinfo.output_components;
-
-	out = (byte*)R_Malloc(memcount, TAG_TEMP_WORKSPACE, qfalse);
-
-	*width = cinfo.output_width;
-	*height = cinfo.output_height;
-
-	/* Step 6: while (scan lines remain to be read) */
-	/*           jpeg_read_scanlines(...); */
+	*pic = R_CopyDecodedImage(image, width, height);
+}
 
-	/* Here we use the library's state variable cinfo.output_scanline as the
-	 * loop counter, so that we don't have to keep track ourselves.
-	 */
-	while (cinfo.output_scanline < cinfo.output_height) {
-		/* jpeg_read_scanlines expects an array of pointers to scanlines.
-		 * Here the array is only one element long, but you could ask for
-		 * more than one scanline at a time if that's more convenient.
-		 */
-		buf = ((out + (row_stride * (cinfo.output_height - cinfo.output_scanline - 1))));
-		buffer = &buf;
-		(void)jpeg_read_scanlines(&cinfo, buffer, 1);
+#ifdef JK2_MODE
+void LoadJPGFromBuffer(byte* inputBuffer, size_t len, unsigned char** pic, int* width, int* height) {
+	if (!inputBuffer) {
+		return;
 	}
 
-	buf = out;
-	// Expand from RGB to RGBA
-	sindex = pixelcount * cinfo.output_components;
-	dindex = memcount;
-
-	do {
-		buf[--dindex] = 255;
-		buf[--dindex] = buf[--sindex];
-		buf[--dindex] = buf[--sindex];
-		buf[--dindex] = buf[--sindex];
-	} while (sindex);
-
-	*pic = out;
-
-	/* Step 7: Finish decompression */
-
-	(void)jpeg_finish_decompress(&cinfo);
-	/* We can ignore the return value since suspension is not possible
-	 * with the stdio data source.
-	 */
-
-	 /* Step 8: Release JPEG decompression object */
-
-	 /* This is an important step since it will release a good deal of memory. */
-	jpeg_destroy_decompress(&cinfo);
-
-	/* At this point you may want to check to see whether any corrupt-data
-	 * warnings occurred (test whether jerr.pub.num_warnings is nonzero).
-	 */
+	DecodedImage image;
+	if (!DecodeJPG(inputBuffer, static_cast<int>(len), &image)) {
+		ri.Printf(PRINT_ALL, "LoadJPG: %s\n", image.error);
+		return;
+	}
 
-	 /* And we're done! */
+	*pic = R_CopyDecodedImage(image, width, height);
 }
 #endif
 
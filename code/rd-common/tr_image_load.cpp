@@ -31,6 +31,7 @@ struct ImageLoaderMap
 {
 	const char* extension;
 	ImageLoaderFn loader;
+	ImageDecoderFn decoder;
 } imageLoaders[MAX_IMAGE_LOADERS];
 int numImageLoaders;
 
@@ -58,7 +59,7 @@ Adds a new image loader to load the specified image file extension.
 The 'extension' string should not begin with a period (full stop).
 =================
 */
-qboolean R_ImageLoader_Add(const char* extension, const ImageLoaderFn imageLoader)
+qboolean R_ImageLoader_Add(const char* extension, const ImageLoaderFn imageLoader, const ImageDecoderFn imageDecoder)
 {
 	if (numImageLoaders >= MAX_IMAGE_LOADERS)
 	{
@@ -75,6 +76,7 @@ qboolean R_ImageLoader_Add(const char* extension, const ImageLoaderFn imageLoade
 	ImageLoaderMap* newImageLoader = &imageLoaders[numImageLoaders];
 	newImageLoader->extension = extension;
 	newImageLoader->loader = imageLoader;
+	newImageLoader->decoder = imageDecoder;
 
 	numImageLoaders++;
 
@@ -92,9 +94,9 @@ void R_ImageLoader_Init()
 	Com_Memset(imageLoaders, 0, sizeof imageLoaders);
 	numImageLoaders = 0;
 
-	R_ImageLoader_Add("jpg", LoadJPG);
-	R_ImageLoader_Add("png", LoadPNG);
-	R_ImageLoader_Add("tga", LoadTGA);
+	R_ImageLoader_Add("jpg", LoadJPG, DecodeJPG);
+	R_ImageLoader_Add("png", LoadPNG, DecodePNG);
+	R_ImageLoader_Add("tga", LoadTGA, DecodeTGA);
 }
 
 /*
@@ -139,4 +141,63 @@ void R_LoadImage(const char* shortname, byte** pic, int* width, int* height) {
 			return;
 		}
 	}
-}
\ No newline at end of file
+}
+
+/*
+=================
+Reads the file R_LoadImage would start with. Unlike R_LoadImage it only moves
+on to the next extension when there is no file, not when it fails to decode.
+=================
+*/
+int R_ReadImage(const char* shortname, byte** buffer, ImageDecoderFn* decoder)
+{
+	*buffer = nullptr;
+	*decoder = nullptr;
+
+	const char* extension = COM_GetExtension(shortname);
+	const ImageLoaderMap* imageLoader = FindImageLoader(extension);
+	if (imageLoader != nullptr)
+	{
+		const int len = static_cast<int>(ri.FS_ReadFile(shortname, reinterpret_cast<void**>(buffer)));
+		if (*buffer)
+		{
+			*decoder = imageLoader->decoder;
+			return len;
+		}
+	}
+
+	char extensionlessName[MAX_QPATH];
+	COM_StripExtension(shortname, extensionlessName, sizeof extensionlessName);
+	for (int i = 0; i < numImageLoaders; i++)
+	{
+		const ImageLoaderMap* tryLoader = &imageLoaders[i];
+		if (tryLoader == imageLoader)
+		{
+			continue;
+		}
+
+		const char* name = va("%s.%s", extensionlessName, tryLoader->extension);
+		const int len = static_cast<int>(ri.FS_ReadFile(name, reinterpret_cast<void**>(buffer)));
+		if (*buffer)
+		{
+			*decoder = tryLoader->decoder;
+			return len;
+		}
+	}
+
+	return -1;
+}
+
+/*
+=================
+Copies a decoded image into memory the rest of the renderer can R_Free.
+=================
+*/
+byte* R_CopyDecodedImage(const DecodedImage& image, int* width, int* height)
+{
+	byte* pic = static_cast<byte*>(R_Malloc(image.pic.size(), TAG_TEMP_WORKSPACE, qfalse));
+	memcpy(pic, image.pic.data(), image.pic.size());
+	*width = image.width;
+	*height = image.height;
+	return pic;
+}
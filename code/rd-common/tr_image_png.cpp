@@ -125,25 +125,26 @@ fopen_failed:
 }
 
 void user_read_data(png_structp png_ptr, png_bytep data, png_size_t length);
-void png_print_error(png_structp png_ptr, const png_const_charp err)
+
+// The decoder can run on a worker thread, so the messages are kept for the
+// caller instead of printed.
+void png_keep_error(const png_structp png_ptr, const png_const_charp err)
 {
-	ri.Printf(PRINT_ERROR, "%s\n", err);
+	const auto image = static_cast<DecodedImage*>(png_get_error_ptr(png_ptr));
+	Q_strncpyz(image->error, err, sizeof image->error);
 }
 
-void png_print_warning(png_structp png_ptr, const png_const_charp warning)
+void png_ignore_warning(png_structp png_ptr, png_const_charp warning)
 {
-	ri.Printf(PRINT_WARNING, "%s\n", warning);
 }
 
 bool IsPowerOfTwo(const int i) { return (i & i - 1) == 0; }
 
 struct PNGFileReader
 {
-	PNGFileReader(char* buf) : buf(buf), offset(0), png_ptr(nullptr), info_ptr(nullptr) {}
+	PNGFileReader(const byte* buf, const size_t len) : buf(buf), len(len), offset(0), png_ptr(nullptr), info_ptr(nullptr) {}
 	~PNGFileReader()
 	{
-		ri.FS_FreeFile(buf);
-
 		if (info_ptr != nullptr)
 		{
 			// Destroys both structs
@@ -155,29 +156,21 @@ struct PNGFileReader
 		}
 	}
 
-	int Read(byte** data, int* width, int* height)
+	int Read(DecodedImage* image)
 	{
-		// Setup the pointers
-		*data = nullptr;
-		*width = 0;
-		*height = 0;
-
 		// Make sure we're actually reading PNG data.
 		constexpr int SIGNATURE_LEN = 8;
 
-		byte ident[SIGNATURE_LEN];
-		memcpy(ident, buf, SIGNATURE_LEN);
-
-		if (!png_check_sig(ident, SIGNATURE_LEN))
+		if (len < SIGNATURE_LEN || !png_check_sig(buf, SIGNATURE_LEN))
 		{
-			ri.Printf(PRINT_ERROR, "PNG signature not found in given image.");
+			Q_strncpyz(image->error, "PNG signature not found in given image.", sizeof image->error);
 			return 0;
 		}
 
-		png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, png_print_error, png_print_warning);
+		png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, image, png_keep_error, png_ignore_warning);
 		if (png_ptr == nullptr)
 		{
-			ri.Printf(PRINT_ERROR, "Could not allocate enough memory to load the image.");
+			Q_strncpyz(image->error, "Could not allocate enough memory to load the image.", sizeof image->error);
 			return 0;
 		}
 
@@ -210,7 +203,7 @@ struct PNGFileReader
 		// so that the graphics driver doesn't have to fiddle about with the texture when uploading.
 		if (!IsPowerOfTwo(width_) || !IsPowerOfTwo(height_))
 		{
-			ri.Printf(PRINT_ERROR, "Width or height is not a power-of-two.\n");
+			Q_strncpyz(image->error, "Width or height is not a power-of-two.", sizeof image->error);
 			return 0;
 		}
 
@@ -220,7 +213,7 @@ struct PNGFileReader
 		// PNG_COLOR_TYPE_GRAY.
 		if (colortype != PNG_COLOR_TYPE_RGB && colortype != PNG_COLOR_TYPE_RGBA)
 		{
-			ri.Printf(PRINT_ERROR, "Image is not 24-bit or 32-bit.");
+			Q_strncpyz(image->error, "Image is not 24-bit or 32-bit.", sizeof image->error);
 			return 0;
 		}
 
@@ -234,63 +227,44 @@ struct PNGFileReader
 		png_read_update_info(png_ptr, info_ptr);
 
 		// We always assume there are 4 channels. RGB channels are expanded to RGBA when read.
-		const auto tempData = static_cast<byte*>(R_Malloc(width_ * height_ * 4, TAG_TEMP_PNG, qfalse));
-		if (!tempData)
-		{
-			ri.Printf(PRINT_ERROR, "Could not allocate enough memory to load the image.");
-			return 0;
-		}
-
-		// Dynamic array of row pointers, with 'height' elements, initialized to NULL.
-		const auto row_pointers = static_cast<byte**>(R_Malloc(sizeof(byte*) * height_, TAG_TEMP_PNG, qfalse));
-		if (!row_pointers)
-		{
-			ri.Printf(PRINT_ERROR, "Could not allocate enough memory to load the image.");
-
-			R_Free(tempData);
-
-			return 0;
-		}
-
-		// Re-set the jmp so that these new memory allocations can be reclaimed
-		if (setjmp(png_jmpbuf(png_ptr)))
-		{
-			R_Free(row_pointers);
-			R_Free(tempData);
-			return 0;
-		}
+		image->pic.resize(width_ * height_ * 4);
 
+		// Dynamic array of row pointers, with 'height' elements.
+		row_pointers.resize(height_);
 		for (unsigned int i = 0, j = 0; i < height_; i++, j += 4)
 		{
-			row_pointers[i] = tempData + j * width_;
+			row_pointers[i] = image->pic.data() + j * width_;
 		}
 
-		png_read_image(png_ptr, row_pointers);
+		png_read_image(png_ptr, row_pointers.data());
 
 		// Finish reading
 		png_read_end(png_ptr, nullptr);
 
-		R_Free(row_pointers);
-
 		// Finally assign all the parameters
-		*data = tempData;
-		*width = width_;
-		*height = height_;
+		image->width = width_;
+		image->height = height_;
 
 		return 1;
 	}
 
-	void ReadBytes(void* dest, const size_t len)
+	void ReadBytes(void* dest, const size_t length)
 	{
-		memcpy(dest, buf + offset, len);
-		offset += len;
+		if (length > len - offset)
+		{
+			png_error(png_ptr, "Unexpected end of file.");
+		}
+		memcpy(dest, buf + offset, length);
+		offset += length;
 	}
 
 private:
-	char* buf;
+	const byte* buf;
+	size_t len;
 	size_t offset;
 	png_structp png_ptr;
 	png_infop info_ptr;
+	std::vector<byte*> row_pointers;
 };
 
 void user_read_data(const png_structp png_ptr, const png_bytep data, const png_size_t length) {
@@ -299,9 +273,20 @@ void user_read_data(const png_structp png_ptr, const png_bytep data, const png_s
 	reader->ReadBytes(data, length);
 }
 
+// Decodes a PNG image from memory.
+qboolean DecodePNG(const byte* buffer, const int len, DecodedImage* image)
+{
+	PNGFileReader reader(buffer, len);
+	return reader.Read(image) ? qtrue : qfalse;
+}
+
 // Loads a PNG image from file.
 void LoadPNG(const char* filename, byte** data, int* width, int* height)
 {
+	*data = nullptr;
+	*width = 0;
+	*height = 0;
+
 	char* buf = nullptr;
 	const int len = ri.FS_ReadFile(filename, reinterpret_cast<void**>(&buf));
 	if (len < 0 || buf == nullptr)
@@ -309,6 +294,16 @@ void LoadPNG(const char* filename, byte** data, int* width, int* height)
 		return;
 	}
 
-	PNGFileReader reader(buf);
-	reader.Read(data, width, height);
-}
\ No newline at end of file
+	DecodedImage image;
+	const qboolean decoded = DecodePNG(reinterpret_cast<byte*>(buf), len, &image);
+
+	ri.FS_FreeFile(buf);
+
+	if (!decoded)
+	{
+		ri.Printf(PRINT_ERROR, "%s (%s)\n", image.error, filename);
+		return;
+	}
+
+	*data = R_CopyDecodedImage(image, width, height);
+}
@@ -49,37 +49,28 @@ typedef struct TGAHeader_s {
 } TGAHeader_t;
 #pragma pack(pop)
 
-// *pic == pic, else NULL for failed.
+// Decodes into image->pic, else leaves the reason in image->error.
 //
-//  returns false if found but had a format error, else true for either OK or not-found (there's a reason for this)
-//
-
-void LoadTGA(const char* name, byte** pic, int* width, int* height)
+qboolean DecodeTGA(const byte* buffer, const int len, DecodedImage* image)
 {
-	char sErrorString[1024];
 	bool bFormatErrors = false;
 
 	// these don't need to be declared or initialised until later, but the compiler whines that 'goto' skips them.
 	//
 	byte* pRGBA = nullptr;
 	byte* pOut = nullptr;
-	byte* pIn = nullptr;
+	const byte* pIn = nullptr;
+	TGAHeader_t header;
+	TGAHeader_t* p_header = &header;
 
-	*pic = nullptr;
-
-#define TGA_FORMAT_ERROR(blah) {sprintf(sErrorString,blah); bFormatErrors = true; goto TGADone;}
+#define TGA_FORMAT_ERROR(blah) {Q_strncpyz(image->error,blah,sizeof image->error); bFormatErrors = true; goto TGADone;}
 	//#define TGA_FORMAT_ERROR(blah) Com_Error( ERR_DROP, blah );
 
-		//
-		// load the file
-		//
-	byte* pTempLoadedBuffer = nullptr;
-	ri.FS_ReadFile(const_cast<char*>(name), reinterpret_cast<void**>(&pTempLoadedBuffer));
-	if (!pTempLoadedBuffer) {
-		return;
+	if (len < static_cast<int>(sizeof header))
+	{
+		TGA_FORMAT_ERROR("LoadTGA: file is too short for a header\n");
 	}
-
-	auto p_header = reinterpret_cast<TGAHeader_t*>(pTempLoadedBuffer);
+	memcpy(&header, buffer, sizeof header);
 
 	p_header->wColourMapLength = LittleShort p_header->wColourMapLength;
 	p_header->wImageWidth = LittleShort p_header->wImageWidth;
@@ -193,15 +184,13 @@ void LoadTGA(const char* name, byte** pic, int* width, int* height)
 
 	// feed back the results...
 	//
-	if (width)
-		*width = p_header->wImageWidth;
-	if (height)
-		*height = p_header->wImageHeight;
+	image->width = p_header->wImageWidth;
+	image->height = p_header->wImageHeight;
 
-	pRGBA = static_cast<byte*>(R_Malloc(p_header->wImageWidth * p_header->wImageHeight * 4, TAG_TEMP_WORKSPACE, qfalse));
-	*pic = pRGBA;
+	image->pic.resize(p_header->wImageWidth * p_header->wImageHeight * 4);
+	pRGBA = image->pic.data();
 	pOut = pRGBA;
-	pIn = pTempLoadedBuffer + sizeof * p_header;
+	pIn = buffer + sizeof * p_header;
 
 	// I don't know if this ID-thing here is right, since comments that I've seen are at the end of the file,
 	//	with a zero in this field. However, may as well...
@@ -367,10 +356,31 @@ void LoadTGA(const char* name, byte** pic, int* width, int* height)
 
 TGADone:
 
+	return bFormatErrors ? qfalse : qtrue;
+}
+
+void LoadTGA(const char* name, byte** pic, int* width, int* height)
+{
+	*pic = nullptr;
+
+	//
+	// load the file
+	//
+	byte* pTempLoadedBuffer = nullptr;
+	const int len = static_cast<int>(ri.FS_ReadFile(const_cast<char*>(name), reinterpret_cast<void**>(&pTempLoadedBuffer)));
+	if (!pTempLoadedBuffer) {
+		return;
+	}
+
+	DecodedImage image;
+	const qboolean decoded = DecodeTGA(pTempLoadedBuffer, len, &image);
+
 	ri.FS_FreeFile(pTempLoadedBuffer);
 
-	if (bFormatErrors)
+	if (!decoded)
 	{
-		Com_Error(ERR_DROP, "%s( File: \"%s\" )\n", sErrorString, name);
+		Com_Error(ERR_DROP, "%s( File: \"%s\" )\n", image.error, name);
 	}
+
+	*pic = R_CopyDecodedImage(image, width, height);
 }
\ No newline at end of file
@@ -30,7 +30,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "../ghoul2/G2.h"
 #include "../ghoul2/ghoul2_gore.h"
 
-#define	REF_API_VERSION		18
+#define	REF_API_VERSION		19
 
 using refimport_t = struct
 {
@@ -73,7 +73,7 @@ using refimport_t = struct
 	fileHandle_t(*FS_FOpenFileWrite)(const char* qpath, qboolean safe);
 	int (*FS_FOpenFileByMode)(const char* qpath, fileHandle_t* f, fsMode_t mode);
 	qboolean(*FS_FileExists)(const char* file);
-	int (*FS_FileIsInPAK)(const char* filename);
+	int (*FS_FileIsInPAK)(const char* filename, int* pChecksum);
 	char** (*FS_ListFiles)(const char* directory, const char* extension, int* numfiles);
 	int (*FS_Write)(const void* buffer, int len, fileHandle_t f);
 	void (*FS_WriteFile)(const char* qpath, const void* buffer, int size);
@@ -99,6 +99,7 @@ using refimport_t = struct
 	// OpenGL-specific
 	void* (*GL_GetProcAddress)(const char* name);
 	qboolean(*GL_ExtensionSupported)(const char* extension);
+	void (*GL_MakeCurrent)(qboolean current);
 
 	CMiniHeap* (*GetG2VertSpaceServer)();
 
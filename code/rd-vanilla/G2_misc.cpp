@@ -74,6 +74,8 @@ static void DestroyGoreTexCoordinates(const int tag)
 	{
 		return;
 	}
+	// the render thread may still be drawing last frame's gore from it
+	RB_WaitRenderThread();
 	(*gTC).~GoreTextureCoordinates();
 	//I don't know what's going on here, it should call the destructor for
 	//this when it erases the record but sometimes it doesn't. -rww
@@ -86,6 +88,7 @@ int AllocGoreRecord()
 {
 	while (GoreRecords.size() > MAX_GORE_RECORDS)
 	{
+		RB_WaitRenderThread();
 		const int tag_high = (*GoreRecords.begin()).first & GORE_TAG_MASK;
 		std::map<int, GoreTextureCoordinates>::iterator it;
 
@@ -855,6 +855,7 @@ bool				COutside::SWeatherZone::mMarkedOutside = false;
 
 void R_AddWeatherZone(vec3_t mins, vec3_t maxs)
 {
+	RB_WaitRenderThread();
 	mOutside.AddWeatherZone(mins, maxs);
 }
 
@@ -1521,7 +1522,7 @@ void R_ShutdownWorldEffects()
 void RB_RenderWorldEffects()
 {
 	if (!tr.world ||
-		tr.refdef.rdflags & RDF_NOWORLDMODEL ||
+		backEnd.refdef.rdflags & RDF_NOWORLDMODEL ||
 		backEnd.refdef.rdflags & RDF_SKYBOXPORTAL ||
 		!mParticleClouds.size() ||
 		ri.CL_IsRunningInGameCinematic())
@@ -1646,6 +1647,9 @@ void R_WorldEffectCommand(const char* command)
 		return;
 	}
 
+	// the render thread may be drawing the weather systems this changes
+	RB_WaitRenderThread();
+
 	const char* token;//, *origCommand;
 
 	COM_BeginParseSession();
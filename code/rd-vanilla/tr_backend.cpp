@@ -26,7 +26,11 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "tr_local.h"
 #include "tr_common.h"
 
-backEndData_t* backEndData;
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+backEndData_t* backEndData[SMP_FRAMES];
 backEndState_t	backEnd;
 
 bool tr_stencilled = false;
@@ -569,11 +573,11 @@ static bool R_WorldCoordToScreenCoordFloat(vec3_t world_coord, float* x, float*
 	const int ycenter = glConfig.vidHeight / 2;
 
 	//AngleVectors (tr.refdef.viewangles, vfwd, vright, vup);
-	VectorCopy(tr.refdef.viewaxis[0], vfwd);
-	VectorCopy(tr.refdef.viewaxis[1], vright);
-	VectorCopy(tr.refdef.viewaxis[2], vup);
+	VectorCopy(backEnd.refdef.viewaxis[0], vfwd);
+	VectorCopy(backEnd.refdef.viewaxis[1], vright);
+	VectorCopy(backEnd.refdef.viewaxis[2], vup);
 
-	VectorSubtract(world_coord, tr.refdef.vieworg, local);
+	VectorSubtract(world_coord, backEnd.refdef.vieworg, local);
 
 	transformed[0] = DotProduct(local, vright);
 	transformed[1] = DotProduct(local, vup);
@@ -585,8 +589,8 @@ static bool R_WorldCoordToScreenCoordFloat(vec3_t world_coord, float* x, float*
 		return false;
 	}
 
-	const float xzi = xcenter / transformed[2] * (90.0 / tr.refdef.fov_x);
-	const float yzi = ycenter / transformed[2] * (90.0 / tr.refdef.fov_y);
+	const float xzi = xcenter / transformed[2] * (90.0 / backEnd.refdef.fov_x);
+	const float yzi = ycenter / transformed[2] * (90.0 / backEnd.refdef.fov_y);
 
 	*x = xcenter + xzi * transformed[0];
 	*y = ycenter - yzi * transformed[1];
@@ -627,6 +631,261 @@ using postRender_t = struct
 static postRender_t g_postRenders[MAX_POST_RENDERS];
 static int g_numPostRenders = 0;
 
+// model surfaces of several entities drawn as one run, with every entity's
+// vertexes moved into world space and lit as they are added
+static struct
+{
+	qboolean	active;
+	qboolean	possible;	// every surface of the run so far can be moved to world space
+	orientationr_t	ori;	// of the entity being added
+} instanceRun;
+
+/*
+==================
+RB_InstanceShader
+
+The surfaces of different entities can only share a draw if nothing the
+shader does depends on the entity or on the vertexes being in its space.
+==================
+*/
+static qboolean RB_InstanceShader(const shader_t* shader)
+{
+	if (shader->numDeforms || shader->sky || shader == tr.distortionShader || shader == tr.shadowShader
+		|| shader == tr.projectionShadowShader)
+	{
+		return qfalse;
+	}
+
+	for (int stage = 0; stage < shader->numUnfoggedPasses; stage++)
+	{
+		const shaderStage_t* p_stage = &shader->stages[stage];
+
+		if (!p_stage->active)
+		{
+			break;
+		}
+		if (p_stage->ss && p_stage->ss->surfaceSpriteType)
+		{
+			return qfalse;
+		}
+
+		switch (p_stage->rgbGen)
+		{
+		case CGEN_IDENTITY:
+		case CGEN_IDENTITY_LIGHTING:
+		case CGEN_CONST:
+		case CGEN_EXACT_VERTEX:
+		case CGEN_VERTEX:
+		case CGEN_ONE_MINUS_VERTEX:
+		case CGEN_WAVEFORM:
+		case CGEN_LIGHTING_DIFFUSE:
+		case CGEN_LIGHTMAPSTYLE:
+		case CGEN_FOG:
+			break;
+		default:
+			return qfalse;
+		}
+
+		switch (p_stage->alphaGen)
+		{
+		case AGEN_IDENTITY:
+		case AGEN_SKIP:
+		case AGEN_CONST:
+		case AGEN_VERTEX:
+		case AGEN_ONE_MINUS_VERTEX:
+		case AGEN_WAVEFORM:
+			break;
+		default:
+			return qfalse;
+		}
+
+		for (const textureBundle_t& bundle : p_stage->bundle)
+		{
+			switch (bundle.tcGen)
+			{
+			case TCGEN_BAD:
+			case TCGEN_IDENTITY:
+			case TCGEN_TEXTURE:
+			case TCGEN_LIGHTMAP:
+			case TCGEN_LIGHTMAP1:
+			case TCGEN_LIGHTMAP2:
+			case TCGEN_LIGHTMAP3:
+			case TCGEN_FOG:
+				break;
+			default:
+				return qfalse;
+			}
+			for (int tm = 0; tm < bundle.numTexMods; tm++)
+			{
+				if (bundle.texMods[tm].type == TMOD_TURBULENT || bundle.texMods[tm].type == TMOD_ENTITY_TRANSLATE)
+				{
+					return qfalse;
+				}
+			}
+		}
+	}
+
+	return qtrue;
+}
+
+static qboolean RB_InstanceEntity(const trRefEntity_t* ent, const trRefEntity_t* first)
+{
+	constexpr int entity_fx = RF_DEPTHHACK | RF_NODEPTH | RF_VOLUMETRIC | RF_ALPHA_FADE | RF_RGB_TINT
+		| RF_SETANIMINDEX | RF_DISINTEGRATE1 | RF_DISINTEGRATE2 | RF_DISTORTION | RF_FORCE_ENT_ALPHA;
+
+	return static_cast<qboolean>(ent->e.reType == RT_MODEL && !(ent->e.renderfx & entity_fx)
+		&& !ent->e.nonNormalizedAxes && !ent->needDlights && ent->e.shaderTime == first->e.shaderTime);
+}
+
+/*
+==================
+RB_InstanceVertexes
+
+Lights the vertexes from first on with the current entity and moves them
+from its space into world space.
+==================
+*/
+static void RB_InstanceVertexes(const int first)
+{
+	const orientationr_t& ori = instanceRun.ori;
+
+	RB_CalcDiffuseColorRange(reinterpret_cast<unsigned char*>(tess.instanceColors), first, tess.numVertexes - first);
+
+	for (int i = first; i < tess.numVertexes; i++)
+	{
+		vec3_t local;
+
+		VectorCopy(tess.xyz[i], local);
+		for (int j = 0; j < 3; j++)
+		{
+			tess.xyz[i][j] = ori.origin[j] + local[0] * ori.axis[0][j] + local[1] * ori.axis[1][j] + local[2] * ori.axis[2][j];
+		}
+
+		VectorCopy(tess.normal[i], local);
+		for (int j = 0; j < 3; j++)
+		{
+			tess.normal[i][j] = local[0] * ori.axis[0][j] + local[1] * ori.axis[1][j] + local[2] * ori.axis[2][j];
+		}
+	}
+	tess.instanceLit = qtrue;
+}
+
+/*
+==================
+RB_MergeInstance
+
+Called when the entity changes but the shader, fog and dlighting don't.
+Returns qtrue if the new entity's surfaces can go into the current run, the
+first time that happens the surfaces already in it are moved to world space.
+==================
+*/
+static qboolean RB_MergeInstance(const shader_t* shader, const int entity_num, const int old_entity_num)
+{
+	if (!r_mergeInstances->integer || !instanceRun.possible || entity_num == REFENTITYNUM_WORLD
+		|| old_entity_num == REFENTITYNUM_WORLD || old_entity_num < 0 || !tess.numVertexes)
+	{
+		return qfalse;
+	}
+
+	const trRefEntity_t* old_ent = &backEnd.refdef.entities[old_entity_num];
+
+	if (!RB_InstanceEntity(&backEnd.refdef.entities[entity_num], old_ent))
+	{
+		return qfalse;
+	}
+
+	if (!instanceRun.active)
+	{
+		if (!RB_InstanceShader(shader) || !RB_InstanceEntity(old_ent, old_ent))
+		{
+			instanceRun.possible = qfalse;
+			return qfalse;
+		}
+		instanceRun.ori = backEnd.ori;
+		RB_InstanceVertexes(0);
+		instanceRun.active = qtrue;
+	}
+
+	backEnd.pc.c_instanceMerges++;
+	backEnd.pc.c_instanceDrawsSaved += tess.numPasses;
+	return qtrue;
+}
+
+// the next surfaces are drawn with the last entity's matrix again
+static void RB_EndInstanceRun()
+{
+	if (instanceRun.active)
+	{
+		instanceRun.active = qfalse;
+		backEnd.ori = instanceRun.ori;
+		qglLoadMatrixf(backEnd.ori.model_matrix);
+	}
+	instanceRun.possible = qtrue;
+}
+
+static qboolean RB_InstanceSurface(const surfaceType_t* surface)
+{
+	if (*surface == SF_MD3)
+	{
+		return qtrue;
+	}
+#ifdef _G2_GORE
+	// gore surfaces fade through the stage colors
+	return static_cast<qboolean>(*surface == SF_MDX && !reinterpret_cast<const CRenderableSurface*>(surface)->alternateTex);
+#else
+	return static_cast<qboolean>(*surface == SF_MDX);
+#endif
+}
+
+// a surface that isn't in the static batch of the run draws what the run has
+// so far and carries on with the tess arrays, the same goes for a surface
+// that can't be moved into world space in a run of several entities
+static void RB_TessSurface(surfaceType_t* surface)
+{
+	if (tess.staticBatch)
+	{
+		if (RB_AddStaticSurface(surface))
+		{
+			return;
+		}
+		shader_t* shader = tess.shader;
+		const int fog_num = tess.fogNum;
+
+		RB_EndSurface();
+		RB_BeginSurface(shader, fog_num);
+	}
+
+	if (!RB_InstanceSurface(surface))
+	{
+		instanceRun.possible = qfalse;
+
+		if (instanceRun.active)
+		{
+			shader_t* shader = tess.shader;
+			const int fog_num = tess.fogNum;
+
+			RB_EndSurface();
+			RB_BeginSurface(shader, fog_num);
+			RB_EndInstanceRun();
+			instanceRun.possible = qfalse;
+		}
+	}
+
+	if (instanceRun.active)
+	{
+		const int registration = tess.registration;
+		const int first_vertex = tess.numVertexes;
+
+		rb_surfaceTable[*surface](surface);
+
+		// an overflow drew the run so far and started over
+		RB_InstanceVertexes(tess.registration == registration ? first_vertex : 0);
+		return;
+	}
+
+	rb_surfaceTable[*surface](surface);
+}
+
 void RB_RenderDrawSurfList(drawSurf_t* draw_surfs, const int num_draw_surfs)
 {
 	shader_t* shader;
@@ -659,12 +918,15 @@ void RB_RenderDrawSurfList(drawSurf_t* draw_surfs, const int num_draw_surfs)
 	auto old_sort = static_cast<unsigned>(-1);
 	int depth_range = qfalse;
 
+	instanceRun.active = qfalse;
+	instanceRun.possible = qtrue;
+
 	backEnd.pc.c_surfaces += num_draw_surfs;
 
 	for (i = 0, draw_surf = draw_surfs; i < num_draw_surfs; i++, draw_surf++) {
 		if (draw_surf->sort == old_sort) {
 			// fast path, same as previous sort
-			rb_surfaceTable[*draw_surf->surface](draw_surf->surface);
+			RB_TessSurface(draw_surf->surface);
 			continue;
 		}
 		R_DecomposeSort(draw_surf->sort, &entity_num, &shader, &fog_num, &dlighted);
@@ -734,11 +996,16 @@ void RB_RenderDrawSurfList(drawSurf_t* draw_surfs, const int num_draw_surfs)
 			}
 		}
 
-		if (shader != old_shader || fog_num != old_fog_num || dlighted != old_dlighted
-			|| entity_num != old_entity_num && !shader->entityMergable)
+		const bool merge_instance = shader == old_shader && fog_num == old_fog_num && dlighted == old_dlighted
+			&& entity_num != old_entity_num && !shader->entityMergable
+			&& RB_MergeInstance(shader, entity_num, old_entity_num);
+
+		if (!merge_instance && (shader != old_shader || fog_num != old_fog_num || dlighted != old_dlighted
+			|| entity_num != old_entity_num && !shader->entityMergable))
 		{
 			if (old_shader != nullptr) {
 				RB_EndSurface();
+				RB_EndInstanceRun();
 
 				if (!did_shadow_pass && shader && shader->sort > SS_BANNER)
 				{
@@ -747,6 +1014,10 @@ void RB_RenderDrawSurfList(drawSurf_t* draw_surfs, const int num_draw_surfs)
 				}
 			}
 			RB_BeginSurface(shader, fog_num);
+			if (entity_num == REFENTITYNUM_WORLD && !dlighted)
+			{
+				tess.staticBatch = RB_StaticBatchForRun(shader, fog_num);
+			}
 			old_shader = shader;
 			old_fog_num = fog_num;
 			old_dlighted = dlighted;
@@ -765,6 +1036,12 @@ void RB_RenderDrawSurfList(drawSurf_t* draw_surfs, const int num_draw_surfs)
 				// set up the transformation matrix
 				R_RotateForEntity(backEnd.currentEntity, &backEnd.viewParms, &backEnd.ori);
 
+				// a merged run is drawn in world space
+				if (instanceRun.active) {
+					instanceRun.ori = backEnd.ori;
+					backEnd.ori = backEnd.viewParms.world;
+				}
+
 				// set up the dynamic lighting if needed
 				if (backEnd.currentEntity->needDlights) {
 					R_TransformDlights(backEnd.refdef.num_dlights, backEnd.refdef.dlights, &backEnd.ori);
@@ -814,12 +1091,13 @@ void RB_RenderDrawSurfList(drawSurf_t* draw_surfs, const int num_draw_surfs)
 		}
 
 		// add the triangles for this surface
-		rb_surfaceTable[*draw_surf->surface](draw_surf->surface);
+		RB_TessSurface(draw_surf->surface);
 	}
 
 	// draw the contents of the last shader batch
 	if (old_shader != nullptr) {
 		RB_EndSurface();
+		RB_EndInstanceRun();
 	}
 
 	if (tr_stencilled && tr_distortionPrePost)
@@ -1365,7 +1643,7 @@ const void* RB_DrawBuffer(const void* data) {
 	qglDrawBuffer(cmd->buffer);
 
 	// clear screen for debugging
-	if (!(backEnd.refdef.rdflags & RDF_NOWORLDMODEL) && tr.world && tr.refdef.rdflags & RDF_doLAGoggles)
+	if (!(backEnd.refdef.rdflags & RDF_NOWORLDMODEL) && tr.world && backEnd.refdef.rdflags & RDF_doLAGoggles)
 	{
 		const fog_t* fog = &tr.world->fogs[tr.world->numfogs];
 
@@ -1545,6 +1823,66 @@ const void* RB_WorldEffects(const void* data)
 	return cmd + 1;
 }
 
+/*
+====================
+RB_NullRenderCommands
+
+r_skipBackEnd 2: walks the command list and deforms every ghoul2 surface
+into tess the way drawing would, but never touches GL.  With r_smp this
+runs the render thread against a null or software GL driver and shows
+what the front end overlaps with, r_speeds 8 still counts the waits.
+====================
+*/
+static void RB_NullRenderCommands(const void* data) {
+	while (true) {
+		data = PADP(data, sizeof(void*));
+
+		switch (*static_cast<const int*>(data)) {
+		case RC_SET_COLOR:
+			data = static_cast<const setColorCommand_t*>(data) + 1;
+			break;
+		case RC_STRETCH_PIC:
+			data = static_cast<const stretchPicCommand_t*>(data) + 1;
+			break;
+		case RC_ROTATE_PIC:
+		case RC_ROTATE_PIC2:
+			data = static_cast<const rotatePicCommand_t*>(data) + 1;
+			break;
+		case RC_SCISSOR:
+			data = static_cast<const scissorCommand_t*>(data) + 1;
+			break;
+		case RC_DRAW_SURFS:
+		{
+			const auto cmd = static_cast<const drawSurfsCommand_t*>(data);
+			for (int i = 0; i < cmd->numDrawSurfs; i++) {
+				surfaceType_t* surface = cmd->drawSurfs[i].surface;
+				if (*surface == SF_MDX) {
+					tess.numVertexes = 0;
+					tess.num_indexes = 0;
+					RB_SurfaceGhoul(reinterpret_cast<CRenderableSurface*>(surface));
+				}
+			}
+			tess.numVertexes = 0;
+			tess.num_indexes = 0;
+			data = cmd + 1;
+			break;
+		}
+		case RC_DRAW_BUFFER:
+			data = static_cast<const drawBufferCommand_t*>(data) + 1;
+			break;
+		case RC_SWAP_BUFFERS:
+			data = static_cast<const swapBuffersCommand_t*>(data) + 1;
+			break;
+		case RC_WORLD_EFFECTS:
+			data = static_cast<const setModeCommand_t*>(data) + 1;
+			break;
+		case RC_END_OF_LIST:
+		default:
+			return;
+		}
+	}
+}
+
 /*
 ====================
 RB_ExecuteRenderCommands
@@ -1553,6 +1891,19 @@ RB_ExecuteRenderCommands
 void RB_ExecuteRenderCommands(const void* data) {
 	const int t1 = ri.Milliseconds();
 
+	if (backEndData[1] && data == backEndData[1]->commands.cmds) {
+		backEnd.smpFrame = 1;
+	}
+	else {
+		backEnd.smpFrame = 0;
+	}
+
+	if (r_skipBackEnd->integer) {
+		RB_NullRenderCommands(data);
+		backEnd.pc.msec = ri.Milliseconds() - t1;
+		return;
+	}
+
 	while (true) {
 		data = PADP(data, sizeof(void*));
 
@@ -1594,6 +1945,164 @@ void RB_ExecuteRenderCommands(const void* data) {
 	}
 }
 
+/*
+============================================================================
+
+RENDER THREAD
+
+With r_smp the back end runs on its own thread.  The front end builds the
+next frame into the other backEndData while the render thread executes the
+last one.  The GL context belongs to the render thread while it is busy and
+is handed back to the front end whenever it waits for the thread.
+
+============================================================================
+*/
+
+static struct
+{
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+	const void* data;			// command list to execute, nullptr when idle
+	bool running;
+	bool shutdown;
+	bool frontEndHasContext;
+} renderThread;
+
+static void RB_RenderThread()
+{
+	std::unique_lock<std::mutex> lock(renderThread.mutex);
+
+	while (true)
+	{
+		renderThread.wake.wait(lock, [] { return renderThread.data != nullptr || renderThread.shutdown; });
+		if (renderThread.shutdown)
+		{
+			break;
+		}
+		const void* data = renderThread.data;
+		lock.unlock();
+
+		ri.GL_MakeCurrent(qtrue);
+		RB_ExecuteRenderCommands(data);
+		ri.GL_MakeCurrent(qfalse);
+
+		lock.lock();
+		renderThread.data = nullptr;
+		renderThread.done.notify_all();
+	}
+}
+
+/*
+================
+RB_SpawnRenderThread
+================
+*/
+void RB_SpawnRenderThread()
+{
+	if (renderThread.running)
+	{
+		return;
+	}
+
+	renderThread.data = nullptr;
+	renderThread.shutdown = false;
+	renderThread.frontEndHasContext = true;
+	try
+	{
+		renderThread.thread = std::thread(RB_RenderThread);
+	}
+	catch (const std::system_error&)
+	{
+		ri.Printf(PRINT_WARNING, "WARNING: couldn't start the render thread, r_smp disabled\n");
+		return;
+	}
+	renderThread.running = true;
+	ri.Printf(PRINT_ALL, "render thread started\n");
+}
+
+/*
+================
+RB_ShutdownRenderThread
+
+Leaves the GL context current on the front end.
+================
+*/
+void RB_ShutdownRenderThread()
+{
+	if (!renderThread.running)
+	{
+		return;
+	}
+
+	RB_WaitRenderThread();
+	{
+		std::lock_guard<std::mutex> lock(renderThread.mutex);
+		renderThread.shutdown = true;
+	}
+	renderThread.wake.notify_all();
+	renderThread.thread.join();
+	renderThread.running = false;
+	tr.smpFrame = 0;
+}
+
+qboolean RB_RenderThreadActive()
+{
+	return renderThread.running ? qtrue : qfalse;
+}
+
+qboolean RB_RenderThreadIsBusy()
+{
+	std::lock_guard<std::mutex> lock(renderThread.mutex);
+	return renderThread.data != nullptr ? qtrue : qfalse;
+}
+
+/*
+================
+RB_WakeRenderThread
+
+Hands a command list and the GL context to the render thread.
+================
+*/
+void RB_WakeRenderThread(const void* data)
+{
+	if (renderThread.frontEndHasContext)
+	{
+		ri.GL_MakeCurrent(qfalse);
+		renderThread.frontEndHasContext = false;
+	}
+	{
+		std::lock_guard<std::mutex> lock(renderThread.mutex);
+		renderThread.data = data;
+	}
+	renderThread.wake.notify_one();
+}
+
+/*
+================
+RB_WaitRenderThread
+
+Sleeps until the render thread is idle and takes the GL context back.
+================
+*/
+void RB_WaitRenderThread()
+{
+	if (!renderThread.running)
+	{
+		return;
+	}
+	{
+		std::unique_lock<std::mutex> lock(renderThread.mutex);
+		renderThread.done.wait(lock, [] { return renderThread.data == nullptr; });
+	}
+	if (!renderThread.frontEndHasContext)
+	{
+		ri.GL_MakeCurrent(qtrue);
+		renderThread.frontEndHasContext = true;
+	}
+}
+
 // What Pixel Shader type is currently active (regcoms or fragment programs).
 GLuint g_uiCurrentPixelShaderType = 0x0;
 
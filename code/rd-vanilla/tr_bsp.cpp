@@ -29,6 +29,8 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "tr_common.h"
 #include "tr_local.h"
 
+#include <vector>
+
 /*
 
 Loads and prepares a map file for scene rendering.
@@ -378,6 +380,8 @@ static void ParseFace(const dsurface_t* ds, mapVert_t* verts, msurface_t* surf,
 	cv->numPoints = num_points;
 	cv->numIndices = num_indexes;
 	cv->ofsIndices = ofs_indexes;
+	cv->staticBatch = nullptr;
+	cv->staticVertex = 0;
 
 	verts += LittleLong ds->firstVert;
 	for (i = 0; i < num_points; i++) {
@@ -529,12 +533,14 @@ static void ParseTriSurf(const dsurface_t* ds, mapVert_t* verts, msurface_t* sur
 	srfTriangles_t* tri = static_cast<srfTriangles_t*>(R_Malloc(
 		sizeof * tri + num_verts * sizeof tri->verts[0] + num_indexes * sizeof tri->indexes[0], TAG_HUNKMISCMODELS,
 		qfalse));
-	tri->dlightBits = 0; //JIC
+	tri->dlightBits[0] = tri->dlightBits[1] = 0; //JIC
 	tri->surfaceType = SF_TRIANGLES;
 	tri->num_verts = num_verts;
 	tri->num_indexes = num_indexes;
 	tri->verts = reinterpret_cast<drawVert_t*>(tri + 1);
 	tri->indexes = reinterpret_cast<int*>(tri->verts + tri->num_verts);
+	tri->staticBatch = nullptr;
+	tri->staticVertex = 0;
 
 	surf->data = reinterpret_cast<surfaceType_t*>(tri);
 
@@ -1221,6 +1227,531 @@ void R_LoadEntities(const lump_t* l, world_t& world_data) {
 	COM_EndParseSession();
 }
 
+/*
+=============================================================================
+
+CLUSTER SURFACE LISTS
+
+For every vis cluster, the surfaces in the leafs of its pvs, split by the
+area of the leafs so the areamask can still be applied.  A view in a known
+cluster then finds its candidate surfaces by walking these lists instead of
+marking the leafs and descending the tree.  Building them takes a pass over
+the leafs per cluster, so they can be cached beside the bsp.
+
+=============================================================================
+*/
+
+constexpr int CLUSTER_SURFACES_IDENT = 'C' << 24 | 'S' << 16 | 'L' << 8 | '1';
+constexpr int CLUSTER_SURFACES_VERSION = 1;
+constexpr int MAX_CLUSTER_SURFACES = 8 << 20;	// don't spend more than 32 megs on the lists
+
+using clusterSurfacesHeader_t = struct {
+	int			ident;
+	int			version;
+	unsigned	checksum;
+	int			numClusters;
+	int			numSurfaces;
+	int			numClusterAreas;
+	int			numClusterSurfaces;
+};
+
+/*
+=================
+R_ClusterSurfacesChecksum
+
+Of everything the lists are built from.
+=================
+*/
+static unsigned R_ClusterSurfacesChecksum(const dheader_t* header) {
+	unsigned checksum = 2166136261u;
+	const int lumps[] = { LUMP_LEAFS, LUMP_LEAFSURFACES, LUMP_VISIBILITY };
+
+	for (const int lump : lumps) {
+		const byte* data = fileBase + header->lumps[lump].fileofs;
+
+		for (int i = 0; i < header->lumps[lump].filelen; i++) {
+			checksum = (checksum ^ data[i]) * 16777619u;
+		}
+	}
+	return checksum;
+}
+
+/*
+=================
+R_BuildClusterSurfaces
+=================
+*/
+static qboolean R_BuildClusterSurfaces(const world_t& world_data, std::vector<int>& firstArea,
+	std::vector<clusterArea_t>& areas, std::vector<int>& surfaces) {
+	const mnode_t* leafs = world_data.nodes + world_data.numDecisionNodes;
+	const int num_leafs = world_data.numnodes - world_data.numDecisionNodes;
+	int num_areas = 0;
+
+	for (int i = 0; i < num_leafs; i++) {
+		if (leafs[i].area + 1 > num_areas) {
+			num_areas = leafs[i].area + 1;
+		}
+	}
+
+	std::vector<std::vector<int>> area_leafs(num_areas);
+	for (int i = 0; i < num_leafs; i++) {
+		if (leafs[i].cluster >= 0 && leafs[i].cluster < world_data.numClusters && leafs[i].area >= 0) {
+			area_leafs[leafs[i].area].push_back(i);
+		}
+	}
+
+	// last group each surface was added to
+	std::vector<int> stamp(world_data.numsurfaces, -1);
+	int group = 0;
+
+	firstArea.resize(world_data.numClusters + 1);
+	for (int cluster = 0; cluster < world_data.numClusters; cluster++) {
+		const byte* vis = world_data.vis + cluster * world_data.clusterBytes;
+
+		firstArea[cluster] = static_cast<int>(areas.size());
+		for (int area = 0; area < num_areas; area++, group++) {
+			clusterArea_t ca;
+			qboolean visible = qfalse;
+
+			ca.area = area;
+			ca.firstSurface = static_cast<int>(surfaces.size());
+			ClearBounds(ca.bounds[0], ca.bounds[1]);
+
+			for (const int leaf_num : area_leafs[area]) {
+				const mnode_t* leaf = &leafs[leaf_num];
+
+				if (!(vis[leaf->cluster >> 3] & 1 << (leaf->cluster & 7))) {
+					continue;
+				}
+				visible = qtrue;
+				AddPointToBounds(leaf->mins, ca.bounds[0], ca.bounds[1]);
+				AddPointToBounds(leaf->maxs, ca.bounds[0], ca.bounds[1]);
+
+				for (int i = 0; i < leaf->nummarksurfaces; i++) {
+					const int surf_num = static_cast<int>(leaf->firstmarksurface[i] - world_data.surfaces);
+
+					if (stamp[surf_num] != group) {
+						stamp[surf_num] = group;
+						surfaces.push_back(surf_num);
+					}
+				}
+			}
+
+			if (visible) {
+				ca.numSurfaces = static_cast<int>(surfaces.size()) - ca.firstSurface;
+				areas.push_back(ca);
+			}
+		}
+
+		if (surfaces.size() > static_cast<size_t>(MAX_CLUSTER_SURFACES)) {
+			ri.Printf(PRINT_DEVELOPER, "cluster surface lists too big for %s, not used\n", world_data.name);
+			return qfalse;
+		}
+	}
+	firstArea[world_data.numClusters] = static_cast<int>(areas.size());
+
+	return qtrue;
+}
+
+/*
+=================
+R_ReadClusterSurfaces
+
+Returns qfalse if there is no cache or it doesn't match the map.
+=================
+*/
+static qboolean R_ReadClusterSurfaces(const char* path, const unsigned checksum, const world_t& world_data,
+	std::vector<int>& firstArea, std::vector<clusterArea_t>& areas, std::vector<int>& surfaces) {
+	byte* buffer;
+	const long len = ri.FS_ReadFile(path, reinterpret_cast<void**>(&buffer));
+
+	if (!buffer) {
+		return qfalse;
+	}
+
+	clusterSurfacesHeader_t header;
+	qboolean valid = qfalse;
+
+	if (len >= static_cast<long>(sizeof header)) {
+		memcpy(&header, buffer, sizeof header);
+		valid = static_cast<qboolean>(header.ident == CLUSTER_SURFACES_IDENT
+			&& header.version == CLUSTER_SURFACES_VERSION
+			&& header.checksum == checksum
+			&& header.numClusters == world_data.numClusters
+			&& header.numSurfaces == world_data.numsurfaces
+			&& header.numClusterAreas >= 0 && header.numClusterSurfaces >= 0
+			&& header.numClusterSurfaces <= MAX_CLUSTER_SURFACES
+			&& len == static_cast<long>(sizeof header
+				+ (header.numClusters + 1) * sizeof(int)
+				+ header.numClusterAreas * sizeof(clusterArea_t)
+				+ header.numClusterSurfaces * sizeof(int)));
+	}
+
+	if (valid) {
+		const byte* p = buffer + sizeof header;
+
+		firstArea.resize(header.numClusters + 1);
+		memcpy(firstArea.data(), p, firstArea.size() * sizeof(int));
+		p += firstArea.size() * sizeof(int);
+		areas.resize(header.numClusterAreas);
+		memcpy(areas.data(), p, areas.size() * sizeof(clusterArea_t));
+		p += areas.size() * sizeof(clusterArea_t);
+		surfaces.resize(header.numClusterSurfaces);
+		memcpy(surfaces.data(), p, surfaces.size() * sizeof(int));
+
+		// don't trust anything that would index out of the lists
+		for (int i = 0; valid && i < header.numClusters; i++) {
+			valid = static_cast<qboolean>(firstArea[i] >= 0 && firstArea[i] <= firstArea[i + 1]);
+		}
+		valid = static_cast<qboolean>(valid && firstArea[header.numClusters] == header.numClusterAreas);
+		for (const clusterArea_t& ca : areas) {
+			if (!valid) {
+				break;
+			}
+			valid = static_cast<qboolean>(ca.area >= 0 && ca.area < MAX_MAP_AREA_BYTES * 8
+				&& ca.firstSurface >= 0 && ca.numSurfaces >= 0
+				&& ca.firstSurface + ca.numSurfaces <= header.numClusterSurfaces);
+		}
+		for (const int surf_num : surfaces) {
+			if (!valid) {
+				break;
+			}
+			valid = static_cast<qboolean>(surf_num >= 0 && surf_num < world_data.numsurfaces);
+		}
+	}
+
+	ri.FS_FreeFile(buffer);
+
+	if (!valid) {
+		ri.Printf(PRINT_DEVELOPER, "%s is out of date, rebuilding\n", path);
+		firstArea.clear();
+		areas.clear();
+		surfaces.clear();
+	}
+	return valid;
+}
+
+/*
+=================
+R_WriteClusterSurfaces
+=================
+*/
+static void R_WriteClusterSurfaces(const char* path, const unsigned checksum, const world_t& world_data,
+	const std::vector<int>& firstArea, const std::vector<clusterArea_t>& areas, const std::vector<int>& surfaces) {
+	clusterSurfacesHeader_t header;
+
+	header.ident = CLUSTER_SURFACES_IDENT;
+	header.version = CLUSTER_SURFACES_VERSION;
+	header.checksum = checksum;
+	header.numClusters = world_data.numClusters;
+	header.numSurfaces = world_data.numsurfaces;
+	header.numClusterAreas = static_cast<int>(areas.size());
+	header.numClusterSurfaces = static_cast<int>(surfaces.size());
+
+	std::vector<byte> buffer;
+	const auto append = [&buffer](const void* data, const size_t size) {
+		const byte* bytes = static_cast<const byte*>(data);
+		buffer.insert(buffer.end(), bytes, bytes + size);
+	};
+	append(&header, sizeof header);
+	append(firstArea.data(), firstArea.size() * sizeof(int));
+	append(areas.data(), areas.size() * sizeof(clusterArea_t));
+	append(surfaces.data(), surfaces.size() * sizeof(int));
+
+	ri.FS_WriteFile(path, buffer.data(), static_cast<int>(buffer.size()));
+}
+
+/*
+=================
+R_SurfaceCullBox
+
+Center and half size of the bounds of a world surface.
+=================
+*/
+static void R_SurfaceCullBox(const msurface_t* surf, vec3_t box[2]) {
+	vec3_t bounds[2];
+
+	if (*surf->data == SF_FACE && reinterpret_cast<srfSurfaceFace_t*>(surf->data)->numPoints > 0) {
+		const srfSurfaceFace_t* face = reinterpret_cast<srfSurfaceFace_t*>(surf->data);
+
+		ClearBounds(bounds[0], bounds[1]);
+		for (int i = 0; i < face->numPoints; i++) {
+			AddPointToBounds(face->points[i], bounds[0], bounds[1]);
+		}
+	}
+	else if (*surf->data == SF_GRID) {
+		const srfGridMesh_t* grid = reinterpret_cast<srfGridMesh_t*>(surf->data);
+
+		VectorCopy(grid->meshBounds[0], bounds[0]);
+		VectorCopy(grid->meshBounds[1], bounds[1]);
+	}
+	else if (*surf->data == SF_TRIANGLES) {
+		const srfTriangles_t* tri = reinterpret_cast<srfTriangles_t*>(surf->data);
+
+		VectorCopy(tri->bounds[0], bounds[0]);
+		VectorCopy(tri->bounds[1], bounds[1]);
+	}
+	else {
+		// flares and such are never culled by their bounds
+		VectorSet(bounds[0], MIN_WORLD_COORD, MIN_WORLD_COORD, MIN_WORLD_COORD);
+		VectorSet(bounds[1], MAX_WORLD_COORD, MAX_WORLD_COORD, MAX_WORLD_COORD);
+	}
+
+	VectorAdd(bounds[0], bounds[1], box[0]);
+	VectorScale(box[0], 0.5f, box[0]);
+	VectorSubtract(bounds[1], box[0], box[1]);
+}
+
+/*
+=================
+R_LoadClusterSurfaces
+=================
+*/
+static void R_LoadClusterSurfaces(const dheader_t* header, world_t& world_data) {
+	if (!r_clusterSurfaces->integer || !world_data.vis || world_data.numClusters <= 0) {
+		return;
+	}
+
+	const int start_time = ri.Milliseconds();
+	const unsigned checksum = R_ClusterSurfacesChecksum(header);
+	std::vector<int> first_area;
+	std::vector<clusterArea_t> areas;
+	std::vector<int> surfaces;
+	char path[MAX_QPATH];
+	qboolean cached = qfalse;
+
+	COM_StripExtension(world_data.name, path, sizeof path);
+	Q_strcat(path, sizeof path, ".csl");
+
+	if (r_clusterSurfaceCache->integer) {
+		cached = R_ReadClusterSurfaces(path, checksum, world_data, first_area, areas, surfaces);
+	}
+	if (!cached) {
+		if (!R_BuildClusterSurfaces(world_data, first_area, areas, surfaces)) {
+			return;
+		}
+		if (r_clusterSurfaceCache->integer) {
+			R_WriteClusterSurfaces(path, checksum, world_data, first_area, areas, surfaces);
+		}
+	}
+
+	world_data.clusterFirstArea = static_cast<int*>(R_Hunk_Alloc(first_area.size() * sizeof(int), qfalse));
+	memcpy(world_data.clusterFirstArea, first_area.data(), first_area.size() * sizeof(int));
+
+	world_data.numClusterAreas = static_cast<int>(areas.size());
+	world_data.clusterAreas = static_cast<clusterArea_t*>(R_Hunk_Alloc(areas.size() * sizeof(clusterArea_t) + 1, qfalse));
+	memcpy(world_data.clusterAreas, areas.data(), areas.size() * sizeof(clusterArea_t));
+
+	world_data.numClusterSurfaces = static_cast<int>(surfaces.size());
+	world_data.clusterSurfaces = static_cast<int*>(R_Hunk_Alloc(surfaces.size() * sizeof(int) + 1, qfalse));
+	memcpy(world_data.clusterSurfaces, surfaces.data(), surfaces.size() * sizeof(int));
+
+	world_data.surfaceCullBoxes = static_cast<vec3_t*>(R_Hunk_Alloc(world_data.numsurfaces * 2 * sizeof(vec3_t), qfalse));
+	for (int i = 0; i < world_data.numsurfaces; i++) {
+		R_SurfaceCullBox(&world_data.surfaces[i], &world_data.surfaceCullBoxes[i * 2]);
+	}
+
+	ri.Printf(PRINT_DEVELOPER, "%d clusters, %d potentially visible surfaces %s in %d msec\n", world_data.numClusters,
+		world_data.numClusterSurfaces, cached ? "loaded" : "built", ri.Milliseconds() - start_time);
+}
+
+/*
+=================
+R_StaticBatchShader
+
+A shader can be batched if nothing it does to the vertexes depends on the
+time, the view or the light styles.
+=================
+*/
+static qboolean R_StaticBatchShader(const shader_t* shader) {
+	if (shader->numDeforms || shader->sky || shader->entityMergable || shader == tr.distortionShader
+		|| shader->lightmapIndex[0] == LIGHTMAP_BY_VERTEX || !shader->numUnfoggedPasses) {
+		return qfalse;
+	}
+
+	for (int stage = 0; stage < shader->numUnfoggedPasses; stage++) {
+		const shaderStage_t* p_stage = &shader->stages[stage];
+
+		if (!p_stage->active) {
+			break;
+		}
+		if (p_stage->ss && p_stage->ss->surfaceSpriteType) {
+			return qfalse;
+		}
+
+		switch (p_stage->rgbGen) {
+		case CGEN_IDENTITY:
+		case CGEN_IDENTITY_LIGHTING:
+		case CGEN_CONST:
+		case CGEN_EXACT_VERTEX:
+		case CGEN_VERTEX:
+		case CGEN_ONE_MINUS_VERTEX:
+			break;
+		default:
+			return qfalse;
+		}
+
+		switch (p_stage->alphaGen) {
+		case AGEN_IDENTITY:
+		case AGEN_SKIP:
+		case AGEN_CONST:
+		case AGEN_VERTEX:
+		case AGEN_ONE_MINUS_VERTEX:
+			break;
+		default:
+			return qfalse;
+		}
+
+		for (const textureBundle_t& bundle : p_stage->bundle) {
+			if (bundle.numTexMods) {
+				return qfalse;
+			}
+			switch (bundle.tcGen) {
+			case TCGEN_BAD:
+			case TCGEN_IDENTITY:
+			case TCGEN_TEXTURE:
+			case TCGEN_LIGHTMAP:
+			case TCGEN_LIGHTMAP1:
+			case TCGEN_LIGHTMAP2:
+			case TCGEN_LIGHTMAP3:
+			case TCGEN_VECTOR:
+				break;
+			default:
+				return qfalse;
+			}
+		}
+	}
+
+	return qtrue;
+}
+
+static int R_StaticSurfaceVertexes(const msurface_t* surf) {
+	switch (*surf->data) {
+	case SF_FACE:
+	{
+		const srfSurfaceFace_t* face = reinterpret_cast<srfSurfaceFace_t*>(surf->data);
+		if (face->numPoints < SHADER_MAX_VERTEXES && face->numIndices < SHADER_MAX_INDEXES) {
+			return face->numPoints;
+		}
+		return 0;
+	}
+	case SF_TRIANGLES:
+		return reinterpret_cast<srfTriangles_t*>(surf->data)->num_verts;
+	default:
+		return 0;
+	}
+}
+
+/*
+=================
+R_LoadStaticBatches
+
+Copies the faces and triangle soups of the world into one batch per shader,
+along with the colors and texcoords of every stage, so the back end only has
+to gather indexes for them.  Patches are left out because their lod changes
+with the view.  The surfaces go through the normal surface and stage code so
+the batch holds exactly what would have been drawn.
+=================
+*/
+static void R_LoadStaticBatches(world_t& world_data) {
+	if (!r_staticBatch->integer) {
+		return;
+	}
+
+	const int start_time = ri.Milliseconds();
+	const bmodel_t& world_model = world_data.bmodels[0];
+	std::vector<int> num_vertexes(tr.numShaders, 0);
+	int num_batches = 0, num_surfaces = 0, total_vertexes = 0;
+
+	for (int i = 0; i < world_model.numSurfaces; i++) {
+		const msurface_t* surf = world_model.firstSurface + i;
+
+		if (R_StaticBatchShader(surf->shader)) {
+			num_vertexes[surf->shader->index] += R_StaticSurfaceVertexes(surf);
+		}
+	}
+
+	world_data.numStaticBatches = tr.numShaders;
+	world_data.staticBatches = static_cast<staticBatch_t**>(R_Hunk_Alloc(tr.numShaders * sizeof(staticBatch_t*), qtrue));
+
+	for (int i = 0; i < tr.numShaders; i++) {
+		if (!num_vertexes[i]) {
+			continue;
+		}
+		shader_t* shader = tr.shaders[i];
+		const auto batch = static_cast<staticBatch_t*>(R_Hunk_Alloc(sizeof(staticBatch_t), qtrue));
+
+		batch->shader = shader;
+		batch->xyz = static_cast<vec4_t*>(R_Hunk_Alloc(num_vertexes[i] * sizeof(vec4_t), qfalse));
+		for (int stage = 0; stage < shader->numUnfoggedPasses && shader->stages[stage].active; stage++) {
+			staticStage_t& out = batch->stages[stage];
+
+			out.colors = static_cast<color4ub_t*>(R_Hunk_Alloc(num_vertexes[i] * sizeof(color4ub_t), qfalse));
+			for (vec2_t*& texcoords : out.texcoords) {
+				texcoords = static_cast<vec2_t*>(R_Hunk_Alloc(num_vertexes[i] * sizeof(vec2_t), qfalse));
+			}
+			if (shader->stages[stage].adjustColorsForFog != ACFF_NONE) {
+				batch->fogAdjust = qtrue;
+			}
+		}
+		world_data.staticBatches[i] = batch;
+		num_batches++;
+	}
+
+	// the surfaces are tesselated with the back end's arrays
+	R_IssuePendingRenderCommands();
+
+	trRefEntity_t* old_entity = backEnd.currentEntity;
+	backEnd.currentEntity = &tr.worldEntity;
+
+	for (int i = 0; i < world_model.numSurfaces; i++) {
+		const msurface_t* surf = world_model.firstSurface + i;
+		staticBatch_t* batch = world_data.staticBatches[surf->shader->index];
+
+		if (!batch || !R_StaticSurfaceVertexes(surf)) {
+			continue;
+		}
+
+		RB_BeginSurface(surf->shader, 0);
+		rb_surfaceTable[*surf->data](surf->data);
+
+		const int first_vertex = batch->numVertexes;
+		const int count = tess.numVertexes;
+
+		memcpy(batch->xyz + first_vertex, tess.xyz, count * sizeof(vec4_t));
+		for (int stage = 0; stage < MAX_SHADER_STAGES && batch->stages[stage].colors; stage++) {
+			staticStage_t& out = batch->stages[stage];
+
+			RB_CalcStaticStageVars(stage);
+			memcpy(out.colors + first_vertex, tess.svars.colors, count * sizeof(color4ub_t));
+			for (int b = 0; b < NUM_TEXTURE_BUNDLES; b++) {
+				memcpy(out.texcoords[b] + first_vertex, tess.svars.texcoords[b], count * sizeof(vec2_t));
+			}
+		}
+		batch->numVertexes += count;
+
+		if (*surf->data == SF_FACE) {
+			const auto face = reinterpret_cast<srfSurfaceFace_t*>(surf->data);
+			face->staticBatch = batch;
+			face->staticVertex = first_vertex;
+		}
+		else {
+			const auto tri = reinterpret_cast<srfTriangles_t*>(surf->data);
+			tri->staticBatch = batch;
+			tri->staticVertex = first_vertex;
+		}
+		num_surfaces++;
+		total_vertexes += count;
+	}
+
+	tess.numVertexes = 0;
+	tess.num_indexes = 0;
+	backEnd.currentEntity = old_entity;
+
+	ri.Printf(PRINT_DEVELOPER, "%d static batches, %d surfaces, %d vertexes built in %d msec\n", num_batches,
+		num_surfaces, total_vertexes, ri.Milliseconds() - start_time);
+}
+
 /*
 =================
 RE_LoadWorldMap
@@ -1329,6 +1860,8 @@ void RE_LoadWorldMap_Actual(const char* name, world_t& world_data, const int ind
 
 	if (!index)
 	{
+		R_LoadClusterSurfaces(header, world_data);
+		R_LoadStaticBatches(world_data);
 		R_LoadEntities(&header->lumps[LUMP_ENTITIES], world_data);
 		R_LoadLightGrid(&header->lumps[LUMP_LIGHTGRID], world_data);
 		R_LoadLightGridArray(&header->lumps[LUMP_LIGHTARRAY], world_data);
@@ -36,6 +36,9 @@ void R_PerformanceCounters() {
 		// clear the counters even if we aren't printing
 		memset(&tr.pc, 0, sizeof tr.pc);
 		memset(&backEnd.pc, 0, sizeof backEnd.pc);
+		c_blockedOnRender = 0;
+		c_blockedOnMain = 0;
+		c_inlineFrames = 0;
 		return;
 	}
 
@@ -73,6 +76,21 @@ void R_PerformanceCounters() {
 		ri.Printf(PRINT_ALL, "flare adds:%i tests:%i renders:%i\n",
 			backEnd.pc.c_flareAdds, backEnd.pc.c_flareTests, backEnd.pc.c_flareRenders);
 	}
+	else if (r_speeds->integer == 8)
+	{
+		ri.Printf(PRINT_ALL, "smp: %i blocked on render, %i blocked on main, %i inline frames\n",
+			c_blockedOnRender, c_blockedOnMain, c_inlineFrames);
+	}
+	else if (r_speeds->integer == 9)
+	{
+		ri.Printf(PRINT_ALL, "static batches: %i srfs %i vrts drawn in place, %i vrts copied\n",
+			backEnd.pc.c_staticSurfaces, backEnd.pc.c_staticVertexes, backEnd.pc.c_vertexes);
+	}
+	else if (r_speeds->integer == 10)
+	{
+		ri.Printf(PRINT_ALL, "instances: %i merged, %i draw calls saved\n",
+			backEnd.pc.c_instanceMerges, backEnd.pc.c_instanceDrawsSaved);
+	}
 	else if (r_speeds->integer == 7) {
 		const float tex_size = R_SumOfUsedImages(qtrue) / 1048576.0f;
 		const float back_buff = glConfig.vidWidth * glConfig.vidHeight * glConfig.colorBits / (8.0f * 1024 * 1024);
@@ -84,6 +102,9 @@ void R_PerformanceCounters() {
 
 	memset(&tr.pc, 0, sizeof tr.pc);
 	memset(&backEnd.pc, 0, sizeof backEnd.pc);
+	c_blockedOnRender = 0;
+	c_blockedOnMain = 0;
+	c_inlineFrames = 0;
 }
 
 /*
@@ -93,10 +114,13 @@ R_IssueRenderCommands
 */
 int	c_blockedOnRender;
 int	c_blockedOnMain;
+int	c_inlineFrames;
 
 void R_IssueRenderCommands(const qboolean runPerformanceCounters)
 {
-	renderCommandList_t* cmd_list = &backEndData->commands;
+	backEndData_t* data = backEndData[tr.smpFrame];
+	renderCommandList_t* cmd_list = &data->commands;
+	const qboolean has_commands = static_cast<qboolean>(cmd_list->used != 0);
 
 	// add an end-of-list command
 	byteAlias_t* ba = reinterpret_cast<byteAlias_t*>(&cmd_list->cmds[cmd_list->used]);
@@ -105,16 +129,52 @@ void R_IssueRenderCommands(const qboolean runPerformanceCounters)
 	// clear it out, in case this is a sync and not a buffer flip
 	cmd_list->used = 0;
 
+	if (RB_RenderThreadActive()) {
+		// if the render thread is not idle, wait for it
+		if (RB_RenderThreadIsBusy()) {
+			c_blockedOnRender++;
+			if (r_showSmp->integer) {
+				ri.Printf(PRINT_ALL, "R");
+			}
+		}
+		else {
+			c_blockedOnMain++;
+			if (r_showSmp->integer) {
+				ri.Printf(PRINT_ALL, ".");
+			}
+		}
+
+		// sleep until the renderer has completed
+		RB_WaitRenderThread();
+	}
+
 	// at this point, the back end thread is idle, so it is ok
 	// to look at it's performance counters
 	if (runPerformanceCounters) {
 		R_PerformanceCounters();
 	}
 
+	// images queued while a level loads have to be uploaded before anything
+	// draws with them, a sync with nothing to draw leaves them queued
+	if (has_commands) {
+		R_FlushImageBatch();
+	}
+
 	// actually start the commands going
-	if (!r_skipBackEnd->integer) {
-		// let it start on the new batch
-		RB_ExecuteRenderCommands(cmd_list->cmds);
+	// r_skipBackEnd 2 still runs the back end, without any GL
+	if (r_skipBackEnd->integer != 1) {
+		// ghoul2 surfaces without a bone snapshot read bone caches the game
+		// keeps changing, so those frames are drawn before the front end moves on
+		if (RB_RenderThreadActive() && !data->ghoul2LiveBones) {
+			// let it start on the new batch
+			RB_WakeRenderThread(cmd_list->cmds);
+		}
+		else {
+			if (RB_RenderThreadActive()) {
+				c_inlineFrames++;
+			}
+			RB_ExecuteRenderCommands(cmd_list->cmds);
+		}
 	}
 }
 
@@ -122,7 +182,8 @@ void R_IssueRenderCommands(const qboolean runPerformanceCounters)
 ====================
 R_IssuePendingRenderCommands
 
-Issue any pending commands and wait for them to complete.
+Issue any pending commands and wait for them to complete.  After this
+returns the front end may use GL directly.
 ====================
 */
 void R_IssuePendingRenderCommands() {
@@ -130,6 +191,28 @@ void R_IssuePendingRenderCommands() {
 		return;
 	}
 	R_IssueRenderCommands(qfalse);
+
+	if (!RB_RenderThreadActive()) {
+		return;
+	}
+	RB_WaitRenderThread();
+}
+
+/*
+====================
+R_ToggleSmpFrame
+
+Use the other set of buffers next frame, because the render thread may
+still be drawing from the current ones.
+====================
+*/
+void R_ToggleSmpFrame() {
+	if (RB_RenderThreadActive()) {
+		tr.smpFrame ^= 1;
+	}
+	else {
+		tr.smpFrame = 0;
+	}
 }
 
 /*
@@ -141,7 +224,7 @@ make sure there is enough command space
 */
 void* R_GetCommandBufferReserved(unsigned int bytes, const int reserved_bytes)
 {
-	renderCommandList_t* cmd_list = &backEndData->commands;
+	renderCommandList_t* cmd_list = &backEndData[tr.smpFrame]->commands;
 	bytes = PAD(bytes, sizeof(void*));
 
 	// always leave room for the end of list command
@@ -484,6 +567,10 @@ void RE_EndFrame(int* front_end_msec, int* back_end_msec)
 
 	R_IssueRenderCommands(qtrue);
 
+	// use the other buffers next frame, because another CPU
+	// may still be rendering into the current ones
+	R_ToggleSmpFrame();
+
 	R_InitNextFrame();
 
 	if (front_end_msec) {
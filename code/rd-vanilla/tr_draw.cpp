@@ -482,6 +482,9 @@ qboolean RE_ProcessDissolve()
 
 		if (i_dissolve_percentage <= 100)
 		{
+			// draws straight to GL, so the render thread has to be done with the last frame
+			RB_WaitRenderThread();
+
 			extern void	RB_SetGL2D();
 			RB_SetGL2D();
 
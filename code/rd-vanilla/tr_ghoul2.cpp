@@ -644,6 +644,7 @@ public:
 	int				fogNum;
 	qboolean		personalModel;
 	CBoneCache* bone_cache;
+	mdxaBone_t* bone_snapshot;
 	int				renderfx;
 	const skin_t* skin;
 	const model_t* currentModel;
@@ -678,6 +679,7 @@ public:
 		fogNum(initfogNum),
 		personalModel(initpersonalModel),
 		bone_cache(initboneCache),
+		bone_snapshot(nullptr),
 		renderfx(initrenderfx),
 		skin(initskin),
 		currentModel(initcurrentModel),
@@ -693,18 +695,61 @@ public:
 };
 
 #define MAX_RENDER_SURFACES (2048)
-static CRenderableSurface RSStorage[MAX_RENDER_SURFACES];
-static unsigned int NextRS = 0;
+// one ring per frame buffer, the render thread may still be drawing the other
+static CRenderableSurface RSStorage[SMP_FRAMES][MAX_RENDER_SURFACES];
+static unsigned int NextRS[SMP_FRAMES];
 
 CRenderableSurface* AllocRS()
 {
-	CRenderableSurface* ret = &RSStorage[NextRS];
+	CRenderableSurface* ret = &RSStorage[tr.smpFrame][NextRS[tr.smpFrame]];
 	ret->Init();
-	NextRS++;
-	NextRS %= MAX_RENDER_SURFACES;
+	NextRS[tr.smpFrame]++;
+	NextRS[tr.smpFrame] %= MAX_RENDER_SURFACES;
 	return ret;
 }
 
+/*
+=============
+R_SnapshotGhoulBones
+
+With the render thread running, copies the bones a surface is skinned
+with into this frame's back end data, so drawing it never touches the
+bone cache the game goes on animating.  Returns nullptr (and keeps the
+frame on the main thread) when there is no render thread or no room.
+=============
+*/
+static const mdxaBone_t* R_SnapshotGhoulBones(CRenderSurface& RS, const mdxmSurface_t* surface)
+{
+	if (!RB_RenderThreadActive())
+	{
+		return nullptr;
+	}
+
+	backEndData_t* data = backEndData[tr.smpFrame];
+	if (!RS.bone_snapshot)
+	{
+		if (data->numGhoul2Bones + RS.bone_cache->mNumBones > MAX_GHOUL2_BONES)
+		{
+			data->ghoul2LiveBones = qtrue;
+			return nullptr;
+		}
+		RS.bone_snapshot = &data->ghoul2Bones[data->numGhoul2Bones];
+		data->numGhoul2Bones += RS.bone_cache->mNumBones;
+	}
+
+	const int* pi_bone_references = reinterpret_cast<const int*>(reinterpret_cast<const byte*>(surface) + surface->ofsBoneReferences);
+	for (int i = 0; i < surface->numBoneReferences; i++)
+	{
+		const int bone = pi_bone_references[i];
+#ifdef JK2_MODE
+		RS.bone_snapshot[bone] = RS.bone_cache->Eval(bone);
+#else
+		RS.bone_snapshot[bone] = RS.bone_cache->EvalRender(bone);
+#endif // JK2_MODE
+	}
+	return RS.bone_snapshot;
+}
+
 /*
 
 All bones should be an identity orientation to display the mesh exactly
@@ -2258,6 +2303,7 @@ void RenderSurfaces(CRenderSurface& RS)
 				newSurf->surfaceData = surface;
 			}
 			newSurf->bone_cache = RS.bone_cache;
+			newSurf->bone_snapshot = R_SnapshotGhoulBones(RS, newSurf->surfaceData);
 			R_AddDrawSurf(reinterpret_cast<surfaceType_t*>(newSurf), tr.shadowShader, 0, qfalse);
 		}
 
@@ -2271,6 +2317,7 @@ void RenderSurfaces(CRenderSurface& RS)
 			CRenderableSurface* newSurf = AllocRS();
 			newSurf->surfaceData = surface;
 			newSurf->bone_cache = RS.bone_cache;
+			newSurf->bone_snapshot = R_SnapshotGhoulBones(RS, surface);
 			R_AddDrawSurf(reinterpret_cast<surfaceType_t*>(newSurf), tr.projectionShadowShader, 0, qfalse);
 		}
 
@@ -2280,6 +2327,7 @@ void RenderSurfaces(CRenderSurface& RS)
 			CRenderableSurface* newSurf = AllocRS();
 			newSurf->surfaceData = surface;
 			newSurf->bone_cache = RS.bone_cache;
+			newSurf->bone_snapshot = R_SnapshotGhoulBones(RS, surface);
 			R_AddDrawSurf(reinterpret_cast<surfaceType_t*>(newSurf), shader, RS.fogNum, qfalse);
 
 #ifdef _G2_GORE
@@ -2299,6 +2347,7 @@ void RenderSurfaces(CRenderSurface& RS)
 					{
 						if (tex)
 						{
+							RB_WaitRenderThread();
 							(*tex).~GoreTextureCoordinates();
 							//I don't know what's going on here, it should call the destructor for
 							//this when it erases the record but sometimes it doesn't. -rww
@@ -2696,6 +2745,26 @@ void G2_ConstructGhoulSkeleton(CGhoul2Info_v& ghoul2, const int frame_num, const
 	}
 }
 
+/*
+==============
+RB_GhoulBone
+
+The front end's snapshot of a bone when it took one, else the live cache.
+==============
+*/
+static const mdxaBone_t& RB_GhoulBone(const CRenderableSurface* surf, const int index)
+{
+	if (surf->bone_snapshot)
+	{
+		return surf->bone_snapshot[index];
+	}
+#ifdef JK2_MODE
+	return surf->bone_cache->Eval(index);
+#else
+	return surf->bone_cache->EvalRender(index);
+#endif // JK2_MODE
+}
+
 /*
 ==============
 RB_SurfaceGhoul
@@ -2832,8 +2901,6 @@ void RB_SurfaceGhoul(CRenderableSurface* surf)
 	// grab the pointer to the surface info within the loaded mesh file
 	mdxmSurface_t* surface = surf->surfaceData;
 
-	CBoneCache* bones = surf->bone_cache;
-
 	// first up, sanity check our numbers
 	RB_CheckOverflow(surface->num_verts, surface->numTriangles);
 
@@ -2882,7 +2949,7 @@ void RB_SurfaceGhoul(CRenderableSurface* surf)
 			k = 0;
 			int		i_bone_index = G2_GetVertBoneIndex(v, k);
 			float	fBoneWeight = G2_GetVertBoneWeight(v, k, fTotalWeight, iNumWeights);
-			const mdxaBone_t* bone = &bones->EvalRender(piBoneReferences[i_bone_index]);
+			const mdxaBone_t* bone = &RB_GhoulBone(surf, piBoneReferences[i_bone_index]);
 
 			tess.xyz[baseVertex][0] = fBoneWeight * (DotProduct(bone->matrix[0], v->vertCoords) + bone->matrix[0][3]);
 			tess.xyz[baseVertex][1] = fBoneWeight * (DotProduct(bone->matrix[1], v->vertCoords) + bone->matrix[1][3]);
@@ -2897,7 +2964,7 @@ void RB_SurfaceGhoul(CRenderableSurface* surf)
 				i_bone_index = G2_GetVertBoneIndex(v, k);
 				fBoneWeight = G2_GetVertBoneWeight(v, k, fTotalWeight, iNumWeights);
 
-				bone = &bones->EvalRender(piBoneReferences[i_bone_index]);
+				bone = &RB_GhoulBone(surf, piBoneReferences[i_bone_index]);
 
 				tess.xyz[baseVertex][0] += fBoneWeight * (DotProduct(bone->matrix[0], v->vertCoords) + bone->matrix[0][3]);
 				tess.xyz[baseVertex][1] += fBoneWeight * (DotProduct(bone->matrix[1], v->vertCoords) + bone->matrix[1][3]);
@@ -2923,11 +2990,7 @@ void RB_SurfaceGhoul(CRenderableSurface* surf)
 		const mdxaBone_t* bone2;
 		for (j = 0; j < num_verts; j++, baseVertex++, v++)
 		{
-#ifdef JK2_MODE
-			bone = &bones->Eval(piBoneReferences[G2_GetVertBoneIndex(v, 0)]);
-#else
-			bone = &bones->EvalRender(piBoneReferences[G2_GetVertBoneIndex(v, 0)]);
-#endif // JK2_MODE
+			bone = &RB_GhoulBone(surf, piBoneReferences[G2_GetVertBoneIndex(v, 0)]);
 			int iNumWeights = G2_GetVertWeights(v);
 			tess.normal[baseVertex][0] = DotProduct(bone->matrix[0], v->normal);
 			tess.normal[baseVertex][1] = DotProduct(bone->matrix[1], v->normal);
@@ -2944,11 +3007,7 @@ void RB_SurfaceGhoul(CRenderableSurface* surf)
 				fBoneWeight = G2_GetVertBoneWeightNotSlow(v, 0);
 				if (iNumWeights == 2)
 				{
-#ifdef JK2_MODE
-					bone2 = &bones->Eval(piBoneReferences[G2_GetVertBoneIndex(v, 1)]);
-#else
-					bone2 = &bones->EvalRender(piBoneReferences[G2_GetVertBoneIndex(v, 1)]);
-#endif // JK2_MODE
+					bone2 = &RB_GhoulBone(surf, piBoneReferences[G2_GetVertBoneIndex(v, 1)]);
 					/*
 					useless transposition
 					tess.xyz[baseVertex][0] =
@@ -2976,11 +3035,7 @@ void RB_SurfaceGhoul(CRenderableSurface* surf)
 					fTotalWeight = fBoneWeight;
 					for (k = 1; k < iNumWeights - 1; k++)
 					{
-#ifdef JK2_MODE
-						bone = &bones->Eval(piBoneReferences[G2_GetVertBoneIndex(v, k)]);
-#else
-						bone = &bones->EvalRender(piBoneReferences[G2_GetVertBoneIndex(v, k)]);
-#endif // JK2_MODE
+						bone = &RB_GhoulBone(surf, piBoneReferences[G2_GetVertBoneIndex(v, k)]);
 
 						fBoneWeight = G2_GetVertBoneWeightNotSlow(v, k);
 						fTotalWeight += fBoneWeight;
@@ -2990,11 +3045,7 @@ void RB_SurfaceGhoul(CRenderableSurface* surf)
 						tess.xyz[baseVertex][2] += fBoneWeight * (DotProduct(bone->matrix[2], v->vertCoords) + bone->matrix[2][3]);
 					}
 
-#ifdef JK2_MODE
-					bone = &bones->Eval(piBoneReferences[G2_GetVertBoneIndex(v, k)]);
-#else
-					bone = &bones->EvalRender(piBoneReferences[G2_GetVertBoneIndex(v, k)]);
-#endif // JK2_MODE
+					bone = &RB_GhoulBone(surf, piBoneReferences[G2_GetVertBoneIndex(v, k)]);
 					fBoneWeight = 1.0f - fTotalWeight;
 
 					tess.xyz[baseVertex][0] += fBoneWeight * (DotProduct(bone->matrix[0], v->vertCoords) + bone->matrix[0][3]);
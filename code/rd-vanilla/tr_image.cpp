@@ -28,8 +28,11 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 #include "tr_local.h"
 #include "../rd-common/tr_common.h"
+#include "../qcommon/timing.h"
 #include <png.h>
+#include <zlib.h>
 #include <map>
+#include <vector>
 
 static byte			 s_intensitytable[256];
 static unsigned char s_gammatable[256];
@@ -377,53 +380,7 @@ static void R_LightScaleTexture(unsigned* in, const int inwidth, const int inhei
 	}
 }
 
-/*
-================
-R_MipMap2
-
-Uses temp mem, but then copies back to input, quartering the size of the texture
-Proper linear filter
-================
-*/
-static void R_MipMap2(unsigned* in, const int inWidth, const int inHeight) {
-	const int outWidth = inWidth >> 1;
-	const int outHeight = inHeight >> 1;
-	unsigned* temp = static_cast<unsigned*>(R_Malloc(outWidth * outHeight * 4, TAG_TEMP_WORKSPACE, qfalse));
-
-	const int inWidthMask = inWidth - 1;
-	const int inHeightMask = inHeight - 1;
-
-	for (int i = 0; i < outHeight; i++) {
-		for (int j = 0; j < outWidth; j++) {
-			byte* outpix = reinterpret_cast<byte*>(temp + i * outWidth + j);
-			for (int k = 0; k < 4; k++) {
-				const int total = 1 * reinterpret_cast<byte*>(&in[((i * 2 - 1) & inHeightMask) * inWidth + ((j * 2 - 1) & inWidthMask)])[k] +
-					2 * reinterpret_cast<byte*>(&in[((i * 2 - 1) & inHeightMask) * inWidth + ((j * 2) & inWidthMask)])[k] +
-					2 * reinterpret_cast<byte*>(&in[((i * 2 - 1) & inHeightMask) * inWidth + ((j * 2 + 1) & inWidthMask)])[k] +
-					1 * reinterpret_cast<byte*>(&in[((i * 2 - 1) & inHeightMask) * inWidth + ((j * 2 + 2) & inWidthMask)])[k] +
-
-					2 * reinterpret_cast<byte*>(&in[((i * 2) & inHeightMask) * inWidth + ((j * 2 - 1) & inWidthMask)])[k] +
-					4 * reinterpret_cast<byte*>(&in[((i * 2) & inHeightMask) * inWidth + ((j * 2) & inWidthMask)])[k] +
-					4 * reinterpret_cast<byte*>(&in[((i * 2) & inHeightMask) * inWidth + ((j * 2 + 1) & inWidthMask)])[k] +
-					2 * reinterpret_cast<byte*>(&in[((i * 2) & inHeightMask) * inWidth + ((j * 2 + 2) & inWidthMask)])[k] +
-
-					2 * reinterpret_cast<byte*>(&in[((i * 2 + 1) & inHeightMask) * inWidth + ((j * 2 - 1) & inWidthMask)])[k] +
-					4 * reinterpret_cast<byte*>(&in[((i * 2 + 1) & inHeightMask) * inWidth + ((j * 2) & inWidthMask)])[k] +
-					4 * reinterpret_cast<byte*>(&in[((i * 2 + 1) & inHeightMask) * inWidth + ((j * 2 + 1) & inWidthMask)])[k] +
-					2 * reinterpret_cast<byte*>(&in[((i * 2 + 1) & inHeightMask) * inWidth + ((j * 2 + 2) & inWidthMask)])[k] +
-
-					1 * reinterpret_cast<byte*>(&in[((i * 2 + 2) & inHeightMask) * inWidth + ((j * 2 - 1) & inWidthMask)])[k] +
-					2 * reinterpret_cast<byte*>(&in[((i * 2 + 2) & inHeightMask) * inWidth + ((j * 2) & inWidthMask)])[k] +
-					2 * reinterpret_cast<byte*>(&in[((i * 2 + 2) & inHeightMask) * inWidth + ((j * 2 + 1) & inWidthMask)])[k] +
-					1 * reinterpret_cast<byte*>(&in[((i * 2 + 2) & inHeightMask) * inWidth + ((j * 2 + 2) & inWidthMask)])[k];
-				outpix[k] = total / 36;
-			}
-		}
-	}
-
-	memcpy(in, temp, outWidth * outHeight * 4);
-	R_Free(temp);
-}
+const imageKernels_t* imageKernels;
 
 /*
 ================
@@ -432,41 +389,40 @@ R_MipMap
 Operates in place, quartering the size of the texture
 ================
 */
-static void R_MipMap(byte* in, int width, int height) {
-	int		i;
-
+static void R_MipMap(byte* in, const int width, const int height) {
 	if (width == 1 && height == 1) {
 		return;
 	}
 
-	if (!r_simpleMipMaps->integer) {
-		R_MipMap2(reinterpret_cast<unsigned*>(in), width, height);
+	if (r_simpleMipMaps->integer) {
+		imageKernels->mipMapBox(in, in, width, height);
 		return;
 	}
 
-	const int row = width * 4;
-	byte* out = in;
-	width >>= 1;
-	height >>= 1;
-
-	if (width == 0 || height == 0) {
-		width += height;	// get largest
-		for (i = 0; i < width; i++, out += 4, in += 8) {
-			out[0] = (in[0] + in[4]) >> 1;
-			out[1] = (in[1] + in[5]) >> 1;
-			out[2] = (in[2] + in[6]) >> 1;
-			out[3] = (in[3] + in[7]) >> 1;
-		}
+	// a side down to 1 is left as it is
+	if (width == 1 || height == 1) {
 		return;
 	}
 
-	for (i = 0; i < height; i++, in += row) {
-		for (int j = 0; j < width; j++, out += 4, in += 8) {
-			out[0] = (in[0] + in[4] + in[row + 0] + in[row + 4]) >> 2;
-			out[1] = (in[1] + in[5] + in[row + 1] + in[row + 5]) >> 2;
-			out[2] = (in[2] + in[6] + in[row + 2] + in[row + 6]) >> 2;
-			out[3] = (in[3] + in[7] + in[row + 3] + in[row + 7]) >> 2;
-		}
+	// proper linear filter, which reads around each pixel so it can't write in place
+	std::vector<byte> temp((width >> 1) * (height >> 1) * 4);
+	imageKernels->mipMapFilter(in, temp.data(), width, height);
+	memcpy(in, temp.data(), temp.size());
+}
+
+/*
+================
+R_MipMapInto
+
+Builds the next mip level of in into out
+================
+*/
+static void R_MipMapInto(const byte* in, byte* out, const int width, const int height) {
+	if (r_simpleMipMaps->integer) {
+		imageKernels->mipMapBox(in, out, width, height);
+	}
+	else {
+		imageKernels->mipMapFilter(in, out, width, height);
 	}
 }
 
@@ -511,187 +467,240 @@ byte	mipBlendColors[16][4] = {
 	{0,0,255,128},
 };
 
+using imageUpload_t = struct imageUpload_s
+{
+	const byte* data;		// level 0, in the buffer the pixels came in
+	const byte* mipData;	// the smaller levels one after another
+	int width;
+	int height;
+	int samples;			// 4 if any pixel isn't opaque
+	int internalFormat;
+	int numLevels;
+	std::vector<byte> mips;	// holds mipData unless it points somewhere else
+};
+
 /*
 ===============
-Upload32
-
+R_ImageInternalFormat
 ===============
 */
-static void Upload32(unsigned* data,
-	const GLenum format,
-	const qboolean mipmap,
-	const qboolean picmip,
-	const qboolean isLightmap,
-	const qboolean allowTC,
-	int* pformat,
-	word* pUploadWidth, word* pUploadHeight)
+static int R_ImageInternalFormat(const int samples, const qboolean isLightmap, const qboolean allowTC)
 {
-	if (format == GL_RGBA)
+	if (samples == 3)
 	{
-		int			i;
-		float		rMax = 0, gMax = 0, bMax = 0;
-		int			width = *pUploadWidth;
-		int			height = *pUploadHeight;
-
-		//
-		// perform optional picmip operation
-		//
-		if (picmip) {
-			for (i = 0; i < r_picmip->integer; i++) {
-				R_MipMap(reinterpret_cast<byte*>(data), width, height);
-				width >>= 1;
-				height >>= 1;
-				if (width < 1) {
-					width = 1;
-				}
-				if (height < 1) {
-					height = 1;
-				}
-			}
+		if (glConfig.textureCompression == TC_S3TC && allowTC)
+		{
+			return GL_RGB4_S3TC;
 		}
-
-		//
-		// clamp to the current upper OpenGL limit
-		// scale both axis down equally so we don't have to
-		// deal with a half mip resampling
-		//
-		while (width > glConfig.maxTextureSize || height > glConfig.maxTextureSize) {
-			R_MipMap(reinterpret_cast<byte*>(data), width, height);
-			width >>= 1;
-			height >>= 1;
+		if (glConfig.textureCompression == TC_S3TC_DXT && allowTC)
+		{	// Compress purely color - no alpha
+			if (r_texturebits->integer == 16) {
+				return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;	//this format cuts to 16 bit
+			}
+			//if we aren't using 16 bit then, use 32 bit compression
+			return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
 		}
-
-		//
-		// scan the texture for each channel's max values
-		// and verify if the alpha channel is being used or not
-		//
-		const int c = width * height;
-		const byte* scan = reinterpret_cast<byte*>(data);
-		int samples = 3;
-		for (i = 0; i < c; i++)
+		if (isLightmap && r_texturebitslm->integer > 0)
 		{
-			if (scan[i * 4 + 0] > rMax)
-			{
-				rMax = scan[i * 4 + 0];
-			}
-			if (scan[i * 4 + 1] > gMax)
+			// Allow different bit depth when we are a lightmap
+			if (r_texturebitslm->integer == 16)
 			{
-				gMax = scan[i * 4 + 1];
+				return GL_RGB5;
 			}
-			if (scan[i * 4 + 2] > bMax)
+			if (r_texturebitslm->integer == 32)
 			{
-				bMax = scan[i * 4 + 2];
-			}
-			if (scan[i * 4 + 3] != 255)
-			{
-				samples = 4;
-				break;
+				return GL_RGB8;
 			}
 		}
-
-		// select proper internal format
-		if (samples == 3)
+		else if (r_texturebits->integer == 16)
 		{
-			if (glConfig.textureCompression == TC_S3TC && allowTC)
-			{
-				*pformat = GL_RGB4_S3TC;
-			}
-			else if (glConfig.textureCompression == TC_S3TC_DXT && allowTC)
-			{	// Compress purely color - no alpha
-				if (r_texturebits->integer == 16) {
-					*pformat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;	//this format cuts to 16 bit
-				}
-				else {//if we aren't using 16 bit then, use 32 bit compression
-					*pformat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
-				}
-			}
-			else if (isLightmap && r_texturebitslm->integer > 0)
-			{
-				// Allow different bit depth when we are a lightmap
-				if (r_texturebitslm->integer == 16)
-				{
-					*pformat = GL_RGB5;
-				}
-				else if (r_texturebitslm->integer == 32)
-				{
-					*pformat = GL_RGB8;
-				}
-			}
-			else if (r_texturebits->integer == 16)
-			{
-				*pformat = GL_RGB5;
-			}
-			else if (r_texturebits->integer == 32)
-			{
-				*pformat = GL_RGB8;
-			}
-			else
-			{
-				*pformat = 3;
-			}
+			return GL_RGB5;
 		}
-		else if (samples == 4)
+		else if (r_texturebits->integer == 32)
 		{
-			if (glConfig.textureCompression == TC_S3TC_DXT && allowTC)
-			{	// Compress both alpha and color
-				*pformat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
-			}
-			else if (r_texturebits->integer == 16)
-			{
-				*pformat = GL_RGBA4;
-			}
-			else if (r_texturebits->integer == 32)
-			{
-				*pformat = GL_RGBA8;
+			return GL_RGB8;
+		}
+		return 3;
+	}
+
+	if (glConfig.textureCompression == TC_S3TC_DXT && allowTC)
+	{	// Compress both alpha and color
+		return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	}
+	if (r_texturebits->integer == 16)
+	{
+		return GL_RGBA4;
+	}
+	if (r_texturebits->integer == 32)
+	{
+		return GL_RGBA8;
+	}
+	return 4;
+}
+
+/*
+===============
+R_MipChainBytes
+
+Size of every level after the first, and how many levels there are in all.
+===============
+*/
+static int R_MipChainBytes(int width, int height, int* numLevels)
+{
+	int bytes = 0;
+
+	for (*numLevels = 1; width > 1 || height > 1; (*numLevels)++)
+	{
+		width = width > 1 ? width >> 1 : 1;
+		height = height > 1 ? height >> 1 : 1;
+		bytes += width * height * 4;
+	}
+
+	return bytes;
+}
+
+/*
+===============
+R_PrepareUpload
+
+Everything Upload32 does before it gets to GL: picmip, the internal format,
+light scaling and the mip chain.  Works on data in place and doesn't touch
+any shared state, so it can run on the worker threads.
+===============
+*/
+static void R_PrepareUpload(byte* data, int width, int height,
+	const qboolean mipmap,
+	const qboolean picmip,
+	const qboolean isLightmap,
+	const qboolean allowTC,
+	imageUpload_t* upload)
+{
+	int			i;
+	float		rMax = 0, gMax = 0, bMax = 0;
+
+	//
+	// perform optional picmip operation
+	//
+	if (picmip) {
+		for (i = 0; i < r_picmip->integer; i++) {
+			R_MipMap(data, width, height);
+			width >>= 1;
+			height >>= 1;
+			if (width < 1) {
+				width = 1;
 			}
-			else
-			{
-				*pformat = 4;
+			if (height < 1) {
+				height = 1;
 			}
 		}
+	}
 
-		*pUploadWidth = width;
-		*pUploadHeight = height;
+	//
+	// clamp to the current upper OpenGL limit
+	// scale both axis down equally so we don't have to
+	// deal with a half mip resampling
+	//
+	while (width > glConfig.maxTextureSize || height > glConfig.maxTextureSize) {
+		R_MipMap(data, width, height);
+		width >>= 1;
+		height >>= 1;
+	}
 
-		// copy or resample data as appropriate for first MIP level
-		if (!mipmap)
+	//
+	// scan the texture for each channel's max values
+	// and verify if the alpha channel is being used or not
+	//
+	const int c = width * height;
+	const byte* scan = data;
+	int samples = 3;
+	for (i = 0; i < c; i++)
+	{
+		if (scan[i * 4 + 0] > rMax)
+		{
+			rMax = scan[i * 4 + 0];
+		}
+		if (scan[i * 4 + 1] > gMax)
+		{
+			gMax = scan[i * 4 + 1];
+		}
+		if (scan[i * 4 + 2] > bMax)
+		{
+			bMax = scan[i * 4 + 2];
+		}
+		if (scan[i * 4 + 3] != 255)
 		{
-			qglTexImage2D(GL_TEXTURE_2D, 0, *pformat, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-			goto done;
+			samples = 4;
+			break;
 		}
+	}
 
-		R_LightScaleTexture(data, width, height, static_cast<qboolean>(!mipmap));
+	upload->samples = samples;
+	upload->internalFormat = R_ImageInternalFormat(samples, isLightmap, allowTC);
 
-		qglTexImage2D(GL_TEXTURE_2D, 0, *pformat, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+	upload->data = data;
+	upload->width = width;
+	upload->height = height;
+	upload->numLevels = 1;
 
-		if (mipmap)
-		{
-			int miplevel = 0;
-			while (width > 1 || height > 1)
-			{
-				R_MipMap(reinterpret_cast<byte*>(data), width, height);
-				width >>= 1;
-				height >>= 1;
-				if (width < 1)
-					width = 1;
-				if (height < 1)
-					height = 1;
-				miplevel++;
-
-				if (r_colorMipLevels->integer)
-				{
-					R_BlendOverTexture(reinterpret_cast<byte*>(data), width * height, mipBlendColors[miplevel]);
-				}
+	// copy or resample data as appropriate for first MIP level
+	if (!mipmap)
+	{
+		return;
+	}
 
-				qglTexImage2D(GL_TEXTURE_2D, miplevel, *pformat, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-			}
+	R_LightScaleTexture(reinterpret_cast<unsigned*>(data), width, height, static_cast<qboolean>(!mipmap));
+
+	// room for the whole chain in one go
+	upload->mips.resize(R_MipChainBytes(width, height, &upload->numLevels));
+	upload->mipData = upload->mips.data();
+
+	const byte* in = data;
+	byte* out = upload->mips.data();
+	for (int miplevel = 1; miplevel < upload->numLevels; miplevel++)
+	{
+		R_MipMapInto(in, out, width, height);
+		width >>= 1;
+		height >>= 1;
+		if (width < 1)
+			width = 1;
+		if (height < 1)
+			height = 1;
+
+		if (r_colorMipLevels->integer)
+		{
+			R_BlendOverTexture(out, width * height, mipBlendColors[miplevel]);
 		}
+
+		in = out;
+		out += width * height * 4;
 	}
-	else
+}
+
+/*
+===============
+R_UploadLevels
+
+The GL half of Upload32, for the levels R_PrepareUpload built.
+===============
+*/
+static void R_UploadLevels(const imageUpload_t& upload, const qboolean mipmap)
+{
+	const byte* data = upload.data;
+	int width = upload.width;
+	int height = upload.height;
+
+	for (int miplevel = 0; miplevel < upload.numLevels; miplevel++)
 	{
-	}
+		qglTexImage2D(GL_TEXTURE_2D, miplevel, upload.internalFormat, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
 
-done:
+		data = miplevel == 0 ? upload.mipData : data + width * height * 4;
+		width >>= 1;
+		height >>= 1;
+		if (width < 1)
+			width = 1;
+		if (height < 1)
+			height = 1;
+	}
 
 	if (mipmap)
 	{
@@ -711,6 +720,35 @@ done:
 	GL_CheckErrors();
 }
 
+/*
+===============
+Upload32
+
+===============
+*/
+static void Upload32(unsigned* data,
+	const GLenum format,
+	const qboolean mipmap,
+	const qboolean picmip,
+	const qboolean isLightmap,
+	const qboolean allowTC,
+	int* pformat,
+	word* pUploadWidth, word* pUploadHeight)
+{
+	imageUpload_t upload{};
+
+	upload.internalFormat = *pformat;
+	if (format == GL_RGBA)
+	{
+		R_PrepareUpload(reinterpret_cast<byte*>(data), *pUploadWidth, *pUploadHeight, mipmap, picmip, isLightmap, allowTC, &upload);
+		*pformat = upload.internalFormat;
+		*pUploadWidth = upload.width;
+		*pUploadHeight = upload.height;
+	}
+
+	R_UploadLevels(upload, mipmap);
+}
+
 class CStringComparator
 {
 public:
@@ -739,6 +777,8 @@ image_t* R_Images_GetNextIteration()
 	return pImage;
 }
 
+static void R_DropPendingImage(const image_t* pImage);
+
 // clean up anything to do with an image_t struct, but caller will have to clear the internal to an image_t struct ready for either struct free() or overwrite...
 //
 static void R_Images_DeleteImageContents(image_t* pImage)
@@ -746,6 +786,7 @@ static void R_Images_DeleteImageContents(image_t* pImage)
 	assert(pImage);	// should never be called with NULL
 	if (pImage)
 	{
+		R_DropPendingImage(pImage);
 		qglDeleteTextures(1, &pImage->texnum);
 		R_Free(pImage);
 	}
@@ -927,6 +968,58 @@ static image_t* R_FindImageFile_NoLoad(const char* name, const qboolean mipmap,
 	return nullptr;
 }
 
+/*
+================
+R_AllocImage
+
+Sets up an image_t and files it under its name, the pixels come later
+================
+*/
+static image_t* R_AllocImage(const char* name, const int width, const int height, const qboolean mipmap, const qboolean allow_picmip,
+	const int gl_wrap_clamp_mode)
+{
+	const auto image = static_cast<image_t*>(R_Malloc(sizeof(image_t), TAG_IMAGE_T, qtrue));
+
+	//image->imgfileSize=fileSize;
+
+	image->texnum = 1024 + giTextureBindNum++;	// ++ is of course staggeringly important...
+
+	// record which map it was used on...
+	//
+	image->iLastLevelUsedOn = RE_RegisterMedia_GetLevel();
+
+	image->mipmap = !!mipmap;
+	image->allowPicmip = !!allow_picmip;
+
+	image->width = width;
+	image->height = height;
+	image->wrapClampMode = gl_wrap_clamp_mode;
+
+	const char* psNewName = GenerateImageMappingName(name);
+	Q_strncpyz(image->imgName, psNewName, sizeof(image->imgName));
+	AllocatedImages[image->imgName] = image;
+
+	return image;
+}
+
+static void R_BeginImageUpload(image_t* image)
+{
+	if (qglActiveTextureARB) {
+		GL_SelectTexture(0);
+	}
+
+	GL_Bind(image);
+}
+
+static void R_EndImageUpload(const image_t* image)
+{
+	qglTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, image->wrapClampMode);
+	qglTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, image->wrapClampMode);
+
+	qglBindTexture(GL_TEXTURE_2D, 0);	//jfm: i don't know why this is here, but it breaks lightmaps when there's only 1
+	glState.currenttextures[glState.currenttmu] = 0;	//mark it not bound
+}
+
 /*
 ================
 R_CreateImage
@@ -962,30 +1055,9 @@ image_t* R_CreateImage(const char* name, const byte* pic, const int width, const
 		return image;
 	}
 
-	image = static_cast<image_t*>(R_Malloc(sizeof(image_t), TAG_IMAGE_T, qtrue));
-
-	//image->imgfileSize=fileSize;
-
-	image->texnum = 1024 + giTextureBindNum++;	// ++ is of course staggeringly important...
-
-	// record which map it was used on...
-	//
-	image->iLastLevelUsedOn = RE_RegisterMedia_GetLevel();
-
-	image->mipmap = !!mipmap;
-	image->allowPicmip = !!allow_picmip;
-
-	Q_strncpyz(image->imgName, name, sizeof(image->imgName));
-
-	image->width = width;
-	image->height = height;
-	image->wrapClampMode = gl_wrap_clamp_mode;
-
-	if (qglActiveTextureARB) {
-		GL_SelectTexture(0);
-	}
+	image = R_AllocImage(name, width, height, mipmap, allow_picmip, gl_wrap_clamp_mode);
 
-	GL_Bind(image);
+	R_BeginImageUpload(image);
 
 	Upload32((unsigned*)pic, format,
 		static_cast<qboolean>(image->mipmap),
@@ -996,31 +1068,597 @@ image_t* R_CreateImage(const char* name, const byte* pic, const int width, const
 		&image->width,
 		&image->height);
 
-	qglTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, gl_wrap_clamp_mode);
-	qglTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, gl_wrap_clamp_mode);
-
-	qglBindTexture(GL_TEXTURE_2D, 0);	//jfm: i don't know why this is here, but it breaks lightmaps when there's only 1
-	glState.currenttextures[glState.currenttmu] = 0;	//mark it not bound
-
-	const char* psNewName = GenerateImageMappingName(name);
-	Q_strncpyz(image->imgName, psNewName, sizeof(image->imgName));
-	AllocatedImages[image->imgName] = image;
+	R_EndImageUpload(image);
 
 	return image;
 }
 
 /*
-===============
-R_FindImageFile
+====================================================================
 
-Finds or loads the given image.
-Returns NULL if it fails, not a default image.
-==============
+TEXTURE CACHE
+
+With r_imageCache on, the images a level load batches up are kept in
+texcache/ under fs_homepath, picmipped, light scaled and with their whole mip
+chain, so the next load only has to checksum the source file and upload them.
+Images registered outside a level load aren't cached.  It is off by default,
+a hit still reads the source file and a bigger uncompressed cache file.  The
+key holds everything the prepared pixels depend on, a file that doesn't match
+it is built again and written over.
+
+The file name has the mipmap and picmip flags in it, since the same image can
+be registered both ways.  Each source image has at most one file per
+combination, so the directory only grows with the set of images ever loaded.
+Nothing else refers to it and it is safe to delete at any time.
+
+====================================================================
 */
-image_t* R_FindImageFile(const char* name, const qboolean mipmap, const qboolean allowPicmip, const qboolean allowTC, int glWrapClampMode) {
-	int		width, height;
+
+#define IMAGE_CACHE_IDENT	(('C'<<24)+('X'<<16)+('E'<<8)+'T')
+constexpr int IMAGE_CACHE_VERSION = 1;
+
+using imageCacheKey_t = struct imageCacheKey_s
+{
+	unsigned sourceCrc;
+	int sourceLength;
+	int mipmap;
+	int picmip;				// r_picmip if the image allows it
+	int simpleMipMaps;
+	int maxTextureSize;
+	unsigned lightCrc;		// intensity and gamma tables baked into mipmapped images
+};
+
+using imageCacheHeader_t = struct imageCacheHeader_s
+{
+	int ident;
+	int version;
+	imageCacheKey_t key;
+	int width;
+	int height;
+	int samples;
+	int numLevels;
+	// followed by the levels, biggest first
+};
+
+static void R_ImageCachePath(const char* name, const qboolean mipmap, const qboolean allowPicmip, char* path, const int size)
+{
+	char stripped[MAX_QPATH];
+
+	COM_StripExtension(name, stripped, sizeof stripped);
+	Com_sprintf(path, size, "texcache/%s_m%dp%d.tex", stripped, mipmap ? 1 : 0, allowPicmip ? 1 : 0);
+}
+
+/*
+================
+R_ImageCacheKey
+
+Everything but the source checksum, which the workers fill in.
+================
+*/
+static void R_ImageCacheKey(const qboolean mipmap, const qboolean allowPicmip, imageCacheKey_t* key)
+{
+	memset(key, 0, sizeof * key);
+	key->mipmap = mipmap;
+	key->picmip = allowPicmip ? r_picmip->integer : 0;
+	key->simpleMipMaps = r_simpleMipMaps->integer;
+	key->maxTextureSize = glConfig.maxTextureSize;
+
+	// see R_LightScaleTexture
+	if (mipmap)
+	{
+		key->lightCrc = crc32(0L, s_intensitytable, sizeof s_intensitytable);
+		if (!glConfig.deviceSupportsGamma)
+		{
+			key->lightCrc = crc32(key->lightCrc, s_gammatable, sizeof s_gammatable);
+		}
+	}
+}
+
+/*
+================
+R_ReadImageCache
+
+Points upload at the levels in a cache file if it was built for key.  Leaves
+the internal format to the caller.  Safe on the worker threads.
+================
+*/
+static bool R_ReadImageCache(const byte* buffer, const int length, const imageCacheKey_t& key, imageUpload_t* upload)
+{
+	imageCacheHeader_t header;
+
+	if (!buffer || length < static_cast<int>(sizeof header))
+	{
+		return false;
+	}
+	memcpy(&header, buffer, sizeof header);
+
+	if (header.ident != IMAGE_CACHE_IDENT || header.version != IMAGE_CACHE_VERSION || memcmp(&header.key, &key, sizeof key))
+	{
+		return false;
+	}
+	if (header.width < 1 || header.width > key.maxTextureSize || header.height < 1 || header.height > key.maxTextureSize)
+	{
+		return false;
+	}
+	if (header.samples != 3 && header.samples != 4)
+	{
+		return false;
+	}
+
+	int numLevels = 1;
+	const int levelBytes = header.width * header.height * 4;
+	const int mipBytes = key.mipmap ? R_MipChainBytes(header.width, header.height, &numLevels) : 0;
+
+	if (header.numLevels != numLevels || length != static_cast<int>(sizeof header) + levelBytes + mipBytes)
+	{
+		return false;
+	}
+
+	upload->data = buffer + sizeof header;
+	upload->mipData = upload->data + levelBytes;
+	upload->width = header.width;
+	upload->height = header.height;
+	upload->samples = header.samples;
+	upload->numLevels = header.numLevels;
+	return true;
+}
+
+/*
+================
+R_WriteImageCache
+================
+*/
+static void R_WriteImageCache(const image_t* image, const char* name, const imageCacheKey_t& key, const imageUpload_t& upload)
+{
+	char path[MAX_OSPATH];
+	imageCacheHeader_t header;
+	int numLevels = 1;
+
+	R_ImageCachePath(name, static_cast<qboolean>(image->mipmap), static_cast<qboolean>(image->allowPicmip), path, sizeof path);
+	const fileHandle_t f = ri.FS_FOpenFileWrite(path, qtrue);
+	if (!f)
+	{
+		return;
+	}
+
+	header.ident = IMAGE_CACHE_IDENT;
+	header.version = IMAGE_CACHE_VERSION;
+	header.key = key;
+	header.width = upload.width;
+	header.height = upload.height;
+	header.samples = upload.samples;
+	header.numLevels = upload.numLevels;
+
+	ri.FS_Write(&header, sizeof header, f);
+	ri.FS_Write(upload.data, upload.width * upload.height * 4, f);
+	if (upload.numLevels > 1)
+	{
+		ri.FS_Write(upload.mipData, R_MipChainBytes(upload.width, upload.height, &numLevels), f);
+	}
+	ri.FS_FCloseFile(f);
+}
+
+/*
+====================================================================
+
+IMAGE BATCH
+
+While a level loads R_FindImageFile only reads the files and hands out
+image_t's with nothing uploaded yet.  The queued images are decoded and
+mipmapped on the worker threads, and uploaded by the thread that has the GL
+context before anything gets to draw with them.
+
+A file that is there but doesn't decode can't turn the image_t back into the
+NULL R_FindImageFile would have returned, so the flush resolves it: the normal
+loaders get another go, trying the other extensions, and if nothing loads the
+image gets the default image's pixels and a warning.
+
+====================================================================
+*/
+
+constexpr int MAX_PENDING_IMAGES = 32;
+constexpr int MAX_PENDING_IMAGE_BYTES = 16 << 20;	// of files, decoded they're usually bigger
+
+using pendingImage_t = struct pendingImage_s
+{
+	image_t* image;
+	char name[MAX_QPATH];		// as asked for, to load it the slow way if it doesn't decode
+	byte* file;
+	int fileLength;
+	ImageDecoderFn decoder;
+	qboolean allowTC;
+	bool useCache;
+	byte* cacheFile;			// texcache/ copy, if there is one
+	int cacheLength;
+	imageCacheKey_t cacheKey;	// the workers add the source checksum
+
+	// filled in by the workers
+	DecodedImage decoded;
+	imageUpload_t upload;
+	bool fromCache;
+	bool decodedOk;
+	bool prepared;
+	int64_t usec;
+};
+
+static struct
+{
+	bool active;
+	char mapName[MAX_QPATH];
+	std::vector<pendingImage_t> pending;
+	int pendingBytes;
+
+	// for the report at the end of the load
+	int numImages;
+	int numCached;
+	int numFallbacks;
+	int64_t readUsec;
+	int64_t decodeUsec;		// wall clock
+	int64_t jobUsec;		// summed over the jobs
+	int64_t uploadUsec;
+	int64_t cacheWriteUsec;
+} imageBatch;
+
+static void R_ImageBatchJob(const int job, void* data)
+{
+	pendingImage_t& p = static_cast<pendingImage_t*>(data)[job];
+	const qboolean isLightmap = static_cast<qboolean>(p.image->imgName[0] == '$');
+	const timingUsec_c timer;
+
+	if (p.useCache)
+	{
+		p.cacheKey.sourceCrc = crc32(0L, p.file, p.fileLength);
+		p.cacheKey.sourceLength = p.fileLength;
+		p.fromCache = R_ReadImageCache(p.cacheFile, p.cacheLength, p.cacheKey, &p.upload);
+	}
+
+	if (p.fromCache)
+	{
+		p.upload.internalFormat = R_ImageInternalFormat(p.upload.samples, isLightmap, p.allowTC);
+		p.prepared = true;
+	}
+	else if ((p.decodedOk = p.decoder(p.file, p.fileLength, &p.decoded)))
+	{
+		const int width = p.decoded.width;
+		const int height = p.decoded.height;
+
+		// anything that isn't a power of 2 is an error for the main thread to raise
+		if (!(width & (width - 1)) && !(height & (height - 1)))
+		{
+			p.upload.internalFormat = 0;
+			R_PrepareUpload(p.decoded.pic.data(), width, height, static_cast<qboolean>(p.image->mipmap),
+				static_cast<qboolean>(p.image->allowPicmip), isLightmap, p.allowTC,
+				&p.upload);
+			p.prepared = true;
+		}
+	}
+
+	p.usec = timer.End();
+}
+
+/*
+================
+R_DefaultImagePixels
+
+The default image is a box, to allow you to see the mapping coordinates
+================
+*/
+#define	DEFAULT_SIZE	16
+static void R_DefaultImagePixels(byte data[DEFAULT_SIZE][DEFAULT_SIZE][4]) {
+	memset(data, 32, DEFAULT_SIZE * DEFAULT_SIZE * 4);
+	for (int x = 0; x < DEFAULT_SIZE; x++) {
+		data[0][x][0] =
+			data[0][x][1] =
+			data[0][x][2] =
+			data[0][x][3] = 255;
+
+		data[x][0][0] =
+			data[x][0][1] =
+			data[x][0][2] =
+			data[x][0][3] = 255;
+
+		data[DEFAULT_SIZE - 1][x][0] =
+			data[DEFAULT_SIZE - 1][x][1] =
+			data[DEFAULT_SIZE - 1][x][2] =
+			data[DEFAULT_SIZE - 1][x][3] = 255;
+
+		data[x][DEFAULT_SIZE - 1][0] =
+			data[x][DEFAULT_SIZE - 1][1] =
+			data[x][DEFAULT_SIZE - 1][2] =
+			data[x][DEFAULT_SIZE - 1][3] = 255;
+	}
+}
+
+/*
+================
+R_UploadPendingImage
+
+Main thread half of a queued image.  Anything the workers couldn't decode
+goes through the normal loaders, which try the other extensions and report
+what is wrong with the file.
+================
+*/
+static void R_UploadPendingImage(const pendingImage_t& p)
+{
+	image_t* image = p.image;
+	const qboolean isLightmap = static_cast<qboolean>(image->imgName[0] == '$');
+
+	if (p.prepared)
+	{
+		R_BeginImageUpload(image);
+		R_UploadLevels(p.upload, static_cast<qboolean>(image->mipmap));
+		R_EndImageUpload(image);
+
+		image->internalFormat = p.upload.internalFormat;
+		image->width = p.upload.width;
+		image->height = p.upload.height;
+		return;
+	}
+
+	if (p.decodedOk)
+	{
+		Com_Error(ERR_FATAL, "R_CreateImage: %s dimensions (%i x %i) not power of 2!\n", p.name, p.decoded.width, p.decoded.height);
+	}
+
+	byte* pic;
+	int width, height;
+
+	R_LoadImage(p.name, &pic, &width, &height);
+	imageBatch.numFallbacks++;
+
+	if (!pic)
+	{
+		// the shaders already have this image_t, so it's too late to fail
+		ri.Printf(PRINT_WARNING, "WARNING: couldn't load image %s, using the default image\n", p.name);
+
+		pic = static_cast<byte*>(R_Malloc(DEFAULT_SIZE * DEFAULT_SIZE * 4, TAG_TEMP_WORKSPACE, qfalse));
+		R_DefaultImagePixels(reinterpret_cast<byte(*)[DEFAULT_SIZE][4]>(pic));
+		width = height = DEFAULT_SIZE;
+	}
+
+	if ((width & (width - 1)) || (height & (height - 1)))
+	{
+		Com_Error(ERR_FATAL, "R_CreateImage: %s dimensions (%i x %i) not power of 2!\n", p.name, width, height);
+	}
+
+	image->width = width;
+	image->height = height;
+
+	R_BeginImageUpload(image);
+
+	Upload32(reinterpret_cast<unsigned*>(pic), GL_RGBA,
+		static_cast<qboolean>(image->mipmap),
+		static_cast<qboolean>(image->allowPicmip),
+		isLightmap,
+		p.allowTC,
+		&image->internalFormat,
+		&image->width,
+		&image->height);
+
+	R_EndImageUpload(image);
+
+	R_Free(pic);
+}
+
+/*
+================
+R_FlushImageBatch
+
+Decodes and uploads everything queued so far.  Needs the GL context, so only
+call it from the front end once the render thread is idle.
+================
+*/
+void R_FlushImageBatch()
+{
+	if (imageBatch.pending.empty())
+	{
+		return;
+	}
+
+	timingUsec_c timer;
+	R_RunWorkerJobs(static_cast<int>(imageBatch.pending.size()), R_ImageBatchJob, imageBatch.pending.data());
+	imageBatch.decodeUsec += timer.End();
+	timer.Start();
+	int64_t writeUsec = 0;
+
+	for (pendingImage_t& p : imageBatch.pending)
+	{
+		imageBatch.jobUsec += p.usec;
+		R_UploadPendingImage(p);
+
+		if (p.fromCache)
+		{
+			imageBatch.numCached++;
+		}
+		else if (p.useCache && p.prepared)
+		{
+			const timingUsec_c writeTimer;
+			R_WriteImageCache(p.image, p.name, p.cacheKey, p.upload);
+			writeUsec += writeTimer.End();
+		}
+
+		ri.FS_FreeFile(p.file);
+		if (p.cacheFile)
+		{
+			ri.FS_FreeFile(p.cacheFile);
+		}
+	}
+
+	imageBatch.uploadUsec += timer.End() - writeUsec;
+	imageBatch.cacheWriteUsec += writeUsec;
+
+	imageBatch.pending.clear();
+	imageBatch.pendingBytes = 0;
+}
+
+/*
+================
+R_LoadImageFile
+
+Loads and uploads the image right away, R_FindImageFile without the batch.
+================
+*/
+static image_t* R_LoadImageFile(const char* name, const qboolean mipmap, const qboolean allowPicmip, const qboolean allowTC,
+	const int glWrapClampMode)
+{
 	byte* pic;
+	int width, height;
+
+	R_LoadImage(name, &pic, &width, &height);
+	if (!pic) {
+		return nullptr;
+	}
+
+	image_t* image = R_CreateImage(name, pic, width, height, GL_RGBA, mipmap, allowPicmip, allowTC, glWrapClampMode);
+	R_Free(pic);
+	return image;
+}
+
+/*
+================
+R_QueueImageFile
+
+Reads the file and queues it for the workers to decode.  Returns NULL when
+there's no file under any of the extensions, like R_FindImageFile does
+without the batch.
+================
+*/
+static image_t* R_QueueImageFile(const char* name, const qboolean mipmap, const qboolean allowPicmip, const qboolean allowTC,
+	const int glWrapClampMode)
+{
+	if (strlen(name) >= MAX_QPATH) {
+		Com_Error(ERR_DROP, "R_CreateImage: \"%s\" is too long\n", name);
+	}
+
+	pendingImage_t p{};
+	const timingUsec_c timer;
+
+	p.fileLength = R_ReadImage(name, &p.file, &p.decoder);
+	if (!p.file) {
+		imageBatch.readUsec += timer.End();
+		return nullptr;
+	}
+
+	Q_strncpyz(p.name, name, sizeof p.name);
+	p.allowTC = allowTC;
+
+	// mip levels tinted for debugging aren't worth keeping
+	p.useCache = r_imageCache->integer && !r_colorMipLevels->integer;
+	if (p.useCache) {
+		char path[MAX_OSPATH];
+
+		R_ImageCacheKey(mipmap, allowPicmip, &p.cacheKey);
+		R_ImageCachePath(name, mipmap, allowPicmip, path, sizeof path);
+		p.cacheLength = static_cast<int>(ri.FS_ReadFile(path, reinterpret_cast<void**>(&p.cacheFile)));
+		if (!p.cacheFile) {
+			p.cacheLength = 0;
+		}
+	}
+	imageBatch.readUsec += timer.End();
+
+	p.image = R_AllocImage(name, 0, 0, mipmap, allowPicmip, glWrapClampMode);
+	imageBatch.numImages++;
+	imageBatch.pendingBytes += p.fileLength + p.cacheLength;
+	imageBatch.pending.push_back(std::move(p));
+
+	image_t* image = imageBatch.pending.back().image;
+	if (static_cast<int>(imageBatch.pending.size()) >= MAX_PENDING_IMAGES || imageBatch.pendingBytes >= MAX_PENDING_IMAGE_BYTES)
+	{
+		R_FlushImageBatch();
+	}
+
+	return image;
+}
+
+// an image is going away before the batch got to it
+//
+static void R_DropPendingImage(const image_t* pImage)
+{
+	for (auto it = imageBatch.pending.begin(); it != imageBatch.pending.end(); ++it)
+	{
+		if (it->image == pImage)
+		{
+			imageBatch.pendingBytes -= it->fileLength + it->cacheLength;
+			ri.FS_FreeFile(it->file);
+			if (it->cacheFile)
+			{
+				ri.FS_FreeFile(it->cacheFile);
+			}
+			imageBatch.pending.erase(it);
+			return;
+		}
+	}
+}
+
+/*
+================
+R_BeginImageBatch
+
+Called when a level starts loading, with r_parallelImages on the images it
+registers are queued from here on.
+================
+*/
+void R_BeginImageBatch(const char* mapName)
+{
+	imageBatch.active = r_parallelImages && r_parallelImages->integer;
+	Q_strncpyz(imageBatch.mapName, mapName, sizeof imageBatch.mapName);
+	imageBatch.numImages = 0;
+	imageBatch.numCached = 0;
+	imageBatch.numFallbacks = 0;
+	imageBatch.readUsec = 0;
+	imageBatch.decodeUsec = 0;
+	imageBatch.jobUsec = 0;
+	imageBatch.uploadUsec = 0;
+	imageBatch.cacheWriteUsec = 0;
+}
+
+/*
+================
+R_EndImageBatch
+
+Uploads whatever is left once the level is loaded and reports where the time
+went.
+================
+*/
+void R_EndImageBatch()
+{
+	if (!imageBatch.active)
+	{
+		return;
+	}
+
+	R_IssuePendingRenderCommands();
+	R_FlushImageBatch();
+	imageBatch.active = false;
+
+	if (!imageBatch.numImages)
+	{
+		return;
+	}
+
+	ri.Printf(PRINT_ALL, "%s: %d images, %.1f ms reading, %.1f ms decoding and mipmapping (%.1f ms of work on %d threads), %.1f ms uploading\n",
+		imageBatch.mapName, imageBatch.numImages, imageBatch.readUsec / 1000.0, imageBatch.decodeUsec / 1000.0,
+		imageBatch.jobUsec / 1000.0, R_NumWorkers() + 1, imageBatch.uploadUsec / 1000.0);
+	if (imageBatch.numCached || imageBatch.cacheWriteUsec)
+	{
+		ri.Printf(PRINT_ALL, "%s: %d images from the texture cache, %.1f ms writing it\n", imageBatch.mapName,
+			imageBatch.numCached, imageBatch.cacheWriteUsec / 1000.0);
+	}
+	if (imageBatch.numFallbacks)
+	{
+		ri.Printf(PRINT_DEVELOPER, "%d images didn't decode for the batch and were loaded the normal way\n", imageBatch.numFallbacks);
+	}
+}
+
+/*
+===============
+R_FindImageFile
 
+Finds or loads the given image.
+Returns NULL if it fails, not a default image.
+==============
+*/
+image_t* R_FindImageFile(const char* name, const qboolean mipmap, const qboolean allowPicmip, const qboolean allowTC, int glWrapClampMode) {
 	if (!name) {
 		return nullptr;
 	}
@@ -1037,17 +1675,14 @@ image_t* R_FindImageFile(const char* name, const qboolean mipmap, const qboolean
 		return image;
 	}
 
+	if (imageBatch.active) {
+		return R_QueueImageFile(name, mipmap, allowPicmip, allowTC, glWrapClampMode);
+	}
+
 	//
 	// load the pic from disk
 	//
-	R_LoadImage(name, &pic, &width, &height);
-	if (!pic) {
-		return nullptr;
-	}
-
-	image = R_CreateImage(name, pic, width, height, GL_RGBA, mipmap, allowPicmip, allowTC, glWrapClampMode);
-	R_Free(pic);
-	return image;
+	return R_LoadImageFile(name, mipmap, allowPicmip, allowTC, glWrapClampMode);
 }
 
 /*
@@ -1217,33 +1852,10 @@ static void R_CreateFogImage() {
 R_CreateDefaultImage
 ==================
 */
-#define	DEFAULT_SIZE	16
 static void R_CreateDefaultImage() {
 	byte	data[DEFAULT_SIZE][DEFAULT_SIZE][4];
 
-	// the default image will be a box, to allow you to see the mapping coordinates
-	memset(data, 32, sizeof(data));
-	for (int x = 0; x < DEFAULT_SIZE; x++) {
-		data[0][x][0] =
-			data[0][x][1] =
-			data[0][x][2] =
-			data[0][x][3] = 255;
-
-		data[x][0][0] =
-			data[x][0][1] =
-			data[x][0][2] =
-			data[x][0][3] = 255;
-
-		data[DEFAULT_SIZE - 1][x][0] =
-			data[DEFAULT_SIZE - 1][x][1] =
-			data[DEFAULT_SIZE - 1][x][2] =
-			data[DEFAULT_SIZE - 1][x][3] = 255;
-
-		data[x][DEFAULT_SIZE - 1][0] =
-			data[x][DEFAULT_SIZE - 1][1] =
-			data[x][DEFAULT_SIZE - 1][2] =
-			data[x][DEFAULT_SIZE - 1][3] = 255;
-	}
+	R_DefaultImagePixels(data);
 	tr.defaultImage = R_CreateImage("*default", reinterpret_cast<byte*>(data), DEFAULT_SIZE, DEFAULT_SIZE, GL_RGBA, qtrue, qfalse, qtrue, GL_REPEAT);
 }
 
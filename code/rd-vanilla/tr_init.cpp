@@ -46,6 +46,20 @@ cvar_t* r_detailTextures;
 cvar_t* r_znear;
 
 cvar_t* r_skipBackEnd;
+cvar_t* r_smp;
+cvar_t* r_showSmp;
+cvar_t* r_workerThreads;
+cvar_t* r_parallelWorld;
+cvar_t* r_clusterSurfaces;
+cvar_t* r_clusterSurfaceCache;
+cvar_t* r_parallelSort;
+cvar_t* r_sortCoherence;
+cvar_t* r_simd;
+cvar_t* r_parallelImages;
+cvar_t* r_imageCache;
+cvar_t* r_shaderCache;
+cvar_t* r_staticBatch;
+cvar_t* r_mergeInstances;
 
 cvar_t* r_measureOverdraw;
 
@@ -1508,6 +1522,9 @@ static consoleCommand_t	commands[] = {
 	{ "r_reloadfonts",		R_ReloadFonts_f },
 	{ "weather",			R_SetWeatherEffect_f },
 	{ "r_weather",			R_WeatherEffect_f },
+	{ "r_worldbench",		R_WorldBench_f },
+	{ "r_sortbench",		R_SortBench_f },
+	{ "r_simdbench",		R_SimdBench_f },
 };
 
 #ifdef _DEBUG
@@ -1626,6 +1643,20 @@ void R_Register()
 	r_portalOnly = ri.Cvar_Get("r_portalOnly", "0", CVAR_CHEAT);
 
 	r_skipBackEnd = ri.Cvar_Get("r_skipBackEnd", "0", CVAR_CHEAT);
+	r_smp = ri.Cvar_Get("r_smp", "0", CVAR_ARCHIVE_ND | CVAR_LATCH);
+	r_showSmp = ri.Cvar_Get("r_showSmp", "0", CVAR_CHEAT);
+	r_workerThreads = ri.Cvar_Get("r_workerThreads", "-1", CVAR_ARCHIVE_ND | CVAR_LATCH);
+	r_parallelWorld = ri.Cvar_Get("r_parallelWorld", "1", CVAR_ARCHIVE_ND);
+	r_clusterSurfaces = ri.Cvar_Get("r_clusterSurfaces", "1", CVAR_ARCHIVE_ND);
+	r_clusterSurfaceCache = ri.Cvar_Get("r_clusterSurfaceCache", "0", CVAR_ARCHIVE_ND);
+	r_parallelSort = ri.Cvar_Get("r_parallelSort", "1", CVAR_ARCHIVE_ND);
+	r_sortCoherence = ri.Cvar_Get("r_sortCoherence", "0", CVAR_ARCHIVE_ND);
+	r_simd = ri.Cvar_Get("r_simd", "-1", CVAR_ARCHIVE_ND | CVAR_LATCH);
+	r_parallelImages = ri.Cvar_Get("r_parallelImages", "1", CVAR_ARCHIVE_ND);
+	r_imageCache = ri.Cvar_Get("r_imageCache", "0", CVAR_ARCHIVE_ND);
+	r_shaderCache = ri.Cvar_Get("r_shaderCache", "1", CVAR_ARCHIVE_ND);
+	r_staticBatch = ri.Cvar_Get("r_staticBatch", "1", CVAR_ARCHIVE_ND);
+	r_mergeInstances = ri.Cvar_Get("r_mergeInstances", "0", CVAR_ARCHIVE_ND);
 
 	r_measureOverdraw = ri.Cvar_Get("r_measureOverdraw", "0", CVAR_CHEAT);
 	r_norefresh = ri.Cvar_Get("r_norefresh", "0", CVAR_CHEAT);
@@ -1771,8 +1802,15 @@ void R_Init()
 	R_ImageLoader_Init();
 	R_NoiseInit();
 	R_Register();
+	R_InitSimdKernels();
 
-	backEndData = static_cast<backEndData_t*>(R_Hunk_Alloc(sizeof(backEndData_t), qtrue));
+	backEndData[0] = static_cast<backEndData_t*>(R_Hunk_Alloc(sizeof(backEndData_t), qtrue));
+	if (r_smp->integer) {
+		backEndData[1] = static_cast<backEndData_t*>(R_Hunk_Alloc(sizeof(backEndData_t), qtrue));
+	}
+	else {
+		backEndData[1] = nullptr;
+	}
 	R_InitNextFrame();
 
 	constexpr color4ub_t color = { 0xff, 0xff, 0xff, 0xff };
@@ -1782,6 +1820,11 @@ void R_Init()
 	}
 	InitOpenGL();
 
+	if (r_smp->integer && backEndData[1]) {
+		RB_SpawnRenderThread();
+	}
+	R_InitWorkers();
+
 	R_InitImages();
 	R_InitShaders();
 	R_InitSkins();
@@ -1809,6 +1852,14 @@ extern void R_ShutdownWorldEffects();
 
 void RE_Shutdown(const qboolean destroy_window, const qboolean restarting)
 {
+	// finish the last frame and take the GL context back before anything is freed
+	if (tr.registered)
+	{
+		R_IssuePendingRenderCommands();
+	}
+	RB_ShutdownRenderThread();
+	R_ShutdownWorkers();
+
 	for (const auto& command : commands)
 		ri.Cmd_RemoveCommand(command.cmd);
 
@@ -99,13 +99,13 @@ void R_DlightBmodel(const bmodel_t* bmodel, const qboolean NoLight) {
 		const msurface_t* surf = bmodel->firstSurface + i;
 
 		if (*surf->data == SF_FACE) {
-			reinterpret_cast<srfSurfaceFace_t*>(surf->data)->dlightBits = mask;
+			reinterpret_cast<srfSurfaceFace_t*>(surf->data)->dlightBits[tr.smpFrame] = mask;
 		}
 		else if (*surf->data == SF_GRID) {
-			reinterpret_cast<srfGridMesh_t*>(surf->data)->dlightBits = mask;
+			reinterpret_cast<srfGridMesh_t*>(surf->data)->dlightBits[tr.smpFrame] = mask;
 		}
 		else if (*surf->data == SF_TRIANGLES) {
-			reinterpret_cast<srfTriangles_t*>(surf->data)->dlightBits = mask;
+			reinterpret_cast<srfTriangles_t*>(surf->data)->dlightBits[tr.smpFrame] = mask;
 		}
 	}
 }
@@ -30,6 +30,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "tr_public.h"
 #include "mdx_format.h"
 #include "qgl.h"
+#include "tr_simd.h"
 
 #define GL_INDEX_TYPE		GL_UNSIGNED_INT
 using glIndex_t = unsigned int;
@@ -598,11 +599,15 @@ using srfFlare_t = struct srfFlare_s {
 	vec3_t			color;
 };
 
+// the front end fills one set of per frame data while the render thread
+// draws from the other
+#define	SMP_FRAMES		2
+
 using srfGridMesh_t = struct srfGridMesh_s {
 	surfaceType_t	surfaceType;
 
 	// dynamic lighting information
-	int				dlightBits;
+	int				dlightBits[SMP_FRAMES];
 
 	// culling information
 	vec3_t			meshBounds[2];
@@ -628,12 +633,18 @@ using srfGridMesh_t = struct srfGridMesh_s {
 
 #define	VERTEX_FINAL_COLOR	(5+(MAXLIGHTMAPS*3))
 
+struct staticBatch_s;
+
 using srfSurfaceFace_t = struct {
 	surfaceType_t	surfaceType;
 	cplane_t	plane;
 
 	// dynamic lighting information
-	int			dlightBits;
+	int			dlightBits[SMP_FRAMES];
+
+	// where the vertexes are in the static batch of the shader, if there is one
+	const staticBatch_s* staticBatch;
+	int			staticVertex;
 
 	// triangle definitions (no normals at points)
 	int			numPoints;
@@ -648,7 +659,7 @@ using srfTriangles_t = struct {
 	surfaceType_t	surfaceType;
 
 	// dynamic lighting information
-	int				dlightBits;
+	int				dlightBits[SMP_FRAMES];
 
 	// culling information (FIXME: use this!)
 	vec3_t			bounds[2];
@@ -661,6 +672,9 @@ using srfTriangles_t = struct {
 
 	int				num_verts;
 	drawVert_t* verts;
+
+	const staticBatch_s* staticBatch;
+	int				staticVertex;
 };
 
 extern	void (*rb_surfaceTable[SF_NUM_SURFACE_TYPES])(void*);
@@ -723,6 +737,14 @@ using mgrid_t = struct {
 	byte		latLong[2];
 };
 
+// the surfaces in the pvs of one cluster that are in leafs of one area
+using clusterArea_t = struct {
+	int			area;
+	int			firstSurface;	// into world_t::clusterSurfaces
+	int			numSurfaces;
+	vec3_t		bounds[2];		// of the leafs
+};
+
 using world_t = struct {
 	char		name[MAX_QPATH];		// ie: maps/tim_dm2.bsp
 	char		baseName[MAX_QPATH];	// ie: tim_dm2
@@ -765,6 +787,18 @@ using world_t = struct {
 	const byte* vis;			// may be passed in by CM_LoadMap to save space
 
 	byte* novis;			// clusterBytes of 0xff
+
+	// precomputed potentially visible surfaces, nullptr if not built
+	int* clusterFirstArea;		// numClusters + 1 entries into clusterAreas
+	int			numClusterAreas;
+	clusterArea_t* clusterAreas;
+	int			numClusterSurfaces;
+	int* clusterSurfaces;		// indexes into surfaces
+	vec3_t* surfaceCullBoxes;		// center and half size of each surface
+
+	// static batches by shader index, nullptr if not built
+	int			numStaticBatches;
+	staticBatch_s** staticBatches;
 };
 
 //======================================================================
@@ -889,6 +923,12 @@ using backEndCounters_t = struct {
 	int		c_surfaces, c_shaders, c_vertexes, c_indexes, c_totalIndexes;
 	float	c_overDraw;
 
+	int		c_staticSurfaces;
+	int		c_staticVertexes;
+
+	int		c_instanceMerges;		// entities drawn together with the one before them
+	int		c_instanceDrawsSaved;
+
 	int		c_dlightVertexes;
 	int		c_dlightIndexes;
 
@@ -906,6 +946,7 @@ using backEndState_t = struct {
 	viewParms_t	viewParms;
 	orientationr_t	ori;
 	backEndCounters_t	pc;
+	int			smpFrame;		// which backEndData the commands came from
 	qboolean	isHyperspace;
 	trRefEntity_t* currentEntity;
 	qboolean	skyRenderedThisView;	// flag for drawing sun
@@ -937,6 +978,8 @@ using trGlobals_t = struct {
 
 	int						frameSceneNum;	// zeroed at RE_BeginFrame
 
+	int						smpFrame;		// toggled every frame when r_smp is on
+
 	qboolean				worldMapLoaded;
 	world_t* world;
 	char					worldDir[MAX_QPATH];		// ie: maps/tim_dm2 (copy of world_t::name sans extension but still includes the path)
@@ -1169,6 +1212,20 @@ extern	cvar_t* r_portalOnly;
 extern	cvar_t* r_subdivisions;
 extern	cvar_t* r_lodCurveError;
 extern	cvar_t* r_skipBackEnd;
+extern	cvar_t* r_smp;
+extern	cvar_t* r_showSmp;
+extern	cvar_t* r_workerThreads;				// front end worker threads, -1 = one per extra core
+extern	cvar_t* r_parallelWorld;				// walk the world bsp on the worker threads
+extern	cvar_t* r_clusterSurfaces;				// use the per cluster surface lists
+extern	cvar_t* r_clusterSurfaceCache;			// save and load the lists beside the bsp
+extern	cvar_t* r_parallelSort;					// radix sort big draw surface lists on the worker threads
+extern	cvar_t* r_sortCoherence;				// merge draw surface lists made of a few sorted runs
+extern	cvar_t* r_simd;							// vertex and image kernels, -1 = best the cpu has, 0 = scalar, 1 = SSE2, 2 = AVX2
+extern	cvar_t* r_parallelImages;				// decode and mipmap the images a level loads on the worker threads
+extern	cvar_t* r_imageCache;					// keep level load images mipmapped in texcache/ under fs_homepath
+extern	cvar_t* r_shaderCache;					// keep the shader text index in shadercache.bin and reuse parsed shaders
+extern	cvar_t* r_staticBatch;					// draw world faces and triangle soups from per shader batches built at load
+extern	cvar_t* r_mergeInstances;				// merge the model surfaces of entities that share a shader on the CPU
 
 extern	cvar_t* r_ignoreGLErrors;
 
@@ -1210,6 +1267,7 @@ void R_DecomposeSort(unsigned sort, int* entity_num, shader_t** shader,
 	int* fog_num, int* dlight_map);
 
 void R_AddDrawSurf(const surfaceType_t* surface, const shader_t* shader, int fog_index, int dlight_map);
+void R_SortBench_f();
 
 #define	CULL_IN		0		// completely unclipped
 #define	CULL_CLIP	1		// clipped by one or more planes
@@ -1303,6 +1361,10 @@ image_t* R_FindImageFile(const char* name, qboolean mipmap, qboolean allowPicmip
 
 image_t* R_CreateImage(const char* name, const byte* pic, int width, int height, GLenum format, qboolean mipmap, qboolean allow_picmip, qboolean allow_tc, int gl_wrap_clamp_mode);
 
+void		R_BeginImageBatch(const char* mapName);
+void		R_FlushImageBatch();
+void		R_EndImageBatch();
+
 qboolean	R_GetModeInfo(int* width, int* height, int mode);
 
 void		R_SetColorMappings();
@@ -1338,6 +1400,7 @@ shader_t* R_FindShader(const char* name, const int* lightmap_index, const byte*
 shader_t* R_GetShaderByHandle(qhandle_t h_shader);
 void		R_InitShaders();
 void		R_ShaderList_f();
+void		R_ShaderLoadReport();
 
 //
 // tr_arb.c
@@ -1370,6 +1433,21 @@ using stageVars_t = struct stageVars
 
 #define	NUM_TEX_COORDS		(MAXLIGHTMAPS+1)
 
+// the world faces and triangle soups of one shader in a single set of arrays,
+// with the colors and texcoords of every stage worked out when the level loads
+using staticStage_t = struct {
+	color4ub_t* colors;
+	vec2_t* texcoords[NUM_TEXTURE_BUNDLES];
+};
+
+using staticBatch_t = struct staticBatch_s {
+	shader_t* shader;
+	int			numVertexes;
+	qboolean	fogAdjust;			// some stage fades its colors in fog, which depends on the view
+	vec4_t* xyz;
+	staticStage_t	stages[MAX_SHADER_STAGES];
+};
+
 struct shaderCommands_s
 {
 	glIndex_t	indexes[SHADER_MAX_INDEXES] QALIGN(16);
@@ -1379,12 +1457,16 @@ struct shaderCommands_s
 	color4ub_t	vertexColors[SHADER_MAX_VERTEXES] QALIGN(16);
 	byte		vertexAlphas[SHADER_MAX_VERTEXES][4] QALIGN(16);
 	int			vertexDlightBits[SHADER_MAX_VERTEXES] QALIGN(16);
+	color4ub_t	instanceColors[SHADER_MAX_VERTEXES] QALIGN(16);	// diffuse lighting of each vertex's own entity
 
 	stageVars_t	svars QALIGN(16);
 
 	shader_t* shader;
 	int			fogNum;
 
+	const staticBatch_t* staticBatch;	// the indexes point into this batch instead of the arrays above
+	qboolean	instanceLit;	// the vertexes of several entities are in world space, lit in instanceColors
+
 	int			dlightBits;	// or together of all vertexDlightBits
 
 	int			num_indexes;
@@ -1416,6 +1498,9 @@ extern	bool		styleUpdated[MAX_LIGHT_STYLES];
 
 void RB_BeginSurface(shader_t* shader, int fog_num);
 void RB_EndSurface();
+const staticBatch_t* RB_StaticBatchForRun(const shader_t* shader, int fog_num);
+qboolean RB_AddStaticSurface(const surfaceType_t* surface);
+void RB_CalcStaticStageVars(int stage);
 void RB_CheckOverflow(int verts, int indexes);
 #define RB_CHECKOVERFLOW(v,i) if (tess.numVertexes + (v) >= SHADER_MAX_VERTEXES || tess.num_indexes + (i) >= SHADER_MAX_INDEXES ) {RB_CheckOverflow(v,i);}
 
@@ -1437,6 +1522,7 @@ WORLD MAP
 
 void R_AddBrushModelSurfaces(trRefEntity_t* ent);
 void R_AddWorldSurfaces();
+void R_WorldBench_f();
 
 /*
 ============================================================
@@ -1548,6 +1634,7 @@ public:
 	const int		ident;			// ident of this surface - required so the materials renderer knows what sort of surface this refers to
 #endif
 	CBoneCache* bone_cache;		// pointer to transformed bone list for this surf
+	const mdxaBone_t* bone_snapshot;	// this frame's copy of the bones, read instead of bone_cache when set
 	mdxmSurface_t* surfaceData;	// pointer to surface data loaded into file - only used by client renderer DO NOT USE IN GAME SIDE - if there is a vid restart this will be out of wack on the game
 #ifdef _G2_GORE
 	float* alternateTex;		// alternate texture coordinates.
@@ -1563,6 +1650,7 @@ public:
 	{
 		ident = src.ident;
 		bone_cache = src.bone_cache;
+		bone_snapshot = src.bone_snapshot;
 		surfaceData = src.surfaceData;
 		alternateTex = src.alternateTex;
 		goreChain = src.goreChain;
@@ -1574,6 +1662,7 @@ public:
 	CRenderableSurface() :
 		ident(SF_MDX),
 		bone_cache(nullptr),
+		bone_snapshot(nullptr),
 #ifdef _G2_GORE
 		surfaceData(nullptr),
 		alternateTex(nullptr),
@@ -1587,6 +1676,7 @@ public:
 	void Init()
 	{
 		bone_cache = nullptr;
+		bone_snapshot = nullptr;
 		surfaceData = nullptr;
 #ifdef _G2_GORE
 		ident = SF_MDX;
@@ -1610,6 +1700,12 @@ void	R_TransformModelToClip(const vec3_t src, const float* model_matrix, const f
 	vec4_t eye, vec4_t dst);
 void	R_TransformClipToWindow(const vec4_t clip, const viewParms_t* view, vec4_t normalized, vec4_t window);
 
+extern const tessKernels_t* tessKernels;
+extern const imageKernels_t* imageKernels;
+
+void	R_InitSimdKernels();
+void	R_SimdBench_f();
+
 void	RB_DeformTessGeometry();
 
 void	RB_CalcScaleTexCoords(const float scale[2], float* dst_tex_coords);
@@ -1634,6 +1730,7 @@ void	RB_CalcModulateAlphasByFog(unsigned char* dstColors);
 void	RB_CalcModulateRGBAsByFog(unsigned char* dstColors);
 
 void	RB_CalcDiffuseColor(unsigned char* colors);
+void	RB_CalcDiffuseColorRange(unsigned char* colors, int first, int count);
 void	RB_CalcDiffuseEntityColor(unsigned char* colors);
 void	RB_CalcDisintegrateColors(unsigned char* colors, colorGen_t rgb_gen);
 void	RB_CalcDisintegrateVertDeform();
@@ -1746,6 +1843,7 @@ using renderCommand_t = enum {
 // the main view, all the 3D icons, etc
 #define	MAX_POLYS		2048
 #define	MAX_POLYVERTS	( MAX_POLYS * 4 )
+#define	MAX_GHOUL2_BONES	16384
 
 // all of the information needed by the back end must be
 // contained in a backEndData_t.
@@ -1756,14 +1854,38 @@ using backEndData_t = struct {
 	srfPoly_t	polys[MAX_POLYS];
 	polyVert_t	polyVerts[MAX_POLYVERTS];
 	renderCommandList_t	commands;
+	mdxaBone_t	ghoul2Bones[MAX_GHOUL2_BONES];	// bone snapshots the render thread draws ghoul2 surfaces with
+	int		numGhoul2Bones;
+	qboolean	ghoul2LiveBones;	// snapshots ran out, the frame is not handed to the render thread
 };
 
-extern	backEndData_t* backEndData;
+extern	backEndData_t* backEndData[SMP_FRAMES];	// the second one may not be allocated
+
+extern	int		c_blockedOnRender;
+extern	int		c_blockedOnMain;
+extern	int		c_inlineFrames;
 
 void* R_GetCommandBuffer(int bytes);
 void RB_ExecuteRenderCommands(const void* data);
 
+void RB_SpawnRenderThread();
+void RB_ShutdownRenderThread();
+qboolean RB_RenderThreadActive();
+qboolean RB_RenderThreadIsBusy();
+void RB_WakeRenderThread(const void* data);
+void RB_WaitRenderThread();
+
 void R_IssuePendingRenderCommands();
+void R_ToggleSmpFrame();
+
+#define	MAX_RENDER_WORKERS		8
+
+using workerJob_t = void (*)(int job, void* data);
+
+void R_InitWorkers();
+void R_ShutdownWorkers();
+int R_NumWorkers();
+void R_RunWorkerJobs(int numJobs, workerJob_t func, void* data);
 
 void R_AddDrawSurfCmd(drawSurf_t* draw_surfs, int num_draw_surfs);
 
@@ -31,6 +31,9 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #if !defined(G2_H_INC)
 #include "../ghoul2/G2.h"
 #endif
+#include "../qcommon/timing.h"
+
+#include <vector>
 
 trGlobals_t		tr;
 
@@ -1066,52 +1069,287 @@ DRAWSURF SORTING
 ==========================================================================================
 */
 
+constexpr int MAX_SORT_JOBS = MAX_RENDER_WORKERS + 1;
+constexpr int PARALLEL_SORT_MIN = 4096;		// below this the threads cost more than they save
+constexpr int MAX_COHERENT_RUNS = 16;
+
+static drawSurf_t sortScratch[MAX_DRAWSURFS];
+
+// one radix pass, split into a chunk of the surfaces per job.  Every job
+// counts its own chunk and then scatters it to where the counts of the
+// chunks before it leave off, so the sort stays stable.
+static struct {
+	const drawSurf_t* source;
+	drawSurf_t* dest;
+	int			size;
+	int			shift;
+	int			numJobs;
+	int			count[MAX_SORT_JOBS][256];
+	int			index[MAX_SORT_JOBS][256];
+} radixPass;
+
+static void R_RadixCountJob(const int job, void* data) {
+	const int start = static_cast<int>(static_cast<int64_t>(radixPass.size) * job / radixPass.numJobs);
+	const int end = static_cast<int>(static_cast<int64_t>(radixPass.size) * (job + 1) / radixPass.numJobs);
+	const drawSurf_t* source = radixPass.source;
+	const int shift = radixPass.shift;
+	int* count = radixPass.count[job];
+
+	memset(count, 0, sizeof radixPass.count[0]);
+	for (int i = start; i < end; i++) {
+		++count[source[i].sort >> shift & 0xff];
+	}
+}
+
+static void R_RadixScatterJob(const int job, void* data) {
+	const int start = static_cast<int>(static_cast<int64_t>(radixPass.size) * job / radixPass.numJobs);
+	const int end = static_cast<int>(static_cast<int64_t>(radixPass.size) * (job + 1) / radixPass.numJobs);
+	const drawSurf_t* source = radixPass.source;
+	drawSurf_t* dest = radixPass.dest;
+	const int shift = radixPass.shift;
+	int* index = radixPass.index[job];
+
+	for (int i = start; i < end; i++) {
+		dest[index[source[i].sort >> shift & 0xff]++] = source[i];
+	}
+}
+
+/*
+===============
+R_RadixSortJobs
+
+Radix sort with 4 byte size buckets, each pass spread over numJobs jobs.
+A pass is skipped when every key has the same value in its byte, which
+is common for the fog and entity bits.
+===============
+*/
+static void R_RadixSortJobs(drawSurf_t* source, const int size, const int numJobs)
+{
+	drawSurf_t* in = source;
+	drawSurf_t* out = sortScratch;
+
+	radixPass.size = size;
+	radixPass.numJobs = numJobs;
+
+	for (int pass = 0; pass < 4; pass++) {
+		radixPass.source = in;
+		radixPass.dest = out;
+		radixPass.shift = pass * 8;
+
+		R_RunWorkerJobs(numJobs, R_RadixCountJob, nullptr);
+
+		int total = 0;
+		qboolean trivial = qfalse;
+		for (int b = 0; b < 256 && !trivial; b++) {
+			int bucket = 0;
+			for (int j = 0; j < numJobs; j++) {
+				radixPass.index[j][b] = total;
+				total += radixPass.count[j][b];
+				bucket += radixPass.count[j][b];
+			}
+			trivial = static_cast<qboolean>(bucket == size);
+		}
+		if (trivial) {
+			continue;
+		}
+
+		R_RunWorkerJobs(numJobs, R_RadixScatterJob, nullptr);
+
+		drawSurf_t* swap = in;
+		in = out;
+		out = swap;
+	}
+
+	if (in != source) {
+		memcpy(source, in, size * sizeof(drawSurf_t));
+	}
+}
+
 /*
 ===============
-R_Radix
+R_SortRuns
+
+Sorts surfaces that are already made of a few ascending runs by merging
+the runs, returns qfalse if there are too many of them to bother.  The
+merge is stable, so the result is the same as the radix sort's.
 ===============
 */
-static QINLINE void R_Radix(const int byte, const int size, drawSurf_t* source, drawSurf_t* dest)
+static qboolean R_SortRuns(drawSurf_t* source, const int size)
 {
-	int           count[256] = { 0 };
-	int           index[256];
-	int           i;
+	int runs[MAX_COHERENT_RUNS + 1];
+	int numRuns = 1;
+
+	runs[0] = 0;
+	for (int i = 1; i < size; i++) {
+		if (source[i].sort < source[i - 1].sort) {
+			if (numRuns == MAX_COHERENT_RUNS) {
+				return qfalse;
+			}
+			runs[numRuns++] = i;
+		}
+	}
+	runs[numRuns] = size;
+
+	drawSurf_t* in = source;
+	drawSurf_t* out = sortScratch;
+
+	while (numRuns > 1) {
+		int merged = 0;
 
-	unsigned char* sort_key = reinterpret_cast<unsigned char*>(&source[0].sort) + byte;
-	for (const unsigned char* end = sort_key + size * sizeof(drawSurf_t); sort_key < end; sort_key += sizeof(drawSurf_t))
-		++count[*sort_key];
+		for (int r = 0; r < numRuns; r += 2) {
+			const int start = runs[r];
+			const int mid = runs[Q_min(r + 1, numRuns)];
+			const int end = runs[Q_min(r + 2, numRuns)];
+			int a = start, b = mid, o = start;
 
-	index[0] = 0;
+			while (a < mid && b < end) {
+				out[o++] = in[b].sort < in[a].sort ? in[b++] : in[a++];
+			}
+			while (a < mid) {
+				out[o++] = in[a++];
+			}
+			while (b < end) {
+				out[o++] = in[b++];
+			}
+			runs[merged++] = start;
+		}
+		runs[merged] = size;
+		numRuns = merged;
 
-	for (i = 1; i < 256; ++i)
-		index[i] = index[i - 1] + count[i - 1];
+		drawSurf_t* swap = in;
+		in = out;
+		out = swap;
+	}
 
-	sort_key = reinterpret_cast<unsigned char*>(&source[0].sort) + byte;
-	for (i = 0; i < size; ++i, sort_key += sizeof(drawSurf_t))
-		dest[index[*sort_key]++] = source[i];
+	if (in != source) {
+		memcpy(source, in, size * sizeof(drawSurf_t));
+	}
+	return qtrue;
 }
 
 /*
 ===============
 R_RadixSort
+===============
+*/
+static void R_RadixSort(drawSurf_t* source, const int size)
+{
+	if (r_sortCoherence->integer && R_SortRuns(source, size)) {
+		return;
+	}
 
-Radix sort with 4 byte size buckets
+	int numJobs = 1;
+	if (r_parallelSort->integer && size >= PARALLEL_SORT_MIN) {
+		numJobs = Q_min(R_NumWorkers() + 1, MAX_SORT_JOBS);
+	}
+	R_RadixSortJobs(source, size, numJobs);
+}
+
+constexpr int DRAWSURF_KEYS_IDENT = 'D' << 24 | 'S' << 16 | 'K' << 8 | '1';
+
+static qboolean sortRecord;
+
+static void R_RecordDrawSurfKeys(const drawSurf_t* draw_surfs, const int num_draw_surfs)
+{
+	std::vector<unsigned> buffer(num_draw_surfs + 2);
+	char path[MAX_QPATH];
+
+	buffer[0] = DRAWSURF_KEYS_IDENT;
+	buffer[1] = num_draw_surfs;
+	for (int i = 0; i < num_draw_surfs; i++) {
+		buffer[i + 2] = draw_surfs[i].sort;
+	}
+
+	Com_sprintf(path, sizeof path, "drawsurfs/%i.dsk", tr.frameCount);
+	ri.FS_WriteFile(path, buffer.data(), static_cast<int>(buffer.size() * sizeof(unsigned)));
+	ri.Printf(PRINT_ALL, "wrote %d draw surface keys to %s\n", num_draw_surfs, path);
+}
+
+static double R_SortBenchRun(const std::vector<drawSurf_t>& input, std::vector<drawSurf_t>& output, const int mode,
+	const int iterations)
+{
+	const int size = static_cast<int>(input.size());
+	int64_t usec = 0;
+
+	for (int i = 0; i < iterations; i++) {
+		output = input;
+
+		const timingUsec_c timer;
+		if (mode == 0) {
+			R_RadixSortJobs(output.data(), size, 1);
+		}
+		else if (mode == 1) {
+			R_RadixSortJobs(output.data(), size, Q_min(R_NumWorkers() + 1, MAX_SORT_JOBS));
+		}
+		else if (!R_SortRuns(output.data(), size)) {
+			R_RadixSortJobs(output.data(), size, 1);
+		}
+		usec += timer.End();
+	}
+	return static_cast<double>(usec) / iterations;
+}
+
+/*
+===============
+R_SortBench_f
+
+r_sortbench record
+r_sortbench <file> [iterations]
+
+Records the draw surface keys of the next view to drawsurfs/<frame>.dsk,
+or times the ways of sorting a recorded file.
 ===============
 */
-static void R_RadixSort(drawSurf_t* source, int size)
+void R_SortBench_f()
 {
-	static drawSurf_t scratch[MAX_DRAWSURFS];
-#ifdef Q3_LITTLE_ENDIAN
-	R_Radix(0, size, source, scratch);
-	R_Radix(1, size, scratch, source);
-	R_Radix(2, size, source, scratch);
-	R_Radix(3, size, scratch, source);
-#else
-	R_Radix(3, size, source, scratch);
-	R_Radix(2, size, scratch, source);
-	R_Radix(1, size, source, scratch);
-	R_Radix(0, size, scratch, source);
-#endif //Q3_LITTLE_ENDIAN
+	if (ri.Cmd_Argc() < 2) {
+		ri.Printf(PRINT_ALL, "usage: r_sortbench record | <file> [iterations]\n");
+		return;
+	}
+	if (!Q_stricmp(ri.Cmd_Argv(1), "record")) {
+		sortRecord = qtrue;
+		return;
+	}
+
+	unsigned* buffer;
+	const long len = ri.FS_ReadFile(ri.Cmd_Argv(1), reinterpret_cast<void**>(&buffer));
+	if (!buffer) {
+		ri.Printf(PRINT_ALL, "r_sortbench: couldn't load %s\n", ri.Cmd_Argv(1));
+		return;
+	}
+	if (len < static_cast<long>(2 * sizeof(unsigned)) || buffer[0] != static_cast<unsigned>(DRAWSURF_KEYS_IDENT)
+		|| buffer[1] > MAX_DRAWSURFS || len != static_cast<long>((buffer[1] + 2) * sizeof(unsigned))) {
+		ri.Printf(PRINT_ALL, "r_sortbench: %s isn't a draw surface key dump\n", ri.Cmd_Argv(1));
+		ri.FS_FreeFile(buffer);
+		return;
+	}
+
+	// the surface pointers are only there to check the sorts are stable
+	std::vector<drawSurf_t> input(buffer[1]);
+	int runs = input.empty() ? 0 : 1;
+	for (size_t i = 0; i < input.size(); i++) {
+		input[i].sort = buffer[i + 2];
+		input[i].surface = reinterpret_cast<surfaceType_t*>(i + 1);
+		if (i && input[i].sort < input[i - 1].sort) {
+			runs++;
+		}
+	}
+	ri.FS_FreeFile(buffer);
+
+	const int iterations = ri.Cmd_Argc() > 2 ? Com_Clampi(1, 100000, atoi(ri.Cmd_Argv(2))) : 1000;
+	const char* names[] = { "radix", "parallel radix", "coherent" };
+	std::vector<drawSurf_t> reference, output;
+
+	ri.Printf(PRINT_ALL, "r_sortbench: %d draw surfaces in %d ascending runs, %d iterations\n",
+		static_cast<int>(input.size()), runs, iterations);
+	for (int mode = 0; mode < 3; mode++) {
+		const double usec = R_SortBenchRun(input, mode ? output : reference, mode, iterations);
+		const qboolean same = static_cast<qboolean>(!mode || !memcmp(reference.data(), output.data(),
+			input.size() * sizeof(drawSurf_t)));
+
+		ri.Printf(PRINT_ALL, " %-16s %8.1f usec%s\n", names[mode], usec, same ? "" : "  DIFFERENT ORDER");
+	}
+	ri.Printf(PRINT_ALL, " %d worker threads, coherent merges up to %d runs\n", R_NumWorkers(), MAX_COHERENT_RUNS);
 }
 
 //==========================================================================================
@@ -1183,6 +1421,11 @@ void R_SortDrawSurfs(drawSurf_t* draw_surfs, int num_draw_surfs) {
 		num_draw_surfs = MAX_DRAWSURFS;
 	}
 
+	if (sortRecord) {
+		sortRecord = qfalse;
+		R_RecordDrawSurfKeys(draw_surfs, num_draw_surfs);
+	}
+
 	// sort the drawsurfs by sort type, then orientation, then shader
 	R_RadixSort(draw_surfs, num_draw_surfs);
 
@@ -405,6 +405,8 @@ void RE_RegisterMedia_LevelLoadBegin(const char* ps_map_name, const ForceReload_
 		Q_strncpyz(s_prev_map_name, ps_map_name, sizeof s_prev_map_name);
 		giRegisterMedia_CurrentLevel++;
 	}
+
+	R_BeginImageBatch(ps_map_name);
 }
 
 int RE_RegisterMedia_GetLevel()
@@ -414,6 +416,9 @@ int RE_RegisterMedia_GetLevel()
 
 void RE_RegisterMedia_LevelLoadEnd()
 {
+	R_EndImageBatch();
+	R_ShaderLoadReport();
+
 	RE_RegisterModels_LevelLoadEnd(qfalse);
 	RE_RegisterImages_LevelLoadEnd();
 	ri.SND_RegisterAudio_LevelLoadEnd(qfalse);
@@ -49,7 +49,11 @@ R_InitNextFrame
 ====================
 */
 void R_InitNextFrame() {
-	backEndData->commands.used = 0;
+	backEndData[tr.smpFrame]->commands.used = 0;
+	// kept for the whole frame, a sync in the middle of it must not drop
+	// the bones of ghoul2 surfaces still waiting in the command list
+	backEndData[tr.smpFrame]->numGhoul2Bones = 0;
+	backEndData[tr.smpFrame]->ghoul2LiveBones = qfalse;
 
 	r_firstSceneDrawSurf = 0;
 
@@ -138,11 +142,11 @@ void RE_AddPolyToScene(const qhandle_t h_shader, const int num_verts, const poly
 		return;
 	}
 
-	srfPoly_t* poly = &backEndData->polys[r_numpolys];
+	srfPoly_t* poly = &backEndData[tr.smpFrame]->polys[r_numpolys];
 	poly->surfaceType = SF_POLY;
 	poly->h_shader = h_shader;
 	poly->num_verts = num_verts;
-	poly->verts = &backEndData->polyVerts[r_numpolyverts];
+	poly->verts = &backEndData[tr.smpFrame]->polyVerts[r_numpolyverts];
 
 	memcpy(poly->verts, verts, num_verts * sizeof * verts);
 	r_numpolys++;
@@ -215,8 +219,8 @@ void RE_AddRefEntityToScene(const refEntity_t* ent) {
 		Com_Error(ERR_DROP, "RE_AddRefEntityToScene: bad reType %i", ent->reType);
 	}
 
-	backEndData->entities[r_numentities].e = *ent;
-	backEndData->entities[r_numentities].lightingCalculated = qfalse;
+	backEndData[tr.smpFrame]->entities[r_numentities].e = *ent;
+	backEndData[tr.smpFrame]->entities[r_numentities].lightingCalculated = qfalse;
 
 	r_numentities++;
 }
@@ -237,7 +241,7 @@ void RE_AddLightToScene(const vec3_t org, const float intensity, const float r,
 	if (intensity <= 0) {
 		return;
 	}
-	dlight_t* dl = &backEndData->dlights[r_numdlights++];
+	dlight_t* dl = &backEndData[tr.smpFrame]->dlights[r_numdlights++];
 	VectorCopy(org, dl->origin);
 	dl->radius = intensity;
 	dl->color[0] = r;
@@ -338,15 +342,15 @@ void RE_RenderScene(const refdef_t* fd) {
 	tr.refdef.floatTime = tr.refdef.time * 0.001;
 
 	tr.refdef.numDrawSurfs = r_firstSceneDrawSurf;
-	tr.refdef.drawSurfs = backEndData->drawSurfs;
+	tr.refdef.drawSurfs = backEndData[tr.smpFrame]->drawSurfs;
 
 	tr.refdef.num_entities = r_numentities - r_firstSceneEntity;
-	tr.refdef.entities = &backEndData->entities[r_firstSceneEntity];
+	tr.refdef.entities = &backEndData[tr.smpFrame]->entities[r_firstSceneEntity];
 	tr.refdef.num_dlights = r_numdlights - r_firstSceneDlight;
-	tr.refdef.dlights = &backEndData->dlights[r_firstSceneDlight];
+	tr.refdef.dlights = &backEndData[tr.smpFrame]->dlights[r_firstSceneDlight];
 
 	tr.refdef.numPolys = r_numpolys - r_firstScenePoly;
-	tr.refdef.polys = &backEndData->polys[r_firstScenePoly];
+	tr.refdef.polys = &backEndData[tr.smpFrame]->polys[r_firstScenePoly];
 
 	// turn off dynamic lighting globally by clearing all the
 	// dlights if it needs to be disabled or if vertex lighting is enabled
@@ -103,7 +103,8 @@ static void R_DrawStripElements(const int num_indexes, const glIndex_t* indexes,
 			{
 				element(indexes[i + 2]);
 				c_vertexes++;
-				assert(static_cast<int>(indexes[i + 2]) < tess.numVertexes);
+				// static batches index their own vertexes and leave tess empty
+				assert(static_cast<int>(indexes[i + 2]) < (tess.staticBatch ? tess.staticBatch->numVertexes : tess.numVertexes));
 				even = qtrue;
 			}
 			// otherwise we're done with this strip so finish it and start
@@ -227,7 +228,7 @@ void R_BindAnimatedImage(const textureBundle_t* bundle) {
 		return;
 	}
 
-	if ((r_fullbright->integer || tr.refdef.doLAGoggles || tr.refdef.rdflags & RDF_doFullbright) && bundle->isLightmap)
+	if ((r_fullbright->integer || backEnd.refdef.doLAGoggles || backEnd.refdef.rdflags & RDF_doFullbright) && bundle->isLightmap)
 	{
 		GL_Bind(tr.whiteImage);
 		return;
@@ -421,6 +422,8 @@ void RB_BeginSurface(shader_t* shader, const int fog_num)
 	tess.numVertexes = 0;
 	tess.shader = state;//shader;
 	tess.fogNum = fog_num;
+	tess.staticBatch = nullptr;
+	tess.instanceLit = qfalse;
 	tess.dlightBits = 0;		// will be OR'd in by surface functions
 
 	tess.SSInitializedWind = qfalse;	//is this right?
@@ -435,6 +438,132 @@ void RB_BeginSurface(shader_t* shader, const int fog_num)
 	tess.registration++;
 }
 
+/*
+==============
+RB_StaticBatchForRun
+
+Returns the static batch a run of world surfaces can be drawn from, or
+nullptr if something in it has to be worked out per vertex every frame.
+==============
+*/
+const staticBatch_t* RB_StaticBatchForRun(const shader_t* shader, const int fog_num)
+{
+	if (!r_staticBatch->integer || !tr.world || shader->index >= tr.world->numStaticBatches)
+	{
+		return nullptr;
+	}
+
+	const staticBatch_t* batch = tr.world->staticBatches[shader->index];
+
+	// r_primitives 3 reads the tess arrays directly
+	if (!batch || r_showtris->integer || r_shownormals->integer || r_primitives->integer == 3)
+	{
+		return nullptr;
+	}
+
+	if (fog_num)
+	{
+		if (batch->fogAdjust)
+		{
+			return nullptr;
+		}
+		// the fog pass is worked out on the tess vertexes, gl fog can stay
+#ifdef JK2_MODE
+		if (shader->fogPass && r_drawfog->value)
+#else
+		if ((fog_num != tr.world->globalFog || r_drawfog->value != 2) && r_drawfog->value && shader->fogPass)
+#endif
+		{
+			return nullptr;
+		}
+	}
+
+	return batch;
+}
+
+/*
+==============
+RB_AddStaticSurface
+
+Adds the indexes of a surface in the static batch of the current run, the
+vertexes are already in the batch.  Returns qfalse if the surface isn't in it.
+==============
+*/
+qboolean RB_AddStaticSurface(const surfaceType_t* surface)
+{
+	const staticBatch_t* batch = tess.staticBatch;
+	const unsigned int* indexes;
+	int num_indexes, num_vertexes, first_vertex;
+
+	switch (*surface)
+	{
+	case SF_FACE:
+	{
+		const auto* face = reinterpret_cast<const srfSurfaceFace_t*>(surface);
+		if (face->staticBatch != batch)
+		{
+			return qfalse;
+		}
+		indexes = reinterpret_cast<const unsigned int*>(reinterpret_cast<const char*>(face) + face->ofsIndices);
+		num_indexes = face->numIndices;
+		num_vertexes = face->numPoints;
+		first_vertex = face->staticVertex;
+		break;
+	}
+	case SF_TRIANGLES:
+	{
+		const auto* tri = reinterpret_cast<const srfTriangles_t*>(surface);
+		if (tri->staticBatch != batch)
+		{
+			return qfalse;
+		}
+		indexes = reinterpret_cast<const unsigned int*>(tri->indexes);
+		num_indexes = tri->num_indexes;
+		num_vertexes = tri->num_verts;
+		first_vertex = tri->staticVertex;
+		break;
+	}
+	default:
+		return qfalse;
+	}
+
+	if (tess.num_indexes + num_indexes >= SHADER_MAX_INDEXES)
+	{
+		RB_EndSurface();
+		RB_BeginSurface(tess.shader, tess.fogNum);
+		tess.staticBatch = batch;
+	}
+
+	glIndex_t* tess_indexes = tess.indexes + tess.num_indexes;
+	for (int i = 0; i < num_indexes; i++)
+	{
+		tess_indexes[i] = indexes[i] + first_vertex;
+	}
+	tess.num_indexes += num_indexes;
+
+	backEnd.pc.c_staticSurfaces++;
+	backEnd.pc.c_staticVertexes += num_vertexes;
+	return qtrue;
+}
+
+static const color4ub_t* StageColors(const shaderCommands_t* input, const int stage)
+{
+	if (input->staticBatch)
+	{
+		return input->staticBatch->stages[stage].colors;
+	}
+	return input->svars.colors;
+}
+
+static const vec2_t* StageTexCoords(const shaderCommands_t* input, const int stage, const int bundle)
+{
+	if (input->staticBatch)
+	{
+		return input->staticBatch->stages[stage].texcoords[bundle];
+	}
+	return input->svars.texcoords[bundle];
+}
+
 /*
 ===================
 DrawMultitextured
@@ -455,7 +584,7 @@ static void DrawMultitextured(const shaderCommands_t* input, const int stage)
 	// base
 	//
 	GL_SelectTexture(0);
-	qglTexCoordPointer(2, GL_FLOAT, 0, input->svars.texcoords[0]);
+	qglTexCoordPointer(2, GL_FLOAT, 0, StageTexCoords(input, stage, 0));
 	R_BindAnimatedImage(&p_stage->bundle[0]);
 
 	//
@@ -472,7 +601,7 @@ static void DrawMultitextured(const shaderCommands_t* input, const int stage)
 		GL_TexEnv(tess.shader->multitextureEnv);
 	}
 
-	qglTexCoordPointer(2, GL_FLOAT, 0, input->svars.texcoords[1]);
+	qglTexCoordPointer(2, GL_FLOAT, 0, StageTexCoords(input, stage, 1));
 
 	R_BindAnimatedImage(&p_stage->bundle[1]);
 
@@ -1402,7 +1531,14 @@ static void ComputeColors(shaderStage_t* p_stage, alphaGen_t force_alpha_gen, co
 		memset(tess.svars.colors, tr.identityLightByte, tess.numVertexes * 4);
 		break;
 	case CGEN_LIGHTING_DIFFUSE:
-		RB_CalcDiffuseColor(reinterpret_cast<unsigned char*>(tess.svars.colors));
+		if (tess.instanceLit)
+		{
+			memcpy(tess.svars.colors, tess.instanceColors, tess.numVertexes * sizeof tess.instanceColors[0]);
+		}
+		else
+		{
+			RB_CalcDiffuseColor(reinterpret_cast<unsigned char*>(tess.svars.colors));
+		}
 		break;
 	case CGEN_LIGHTING_DIFFUSE_ENTITY:
 		RB_CalcDiffuseEntityColor(reinterpret_cast<unsigned char*>(tess.svars.colors));
@@ -1733,6 +1869,21 @@ static void ComputeTexCoords(shaderStage_t* p_stage)
 	}
 }
 
+/*
+===============
+RB_CalcStaticStageVars
+
+Fills svars for a stage of the static batch being built.
+===============
+*/
+void RB_CalcStaticStageVars(const int stage)
+{
+	shaderStage_t* p_stage = &tess.xstages[stage];
+
+	ComputeColors(p_stage, static_cast<alphaGen_t>(0), static_cast<colorGen_t>(0));
+	ComputeTexCoords(p_stage);
+}
+
 void ForceAlpha(unsigned char* dst_colors, const int tr_force_ent_alpha)
 {
 	dst_colors += 3;
@@ -1897,16 +2048,19 @@ static void RB_IterateStagesGeneric(const shaderCommands_t* input)
 		}
 #endif
 
-		if (!input->fading)
-		{ //this means ignore this, while we do a fade-out
-			ComputeColors(p_stage, force_alpha_gen, force_rgb_gen);
+		if (!input->staticBatch)
+		{ // a static batch has them from when it was built
+			if (!input->fading)
+			{ //this means ignore this, while we do a fade-out
+				ComputeColors(p_stage, force_alpha_gen, force_rgb_gen);
+			}
+			ComputeTexCoords(p_stage);
 		}
-		ComputeTexCoords(p_stage);
 
 		if (!setArraysOnce)
 		{
 			qglEnableClientState(GL_COLOR_ARRAY);
-			qglColorPointer(4, GL_UNSIGNED_BYTE, 0, input->svars.colors);
+			qglColorPointer(4, GL_UNSIGNED_BYTE, 0, StageColors(input, stage));
 		}
 
 		if (p_stage->bundle[0].isLightmap && r_debugStyle->integer >= 0)
@@ -1935,7 +2089,7 @@ static void RB_IterateStagesGeneric(const shaderCommands_t* input)
 
 			if (!setArraysOnce)
 			{
-				qglTexCoordPointer(2, GL_FLOAT, 0, input->svars.texcoords[0]);
+				qglTexCoordPointer(2, GL_FLOAT, 0, StageTexCoords(input, stage, 0));
 			}
 
 			//
@@ -2047,18 +2201,29 @@ void RB_StageIteratorGeneric()
 		setArraysOnce = qtrue;
 
 		qglEnableClientState(GL_COLOR_ARRAY);
-		qglColorPointer(4, GL_UNSIGNED_BYTE, 0, tess.svars.colors);
+		qglColorPointer(4, GL_UNSIGNED_BYTE, 0, StageColors(input, 0));
 
 		qglEnableClientState(GL_TEXTURE_COORD_ARRAY);
-		qglTexCoordPointer(2, GL_FLOAT, 0, tess.svars.texcoords[0]);
+		qglTexCoordPointer(2, GL_FLOAT, 0, StageTexCoords(input, 0, 0));
 	}
 
 	//
 	// lock XYZ
 	//
-	qglVertexPointer(3, GL_FLOAT, 16, input->xyz);	// padded for SIMD
+	// a static batch is only partly drawn, locking all of it would make the
+	// driver transform vertexes nothing uses
+	const qboolean lock_arrays = static_cast<qboolean>(qglLockArraysEXT && !input->staticBatch);
+
+	if (input->staticBatch)
+	{
+		qglVertexPointer(3, GL_FLOAT, 16, input->staticBatch->xyz);
+	}
+	else
+	{
+		qglVertexPointer(3, GL_FLOAT, 16, input->xyz);	// padded for SIMD
+	}
 
-	if (qglLockArraysEXT)
+	if (lock_arrays)
 	{
 		qglLockArraysEXT(0, input->numVertexes);
 		GLimp_LogComment("glLockArraysEXT\n");
@@ -2108,7 +2273,7 @@ void RB_StageIteratorGeneric()
 	//
 	// unlock arrays
 	//
-	if (qglUnlockArraysEXT)
+	if (lock_arrays && qglUnlockArraysEXT)
 	{
 		qglUnlockArraysEXT();
 		GLimp_LogComment("glUnlockArraysEXT\n");
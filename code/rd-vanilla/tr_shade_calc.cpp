@@ -27,6 +27,11 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 #include "tr_local.h"
 #include "../rd-common/tr_common.h"
+#include "../qcommon/timing.h"
+
+#include <random>
+#include <vector>
+
 #define	WAVEVALUE( table, base, amplitude, phase, freq )  ((base) + table[ Q_ftol( ( ( (phase) + backEnd.refdef.floatTime * (freq) ) * FUNCTABLE_SIZE ) ) & FUNCTABLE_MASK ] * (amplitude))
 
 static float* table_for_func(const genFunc_t func)
@@ -124,44 +129,19 @@ RB_CalcDeformVertexes
 */
 void RB_CalcDeformVertexes(const deformStage_t* ds)
 {
-	int i;
-	vec3_t	offset;
-	float	scale;
 	auto* xyz = reinterpret_cast<float*>(tess.xyz);
-	auto* normal = reinterpret_cast<float*>(tess.normal);
+	const auto* normal = reinterpret_cast<const float*>(tess.normal);
 
 	if (ds->deformationWave.frequency == 0)
 	{
-		scale = EvalWaveForm(&ds->deformationWave);
-
-		for (i = 0; i < tess.numVertexes; i++, xyz += 4, normal += 4)
-		{
-			VectorScale(normal, scale, offset);
-
-			xyz[0] += offset[0];
-			xyz[1] += offset[1];
-			xyz[2] += offset[2];
-		}
+		tessKernels->deformNormals(xyz, normal, tess.numVertexes, EvalWaveForm(&ds->deformationWave));
 	}
 	else
 	{
-		const float* table = table_for_func(ds->deformationWave.func);
-
-		for (i = 0; i < tess.numVertexes; i++, xyz += 4, normal += 4)
-		{
-			const float off = (xyz[0] + xyz[1] + xyz[2]) * ds->deformationSpread;
-
-			scale = WAVEVALUE(table, ds->deformationWave.base,
-				ds->deformationWave.amplitude,
-				ds->deformationWave.phase + off,
-				ds->deformationWave.frequency);
-
-			VectorScale(normal, scale, offset);
-
-			xyz[0] += offset[0];
-			xyz[1] += offset[1];
-			xyz[2] += offset[2];
-		}
+		// same as WAVEVALUE with the phase offset by the vertex position
+		tessKernels->deformWave(xyz, normal, tess.numVertexes, table_for_func(ds->deformationWave.func),
+			FUNCTABLE_SIZE, ds->deformationWave.base, ds->deformationWave.amplitude, ds->deformationWave.phase,
+			ds->deformationSpread, backEnd.refdef.floatTime * ds->deformationWave.frequency);
 	}
 }
 
@@ -212,12 +192,7 @@ void RB_CalcBulgeVertexes(const deformStage_t* ds)
 	if (ds->bulgeSpeed == 0.0f && ds->bulgeWidth == 0.0f)
 	{
 		// We don't have a speed and width, so just use height to expand uniformly
-		for (i = 0; i < tess.numVertexes; i++, xyz += 4, normal += 4)
-		{
-			xyz[0] += normal[0] * ds->bulgeHeight;
-			xyz[1] += normal[1] * ds->bulgeHeight;
-			xyz[2] += normal[2] * ds->bulgeHeight;
-		}
+		tessKernels->deformNormals(xyz, normal, tess.numVertexes, ds->bulgeHeight);
 	}
 	else
 	{
@@ -260,10 +235,7 @@ void RB_CalcMoveVertexes(const deformStage_t* ds)
 
 	VectorScale(ds->moveVector, scale, offset);
 
-	auto* xyz = reinterpret_cast<float*>(tess.xyz);
-	for (int i = 0; i < tess.numVertexes; i++, xyz += 4) {
-		VectorAdd(xyz, offset, xyz);
-	}
+	tessKernels->moveVertexes(tess.xyz[0], tess.numVertexes, offset);
 }
 
 /*
@@ -586,16 +558,12 @@ COLORS
 */
 void RB_CalcColorFromEntity(unsigned char* dst_colors)
 {
-	auto* p_colors = reinterpret_cast<int*>(dst_colors);
-
 	if (!backEnd.currentEntity)
 		return;
 
 	const byteAlias_t* ba = reinterpret_cast<byteAlias_t*>(&backEnd.currentEntity->e.shaderRGBA);
 
-	for (int i = 0; i < tess.numVertexes; i++) {
-		*p_colors++ = ba->i;
-	}
+	tessKernels->fillColors(reinterpret_cast<unsigned*>(dst_colors), tess.numVertexes, ba->ui);
 }
 
 /*
@@ -603,7 +571,6 @@ void RB_CalcColorFromEntity(unsigned char* dst_colors)
 */
 void RB_CalcColorFromOneMinusEntity(unsigned char* dst_colors)
 {
-	auto* p_colors = reinterpret_cast<int*>(dst_colors);
 	unsigned char inv_modulate[4];
 
 	if (!backEnd.currentEntity)
@@ -616,9 +583,7 @@ void RB_CalcColorFromOneMinusEntity(unsigned char* dst_colors)
 
 	const byteAlias_t* ba = reinterpret_cast<byteAlias_t*>(&inv_modulate);
 
-	for (int i = 0; i < tess.numVertexes; i++) {
-		*p_colors++ = ba->i;
-	}
+	tessKernels->fillColors(reinterpret_cast<unsigned*>(dst_colors), tess.numVertexes, ba->ui);
 }
 
 /*
@@ -659,7 +624,6 @@ void RB_CalcAlphaFromOneMinusEntity(unsigned char* dst_colors)
 void RB_CalcWaveColor(const waveForm_t* wf, unsigned char* dst_colors)
 {
 	float glow;
-	auto* colors = reinterpret_cast<int*>(dst_colors);
 	byte	color[4];
 
 	if (wf->func == GF_NOISE) {
@@ -682,9 +646,7 @@ void RB_CalcWaveColor(const waveForm_t* wf, unsigned char* dst_colors)
 
 	const byteAlias_t* ba = reinterpret_cast<byteAlias_t*>(&color);
 
-	for (int i = 0; i < tess.numVertexes; i++) {
-		*colors++ = ba->i;
-	}
+	tessKernels->fillColors(reinterpret_cast<unsigned*>(dst_colors), tess.numVertexes, ba->ui);
 }
 
 /*
@@ -780,8 +742,6 @@ doesn't fit our shader data.
 
 void RB_CalcFogTexCoords(float* dst_tex_coords)
 {
-	int			i;
-	float* v;
 	float		eye_t;
 	qboolean	eye_outside;
 	vec3_t		local_vec;
@@ -833,33 +793,8 @@ void RB_CalcFogTexCoords(float* dst_tex_coords)
 	fog_distance_vector[3] += 1.0 / 512;
 
 	// calculate density for each point
-	for (i = 0, v = tess.xyz[0]; i < tess.numVertexes; i++, v += 4) {
-		// calculate the length in fog
-		const float s = DotProduct(v, fog_distance_vector) + fog_distance_vector[3];
-		float t = DotProduct(v, fog_depth_vector) + fog_depth_vector[3];
-
-		// partially clipped fogs use the T axis
-		if (eye_outside) {
-			if (t < 1.0) {
-				t = 1.0 / 32;	// point is outside, so no fogging
-			}
-			else {
-				t = 1.0 / 32 + 30.0 / 32 * t / (t - eye_t);	// cut the distance at the fog plane
-			}
-		}
-		else {
-			if (t < 0) {
-				t = 1.0 / 32;	// point is outside, so no fogging
-			}
-			else {
-				t = 31.0 / 32;
-			}
-		}
-
-		dst_tex_coords[0] = Q_isnan(s) ? 0.0f : s;
-		dst_tex_coords[1] = Q_isnan(s) ? 0.0f : t;
-		dst_tex_coords += 2;
-	}
+	tessKernels->fogTexCoords(tess.xyz[0], tess.numVertexes, fog_distance_vector, fog_depth_vector, eye_t,
+		eye_outside != qfalse, dst_tex_coords);
 }
 
 /*
@@ -867,32 +802,20 @@ void RB_CalcFogTexCoords(float* dst_tex_coords)
 */
 void RB_CalcEnvironmentTexCoords(float* dst_tex_coords)
 {
-	int			i;
-	float		d;
-
-	float* v = tess.xyz[0];
 	float* normal = tess.normal[0];
 
 	if (backEnd.currentEntity && backEnd.currentEntity->e.renderfx & RF_FIRST_PERSON)	//this is a view model so we must use world lights instead of vieworg
 	{
-		for (i = 0; i < tess.numVertexes; i++, v += 4, normal += 4, dst_tex_coords += 2)
+		for (int i = 0; i < tess.numVertexes; i++, normal += 4, dst_tex_coords += 2)
 		{
-			d = DotProduct(normal, backEnd.currentEntity->lightDir);
+			const float d = DotProduct(normal, backEnd.currentEntity->lightDir);
 			dst_tex_coords[0] = normal[0] * d - backEnd.currentEntity->lightDir[0];
 			dst_tex_coords[1] = normal[1] * d - backEnd.currentEntity->lightDir[1];
 		}
 	}
 	else {	//the normal way
-		for (i = 0; i < tess.numVertexes; i++, v += 4, normal += 4, dst_tex_coords += 2)
-		{
-			vec3_t viewer;
-			VectorSubtract(backEnd.ori.viewOrigin, v, viewer);
-			VectorNormalizeFast(viewer);
-
-			d = DotProduct(normal, viewer);
-			dst_tex_coords[0] = normal[0] * d - 0.5 * viewer[0];
-			dst_tex_coords[1] = normal[1] * d - 0.5 * viewer[1];
-		}
+		tessKernels->environmentTexCoords(tess.xyz[0], normal, tess.numVertexes, backEnd.ori.viewOrigin,
+			dst_tex_coords);
 	}
 }
 
@@ -918,11 +841,9 @@ void RB_CalcTurbulentTexCoords(const waveForm_t* wf, float* dst_tex_coords)
 */
 void RB_CalcScaleTexCoords(const float scale[2], float* dst_tex_coords)
 {
-	for (int i = 0; i < tess.numVertexes; i++, dst_tex_coords += 2)
-	{
-		dst_tex_coords[0] *= scale[0];
-		dst_tex_coords[1] *= scale[1];
-	}
+	constexpr float bias[2] = { 0.0f, 0.0f };
+
+	tessKernels->scaleBiasTexCoords(dst_tex_coords, tess.numVertexes, scale, bias);
 }
 
 /*
@@ -940,11 +861,10 @@ void RB_CalcScrollTexCoords(const float scroll_speed[2], float* dst_tex_coords)
 	adjusted_scroll_s = adjusted_scroll_s - floor(adjusted_scroll_s);
 	adjusted_scroll_t = adjusted_scroll_t - floor(adjusted_scroll_t);
 
-	for (int i = 0; i < tess.numVertexes; i++, dst_tex_coords += 2)
-	{
-		dst_tex_coords[0] += adjusted_scroll_s;
-		dst_tex_coords[1] += adjusted_scroll_t;
-	}
+	constexpr float scale[2] = { 1.0f, 1.0f };
+	const float bias[2] = { adjusted_scroll_s, adjusted_scroll_t };
+
+	tessKernels->scaleBiasTexCoords(dst_tex_coords, tess.numVertexes, scale, bias);
 }
 
 /*
@@ -952,14 +872,7 @@ void RB_CalcScrollTexCoords(const float scroll_speed[2], float* dst_tex_coords)
 */
 void RB_CalcTransformTexCoords(const texModInfo_t* tmi, float* dst_tex_coords)
 {
-	for (int i = 0; i < tess.numVertexes; i++, dst_tex_coords += 2)
-	{
-		const float s = dst_tex_coords[0];
-		const float t = dst_tex_coords[1];
-
-		dst_tex_coords[0] = s * tmi->matrix[0][0] + t * tmi->matrix[1][0] + tmi->translate[0];
-		dst_tex_coords[1] = s * tmi->matrix[0][1] + t * tmi->matrix[1][1] + tmi->translate[1];
-	}
+	tessKernels->transformTexCoords(dst_tex_coords, tess.numVertexes, tmi->matrix, tmi->translate);
 }
 
 void RB_CalcRotateTexCoords(const float degs_per_second, float* dst_tex_coords)
@@ -1050,6 +963,16 @@ void RB_CalcSpecularAlpha(unsigned char* alphas)
 ** The basic vertex lighting calc
 */
 void RB_CalcDiffuseColor(unsigned char* colors)
+{
+	RB_CalcDiffuseColorRange(colors, 0, tess.numVertexes);
+}
+
+/*
+** RB_CalcDiffuseColorRange
+**
+** Lights count vertexes from first on with the current entity
+*/
+void RB_CalcDiffuseColorRange(unsigned char* colors, const int first, const int count)
 {
 	vec3_t			ambient_light;
 	vec3_t			light_dir;
@@ -1061,12 +984,12 @@ void RB_CalcDiffuseColor(unsigned char* colors)
 	VectorCopy(ent->directedLight, directed_light);
 	VectorCopy(ent->lightDir, light_dir);
 
-	float* v = tess.xyz[0];
-	float* normal = tess.normal[0];
+	float* v = tess.xyz[first];
+	float* normal = tess.normal[first];
 
-	const int num_vertexes = tess.numVertexes;
+	const int num_vertexes = first + count;
 
-	for (int i = 0; i < num_vertexes; i++, v += 4, normal += 4)
+	for (int i = first; i < num_vertexes; i++, v += 4, normal += 4)
 	{
 		const float incoming = DotProduct(normal, light_dir);
 		if (incoming <= 0) {
@@ -1309,4 +1232,196 @@ void RB_CalcDisintegrateVertDeform()
 			}
 		}
 	}
-}
\ No newline at end of file
+}
+
+/*
+====================================================================
+
+VERTEX KERNELS
+
+====================================================================
+*/
+
+const tessKernels_t* tessKernels;
+
+/*
+=================
+R_InitSimdKernels
+
+r_simd -1 picks the widest kernels the cpu can run.
+=================
+*/
+void R_InitSimdKernels()
+{
+	const simdLevel_t supported = R_SimdSupported();
+	simdLevel_t level = supported;
+
+	if (r_simd->integer >= 0 && r_simd->integer < level)
+	{
+		level = static_cast<simdLevel_t>(r_simd->integer);
+	}
+	tessKernels = R_TessKernels(level);
+	imageKernels = R_ImageKernels(level);
+
+	ri.Printf(PRINT_DEVELOPER, "Using %s vertex kernels (%s supported)\n", tessKernels->name,
+		R_TessKernels(supported)->name);
+}
+
+enum
+{
+	SIMD_BENCH_DEFORM_NORMALS,
+	SIMD_BENCH_DEFORM_WAVE,
+	SIMD_BENCH_MOVE_VERTEXES,
+	SIMD_BENCH_ENVIRONMENT,
+	SIMD_BENCH_FOG,
+	SIMD_BENCH_SCALE_BIAS,
+	SIMD_BENCH_TRANSFORM,
+	SIMD_BENCH_FILL_COLORS,
+	NUM_SIMD_BENCH_KERNELS
+};
+
+using simdBenchBuffers_t = struct simdBenchBuffers_s
+{
+	std::vector<float> xyz;
+	std::vector<float> normal;
+	std::vector<float> st;
+	std::vector<unsigned> colors;
+};
+
+static void R_SimdBenchKernel(const tessKernels_t* kernels, const int kernel, simdBenchBuffers_t& b, const int count)
+{
+	// constants that keep the buffers bounded however many times they run
+	constexpr vec3_t offset = { 0.25f, -0.25f, 0.125f };
+	constexpr vec3_t view_origin = { 100.0f, -250.0f, 64.0f };
+	constexpr vec4_t fog_distance = { 0.001f, -0.002f, 0.0005f, 0.25f };
+	constexpr vec4_t fog_depth = { 0.0f, 0.0f, 0.004f, -1.0f };
+	constexpr float scale[2] = { 0.5f, 0.5f };
+	constexpr float bias[2] = { 0.25f, 0.25f };
+	constexpr float matrix[2][2] = { { 0.8f, -0.6f }, { 0.6f, 0.8f } };
+	constexpr float translate[2] = { 0.1f, 0.4f };
+
+	switch (kernel)
+	{
+	case SIMD_BENCH_DEFORM_NORMALS:
+		kernels->deformNormals(b.xyz.data(), b.normal.data(), count, 0.5f);
+		break;
+	case SIMD_BENCH_DEFORM_WAVE:
+		kernels->deformWave(b.xyz.data(), b.normal.data(), count, tr.sinTable, FUNCTABLE_SIZE, 0.0f, 0.5f, 0.25f,
+			0.01f, 17.5f);
+		break;
+	case SIMD_BENCH_MOVE_VERTEXES:
+		kernels->moveVertexes(b.xyz.data(), count, offset);
+		break;
+	case SIMD_BENCH_ENVIRONMENT:
+		kernels->environmentTexCoords(b.xyz.data(), b.normal.data(), count, view_origin, b.st.data());
+		break;
+	case SIMD_BENCH_FOG:
+		kernels->fogTexCoords(b.xyz.data(), count, fog_distance, fog_depth, -3.0f, true, b.st.data());
+		break;
+	case SIMD_BENCH_SCALE_BIAS:
+		kernels->scaleBiasTexCoords(b.st.data(), count, scale, bias);
+		break;
+	case SIMD_BENCH_TRANSFORM:
+		kernels->transformTexCoords(b.st.data(), count, matrix, translate);
+		break;
+	case SIMD_BENCH_FILL_COLORS:
+		kernels->fillColors(b.colors.data(), count, 0xff8040c0);
+		break;
+	default:
+		break;
+	}
+}
+
+/*
+=================
+R_SimdBench_f
+
+Runs every vertex kernel at every level the cpu supports on random vertexes,
+checks the results against the scalar kernels and prints the throughput.
+=================
+*/
+void R_SimdBench_f()
+{
+	const int count = ri.Cmd_Argc() > 1 ? Com_Clampi(1, 1 << 20, atoi(ri.Cmd_Argv(1))) : SHADER_MAX_VERTEXES;
+	const int iterations = ri.Cmd_Argc() > 2 ? Com_Clampi(1, 100000, atoi(ri.Cmd_Argv(2))) : 1000;
+	const char* names[NUM_SIMD_BENCH_KERNELS] = {
+		"deformNormals", "deformWave", "moveVertexes", "environment", "fog", "scaleBias", "transform", "fillColors"
+	};
+	const int num_levels = R_SimdSupported() + 1;
+	simdBenchBuffers_t input;
+
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> position(-4096.0f, 4096.0f);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	input.xyz.resize(count * 4);
+	input.normal.resize(count * 4);
+	input.st.resize(count * 2);
+	input.colors.resize(count);
+	for (int i = 0; i < count; i++)
+	{
+		vec3_t normal = { unit(rng), unit(rng), unit(rng) };
+		VectorNormalize(normal);
+		for (int j = 0; j < 3; j++)
+		{
+			input.xyz[i * 4 + j] = position(rng);
+			input.normal[i * 4 + j] = normal[j];
+		}
+		input.xyz[i * 4 + 3] = 1.0f;
+		input.normal[i * 4 + 3] = 0.0f;
+		input.st[i * 2] = unit(rng);
+		input.st[i * 2 + 1] = unit(rng);
+	}
+
+	ri.Printf(PRINT_ALL, "r_simdbench: %d vertexes, %d iterations, million vertexes per second\n", count, iterations);
+	ri.Printf(PRINT_ALL, " %-14s", "");
+	for (int level = 0; level < num_levels; level++)
+	{
+		ri.Printf(PRINT_ALL, " %10s", R_TessKernels(static_cast<simdLevel_t>(level))->name);
+	}
+	ri.Printf(PRINT_ALL, "\n");
+
+	int mismatches = 0;
+	for (int kernel = 0; kernel < NUM_SIMD_BENCH_KERNELS; kernel++)
+	{
+		simdBenchBuffers_t reference;
+
+		ri.Printf(PRINT_ALL, " %-14s", names[kernel]);
+		for (int level = 0; level < num_levels; level++)
+		{
+			const tessKernels_t* kernels = R_TessKernels(static_cast<simdLevel_t>(level));
+			simdBenchBuffers_t b = input;
+
+			// one pass from the same input to compare with the scalar kernel
+			R_SimdBenchKernel(kernels, kernel, b, count);
+			bool same = true;
+			if (!level)
+			{
+				reference = b;
+			}
+			else
+			{
+				same = !memcmp(b.xyz.data(), reference.xyz.data(), b.xyz.size() * sizeof(float))
+					&& !memcmp(b.st.data(), reference.st.data(), b.st.size() * sizeof(float))
+					&& b.colors == reference.colors;
+				mismatches += !same;
+			}
+
+			const timingUsec_c timer;
+			for (int i = 0; i < iterations; i++)
+			{
+				R_SimdBenchKernel(kernels, kernel, b, count);
+			}
+			const double seconds = timer.End() / 1e6;
+
+			ri.Printf(PRINT_ALL, " %9.1f%c", static_cast<double>(count) * iterations / Q_max(seconds, 1e-9) / 1e6,
+				same ? ' ' : '*');
+		}
+		ri.Printf(PRINT_ALL, "\n");
+	}
+	if (mismatches)
+	{
+		ri.Printf(PRINT_WARNING, "r_simdbench: %d results marked * differ from the scalar kernels\n", mismatches);
+	}
+	ri.Printf(PRINT_ALL, " rendering with the %s kernels (r_simd %d)\n", tessKernels->name, r_simd->integer);
+}
@@ -28,6 +28,13 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "tr_local.h"
 #include "tr_stl.h"
 
+#include "../qcommon/timing.h"
+
+#include <zlib.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 // tr_shader.c -- this file deals with the parsing and definition of shaders
 
 static char* s_shaderText;
@@ -2580,7 +2587,7 @@ sortedIndex.
 extern bool inServer;
 static void FixRenderCommandList(int newShader) {
 	if (!inServer) {
-		renderCommandList_t* cmdList = &backEndData->commands;
+		renderCommandList_t* cmdList = &backEndData[tr.smpFrame]->commands;
 
 		if (cmdList) {
 			const void* curCmd = cmdList->cmds;
@@ -3241,6 +3248,118 @@ static const char* FindShaderInShaderText(const char* shadername) {
 #endif
 }
 
+/*
+====================================================================
+
+PARSED SHADERS
+
+The same shader text is asked for with every lightmap and style it is used
+with, so what ParseShader makes of it is kept by name until the next
+R_InitShaders, and later variants are a copy instead of another parse.  Only
+$lightmap stages depend on the lightmap, they are pointed at the new one.
+
+====================================================================
+*/
+
+using parsedShader_t = struct parsedShader_s
+{
+	shader_t shader;
+	std::vector<shaderStage_t> stages;	// up to the last active one
+	std::vector<texModInfo_t> texMods;	// TR_MAX_TEXMODS for each of them
+};
+
+static std::unordered_map<std::string, parsedShader_t> parsedShaders;
+
+static struct
+{
+	int numParsed;
+	int numCopied;
+	int64_t parseUsec;
+	int64_t initUsec;
+	const char* initSource;
+} shaderStats;
+
+static std::string ParsedShaderKey(const char* name)
+{
+	char lower[MAX_QPATH];
+
+	Q_strncpyz(lower, name, sizeof lower);
+	Q_strlwr(lower);
+	return lower;
+}
+
+// keep the global shader as ParseShader left it
+//
+static void SaveParsedShader(const char* name, const qboolean parsedOk)
+{
+	parsedShader_t& parsed = parsedShaders[ParsedShaderKey(name)];
+	int numStages = MAX_SHADER_STAGES;
+
+	if (parsedOk)
+	{
+		while (numStages > 0 && !stages[numStages - 1].active)
+		{
+			numStages--;
+		}
+	}
+
+	parsed.shader = shader;
+	parsed.stages.assign(stages, stages + numStages);
+	parsed.texMods.assign(texMods[0], texMods[0] + numStages * TR_MAX_TEXMODS);
+}
+
+// back into the global shader, for the lightmap and styles already in it
+//
+static qboolean LoadParsedShader(const char* name)
+{
+	const auto it = parsedShaders.find(ParsedShaderKey(name));
+
+	if (it == parsedShaders.end())
+	{
+		return qfalse;
+	}
+
+	const parsedShader_t& parsed = it->second;
+	int lightmapIndex[MAXLIGHTMAPS];
+	byte styles[MAXLIGHTMAPS];
+
+	memcpy(lightmapIndex, shader.lightmapIndex, sizeof lightmapIndex);
+	memcpy(styles, shader.styles, sizeof styles);
+
+	shader = parsed.shader;
+	Q_strncpyz(shader.name, name, sizeof shader.name);
+	memcpy(shader.lightmapIndex, lightmapIndex, sizeof shader.lightmapIndex);
+	memcpy(shader.styles, styles, sizeof shader.styles);
+
+	for (size_t i = 0; i < parsed.stages.size(); i++)
+	{
+		stages[i] = parsed.stages[i];
+		memcpy(texMods[i], &parsed.texMods[i * TR_MAX_TEXMODS], sizeof texMods[i]);
+
+		// same as ParseStage does for $lightmap
+		if (stages[i].bundle[0].isLightmap)
+		{
+			stages[i].bundle[0].image = shader.lightmapIndex[0] < 0 ? tr.whiteImage : tr.lightmaps[shader.lightmapIndex[0]];
+		}
+	}
+
+	return qtrue;
+}
+
+/*
+====================
+R_ShaderLoadReport
+
+Where the shader time went since R_InitShaders.
+====================
+*/
+void R_ShaderLoadReport()
+{
+	ri.Printf(PRINT_ALL, "shaders: %.1f ms loading the shader files (%s), %d parsed and %d copied in %.1f ms\n",
+		shaderStats.initUsec / 1000.0, shaderStats.initSource, shaderStats.numParsed, shaderStats.numCopied,
+		shaderStats.parseUsec / 1000.0);
+}
+
 inline qboolean IsShader(const shader_t* sh, const char* name, const int* lightmap_index, const byte* styles)
 {
 	if (Q_stricmp(sh->name, name))
@@ -3390,12 +3509,25 @@ shader_t* R_FindShader(const char* name, const int* lightmap_index, const byte*
 	//
 	// attempt to define shader from an explicit parameter file
 	//
+	const timingUsec_c timer;
+	if (r_shaderCache->integer && LoadParsedShader(stripped_name)) {
+		shaderStats.numCopied++;
+		shaderStats.parseUsec += timer.End();
+		return FinishShader();
+	}
+
 	shader_text = FindShaderInShaderText(stripped_name);
 	if (shader_text) {
-		if (!ParseShader(&shader_text)) {
+		const qboolean parsed_ok = ParseShader(&shader_text);
+		if (!parsed_ok) {
 			// had errors, so use default shader
 			shader.defaultShader = true;
 		}
+		if (r_shaderCache->integer) {
+			SaveParsedShader(stripped_name, parsed_ok);
+		}
+		shaderStats.numParsed++;
+		shaderStats.parseUsec += timer.End();
 		sh = FinishShader();
 		return sh;
 	}
@@ -3653,6 +3785,188 @@ static void SetupShaderEntryPtrs()
 }
 #endif
 
+/*
+====================================================================
+
+SHADER DATABASE
+
+All the .shader text compressed into one block, with the name index into it.
+It outlives the hunk, so a level load with the same shader files reuses it,
+and with r_shaderCache it is also kept in shadercache.bin under fs_homepath
+to skip the scan of the whole text at startup.
+
+====================================================================
+*/
+
+#define SHADER_CACHE_IDENT	(('B'<<24)+('D'<<16)+('H'<<8)+'S')
+constexpr int SHADER_CACHE_VERSION = 1;
+#define SHADER_CACHE_FILE	"shadercache.bin"
+
+using shaderCacheHeader_t = struct shaderCacheHeader_s
+{
+	int ident;
+	int version;
+	unsigned key;
+	int textLength;		// with the terminating 0
+	int numEntries;
+	// followed by the text, then an offset and a 0 terminated name for each entry
+};
+
+static struct
+{
+	std::vector<char> text;
+	unsigned key;
+	bool valid;
+} shaderDatabase;
+
+/*
+====================
+ShaderFilesKey
+
+Names and sizes of the shader files, in the order they are combined.  A file
+in a pk3 adds the checksum of the pk3, files that aren't in one are the ones
+being worked on, so their contents count instead.
+====================
+*/
+static unsigned ShaderFilesKey(char** shader_files, const int num_shader_files)
+{
+	unsigned key = crc32(0L, nullptr, 0);
+
+	for (int i = 0; i < num_shader_files; i++)
+	{
+		char filename[MAX_QPATH];
+
+		Com_sprintf(filename, sizeof filename, "shaders/%s", shader_files[i]);
+		key = crc32(key, reinterpret_cast<const Bytef*>(filename), strlen(filename) + 1);
+
+		const int length = static_cast<int>(ri.FS_ReadFile(filename, nullptr));
+		key = crc32(key, reinterpret_cast<const Bytef*>(&length), sizeof length);
+
+		if (length <= 0)
+		{
+			continue;
+		}
+
+		int pak_checksum = 0;
+		if (ri.FS_FileIsInPAK(filename, &pak_checksum) == 1)
+		{
+			key = crc32(key, reinterpret_cast<const Bytef*>(&pak_checksum), sizeof pak_checksum);
+		}
+		else
+		{
+			void* buffer;
+
+			ri.FS_ReadFile(filename, &buffer);
+			if (buffer)
+			{
+				key = crc32(key, static_cast<const Bytef*>(buffer), length);
+				ri.FS_FreeFile(buffer);
+			}
+		}
+	}
+
+	return key;
+}
+
+static void AppendShaderCacheEntry(const char* token, const char* p, void* data)
+{
+	auto& out = *static_cast<std::vector<char>*>(data);
+	const int offset = static_cast<int>(p - s_shaderText);
+	const auto bytes = reinterpret_cast<const char*>(&offset);
+
+	out.insert(out.end(), bytes, bytes + sizeof offset);
+	out.insert(out.end(), token, token + strlen(token) + 1);
+}
+
+static void WriteShaderCache()
+{
+	shaderCacheHeader_t header;
+	std::vector<char> out(sizeof header);
+
+	ShaderEntryPtrs_ForEach(AppendShaderCacheEntry, &out);
+
+	header.ident = SHADER_CACHE_IDENT;
+	header.version = SHADER_CACHE_VERSION;
+	header.key = shaderDatabase.key;
+	header.textLength = static_cast<int>(shaderDatabase.text.size());
+	header.numEntries = ShaderEntryPtrs_Size();
+	memcpy(out.data(), &header, sizeof header);
+	out.insert(out.begin() + sizeof header, shaderDatabase.text.begin(), shaderDatabase.text.end());
+
+	ri.FS_WriteFile(SHADER_CACHE_FILE, out.data(), static_cast<int>(out.size()));
+}
+
+static qboolean ReadShaderCache(const unsigned key)
+{
+	char* buffer;
+	shaderCacheHeader_t header;
+
+	const int length = static_cast<int>(ri.FS_ReadFile(SHADER_CACHE_FILE, reinterpret_cast<void**>(&buffer)));
+	if (!buffer)
+	{
+		return qfalse;
+	}
+
+	if (length < static_cast<int>(sizeof header))
+	{
+		ri.FS_FreeFile(buffer);
+		return qfalse;
+	}
+
+	memcpy(&header, buffer, sizeof header);
+	if (header.ident != SHADER_CACHE_IDENT || header.version != SHADER_CACHE_VERSION || header.key != key ||
+		header.textLength < 1 || header.textLength > length - static_cast<int>(sizeof header) ||
+		buffer[sizeof header + header.textLength - 1])
+	{
+		ri.FS_FreeFile(buffer);
+		return qfalse;
+	}
+
+	const char* p = buffer + sizeof header;
+	const char* end = buffer + length;
+
+	shaderDatabase.text.assign(p, p + header.textLength);
+	s_shaderText = shaderDatabase.text.data();
+	p += header.textLength;
+
+	int i;
+	for (i = 0; i < header.numEntries; i++)
+	{
+		int offset;
+
+		if (end - p < static_cast<int>(sizeof offset) + 1)
+		{
+			break;
+		}
+		memcpy(&offset, p, sizeof offset);
+		p += sizeof offset;
+
+		const char* name = p;
+		while (p < end && *p)
+		{
+			p++;
+		}
+		if (p == end || offset < 0 || offset >= header.textLength)
+		{
+			break;
+		}
+		p++;
+
+		ShaderEntryPtrs_Insert(name, s_shaderText + offset);
+	}
+
+	ri.FS_FreeFile(buffer);
+
+	if (i != header.numEntries)
+	{
+		ri.Printf(PRINT_WARNING, "WARNING: %s is damaged, scanning the shader files again\n", SHADER_CACHE_FILE);
+		ShaderEntryPtrs_Clear();
+		return qfalse;
+	}
+
+	return qtrue;
+}
+
 /*
 ====================
 ScanAndLoadShaderFiles
@@ -3682,6 +3996,30 @@ static void ScanAndLoadShaderFiles()
 		num_shader_files = MAX_SHADER_FILES;
 	}
 
+	if (r_shaderCache->integer)
+	{
+		const unsigned key = ShaderFilesKey(shader_files, num_shader_files);
+
+		// same files as the last level
+		if (shaderDatabase.valid && shaderDatabase.key == key && ShaderEntryPtrs_Size())
+		{
+			s_shaderText = shaderDatabase.text.data();
+			shaderStats.initSource = "reused";
+			ri.FS_FreeFileList(shader_files);
+			return;
+		}
+
+		ShaderEntryPtrs_Clear();
+		shaderDatabase.key = key;
+		shaderDatabase.valid = ReadShaderCache(key) != qfalse;
+		if (shaderDatabase.valid)
+		{
+			shaderStats.initSource = "read from " SHADER_CACHE_FILE;
+			ri.FS_FreeFileList(shader_files);
+			return;
+		}
+	}
+
 	// load and store shader files
 	for (i = 0; i < num_shader_files; i++)
 	{
@@ -3699,7 +4037,8 @@ static void ScanAndLoadShaderFiles()
 	}
 
 	// build single large buffer
-	s_shaderText = static_cast<char*>(R_Hunk_Alloc(sum + num_shader_files * 2, qtrue));
+	shaderDatabase.text.resize(sum + num_shader_files * 2);
+	s_shaderText = shaderDatabase.text.data();
 	s_shaderText[0] = '\0';
 	char* text_end = s_shaderText;
 
@@ -3716,6 +4055,8 @@ static void ScanAndLoadShaderFiles()
 	}
 
 	COM_Compress(s_shaderText);
+	shaderDatabase.text.resize(strlen(s_shaderText) + 1);
+	s_shaderText = shaderDatabase.text.data();
 
 	// free up memory
 	ri.FS_FreeFileList(shader_files);
@@ -3723,6 +4064,13 @@ static void ScanAndLoadShaderFiles()
 #ifdef USE_STL_FOR_SHADER_LOOKUPS
 	SetupShaderEntryPtrs();
 #endif
+
+	shaderStats.initSource = "scanned";
+	shaderDatabase.valid = r_shaderCache->integer != 0;
+	if (shaderDatabase.valid)
+	{
+		WriteShaderCache();
+	}
 }
 
 /*
@@ -3780,6 +4128,10 @@ void R_InitShaders() {
 	//ri.Printf( PRINT_ALL, "Initializing Shaders\n" );
 
 	memset(sh_hashTable, 0, sizeof sh_hashTable);
+
+	// they point at images and hunk memory from the last level
+	parsedShaders.clear();
+	memset(&shaderStats, 0, sizeof shaderStats);
 	/*
 	Ghoul2 Insert Start
 	*/
@@ -3791,7 +4143,9 @@ void R_InitShaders() {
 
 	CreateInternalShaders();
 
+	const timingUsec_c timer;
 	ScanAndLoadShaderFiles();
+	shaderStats.initUsec = timer.End();
 
 	CreateExternalShaders();
 }
\ No newline at end of file
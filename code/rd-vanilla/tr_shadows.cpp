@@ -198,7 +198,7 @@ void RB_ShadowTessEnd()
 	dlight_t* dl;
 
 	R_TransformDlights(backEnd.refdef.num_dlights, backEnd.refdef.dlights, &backEnd.ori);
-	dl = &tr.refdef.dlights[0];
+	dl = &backEnd.refdef.dlights[0];
 
 	RB_DoShadowTessEnd(dl->transformed);
 
@@ -601,14 +601,14 @@ void RB_DistortionFill()
 	}
 	else
 	{ //do slow stretchy effect
-		spost = sin(tr.refdef.time * 0.0005f);
+		spost = sin(backEnd.refdef.time * 0.0005f);
 		if (spost < 0.0f)
 		{
 			spost = -spost;
 		}
 		spost *= 0.2f;
 
-		spost2 = sin(tr.refdef.time * 0.0005f);
+		spost2 = sin(backEnd.refdef.time * 0.0005f);
 		if (spost2 < 0.0f)
 		{
 			spost2 = -spost2;
@@ -653,14 +653,14 @@ void RB_DistortionFill()
 			GL_State(GLS_SRCBLEND_SRC_ALPHA | GLS_DSTBLEND_SRC_ALPHA);
 		}
 
-		spost = sin(tr.refdef.time * 0.0008f);
+		spost = sin(backEnd.refdef.time * 0.0008f);
 		if (spost < 0.0f)
 		{
 			spost = -spost;
 		}
 		spost *= 0.08f;
 
-		spost2 = sin(tr.refdef.time * 0.0008f);
+		spost2 = sin(backEnd.refdef.time * 0.0008f);
 		if (spost2 < 0.0f)
 		{
 			spost2 = -spost2;
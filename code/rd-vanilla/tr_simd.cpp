@@ -0,0 +1,976 @@
+/*
+===========================================================================
+Copyright (C) 2013 - 2015, OpenJK contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+// tr_simd.cpp -- scalar, SSE2 and AVX2 versions of the tess vertex kernels.
+// This file doesn't depend on the rest of the renderer so the unit tests can
+// build it on its own.  The wide versions hand their leftover vertexes down to
+// the next narrower one.
+
+#include "tr_simd.h"
+
+#include <cstring>
+#include <vector>
+
+#ifdef SIMD_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef SIMD_HAVE_AVX2
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SIMD_TARGET_AVX2
+#else
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+/*
+====================================================================
+
+SCALAR REFERENCE
+
+====================================================================
+*/
+
+// Q_rsqrt, the renderer normalizes the environment map viewer with it
+static float SIMD_RSqrt(const float number)
+{
+	int i;
+	float y;
+	const float x2 = number * 0.5f;
+
+	memcpy(&i, &number, sizeof i);
+	i = 0x5f3759df - (i >> 1);
+	memcpy(&y, &i, sizeof y);
+	return y * (1.5f - x2 * y * y);
+}
+
+static void DeformNormals_Scalar(float* xyz, const float* normal, const int count, const float scale)
+{
+	for (int i = 0; i < count; i++, xyz += 4, normal += 4)
+	{
+		xyz[0] += normal[0] * scale;
+		xyz[1] += normal[1] * scale;
+		xyz[2] += normal[2] * scale;
+	}
+}
+
+static void DeformWave_Scalar(float* xyz, const float* normal, const int count, const float* table,
+	const int tableSize, const float base, const float amplitude, const float phase, const float spread,
+	const float timeFreq)
+{
+	const float size = static_cast<float>(tableSize);
+
+	for (int i = 0; i < count; i++, xyz += 4, normal += 4)
+	{
+		const float off = (xyz[0] + xyz[1] + xyz[2]) * spread;
+		const int index = static_cast<int>((phase + off + timeFreq) * size) & (tableSize - 1);
+		const float scale = base + table[index] * amplitude;
+
+		xyz[0] += normal[0] * scale;
+		xyz[1] += normal[1] * scale;
+		xyz[2] += normal[2] * scale;
+	}
+}
+
+static void MoveVertexes_Scalar(float* xyz, const int count, const float offset[3])
+{
+	for (int i = 0; i < count; i++, xyz += 4)
+	{
+		xyz[0] += offset[0];
+		xyz[1] += offset[1];
+		xyz[2] += offset[2];
+	}
+}
+
+static void EnvironmentTexCoords_Scalar(const float* xyz, const float* normal, const int count,
+	const float viewOrigin[3], float* st)
+{
+	for (int i = 0; i < count; i++, xyz += 4, normal += 4, st += 2)
+	{
+		float viewer[3];
+
+		viewer[0] = viewOrigin[0] - xyz[0];
+		viewer[1] = viewOrigin[1] - xyz[1];
+		viewer[2] = viewOrigin[2] - xyz[2];
+
+		const float ilength = SIMD_RSqrt(viewer[0] * viewer[0] + viewer[1] * viewer[1] + viewer[2] * viewer[2]);
+		viewer[0] *= ilength;
+		viewer[1] *= ilength;
+		viewer[2] *= ilength;
+
+		const float d = normal[0] * viewer[0] + normal[1] * viewer[1] + normal[2] * viewer[2];
+		st[0] = normal[0] * d - 0.5f * viewer[0];
+		st[1] = normal[1] * d - 0.5f * viewer[1];
+	}
+}
+
+static void FogTexCoords_Scalar(const float* xyz, const int count, const float distance[4], const float depth[4],
+	const float eyeT, const bool eyeOutside, float* st)
+{
+	for (int i = 0; i < count; i++, xyz += 4, st += 2)
+	{
+		const float s = xyz[0] * distance[0] + xyz[1] * distance[1] + xyz[2] * distance[2] + distance[3];
+		float t = xyz[0] * depth[0] + xyz[1] * depth[1] + xyz[2] * depth[2] + depth[3];
+
+		// partially clipped fogs use the T axis
+		if (eyeOutside)
+		{
+			// points outside get no fog, the rest are cut at the fog plane
+			t = t < 1.0f ? 1.0f / 32 : 1.0f / 32 + 30.0f / 32 * t / (t - eyeT);
+		}
+		else
+		{
+			t = t < 0.0f ? 1.0f / 32 : 31.0f / 32;
+		}
+
+		if (s != s)
+		{
+			st[0] = st[1] = 0.0f;
+		}
+		else
+		{
+			st[0] = s;
+			st[1] = t;
+		}
+	}
+}
+
+static void ScaleBiasTexCoords_Scalar(float* st, const int count, const float scale[2], const float bias[2])
+{
+	for (int i = 0; i < count; i++, st += 2)
+	{
+		st[0] = st[0] * scale[0] + bias[0];
+		st[1] = st[1] * scale[1] + bias[1];
+	}
+}
+
+static void TransformTexCoords_Scalar(float* st, const int count, const float matrix[2][2], const float translate[2])
+{
+	for (int i = 0; i < count; i++, st += 2)
+	{
+		const float s = st[0];
+		const float t = st[1];
+
+		st[0] = s * matrix[0][0] + t * matrix[1][0] + translate[0];
+		st[1] = s * matrix[0][1] + t * matrix[1][1] + translate[1];
+	}
+}
+
+static void FillColors_Scalar(unsigned* colors, const int count, const unsigned color)
+{
+	for (int i = 0; i < count; i++)
+	{
+		colors[i] = color;
+	}
+}
+
+static const tessKernels_t scalarKernels = {
+	"scalar",
+	DeformNormals_Scalar,
+	DeformWave_Scalar,
+	MoveVertexes_Scalar,
+	EnvironmentTexCoords_Scalar,
+	FogTexCoords_Scalar,
+	ScaleBiasTexCoords_Scalar,
+	TransformTexCoords_Scalar,
+	FillColors_Scalar,
+};
+
+/*
+====================================================================
+
+SSE2
+
+Four vertexes at a time, positions and normals are transposed so each
+register holds one axis.
+
+====================================================================
+*/
+
+#ifdef SIMD_HAVE_SSE2
+
+static inline __m128 SIMD_RSqrt_SSE2(const __m128 number)
+{
+	const __m128 x2 = _mm_mul_ps(number, _mm_set1_ps(0.5f));
+	const __m128i i = _mm_sub_epi32(_mm_set1_epi32(0x5f3759df), _mm_srai_epi32(_mm_castps_si128(number), 1));
+	const __m128 y = _mm_castsi128_ps(i);
+
+	return _mm_mul_ps(y, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_mul_ps(x2, y), y)));
+}
+
+static inline __m128 SIMD_Select_SSE2(const __m128 mask, const __m128 a, const __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static void DeformNormals_SSE2(float* xyz, const float* normal, const int count, const float scale)
+{
+	const __m128 mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+	const __m128 s = _mm_set1_ps(scale);
+	int i;
+
+	for (i = 0; i < count; i++, xyz += 4, normal += 4)
+	{
+		const __m128 n = _mm_and_ps(_mm_loadu_ps(normal), mask);
+		_mm_storeu_ps(xyz, _mm_add_ps(_mm_loadu_ps(xyz), _mm_mul_ps(n, s)));
+	}
+}
+
+static void DeformWave_SSE2(float* xyz, const float* normal, const int count, const float* table,
+	const int tableSize, const float base, const float amplitude, const float phase, const float spread,
+	const float timeFreq)
+{
+	const __m128 vSpread = _mm_set1_ps(spread);
+	const __m128 vPhase = _mm_set1_ps(phase);
+	const __m128 vTimeFreq = _mm_set1_ps(timeFreq);
+	const __m128 vSize = _mm_set1_ps(static_cast<float>(tableSize));
+	const __m128i vMask = _mm_set1_epi32(tableSize - 1);
+	const __m128 vBase = _mm_set1_ps(base);
+	const __m128 vAmplitude = _mm_set1_ps(amplitude);
+	int i;
+
+	for (i = 0; i + 4 <= count; i += 4, xyz += 16, normal += 16)
+	{
+		__m128 x = _mm_loadu_ps(xyz), y = _mm_loadu_ps(xyz + 4), z = _mm_loadu_ps(xyz + 8), w = _mm_loadu_ps(xyz + 12);
+		__m128 nx = _mm_loadu_ps(normal), ny = _mm_loadu_ps(normal + 4), nz = _mm_loadu_ps(normal + 8),
+			nw = _mm_loadu_ps(normal + 12);
+		alignas(16) int index[4];
+		alignas(16) float value[4];
+
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+		_MM_TRANSPOSE4_PS(nx, ny, nz, nw);
+
+		const __m128 off = _mm_mul_ps(_mm_add_ps(_mm_add_ps(x, y), z), vSpread);
+		const __m128 f = _mm_mul_ps(_mm_add_ps(_mm_add_ps(vPhase, off), vTimeFreq), vSize);
+		_mm_store_si128(reinterpret_cast<__m128i*>(index), _mm_and_si128(_mm_cvttps_epi32(f), vMask));
+		value[0] = table[index[0]];
+		value[1] = table[index[1]];
+		value[2] = table[index[2]];
+		value[3] = table[index[3]];
+
+		const __m128 scale = _mm_add_ps(vBase, _mm_mul_ps(_mm_load_ps(value), vAmplitude));
+		x = _mm_add_ps(x, _mm_mul_ps(nx, scale));
+		y = _mm_add_ps(y, _mm_mul_ps(ny, scale));
+		z = _mm_add_ps(z, _mm_mul_ps(nz, scale));
+
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+		_mm_storeu_ps(xyz, x);
+		_mm_storeu_ps(xyz + 4, y);
+		_mm_storeu_ps(xyz + 8, z);
+		_mm_storeu_ps(xyz + 12, w);
+	}
+	DeformWave_Scalar(xyz, normal, count - i, table, tableSize, base, amplitude, phase, spread, timeFreq);
+}
+
+static void MoveVertexes_SSE2(float* xyz, const int count, const float offset[3])
+{
+	const __m128 o = _mm_set_ps(0.0f, offset[2], offset[1], offset[0]);
+
+	for (int i = 0; i < count; i++, xyz += 4)
+	{
+		_mm_storeu_ps(xyz, _mm_add_ps(_mm_loadu_ps(xyz), o));
+	}
+}
+
+static void EnvironmentTexCoords_SSE2(const float* xyz, const float* normal, const int count,
+	const float viewOrigin[3], float* st)
+{
+	const __m128 ox = _mm_set1_ps(viewOrigin[0]);
+	const __m128 oy = _mm_set1_ps(viewOrigin[1]);
+	const __m128 oz = _mm_set1_ps(viewOrigin[2]);
+	const __m128 half = _mm_set1_ps(0.5f);
+	int i;
+
+	for (i = 0; i + 4 <= count; i += 4, xyz += 16, normal += 16, st += 8)
+	{
+		__m128 x = _mm_loadu_ps(xyz), y = _mm_loadu_ps(xyz + 4), z = _mm_loadu_ps(xyz + 8), w = _mm_loadu_ps(xyz + 12);
+		__m128 nx = _mm_loadu_ps(normal), ny = _mm_loadu_ps(normal + 4), nz = _mm_loadu_ps(normal + 8),
+			nw = _mm_loadu_ps(normal + 12);
+
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+		_MM_TRANSPOSE4_PS(nx, ny, nz, nw);
+
+		__m128 vx = _mm_sub_ps(ox, x);
+		__m128 vy = _mm_sub_ps(oy, y);
+		__m128 vz = _mm_sub_ps(oz, z);
+		const __m128 ilength = SIMD_RSqrt_SSE2(
+			_mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz)));
+		vx = _mm_mul_ps(vx, ilength);
+		vy = _mm_mul_ps(vy, ilength);
+		vz = _mm_mul_ps(vz, ilength);
+
+		const __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, vx), _mm_mul_ps(ny, vy)), _mm_mul_ps(nz, vz));
+		const __m128 s = _mm_sub_ps(_mm_mul_ps(nx, d), _mm_mul_ps(half, vx));
+		const __m128 t = _mm_sub_ps(_mm_mul_ps(ny, d), _mm_mul_ps(half, vy));
+
+		_mm_storeu_ps(st, _mm_unpacklo_ps(s, t));
+		_mm_storeu_ps(st + 4, _mm_unpackhi_ps(s, t));
+	}
+	EnvironmentTexCoords_Scalar(xyz, normal, count - i, viewOrigin, st);
+}
+
+static void FogTexCoords_SSE2(const float* xyz, const int count, const float distance[4], const float depth[4],
+	const float eyeT, const bool eyeOutside, float* st)
+{
+	const __m128 d0 = _mm_set1_ps(distance[0]), d1 = _mm_set1_ps(distance[1]), d2 = _mm_set1_ps(distance[2]),
+		d3 = _mm_set1_ps(distance[3]);
+	const __m128 p0 = _mm_set1_ps(depth[0]), p1 = _mm_set1_ps(depth[1]), p2 = _mm_set1_ps(depth[2]),
+		p3 = _mm_set1_ps(depth[3]);
+	const __m128 vEyeT = _mm_set1_ps(eyeT);
+	const __m128 outside = _mm_set1_ps(1.0f / 32);
+	int i;
+
+	for (i = 0; i + 4 <= count; i += 4, xyz += 16, st += 8)
+	{
+		__m128 x = _mm_loadu_ps(xyz), y = _mm_loadu_ps(xyz + 4), z = _mm_loadu_ps(xyz + 8), w = _mm_loadu_ps(xyz + 12);
+
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+
+		__m128 s = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, d0), _mm_mul_ps(y, d1)), _mm_mul_ps(z, d2)), d3);
+		__m128 t = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, p0), _mm_mul_ps(y, p1)), _mm_mul_ps(z, p2)), p3);
+
+		if (eyeOutside)
+		{
+			const __m128 cut = _mm_add_ps(outside,
+				_mm_div_ps(_mm_mul_ps(_mm_set1_ps(30.0f / 32), t), _mm_sub_ps(t, vEyeT)));
+			t = SIMD_Select_SSE2(_mm_cmplt_ps(t, _mm_set1_ps(1.0f)), outside, cut);
+		}
+		else
+		{
+			t = SIMD_Select_SSE2(_mm_cmplt_ps(t, _mm_setzero_ps()), outside, _mm_set1_ps(31.0f / 32));
+		}
+
+		const __m128 valid = _mm_cmpord_ps(s, s);
+		s = _mm_and_ps(s, valid);
+		t = _mm_and_ps(t, valid);
+
+		_mm_storeu_ps(st, _mm_unpacklo_ps(s, t));
+		_mm_storeu_ps(st + 4, _mm_unpackhi_ps(s, t));
+	}
+	FogTexCoords_Scalar(xyz, count - i, distance, depth, eyeT, eyeOutside, st);
+}
+
+static void ScaleBiasTexCoords_SSE2(float* st, const int count, const float scale[2], const float bias[2])
+{
+	const __m128 vScale = _mm_set_ps(scale[1], scale[0], scale[1], scale[0]);
+	const __m128 vBias = _mm_set_ps(bias[1], bias[0], bias[1], bias[0]);
+	int i;
+
+	for (i = 0; i + 2 <= count; i += 2, st += 4)
+	{
+		_mm_storeu_ps(st, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(st), vScale), vBias));
+	}
+	ScaleBiasTexCoords_Scalar(st, count - i, scale, bias);
+}
+
+static void TransformTexCoords_SSE2(float* st, const int count, const float matrix[2][2], const float translate[2])
+{
+	const __m128 m0 = _mm_set_ps(matrix[0][1], matrix[0][0], matrix[0][1], matrix[0][0]);
+	const __m128 m1 = _mm_set_ps(matrix[1][1], matrix[1][0], matrix[1][1], matrix[1][0]);
+	const __m128 tr = _mm_set_ps(translate[1], translate[0], translate[1], translate[0]);
+	int i;
+
+	for (i = 0; i + 2 <= count; i += 2, st += 4)
+	{
+		const __m128 v = _mm_loadu_ps(st);
+		const __m128 s = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 0, 0));
+		const __m128 t = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 1, 1));
+
+		_mm_storeu_ps(st, _mm_add_ps(_mm_add_ps(_mm_mul_ps(s, m0), _mm_mul_ps(t, m1)), tr));
+	}
+	TransformTexCoords_Scalar(st, count - i, matrix, translate);
+}
+
+static void FillColors_SSE2(unsigned* colors, const int count, const unsigned color)
+{
+	const __m128i c = _mm_set1_epi32(static_cast<int>(color));
+	int i;
+
+	for (i = 0; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(colors + i), c);
+	}
+	FillColors_Scalar(colors + i, count - i, color);
+}
+
+static const tessKernels_t sse2Kernels = {
+	"SSE2",
+	DeformNormals_SSE2,
+	DeformWave_SSE2,
+	MoveVertexes_SSE2,
+	EnvironmentTexCoords_SSE2,
+	FogTexCoords_SSE2,
+	ScaleBiasTexCoords_SSE2,
+	TransformTexCoords_SSE2,
+	FillColors_SSE2,
+};
+
+#endif // SIMD_HAVE_SSE2
+
+/*
+====================================================================
+
+AVX2
+
+Eight vertexes at a time.  Vertexes n and n + 4 share a register, so after
+the in-lane transpose each register holds one axis of all eight in order.
+
+====================================================================
+*/
+
+#ifdef SIMD_HAVE_AVX2
+
+SIMD_TARGET_AVX2 static inline __m256 SIMD_LoadPair_AVX2(const float* v)
+{
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(v)), _mm_loadu_ps(v + 16), 1);
+}
+
+SIMD_TARGET_AVX2 static inline void SIMD_StorePair_AVX2(float* v, const __m256 r)
+{
+	_mm_storeu_ps(v, _mm256_castps256_ps128(r));
+	_mm_storeu_ps(v + 16, _mm256_extractf128_ps(r, 1));
+}
+
+SIMD_TARGET_AVX2 static inline void SIMD_Transpose_AVX2(__m256& r0, __m256& r1, __m256& r2, __m256& r3)
+{
+	const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+	const __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+	const __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+	const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+
+	r0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+	r1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+	r2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+	r3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+SIMD_TARGET_AVX2 static inline void SIMD_LoadVertexes_AVX2(const float* v, __m256& x, __m256& y, __m256& z,
+	__m256& w)
+{
+	x = SIMD_LoadPair_AVX2(v);
+	y = SIMD_LoadPair_AVX2(v + 4);
+	z = SIMD_LoadPair_AVX2(v + 8);
+	w = SIMD_LoadPair_AVX2(v + 12);
+	SIMD_Transpose_AVX2(x, y, z, w);
+}
+
+// s and t in vertex order to 8 interleaved texcoords
+SIMD_TARGET_AVX2 static inline void SIMD_StoreTexCoords_AVX2(float* st, const __m256 s, const __m256 t)
+{
+	const __m256 lo = _mm256_unpacklo_ps(s, t);
+	const __m256 hi = _mm256_unpackhi_ps(s, t);
+
+	_mm256_storeu_ps(st, _mm256_permute2f128_ps(lo, hi, 0x20));
+	_mm256_storeu_ps(st + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+}
+
+SIMD_TARGET_AVX2 static inline __m256 SIMD_RSqrt_AVX2(const __m256 number)
+{
+	const __m256 x2 = _mm256_mul_ps(number, _mm256_set1_ps(0.5f));
+	const __m256i i = _mm256_sub_epi32(_mm256_set1_epi32(0x5f3759df),
+		_mm256_srai_epi32(_mm256_castps_si256(number), 1));
+	const __m256 y = _mm256_castsi256_ps(i);
+
+	return _mm256_mul_ps(y, _mm256_sub_ps(_mm256_set1_ps(1.5f), _mm256_mul_ps(_mm256_mul_ps(x2, y), y)));
+}
+
+SIMD_TARGET_AVX2 static void DeformNormals_AVX2(float* xyz, const float* normal, const int count, const float scale)
+{
+	const __m256 mask = _mm256_castsi256_ps(_mm256_set_epi32(0, -1, -1, -1, 0, -1, -1, -1));
+	const __m256 s = _mm256_set1_ps(scale);
+	int i;
+
+	for (i = 0; i + 2 <= count; i += 2, xyz += 8, normal += 8)
+	{
+		const __m256 n = _mm256_and_ps(_mm256_loadu_ps(normal), mask);
+		_mm256_storeu_ps(xyz, _mm256_add_ps(_mm256_loadu_ps(xyz), _mm256_mul_ps(n, s)));
+	}
+	DeformNormals_SSE2(xyz, normal, count - i, scale);
+}
+
+SIMD_TARGET_AVX2 static void DeformWave_AVX2(float* xyz, const float* normal, const int count, const float* table,
+	const int tableSize, const float base, const float amplitude, const float phase, const float spread,
+	const float timeFreq)
+{
+	const __m256 vSpread = _mm256_set1_ps(spread);
+	const __m256 vPhase = _mm256_set1_ps(phase);
+	const __m256 vTimeFreq = _mm256_set1_ps(timeFreq);
+	const __m256 vSize = _mm256_set1_ps(static_cast<float>(tableSize));
+	const __m256i vMask = _mm256_set1_epi32(tableSize - 1);
+	const __m256 vBase = _mm256_set1_ps(base);
+	const __m256 vAmplitude = _mm256_set1_ps(amplitude);
+	int i;
+
+	for (i = 0; i + 8 <= count; i += 8, xyz += 32, normal += 32)
+	{
+		__m256 x, y, z, w, nx, ny, nz, nw;
+
+		SIMD_LoadVertexes_AVX2(xyz, x, y, z, w);
+		SIMD_LoadVertexes_AVX2(normal, nx, ny, nz, nw);
+
+		const __m256 off = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(x, y), z), vSpread);
+		const __m256 f = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(vPhase, off), vTimeFreq), vSize);
+		const __m256i index = _mm256_and_si256(_mm256_cvttps_epi32(f), vMask);
+		const __m256 scale = _mm256_add_ps(vBase, _mm256_mul_ps(_mm256_i32gather_ps(table, index, 4), vAmplitude));
+
+		x = _mm256_add_ps(x, _mm256_mul_ps(nx, scale));
+		y = _mm256_add_ps(y, _mm256_mul_ps(ny, scale));
+		z = _mm256_add_ps(z, _mm256_mul_ps(nz, scale));
+
+		SIMD_Transpose_AVX2(x, y, z, w);
+		SIMD_StorePair_AVX2(xyz, x);
+		SIMD_StorePair_AVX2(xyz + 4, y);
+		SIMD_StorePair_AVX2(xyz + 8, z);
+		SIMD_StorePair_AVX2(xyz + 12, w);
+	}
+	DeformWave_SSE2(xyz, normal, count - i, table, tableSize, base, amplitude, phase, spread, timeFreq);
+}
+
+SIMD_TARGET_AVX2 static void MoveVertexes_AVX2(float* xyz, const int count, const float offset[3])
+{
+	const __m256 o = _mm256_set_ps(0.0f, offset[2], offset[1], offset[0], 0.0f, offset[2], offset[1], offset[0]);
+	int i;
+
+	for (i = 0; i + 2 <= count; i += 2, xyz += 8)
+	{
+		_mm256_storeu_ps(xyz, _mm256_add_ps(_mm256_loadu_ps(xyz), o));
+	}
+	MoveVertexes_SSE2(xyz, count - i, offset);
+}
+
+SIMD_TARGET_AVX2 static void EnvironmentTexCoords_AVX2(const float* xyz, const float* normal, const int count,
+	const float viewOrigin[3], float* st)
+{
+	const __m256 ox = _mm256_set1_ps(viewOrigin[0]);
+	const __m256 oy = _mm256_set1_ps(viewOrigin[1]);
+	const __m256 oz = _mm256_set1_ps(viewOrigin[2]);
+	const __m256 half = _mm256_set1_ps(0.5f);
+	int i;
+
+	for (i = 0; i + 8 <= count; i += 8, xyz += 32, normal += 32, st += 16)
+	{
+		__m256 x, y, z, w, nx, ny, nz, nw;
+
+		SIMD_LoadVertexes_AVX2(xyz, x, y, z, w);
+		SIMD_LoadVertexes_AVX2(normal, nx, ny, nz, nw);
+
+		__m256 vx = _mm256_sub_ps(ox, x);
+		__m256 vy = _mm256_sub_ps(oy, y);
+		__m256 vz = _mm256_sub_ps(oz, z);
+		const __m256 ilength = SIMD_RSqrt_AVX2(
+			_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(vx, vx), _mm256_mul_ps(vy, vy)), _mm256_mul_ps(vz, vz)));
+		vx = _mm256_mul_ps(vx, ilength);
+		vy = _mm256_mul_ps(vy, ilength);
+		vz = _mm256_mul_ps(vz, ilength);
+
+		const __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, vx), _mm256_mul_ps(ny, vy)),
+			_mm256_mul_ps(nz, vz));
+		const __m256 s = _mm256_sub_ps(_mm256_mul_ps(nx, d), _mm256_mul_ps(half, vx));
+		const __m256 t = _mm256_sub_ps(_mm256_mul_ps(ny, d), _mm256_mul_ps(half, vy));
+
+		SIMD_StoreTexCoords_AVX2(st, s, t);
+	}
+	EnvironmentTexCoords_SSE2(xyz, normal, count - i, viewOrigin, st);
+}
+
+SIMD_TARGET_AVX2 static void FogTexCoords_AVX2(const float* xyz, const int count, const float distance[4],
+	const float depth[4], const float eyeT, const bool eyeOutside, float* st)
+{
+	const __m256 d0 = _mm256_set1_ps(distance[0]), d1 = _mm256_set1_ps(distance[1]),
+		d2 = _mm256_set1_ps(distance[2]), d3 = _mm256_set1_ps(distance[3]);
+	const __m256 p0 = _mm256_set1_ps(depth[0]), p1 = _mm256_set1_ps(depth[1]), p2 = _mm256_set1_ps(depth[2]),
+		p3 = _mm256_set1_ps(depth[3]);
+	const __m256 vEyeT = _mm256_set1_ps(eyeT);
+	const __m256 outside = _mm256_set1_ps(1.0f / 32);
+	int i;
+
+	for (i = 0; i + 8 <= count; i += 8, xyz += 32, st += 16)
+	{
+		__m256 x, y, z, w;
+
+		SIMD_LoadVertexes_AVX2(xyz, x, y, z, w);
+
+		__m256 s = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, d0), _mm256_mul_ps(y, d1)),
+			_mm256_mul_ps(z, d2)), d3);
+		__m256 t = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, p0), _mm256_mul_ps(y, p1)),
+			_mm256_mul_ps(z, p2)), p3);
+
+		if (eyeOutside)
+		{
+			const __m256 cut = _mm256_add_ps(outside,
+				_mm256_div_ps(_mm256_mul_ps(_mm256_set1_ps(30.0f / 32), t), _mm256_sub_ps(t, vEyeT)));
+			t = _mm256_blendv_ps(cut, outside, _mm256_cmp_ps(t, _mm256_set1_ps(1.0f), _CMP_LT_OQ));
+		}
+		else
+		{
+			t = _mm256_blendv_ps(_mm256_set1_ps(31.0f / 32), outside,
+				_mm256_cmp_ps(t, _mm256_setzero_ps(), _CMP_LT_OQ));
+		}
+
+		const __m256 valid = _mm256_cmp_ps(s, s, _CMP_ORD_Q);
+		s = _mm256_and_ps(s, valid);
+		t = _mm256_and_ps(t, valid);
+
+		SIMD_StoreTexCoords_AVX2(st, s, t);
+	}
+	FogTexCoords_SSE2(xyz, count - i, distance, depth, eyeT, eyeOutside, st);
+}
+
+SIMD_TARGET_AVX2 static void ScaleBiasTexCoords_AVX2(float* st, const int count, const float scale[2],
+	const float bias[2])
+{
+	const __m256 vScale = _mm256_set_ps(scale[1], scale[0], scale[1], scale[0], scale[1], scale[0], scale[1], scale[0]);
+	const __m256 vBias = _mm256_set_ps(bias[1], bias[0], bias[1], bias[0], bias[1], bias[0], bias[1], bias[0]);
+	int i;
+
+	for (i = 0; i + 4 <= count; i += 4, st += 8)
+	{
+		_mm256_storeu_ps(st, _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(st), vScale), vBias));
+	}
+	ScaleBiasTexCoords_SSE2(st, count - i, scale, bias);
+}
+
+SIMD_TARGET_AVX2 static void TransformTexCoords_AVX2(float* st, const int count, const float matrix[2][2],
+	const float translate[2])
+{
+	const __m256 m0 = _mm256_set_ps(matrix[0][1], matrix[0][0], matrix[0][1], matrix[0][0], matrix[0][1],
+		matrix[0][0], matrix[0][1], matrix[0][0]);
+	const __m256 m1 = _mm256_set_ps(matrix[1][1], matrix[1][0], matrix[1][1], matrix[1][0], matrix[1][1],
+		matrix[1][0], matrix[1][1], matrix[1][0]);
+	const __m256 tr = _mm256_set_ps(translate[1], translate[0], translate[1], translate[0], translate[1],
+		translate[0], translate[1], translate[0]);
+	int i;
+
+	for (i = 0; i + 4 <= count; i += 4, st += 8)
+	{
+		const __m256 v = _mm256_loadu_ps(st);
+		const __m256 s = _mm256_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 0, 0));
+		const __m256 t = _mm256_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 1, 1));
+
+		_mm256_storeu_ps(st, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(s, m0), _mm256_mul_ps(t, m1)), tr));
+	}
+	TransformTexCoords_SSE2(st, count - i, matrix, translate);
+}
+
+SIMD_TARGET_AVX2 static void FillColors_AVX2(unsigned* colors, const int count, const unsigned color)
+{
+	const __m256i c = _mm256_set1_epi32(static_cast<int>(color));
+	int i;
+
+	for (i = 0; i + 8 <= count; i += 8)
+	{
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(colors + i), c);
+	}
+	FillColors_SSE2(colors + i, count - i, color);
+}
+
+static const tessKernels_t avx2Kernels = {
+	"AVX2",
+	DeformNormals_AVX2,
+	DeformWave_AVX2,
+	MoveVertexes_AVX2,
+	EnvironmentTexCoords_AVX2,
+	FogTexCoords_AVX2,
+	ScaleBiasTexCoords_AVX2,
+	TransformTexCoords_AVX2,
+	FillColors_AVX2,
+};
+
+static bool SIMD_CpuHasAVX2()
+{
+#if defined(_MSC_VER)
+	int info[4];
+
+	__cpuid(info, 0);
+	if (info[0] < 7)
+	{
+		return false;
+	}
+
+	// the os has to save the ymm registers too
+	__cpuid(info, 1);
+	const int osxsave = 1 << 27, avx = 1 << 28;
+	if ((info[2] & (osxsave | avx)) != (osxsave | avx) || (_xgetbv(0) & 6) != 6)
+	{
+		return false;
+	}
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & 1 << 5) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif // SIMD_HAVE_AVX2
+
+/*
+====================================================================
+
+IMAGE KERNELS
+
+Mip levels of 32 bit RGBA images.  The sums stay in 16 bits and the SSE2
+versions divide the same way as the scalar ones, so every level gives the
+same bytes.
+
+====================================================================
+*/
+
+static void MipMapBox_Scalar(const unsigned char* in, unsigned char* out, int width, int height)
+{
+	const int row = width * 4;
+
+	width >>= 1;
+	height >>= 1;
+
+	if (width == 0 || height == 0)
+	{
+		width += height;	// get largest
+		for (int i = 0; i < width; i++, out += 4, in += 8)
+		{
+			out[0] = (in[0] + in[4]) >> 1;
+			out[1] = (in[1] + in[5]) >> 1;
+			out[2] = (in[2] + in[6]) >> 1;
+			out[3] = (in[3] + in[7]) >> 1;
+		}
+		return;
+	}
+
+	for (int i = 0; i < height; i++, in += row)
+	{
+		for (int j = 0; j < width; j++, out += 4, in += 8)
+		{
+			out[0] = (in[0] + in[4] + in[row + 0] + in[row + 4]) >> 2;
+			out[1] = (in[1] + in[5] + in[row + 1] + in[row + 5]) >> 2;
+			out[2] = (in[2] + in[6] + in[row + 2] + in[row + 6]) >> 2;
+			out[3] = (in[3] + in[7] + in[row + 3] + in[row + 7]) >> 2;
+		}
+	}
+}
+
+static void MipMapFilter_Scalar(const unsigned char* in, unsigned char* out, const int width, const int height)
+{
+	const int outWidth = width >> 1;
+	const int outHeight = height >> 1;
+	const int widthMask = width - 1;
+	const int heightMask = height - 1;
+	static const int weights[4] = { 1, 2, 2, 1 };
+
+	if (outWidth == 0 || outHeight == 0)
+	{
+		memmove(out, in, (outWidth + outHeight) * 4);
+		return;
+	}
+
+	for (int i = 0; i < outHeight; i++)
+	{
+		for (int j = 0; j < outWidth; j++, out += 4)
+		{
+			for (int k = 0; k < 4; k++)
+			{
+				int total = 0;
+
+				for (int y = 0; y < 4; y++)
+				{
+					const unsigned char* row = in + ((i * 2 - 1 + y) & heightMask) * width * 4;
+
+					for (int x = 0; x < 4; x++)
+					{
+						total += weights[y] * weights[x] * row[((j * 2 - 1 + x) & widthMask) * 4 + k];
+					}
+				}
+				out[k] = total / 36;
+			}
+		}
+	}
+}
+
+static const imageKernels_t scalarImageKernels = {
+	"scalar",
+	MipMapBox_Scalar,
+	MipMapFilter_Scalar,
+};
+
+#ifdef SIMD_HAVE_SSE2
+
+// four output pixels from two rows of eight
+static void MipMapBox_SSE2(const unsigned char* in, unsigned char* out, const int width, const int height)
+{
+	const int row = width * 4;
+	const int outWidth = width >> 1;
+	const int outHeight = height >> 1;
+
+	if (outWidth < 4 || outWidth & 3 || outHeight == 0)
+	{
+		MipMapBox_Scalar(in, out, width, height);
+		return;
+	}
+
+	const __m128i zero = _mm_setzero_si128();
+
+	for (int i = 0; i < outHeight; i++, in += row * 2)
+	{
+		for (int j = 0; j < outWidth; j += 4, out += 16)
+		{
+			__m128i sum[2];
+
+			for (int h = 0; h < 2; h++)
+			{
+				const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + j * 8 + h * 16));
+				const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + row + j * 8 + h * 16));
+				const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+				const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+
+				// lo and hi hold the column sums of two pixel pairs each
+				sum[h] = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi)), 2);
+			}
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(sum[0], sum[1]));
+		}
+	}
+}
+
+// Sums the four rows of each column first into a row of 16 bit totals with
+// one wrapped column on each side, then weights four columns at a time for
+// each pair of output pixels.  total / 36 is (total >> 2) / 9, which mulhi by
+// 7282 gets exactly for everything below 32768.
+static void MipMapFilter_SSE2(const unsigned char* in, unsigned char* out, const int width, const int height)
+{
+	const int outWidth = width >> 1;
+	const int outHeight = height >> 1;
+	const int heightMask = height - 1;
+
+	if (width < 4 || width & 3 || outHeight == 0)
+	{
+		MipMapFilter_Scalar(in, out, width, height);
+		return;
+	}
+
+	std::vector<unsigned short> columns((width + 2) * 4);
+	unsigned short* total = columns.data() + 4;
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i ninth = _mm_set1_epi16(7282);
+
+	for (int i = 0; i < outHeight; i++)
+	{
+		const unsigned char* r0 = in + ((i * 2 - 1) & heightMask) * width * 4;
+		const unsigned char* r1 = in + ((i * 2) & heightMask) * width * 4;
+		const unsigned char* r2 = in + ((i * 2 + 1) & heightMask) * width * 4;
+		const unsigned char* r3 = in + ((i * 2 + 2) & heightMask) * width * 4;
+
+		for (int x = 0; x < width * 4; x += 16)
+		{
+			const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r0 + x));
+			const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r1 + x));
+			const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r2 + x));
+			const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r3 + x));
+			const __m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(d, zero)),
+				_mm_slli_epi16(_mm_add_epi16(_mm_unpacklo_epi8(b, zero), _mm_unpacklo_epi8(c, zero)), 1));
+			const __m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(d, zero)),
+				_mm_slli_epi16(_mm_add_epi16(_mm_unpackhi_epi8(b, zero), _mm_unpackhi_epi8(c, zero)), 1));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(total + x), lo);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(total + x + 8), hi);
+		}
+		memcpy(total - 4, total + (width - 1) * 4, 4 * sizeof(unsigned short));
+		memcpy(total + width * 4, total, 4 * sizeof(unsigned short));
+
+		for (int j = 0; j < outWidth; j += 2, out += 8)
+		{
+			// columns 2j - 1 to 2j + 4, two to a register
+			const __m128i c0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(total + (j * 2 - 1) * 4));
+			const __m128i c1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(total + (j * 2 + 1) * 4));
+			const __m128i c2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(total + (j * 2 + 3) * 4));
+			const __m128i outer = _mm_add_epi16(_mm_unpacklo_epi64(c0, c1), _mm_unpackhi_epi64(c1, c2));
+			const __m128i inner = _mm_add_epi16(_mm_unpackhi_epi64(c0, c1), _mm_unpacklo_epi64(c1, c2));
+			const __m128i sum = _mm_add_epi16(outer, _mm_slli_epi16(inner, 1));
+			const __m128i pixels = _mm_mulhi_epu16(_mm_srli_epi16(sum, 2), ninth);
+
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(pixels, pixels));
+		}
+	}
+}
+
+static const imageKernels_t sse2ImageKernels = {
+	"SSE2",
+	MipMapBox_SSE2,
+	MipMapFilter_SSE2,
+};
+
+#endif // SIMD_HAVE_SSE2
+
+simdLevel_t R_SimdSupported()
+{
+#if defined(SIMD_HAVE_AVX2)
+	static const bool hasAVX2 = SIMD_CpuHasAVX2();
+	return hasAVX2 ? SIMD_AVX2 : SIMD_SSE2;
+#elif defined(SIMD_HAVE_SSE2)
+	return SIMD_SSE2;
+#else
+	return SIMD_SCALAR;
+#endif
+}
+
+const tessKernels_t* R_TessKernels(const simdLevel_t level)
+{
+	if (level > R_SimdSupported())
+	{
+		return nullptr;
+	}
+
+	switch (level)
+	{
+	case SIMD_SCALAR:
+		return &scalarKernels;
+#ifdef SIMD_HAVE_SSE2
+	case SIMD_SSE2:
+		return &sse2Kernels;
+#endif
+#ifdef SIMD_HAVE_AVX2
+	case SIMD_AVX2:
+		return &avx2Kernels;
+#endif
+	default:
+		return nullptr;
+	}
+}
+
+const imageKernels_t* R_ImageKernels(const simdLevel_t level)
+{
+	if (level > R_SimdSupported())
+	{
+		return nullptr;
+	}
+
+	switch (level)
+	{
+	case SIMD_SCALAR:
+		return &scalarImageKernels;
+#ifdef SIMD_HAVE_SSE2
+	case SIMD_SSE2:
+	case SIMD_AVX2:
+		return &sse2ImageKernels;
+#endif
+	default:
+		return nullptr;
+	}
+}
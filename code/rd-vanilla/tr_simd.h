@@ -0,0 +1,95 @@
+/*
+===========================================================================
+Copyright (C) 2013 - 2015, OpenJK contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+// tr_simd.h -- vertex kernels for the shader deforms and the color and texcoord
+// generators.  They work on plain arrays laid out like the tess buffers, so
+// positions and normals are 4 floats per vertex and texcoords are 2.  Every
+// kernel has a scalar reference, the SSE2 and AVX2 versions do the same float
+// math in the same order and give the same results.  The image kernels build
+// mip levels out of 32 bit RGBA pixels and give the same bytes at every level.
+#pragma once
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86_FP) && _M_IX86_FP >= 2
+#define SIMD_HAVE_SSE2
+#if defined(__GNUC__) || defined(_MSC_VER) && _MSC_VER >= 1800
+#define SIMD_HAVE_AVX2
+#endif
+#endif
+
+enum simdLevel_t
+{
+	SIMD_SCALAR,
+	SIMD_SSE2,
+	SIMD_AVX2,
+	NUM_SIMD_LEVELS
+};
+
+struct tessKernels_t
+{
+	const char* name;
+
+	// xyz += normal * scale
+	void (*deformNormals)(float* xyz, const float* normal, int count, float scale);
+
+	// xyz += normal * (base + table[(phase + (x + y + z) * spread + timeFreq) * tableSize] * amplitude)
+	void (*deformWave)(float* xyz, const float* normal, int count, const float* table, int tableSize,
+		float base, float amplitude, float phase, float spread, float timeFreq);
+
+	// xyz += offset
+	void (*moveVertexes)(float* xyz, int count, const float offset[3]);
+
+	// reflection of the direction to the viewer around the normal
+	void (*environmentTexCoords)(const float* xyz, const float* normal, int count, const float viewOrigin[3],
+		float* st);
+
+	// distance and depth of each vertex in the fog volume
+	void (*fogTexCoords)(const float* xyz, int count, const float distance[4], const float depth[4], float eyeT,
+		bool eyeOutside, float* st);
+
+	// st = st * scale + bias
+	void (*scaleBiasTexCoords)(float* st, int count, const float scale[2], const float bias[2]);
+
+	// st = st * matrix + translate
+	void (*transformTexCoords)(float* st, int count, const float matrix[2][2], const float translate[2]);
+
+	void (*fillColors)(unsigned* colors, int count, unsigned color);
+};
+
+// best level the cpu can run
+simdLevel_t R_SimdSupported();
+
+// kernels for a level, nullptr if the cpu or the build doesn't have it
+const tessKernels_t* R_TessKernels(simdLevel_t level);
+
+struct imageKernels_t
+{
+	const char* name;
+
+	// 2x2 box filter down to half size, out may be the same buffer as in
+	void (*mipMapBox)(const unsigned char* in, unsigned char* out, int width, int height);
+
+	// [1 2 2 1] filter in both directions down to half size, wrapping around the
+	// edges.  Once a side is down to 1 the first half of the pixels is copied
+	// unfiltered, like the old in-place filter left them.  out must not overlap in.
+	void (*mipMapFilter)(const unsigned char* in, unsigned char* out, int width, int height);
+};
+
+// image kernels for a level, the AVX2 level uses the SSE2 ones
+const imageKernels_t* R_ImageKernels(simdLevel_t level);
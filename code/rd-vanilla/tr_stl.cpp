@@ -31,10 +31,10 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "tr_local.h"	// this isn't actually needed other than getting rid of warnings via pragmas
 #include "tr_stl.h"
 
-#include <map>
-#include "../qcommon/sstring.h"	// #include <string>
+#include <string>
+#include <unordered_map>
 
-using ShaderEntryPtrs_t = std::map<sstring_t, const char*>;
+using ShaderEntryPtrs_t = std::unordered_map<std::string, const char*>;
 using ShaderEntryPtr_size = ShaderEntryPtrs_t::size_type;
 ShaderEntryPtrs_t ShaderEntryPtrs;
 
@@ -62,6 +62,14 @@ void ShaderEntryPtrs_Insert(const char* token, const char* p)
 	}
 }
 
+void ShaderEntryPtrs_ForEach(void (*func)(const char* token, const char* p, void* data), void* data)
+{
+	for (const auto& entry : ShaderEntryPtrs)
+	{
+		func(entry.first.c_str(), entry.second, data);
+	}
+}
+
 // returns NULL if not found...
 //
 const char* ShaderEntryPtrs_Lookup(const char* ps_shader_name)
@@ -36,6 +36,7 @@ void ShaderEntryPtrs_Clear();
 int ShaderEntryPtrs_Size();
 const char* ShaderEntryPtrs_Lookup(const char* ps_shader_name);
 void ShaderEntryPtrs_Insert(const char* token, const char* p);
+void ShaderEntryPtrs_ForEach(void (*func)(const char* token, const char* p, void* data), void* data);
 #else
 
 #define ShaderEntryPtrs_Clear()
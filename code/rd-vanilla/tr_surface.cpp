@@ -807,7 +807,7 @@ static void RB_SurfaceElectricity()
 	// see if we should grow from start to end
 	if (e->renderfx & RF_GROW)
 	{
-		perc = 1.0f - (e->endTime - tr.refdef.time) / e->angles[1]/*duration*/;
+		perc = 1.0f - (e->endTime - backEnd.refdef.time) / e->angles[1]/*duration*/;
 
 		if (perc > 1.0f)
 		{
@@ -954,7 +954,7 @@ RB_SurfaceTriangles
 void RB_SurfaceTriangles(const srfTriangles_t* srf) {
 	int			i;
 
-	const int dlight_bits = srf->dlightBits;
+	const int dlight_bits = srf->dlightBits[backEnd.smpFrame];
 	tess.dlightBits |= dlight_bits;
 
 	RB_CHECKOVERFLOW(srf->num_verts, srf->num_indexes);
@@ -1276,7 +1276,7 @@ void RB_SurfaceFace(srfSurfaceFace_t* surf) {
 
 	RB_CHECKOVERFLOW(surf->numPoints, surf->numIndices);
 
-	const int dlight_bits = surf->dlightBits;
+	const int dlight_bits = surf->dlightBits[backEnd.smpFrame];
 	tess.dlightBits |= dlight_bits;
 
 	const unsigned int* indices = reinterpret_cast<unsigned*>(reinterpret_cast<char*>(surf) + surf->ofsIndices);
@@ -1371,7 +1371,7 @@ void RB_SurfaceGrid(srfGridMesh_t* cv) {
 	int		width_table[MAX_GRID_SIZE];
 	int		height_table[MAX_GRID_SIZE];
 
-	const int dlight_bits = cv->dlightBits;
+	const int dlight_bits = cv->dlightBits[backEnd.smpFrame];
 	tess.dlightBits |= dlight_bits;
 
 	// determine the allowable discrepance
@@ -344,7 +344,7 @@ static void RB_VerticalSurfaceSprite(vec3_t loc, const float width, const float
 	float points[16];
 	color4ub_t color;
 
-	const float angle = (loc[0] + loc[1]) * 0.02 + tr.refdef.time * 0.0015;
+	const float angle = (loc[0] + loc[1]) * 0.02 + backEnd.refdef.time * 0.0015;
 
 	if (windidle > 0.0)
 	{
@@ -454,7 +454,7 @@ static void RB_VerticalSurfaceSpriteWindPoint(vec3_t loc, const float width, con
 
 	//	wind += 1.0-windforce;
 
-	const float angle = (loc[0] + loc[1]) * 0.02 + tr.refdef.time * 0.0015;
+	const float angle = (loc[0] + loc[1]) * 0.02 + backEnd.refdef.time * 0.0015;
 
 	if (cur_wind_speed < 80.0)
 	{
@@ -484,7 +484,7 @@ static void RB_VerticalSurfaceSpriteWindPoint(vec3_t loc, const float width, con
 
 	loc2[0] += height * winddiff[0] * windforce;
 	loc2[1] += height * winddiff[1] * windforce;
-	loc2[2] -= height * windforce * (0.75 + 0.15 * sin((tr.refdef.time + 500 * windforce) * 0.01));
+	loc2[2] -= height * windforce * (0.75 + 0.15 * sin((backEnd.refdef.time + 500 * windforce) * 0.01));
 
 	if (flattened)
 	{
@@ -1318,7 +1318,7 @@ static void RB_DrawEffectSurfaceSprites(shaderStage_t* stage, shaderCommands_t*
 		{
 			for (posj = 0; posj < 1.0 - posi; posj += step)
 			{
-				effecttime = (tr.refdef.time + 10000.0 * randomchart[randomindex]) / stage->ss->fxDuration;
+				effecttime = (backEnd.refdef.time + 10000.0 * randomchart[randomindex]) / stage->ss->fxDuration;
 				effectpos = effecttime - static_cast<int>(effecttime);
 
 				randomindex2 = randomindex + effecttime;
@@ -0,0 +1,207 @@
+/*
+===========================================================================
+Copyright (C) 2013 - 2015, OpenJK contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+// tr_workers.cpp -- pool of front end worker threads.  A batch of jobs is
+// handed out to the workers and the calling thread, which works on the batch
+// too and returns once every job is finished.  Jobs must only write to memory
+// that belongs to them, anything shared is merged by the caller afterwards.
+
+#include "../server/exe_headers.h"
+
+#include "tr_local.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static struct
+{
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+	workerJob_t func;
+	void* data;
+	int numJobs;
+	std::atomic<int> nextJob;
+	std::atomic<int> finishedJobs;
+	int active; // workers still inside a batch
+	int batch;
+	bool quit;
+} workers;
+
+static void R_RunWorkerBatch(const int numJobs, const workerJob_t func, void* data)
+{
+	int job;
+
+	while ((job = workers.nextJob.fetch_add(1)) < numJobs)
+	{
+		func(job, data);
+		if (workers.finishedJobs.fetch_add(1) + 1 == numJobs)
+		{
+			std::lock_guard<std::mutex> lock(workers.mutex);
+			workers.done.notify_all();
+		}
+	}
+}
+
+static void R_WorkerThread()
+{
+	int batch = 0;
+
+	while (true)
+	{
+		workerJob_t func;
+		void* data;
+		int numJobs;
+
+		{
+			std::unique_lock<std::mutex> lock(workers.mutex);
+			workers.wake.wait(lock, [&batch] { return workers.quit || workers.batch != batch; });
+			if (workers.quit)
+			{
+				return;
+			}
+			// take the batch while the lock is held, the next one can't be
+			// published until this worker has left it again
+			batch = workers.batch;
+			func = workers.func;
+			data = workers.data;
+			numJobs = workers.numJobs;
+			workers.active++;
+		}
+		R_RunWorkerBatch(numJobs, func, data);
+		{
+			std::lock_guard<std::mutex> lock(workers.mutex);
+			if (--workers.active == 0)
+			{
+				workers.done.notify_all();
+			}
+		}
+	}
+}
+
+/*
+================
+R_ShutdownWorkers
+================
+*/
+void R_ShutdownWorkers()
+{
+	{
+		std::lock_guard<std::mutex> lock(workers.mutex);
+		workers.quit = true;
+	}
+	workers.wake.notify_all();
+	for (std::thread& thread : workers.threads)
+	{
+		thread.join();
+	}
+	workers.threads.clear();
+	workers.quit = false;
+}
+
+/*
+================
+R_InitWorkers
+
+r_workerThreads -1 starts one worker per additional hardware thread.
+================
+*/
+void R_InitWorkers()
+{
+	R_ShutdownWorkers();
+
+	int numWorkers = r_workerThreads->integer;
+	if (numWorkers < 0)
+	{
+		numWorkers = static_cast<int>(std::thread::hardware_concurrency()) - 1;
+	}
+	if (numWorkers > MAX_RENDER_WORKERS)
+	{
+		numWorkers = MAX_RENDER_WORKERS;
+	}
+
+	for (int i = 0; i < numWorkers; i++)
+	{
+		try
+		{
+			workers.threads.emplace_back(R_WorkerThread);
+		}
+		catch (const std::system_error&)
+		{
+			ri.Printf(PRINT_WARNING, "WARNING: only started %d of %d renderer worker threads\n", i, numWorkers);
+			break;
+		}
+	}
+}
+
+int R_NumWorkers()
+{
+	return static_cast<int>(workers.threads.size());
+}
+
+/*
+================
+R_RunWorkerJobs
+
+Runs func for every job number from 0 to numJobs - 1 and waits for all of
+them.  Must only be called from the front end thread.
+================
+*/
+void R_RunWorkerJobs(const int numJobs, const workerJob_t func, void* data)
+{
+	if (numJobs <= 0)
+	{
+		return;
+	}
+
+	if (workers.threads.empty() || numJobs == 1)
+	{
+		for (int i = 0; i < numJobs; i++)
+		{
+			func(i, data);
+		}
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(workers.mutex);
+		// a worker that was slow to wake for the last batch may still be
+		// looking at its job counters
+		workers.done.wait(lock, [] { return workers.active == 0; });
+		workers.func = func;
+		workers.data = data;
+		workers.numJobs = numJobs;
+		workers.finishedJobs = 0;
+		workers.nextJob = 0;
+		workers.batch++;
+	}
+	workers.wake.notify_all();
+
+	// help out with the batch
+	R_RunWorkerBatch(numJobs, func, data);
+
+	std::unique_lock<std::mutex> lock(workers.mutex);
+	workers.done.wait(lock, [] { return workers.finishedJobs >= workers.numJobs; });
+	workers.numJobs = 0;
+}
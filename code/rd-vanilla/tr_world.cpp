@@ -24,6 +24,9 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "../server/exe_headers.h"
 
 #include "tr_local.h"
+#include "../qcommon/timing.h"
+
+#include <vector>
 
 /*
 =================
@@ -50,7 +53,7 @@ Returns true if the grid is completely culled away.
 Also sets the clipped hint bit in tess
 =================
 */
-static qboolean	R_CullGrid(const srfGridMesh_t* cv) {
+static qboolean	R_CullGrid(const srfGridMesh_t* cv, frontEndCounters_t& pc) {
 	int 	sphereCull;
 
 	if (r_nocurves->integer) {
@@ -67,33 +70,33 @@ static qboolean	R_CullGrid(const srfGridMesh_t* cv) {
 	// check for trivial reject
 	if (sphereCull == CULL_OUT)
 	{
-		tr.pc.c_sphere_cull_patch_out++;
+		pc.c_sphere_cull_patch_out++;
 		return qtrue;
 	}
 	// check bounding box if necessary
 	if (sphereCull == CULL_CLIP)
 	{
-		tr.pc.c_sphere_cull_patch_clip++;
+		pc.c_sphere_cull_patch_clip++;
 
 		const int boxCull = R_CullLocalBox(cv->meshBounds);
 
 		if (boxCull == CULL_OUT)
 		{
-			tr.pc.c_box_cull_patch_out++;
+			pc.c_box_cull_patch_out++;
 			return qtrue;
 		}
 		if (boxCull == CULL_IN)
 		{
-			tr.pc.c_box_cull_patch_in++;
+			pc.c_box_cull_patch_in++;
 		}
 		else
 		{
-			tr.pc.c_box_cull_patch_clip++;
+			pc.c_box_cull_patch_clip++;
 		}
 	}
 	else
 	{
-		tr.pc.c_sphere_cull_patch_in++;
+		pc.c_sphere_cull_patch_in++;
 	}
 
 	return qfalse;
@@ -107,15 +110,16 @@ Tries to back face cull surfaces before they are lighted or
 added to the sorting list.
 
 This will also allow mirrors on both sides of a model without recursion.
+The patch cull counters go to pc, so the world walk jobs can keep their own.
 ================
 */
-static qboolean	R_CullSurface(surfaceType_t* surface, const shader_t* shader) {
+static qboolean	R_CullSurface(surfaceType_t* surface, const shader_t* shader, frontEndCounters_t& pc) {
 	if (r_nocull->integer == 1) {
 		return qfalse;
 	}
 
 	if (*surface == SF_GRID) {
-		return R_CullGrid(reinterpret_cast<srfGridMesh_t*>(surface));
+		return R_CullGrid(reinterpret_cast<srfGridMesh_t*>(surface), pc);
 	}
 
 	if (*surface == SF_TRIANGLES) {
@@ -172,7 +176,7 @@ static int R_DlightFace(srfSurfaceFace_t* face, int dlightBits) {
 		tr.pc.c_dlightSurfacesCulled++;
 	}
 
-	face->dlightBits = dlightBits;
+	face->dlightBits[tr.smpFrame] = dlightBits;
 	return dlightBits;
 }
 
@@ -197,13 +201,13 @@ static int R_DlightGrid(srfGridMesh_t* grid, int dlightBits) {
 		tr.pc.c_dlightSurfacesCulled++;
 	}
 
-	grid->dlightBits = dlightBits;
+	grid->dlightBits[tr.smpFrame] = dlightBits;
 	return dlightBits;
 }
 
 static int R_DlightTrisurf(srfTriangles_t* surf, int dlightBits) {
 	// FIXME: more dlight culling to trisurfs...
-	surf->dlightBits = dlightBits;
+	surf->dlightBits[tr.smpFrame] = dlightBits;
 	return dlightBits;
 #if 0
 	int			i;
@@ -229,7 +233,7 @@ static int R_DlightTrisurf(srfTriangles_t* surf, int dlightBits) {
 		tr.pc.c_dlightSurfacesCulled++;
 	}
 
-	grid->dlightBits = dlightBits;
+	grid->dlightBits[tr.smpFrame] = dlightBits;
 	return dlightBits;
 #endif
 }
@@ -266,50 +270,45 @@ static int R_DlightSurface(const msurface_t* surf, int dlightBits) {
 
 /*
 ======================
-R_AddWorldSurface
+R_MarkWorldSurface
+
+Returns qfalse if the surface is already in this view.
 ======================
 */
-static void R_AddWorldSurface(msurface_t* surf, int dlightBits, const qboolean noViewCount = qfalse) {
-	/*
-	if ( surf->viewCount == tr.viewCount ) {
-		return;		// already in this view
-	}
-	*/
-
+static qboolean R_MarkWorldSurface(msurface_t* surf, const int dlightBits) {
 	//rww - changed this to be like sof2mp's so RMG will look right.
 	//Will this affect anything that is non-rmg?
 
-	if (!noViewCount)
+	if (surf->viewCount == tr.viewCount)
 	{
-		if (surf->viewCount == tr.viewCount)
+		// already in this view, but lets make sure all the dlight bits are set
+		if (*surf->data == SF_FACE)
 		{
-			// already in this view, but lets make sure all the dlight bits are set
-			if (*surf->data == SF_FACE)
-			{
-				reinterpret_cast<srfSurfaceFace_t*>(surf->data)->dlightBits |= dlightBits;
-			}
-			else if (*surf->data == SF_GRID)
-			{
-				reinterpret_cast<srfGridMesh_t*>(surf->data)->dlightBits |= dlightBits;
-			}
-			else if (*surf->data == SF_TRIANGLES)
-			{
-				reinterpret_cast<srfTriangles_t*>(surf->data)->dlightBits |= dlightBits;
-			}
-			return;
+			reinterpret_cast<srfSurfaceFace_t*>(surf->data)->dlightBits[tr.smpFrame] |= dlightBits;
 		}
-		surf->viewCount = tr.viewCount;
-		// FIXME: bmodel fog?
+		else if (*surf->data == SF_GRID)
+		{
+			reinterpret_cast<srfGridMesh_t*>(surf->data)->dlightBits[tr.smpFrame] |= dlightBits;
+		}
+		else if (*surf->data == SF_TRIANGLES)
+		{
+			reinterpret_cast<srfTriangles_t*>(surf->data)->dlightBits[tr.smpFrame] |= dlightBits;
+		}
+		return qfalse;
 	}
+	surf->viewCount = tr.viewCount;
+	// FIXME: bmodel fog?
+	return qtrue;
+}
 
-	//	surf->viewCount = tr.viewCount;
-		// FIXME: bmodel fog?
-
-		// try to cull before dlighting or adding
-	if (R_CullSurface(surf->data, surf->shader)) {
-		return;
-	}
+/*
+======================
+R_AddVisibleWorldSurface
 
+Dlights and adds a surface that survived culling.
+======================
+*/
+static void R_AddVisibleWorldSurface(const msurface_t* surf, int dlightBits) {
 	// check for dlighting
 	if (dlightBits) {
 		dlightBits = R_DlightSurface(surf, dlightBits);
@@ -319,6 +318,24 @@ static void R_AddWorldSurface(msurface_t* surf, int dlightBits, const qboolean n
 	R_AddDrawSurf(surf->data, surf->shader, surf->fogIndex, dlightBits);
 }
 
+/*
+======================
+R_AddWorldSurface
+======================
+*/
+static void R_AddWorldSurface(msurface_t* surf, const int dlightBits, const qboolean noViewCount = qfalse) {
+	if (!noViewCount && !R_MarkWorldSurface(surf, dlightBits)) {
+		return;
+	}
+
+	// try to cull before dlighting or adding
+	if (R_CullSurface(surf->data, surf->shader, tr.pc)) {
+		return;
+	}
+
+	R_AddVisibleWorldSurface(surf, dlightBits);
+}
+
 /*
 =============================================================
 
@@ -457,107 +474,110 @@ void RE_GetBModelVerts(const int bmodelIndex, vec3_t* verts, vec3_t normal)
 
 /*
 ================
-R_RecursiveWorldNode
+R_CullWorldNode
+
+Returns qtrue if nothing under the node can be visible.  Clears the
+planeBits of the frustum planes the node is entirely in front of.
 ================
 */
-static void R_RecursiveWorldNode(mnode_t* node, int planeBits, int dlightBits) {
-	do {
-		int			newDlights[2];
-
-		// if the node wasn't marked as potentially visible, exit
-		if (node->visframe != tr.visCount) {
-			return;
-		}
-
-		// if the bounding volume is outside the frustum, nothing
-		// inside can be visible OPTIMIZE: don't do this all the way to leafs?
+static qboolean R_CullWorldNode(mnode_t* node, int& planeBits) {
+	// if the node wasn't marked as potentially visible, exit
+	if (node->visframe != tr.visCount) {
+		return qtrue;
+	}
 
-		if (r_nocull->integer != 1) {
-			int		r;
+	// if the bounding volume is outside the frustum, nothing
+	// inside can be visible OPTIMIZE: don't do this all the way to leafs?
 
-			if (planeBits & 1) {
-				r = BoxOnPlaneSide(node->mins, node->maxs, &tr.viewParms.frustum[0]);
+	if (r_nocull->integer != 1) {
+		for (int i = 0; i < 5; i++) {
+			if (planeBits & 1 << i) {
+				const int r = BoxOnPlaneSide(node->mins, node->maxs, &tr.viewParms.frustum[i]);
 				if (r == 2) {
-					return;						// culled
+					return qtrue;				// culled
 				}
 				if (r == 1) {
-					planeBits &= ~1;			// all descendants will also be in front
+					planeBits &= ~(1 << i);		// all descendants will also be in front
 				}
 			}
+		}
+	}
 
-			if (planeBits & 2) {
-				r = BoxOnPlaneSide(node->mins, node->maxs, &tr.viewParms.frustum[1]);
-				if (r == 2) {
-					return;						// culled
-				}
-				if (r == 1) {
-					planeBits &= ~2;			// all descendants will also be in front
-				}
-			}
+	return qfalse;
+}
 
-			if (planeBits & 4) {
-				r = BoxOnPlaneSide(node->mins, node->maxs, &tr.viewParms.frustum[2]);
-				if (r == 2) {
-					return;						// culled
-				}
-				if (r == 1) {
-					planeBits &= ~4;			// all descendants will also be in front
-				}
-			}
+/*
+================
+R_SplitNodeDlights
 
-			if (planeBits & 8) {
-				r = BoxOnPlaneSide(node->mins, node->maxs, &tr.viewParms.frustum[3]);
-				if (r == 2) {
-					return;						// culled
-				}
-				if (r == 1) {
-					planeBits &= ~8;			// all descendants will also be in front
-				}
-			}
+Determines which dlights are needed on each side of the node.
+================
+*/
+static void R_SplitNodeDlights(const mnode_t* node, const int dlightBits, int newDlights[2]) {
+	if (r_nocull->integer == 2) {
+		newDlights[0] = dlightBits;
+		newDlights[1] = dlightBits;
+		return;
+	}
 
-			if (planeBits & 16) {
-				r = BoxOnPlaneSide(node->mins, node->maxs, &tr.viewParms.frustum[4]);
-				if (r == 2) {
-					return;						// culled
-				}
-				if (r == 1) {
-					planeBits &= ~16;			// all descendants will also be in front
-				}
+	newDlights[0] = 0;
+	newDlights[1] = 0;
+	if (!dlightBits) {
+		return;
+	}
+
+	for (int i = 0; i < tr.refdef.num_dlights; i++) {
+		if (dlightBits & 1 << i) {
+			const dlight_t* dl = &tr.refdef.dlights[i];
+			const float dist = DotProduct(dl->origin, node->plane->normal) - node->plane->dist;
+
+			if (dist > -dl->radius) {
+				newDlights[0] |= 1 << i;
+			}
+			if (dist < dl->radius) {
+				newDlights[1] |= 1 << i;
 			}
 		}
+	}
+}
 
-		if (node->contents != -1) {
-			break;
+/*
+================
+R_AddLeafBounds
+
+Adds a visible leaf to the z buffer bounds.
+================
+*/
+static void R_AddLeafBounds(const mnode_t* node, vec3_t visBounds[2]) {
+	for (int i = 0; i < 3; i++) {
+		if (node->mins[i] < visBounds[0][i]) {
+			visBounds[0][i] = node->mins[i];
 		}
+		if (node->maxs[i] > visBounds[1][i]) {
+			visBounds[1][i] = node->maxs[i];
+		}
+	}
+}
 
-		// determine which dlights are needed
-		if (r_nocull->integer != 2)
-		{
-			newDlights[0] = 0;
-			newDlights[1] = 0;
-			if (dlightBits)
-			{
-				for (int i = 0; i < tr.refdef.num_dlights; i++)
-				{
-					if (dlightBits & 1 << i) {
-						const dlight_t* dl = &tr.refdef.dlights[i];
-						const float dist = DotProduct(dl->origin, node->plane->normal) - node->plane->dist;
-
-						if (dist > -dl->radius) {
-							newDlights[0] |= 1 << i;
-						}
-						if (dist < dl->radius) {
-							newDlights[1] |= 1 << i;
-						}
-					}
-				}
-			}
+/*
+================
+R_RecursiveWorldNode
+================
+*/
+static void R_RecursiveWorldNode(mnode_t* node, int planeBits, int dlightBits) {
+	do {
+		int			newDlights[2];
+
+		if (R_CullWorldNode(node, planeBits)) {
+			return;
 		}
-		else
-		{
-			newDlights[0] = dlightBits;
-			newDlights[1] = dlightBits;
+
+		if (node->contents != -1) {
+			break;
 		}
+
+		R_SplitNodeDlights(node, dlightBits, newDlights);
+
 		// recurse down the children, front side first
 		R_RecursiveWorldNode(node->children[0], planeBits, newDlights[0]);
 
@@ -566,39 +586,175 @@ static void R_RecursiveWorldNode(mnode_t* node, int planeBits, int dlightBits) {
 		dlightBits = newDlights[1];
 	} while (true);
 
-	{
-		tr.pc.c_leafs++;
+	tr.pc.c_leafs++;
+
+	// add to z buffer bounds
+	R_AddLeafBounds(node, tr.viewParms.visBounds);
+
+	// add the individual surfaces
+	msurface_t** mark = node->firstmarksurface;
+	int c = node->nummarksurfaces;
+	while (c--) {
+		// the surface may have already been added if it
+		// spans multiple leafs
+		msurface_t* surf = *mark;
+		R_AddWorldSurface(surf, dlightBits);
+		mark++;
+	}
+}
+
+/*
+=============================================================
+
+	PARALLEL WORLD WALK
+
+The top of the tree is walked on the front end thread down to
+WORLD_JOB_DEPTH, and the subtrees below that are walked by the worker
+threads.  A job only culls, it never touches the surfaces or tr, and
+keeps the surfaces that survived in its own list.  The lists are then
+added in job order, which is the order the single threaded walk visits
+the leafs in, so the draw surfaces come out exactly the same.
+
+=============================================================
+*/
+
+constexpr int WORLD_JOB_DEPTH = 6;
+constexpr int MAX_WORLD_JOBS = 1 << WORLD_JOB_DEPTH;
+
+using worldSurf_t = struct {
+	msurface_t* surf;
+	int			dlightBits;
+};
+
+using worldJob_t = struct {
+	mnode_t* node;
+	int			planeBits;
+	int			dlightBits;
+
+	frontEndCounters_t		pc;
+	vec3_t					visBounds[2];
+	std::vector<worldSurf_t>	surfs;		// keeps its memory from view to view
+};
+
+static worldJob_t	worldJobs[MAX_WORLD_JOBS];
+static int			numWorldJobs;
+
+/*
+================
+R_WorldJobNode
+================
+*/
+static void R_WorldJobNode(worldJob_t* job, mnode_t* node, int planeBits, int dlightBits) {
+	do {
+		int			newDlights[2];
 
-		// add to z buffer bounds
-		if (node->mins[0] < tr.viewParms.visBounds[0][0]) {
-			tr.viewParms.visBounds[0][0] = node->mins[0];
+		if (R_CullWorldNode(node, planeBits)) {
+			return;
 		}
-		if (node->mins[1] < tr.viewParms.visBounds[0][1]) {
-			tr.viewParms.visBounds[0][1] = node->mins[1];
+
+		if (node->contents != -1) {
+			break;
 		}
-		if (node->mins[2] < tr.viewParms.visBounds[0][2]) {
-			tr.viewParms.visBounds[0][2] = node->mins[2];
+
+		R_SplitNodeDlights(node, dlightBits, newDlights);
+
+		R_WorldJobNode(job, node->children[0], planeBits, newDlights[0]);
+
+		node = node->children[1];
+		dlightBits = newDlights[1];
+	} while (true);
+
+	job->pc.c_leafs++;
+	R_AddLeafBounds(node, job->visBounds);
+
+	msurface_t** mark = node->firstmarksurface;
+	int c = node->nummarksurfaces;
+	while (c--) {
+		msurface_t* surf = *mark;
+		// surfaces spanning several leafs are culled once per leaf here,
+		// the duplicates are dropped when the lists are merged
+		if (!R_CullSurface(surf->data, surf->shader, job->pc)) {
+			job->surfs.push_back({ surf, dlightBits });
 		}
+		mark++;
+	}
+}
+
+static void R_WorldJob(const int jobNum, void* data) {
+	worldJob_t* job = &worldJobs[jobNum];
 
-		if (node->maxs[0] > tr.viewParms.visBounds[1][0]) {
-			tr.viewParms.visBounds[1][0] = node->maxs[0];
+	R_WorldJobNode(job, job->node, job->planeBits, job->dlightBits);
+}
+
+/*
+================
+R_GatherWorldJobs
+
+Splits the visible part of the top of the tree into subtree jobs, front
+side first like R_RecursiveWorldNode.
+================
+*/
+static void R_GatherWorldJobs(mnode_t* node, int planeBits, int dlightBits, int depth) {
+	do {
+		int			newDlights[2];
+
+		if (R_CullWorldNode(node, planeBits)) {
+			return;
 		}
-		if (node->maxs[1] > tr.viewParms.visBounds[1][1]) {
-			tr.viewParms.visBounds[1][1] = node->maxs[1];
+
+		if (node->contents != -1 || depth == 0) {
+			worldJob_t* job = &worldJobs[numWorldJobs++];
+
+			job->node = node;
+			job->planeBits = planeBits;
+			job->dlightBits = dlightBits;
+			memset(&job->pc, 0, sizeof job->pc);
+			ClearBounds(job->visBounds[0], job->visBounds[1]);
+			job->surfs.clear();
+			return;
 		}
-		if (node->maxs[2] > tr.viewParms.visBounds[1][2]) {
-			tr.viewParms.visBounds[1][2] = node->maxs[2];
+
+		R_SplitNodeDlights(node, dlightBits, newDlights);
+
+		R_GatherWorldJobs(node->children[0], planeBits, newDlights[0], depth - 1);
+
+		node = node->children[1];
+		dlightBits = newDlights[1];
+		depth--;
+	} while (true);
+}
+
+/*
+================
+R_ParallelWorldNode
+================
+*/
+static void R_ParallelWorldNode(mnode_t* node, const int planeBits, const int dlightBits) {
+	numWorldJobs = 0;
+	R_GatherWorldJobs(node, planeBits, dlightBits, WORLD_JOB_DEPTH);
+
+	R_RunWorkerJobs(numWorldJobs, R_WorldJob, nullptr);
+
+	for (int i = 0; i < numWorldJobs; i++) {
+		const worldJob_t* job = &worldJobs[i];
+
+		tr.pc.c_leafs += job->pc.c_leafs;
+		tr.pc.c_sphere_cull_patch_in += job->pc.c_sphere_cull_patch_in;
+		tr.pc.c_sphere_cull_patch_clip += job->pc.c_sphere_cull_patch_clip;
+		tr.pc.c_sphere_cull_patch_out += job->pc.c_sphere_cull_patch_out;
+		tr.pc.c_box_cull_patch_in += job->pc.c_box_cull_patch_in;
+		tr.pc.c_box_cull_patch_clip += job->pc.c_box_cull_patch_clip;
+		tr.pc.c_box_cull_patch_out += job->pc.c_box_cull_patch_out;
+
+		if (job->pc.c_leafs) {
+			AddPointToBounds(job->visBounds[0], tr.viewParms.visBounds[0], tr.viewParms.visBounds[1]);
+			AddPointToBounds(job->visBounds[1], tr.viewParms.visBounds[0], tr.viewParms.visBounds[1]);
 		}
 
-		// add the individual surfaces
-		msurface_t** mark = node->firstmarksurface;
-		int c = node->nummarksurfaces;
-		while (c--) {
-			// the surface may have already been added if it
-			// spans multiple leafs
-			msurface_t* surf = *mark;
-			R_AddWorldSurface(surf, dlightBits);
-			mark++;
+		for (const worldSurf_t& ws : job->surfs) {
+			if (R_MarkWorldSurface(ws.surf, ws.dlightBits)) {
+				R_AddVisibleWorldSurface(ws.surf, ws.dlightBits);
+			}
 		}
 	}
 }
@@ -662,6 +818,10 @@ qboolean R_inPVS(vec3_t p1, vec3_t p2) {
 	return qtrue;
 }
 
+// set when a view didn't mark the leafs, so the next R_MarkLeaves can't
+// trust tr.viewCluster
+static qboolean leafMarksStale;
+
 /*
 ===============
 R_MarkLeaves
@@ -675,7 +835,7 @@ static void R_MarkLeaves() {
 
 	// lockpvs lets designers walk around to determine the
 	// extent of the current pvs
-	if (r_lockpvs->integer) {
+	if (r_lockpvs->integer && !leafMarksStale) {
 		return;
 	}
 
@@ -688,7 +848,7 @@ static void R_MarkLeaves() {
 
 	// if r_showcluster was just turned on, remark everything
 	if (tr.viewCluster == cluster && !tr.refdef.areamaskModified
-		&& !r_showcluster->modified) {
+		&& !r_showcluster->modified && !leafMarksStale) {
 		return;
 	}
 
@@ -701,6 +861,7 @@ static void R_MarkLeaves() {
 
 	tr.visCount++;
 	tr.viewCluster = cluster;
+	leafMarksStale = qfalse;
 
 	if (r_novis->integer || tr.viewCluster == -1) {
 		for (i = 0; i < tr.world->numnodes; i++) {
@@ -739,6 +900,127 @@ static void R_MarkLeaves() {
 	}
 }
 
+/*
+=============
+R_ClusterSurfaceDlights
+
+Drops the dlights that can't reach the bounds of the surface.
+=============
+*/
+static int R_ClusterSurfaceDlights(const vec3_t box[2], int dlightBits) {
+	for (int i = 0; i < tr.refdef.num_dlights; i++) {
+		if (!(dlightBits & 1 << i)) {
+			continue;
+		}
+		const dlight_t* dl = &tr.refdef.dlights[i];
+		if (fabsf(dl->origin[0] - box[0][0]) > box[1][0] + dl->radius
+			|| fabsf(dl->origin[1] - box[0][1]) > box[1][1] + dl->radius
+			|| fabsf(dl->origin[2] - box[0][2]) > box[1][2] + dl->radius) {
+			dlightBits &= ~(1 << i);
+		}
+	}
+	return dlightBits;
+}
+
+/*
+=============
+R_AddClusterSurfaces
+
+Adds the world surfaces from the precomputed list of the view cluster,
+each one culled by its own bounds.  Returns qfalse if the lists can't be
+used for this view and the tree has to be walked.
+=============
+*/
+static qboolean R_AddClusterSurfaces(const int dlightBits) {
+	const world_t* w = tr.world;
+
+	if (!w->clusterFirstArea || r_novis->integer || r_lockpvs->integer || r_showcluster->integer || r_nocull->integer) {
+		return qfalse;
+	}
+
+	const mnode_t* leaf = R_PointInLeaf(tr.viewParms.pvsOrigin);
+	const int cluster = leaf->cluster;
+	if (cluster < 0 || cluster >= w->numClusters) {
+		return qfalse;
+	}
+
+	tr.viewCluster = cluster;
+	leafMarksStale = qtrue;
+
+	// the positive vertex of a box is center + half size dotted with |normal|
+	vec3_t absNormals[5];
+	const cplane_t* frustum = tr.viewParms.frustum;
+	for (int p = 0; p < 5; p++) {
+		absNormals[p][0] = fabsf(frustum[p].normal[0]);
+		absNormals[p][1] = fabsf(frustum[p].normal[1]);
+		absNormals[p][2] = fabsf(frustum[p].normal[2]);
+	}
+
+	for (int a = w->clusterFirstArea[cluster]; a < w->clusterFirstArea[cluster + 1]; a++) {
+		const clusterArea_t* ca = &w->clusterAreas[a];
+
+		// check for door connection
+		if (tr.refdef.areamask[ca->area >> 3] & 1 << (ca->area & 7)) {
+			continue;
+		}
+		if (R_CullLocalBox(ca->bounds) == CULL_OUT) {
+			continue;
+		}
+
+		tr.pc.c_leafs++;
+		AddPointToBounds(ca->bounds[0], tr.viewParms.visBounds[0], tr.viewParms.visBounds[1]);
+		AddPointToBounds(ca->bounds[1], tr.viewParms.visBounds[0], tr.viewParms.visBounds[1]);
+
+		const int* surfNums = w->clusterSurfaces + ca->firstSurface;
+		for (int i = 0; i < ca->numSurfaces; i++) {
+			const int surfNum = surfNums[i];
+			const vec3_t* box = &w->surfaceCullBoxes[surfNum * 2];
+			int p;
+
+			for (p = 0; p < 5; p++) {
+				const float dist = DotProduct(box[0], frustum[p].normal) - frustum[p].dist;
+				if (dist < -DotProduct(box[1], absNormals[p])) {
+					break;
+				}
+			}
+			if (p != 5) {
+				continue;
+			}
+
+			msurface_t* surf = w->surfaces + surfNum;
+			const int surfDlights = dlightBits ? R_ClusterSurfaceDlights(box, dlightBits) : 0;
+			if (!R_MarkWorldSurface(surf, surfDlights)) {
+				continue;
+			}
+			if (R_CullSurface(surf->data, surf->shader, tr.pc)) {
+				continue;
+			}
+			R_AddVisibleWorldSurface(surf, surfDlights);
+		}
+	}
+
+	return qtrue;
+}
+
+enum {
+	WORLD_WALK_TREE,
+	WORLD_WALK_JOBS,
+	WORLD_WALK_CLUSTERS,
+	NUM_WORLD_WALKS
+};
+
+// the first world view of the last frame, replayed by r_worldbench
+static struct {
+	qboolean		valid;
+	qboolean		running;
+	int				frameCount;
+	int				walkMode;		// WORLD_WALK_*, -1 to go by the cvars
+	viewParms_t		viewParms;
+	orientationr_t	ori;
+	trRefdef_t		refdef;
+	dlight_t		dlights[MAX_DLIGHTS];
+} worldBench = { qfalse, qfalse, -1, -1 };
+
 /*
 =============
 R_AddWorldSurfaces
@@ -756,9 +1038,6 @@ void R_AddWorldSurfaces() {
 	tr.currentEntityNum = REFENTITYNUM_WORLD;
 	tr.shiftedEntityNum = tr.currentEntityNum << QSORT_REFENTITYNUM_SHIFT;
 
-	// determine which leaves are in the PVS / areamask
-	R_MarkLeaves();
-
 	// clear out the visible min/max
 	ClearBounds(tr.viewParms.visBounds[0], tr.viewParms.visBounds[1]);
 
@@ -767,5 +1046,146 @@ void R_AddWorldSurfaces() {
 		tr.refdef.num_dlights = 32;
 	}
 
-	R_RecursiveWorldNode(tr.world->nodes, 31, (1 << tr.refdef.num_dlights) - 1);
-}
\ No newline at end of file
+	if (!worldBench.running && worldBench.frameCount != tr.frameCount) {
+		worldBench.valid = qtrue;
+		worldBench.frameCount = tr.frameCount;
+		worldBench.viewParms = tr.viewParms;
+		worldBench.ori = tr.ori;
+		worldBench.refdef = tr.refdef;
+		memcpy(worldBench.dlights, tr.refdef.dlights, tr.refdef.num_dlights * sizeof(dlight_t));
+		worldBench.refdef.dlights = worldBench.dlights;
+	}
+
+	int walkMode = worldBench.walkMode;
+	if (walkMode < 0) {
+		if (r_clusterSurfaces->integer && tr.world->clusterFirstArea) {
+			walkMode = WORLD_WALK_CLUSTERS;
+		}
+		else if (r_parallelWorld->integer && R_NumWorkers() > 0) {
+			walkMode = WORLD_WALK_JOBS;
+		}
+		else {
+			walkMode = WORLD_WALK_TREE;
+		}
+	}
+
+	const int dlightBits = (1 << tr.refdef.num_dlights) - 1;
+
+	if (walkMode == WORLD_WALK_CLUSTERS && R_AddClusterSurfaces(dlightBits)) {
+		return;
+	}
+
+	// determine which leaves are in the PVS / areamask
+	R_MarkLeaves();
+
+	if (walkMode == WORLD_WALK_JOBS) {
+		R_ParallelWorldNode(tr.world->nodes, 31, dlightBits);
+	}
+	else {
+		R_RecursiveWorldNode(tr.world->nodes, 31, dlightBits);
+	}
+}
+
+/*
+=============
+R_WorldBenchRun
+
+Replays the saved view the given number of times, returns the average
+time of one walk in microseconds.
+=============
+*/
+static double R_WorldBenchRun(const int walkMode, const int frames, drawSurf_t* drawSurfs, int* numDrawSurfs) {
+	int64_t usec = 0;
+
+	worldBench.walkMode = walkMode;
+	// force the first walk to mark the leaves for the saved view
+	leafMarksStale = qtrue;
+	memset(&tr.pc, 0, sizeof tr.pc);
+
+	for (int i = 0; i < frames; i++) {
+		tr.viewParms = worldBench.viewParms;
+		tr.ori = worldBench.ori;
+		tr.refdef = worldBench.refdef;
+		tr.refdef.drawSurfs = drawSurfs;
+		tr.refdef.numDrawSurfs = 0;
+		tr.viewCount++;
+
+		const timingUsec_c timer;
+		R_AddWorldSurfaces();
+		usec += timer.End();
+	}
+
+	*numDrawSurfs = tr.refdef.numDrawSurfs;
+	return static_cast<double>(usec) / frames;
+}
+
+/*
+=============
+R_WorldBench_f
+
+r_worldbench [frames]
+
+Times the world walks on the last frame's view without drawing anything:
+the tree on one thread, the tree on the worker threads and the cluster
+surface lists.  Checks that the threaded walk gives the same draw surfaces.
+=============
+*/
+void R_WorldBench_f() {
+	if (!tr.registered || !tr.world || !worldBench.valid) {
+		ri.Printf(PRINT_ALL, "r_worldbench: no world view to replay, load a map first\n");
+		return;
+	}
+
+	const int frames = ri.Cmd_Argc() > 1 ? Com_Clampi(1, 10000, atoi(ri.Cmd_Argv(1))) : 200;
+
+	// the back end may still be reading the surfaces
+	R_IssuePendingRenderCommands();
+
+	const viewParms_t savedViewParms = tr.viewParms;
+	const orientationr_t savedOri = tr.ori;
+	const trRefdef_t savedRefdef = tr.refdef;
+	const frontEndCounters_t savedPc = tr.pc;
+	const int savedEntityNum = tr.currentEntityNum;
+	const int savedShiftedEntityNum = tr.shiftedEntityNum;
+	std::vector<drawSurf_t> drawSurfs[NUM_WORLD_WALKS];
+	int numDrawSurfs[NUM_WORLD_WALKS];
+	int leafs[NUM_WORLD_WALKS];
+	double usec[NUM_WORLD_WALKS];
+
+	worldBench.running = qtrue;
+	for (int i = 0; i < NUM_WORLD_WALKS; i++) {
+		drawSurfs[i].resize(MAX_DRAWSURFS);
+		usec[i] = R_WorldBenchRun(i, frames, drawSurfs[i].data(), &numDrawSurfs[i]);
+		leafs[i] = tr.pc.c_leafs / frames;
+	}
+	worldBench.running = qfalse;
+	worldBench.walkMode = -1;
+
+	tr.viewParms = savedViewParms;
+	tr.ori = savedOri;
+	tr.refdef = savedRefdef;
+	tr.pc = savedPc;
+	tr.currentEntityNum = savedEntityNum;
+	tr.shiftedEntityNum = savedShiftedEntityNum;
+	// the leafs are marked for the saved view now
+	leafMarksStale = qtrue;
+
+	const qboolean same = static_cast<qboolean>(numDrawSurfs[WORLD_WALK_TREE] == numDrawSurfs[WORLD_WALK_JOBS]
+		&& !memcmp(drawSurfs[WORLD_WALK_TREE].data(), drawSurfs[WORLD_WALK_JOBS].data(),
+			numDrawSurfs[WORLD_WALK_TREE] * sizeof(drawSurf_t)));
+
+	ri.Printf(PRINT_ALL, "r_worldbench: %d frames, %d leafs, %d draw surfaces\n", frames,
+		leafs[WORLD_WALK_TREE], numDrawSurfs[WORLD_WALK_TREE]);
+	ri.Printf(PRINT_ALL, " single threaded %.3f ms\n", usec[WORLD_WALK_TREE] / 1000.0);
+	ri.Printf(PRINT_ALL, " %d worker threads %.3f ms (%.2fx), %d jobs, draw surfaces %s\n", R_NumWorkers(),
+		usec[WORLD_WALK_JOBS] / 1000.0, usec[WORLD_WALK_JOBS] > 0.0 ? usec[WORLD_WALK_TREE] / usec[WORLD_WALK_JOBS] : 0.0,
+		numWorldJobs, same ? "identical" : "DIFFERENT");
+	if (tr.world->clusterFirstArea) {
+		ri.Printf(PRINT_ALL, " cluster lists %.3f ms (%.2fx), %d areas, %d draw surfaces\n", usec[WORLD_WALK_CLUSTERS] / 1000.0,
+			usec[WORLD_WALK_CLUSTERS] > 0.0 ? usec[WORLD_WALK_TREE] / usec[WORLD_WALK_CLUSTERS] : 0.0,
+			leafs[WORLD_WALK_CLUSTERS], numDrawSurfs[WORLD_WALK_CLUSTERS]);
+	}
+	else {
+		ri.Printf(PRINT_ALL, " no cluster lists for this map (r_clusterSurfaces)\n");
+	}
+}
@@ -287,6 +287,9 @@ Ghoul2 Insert End
 
 // pass_entity_num is explicitly excluded from clipping checks (normally ENTITYNUM_NONE)
 
+void SV_TraceBatch(traceJob_t* jobs, int num_jobs);
+// runs each job as SV_Trace would, sharing the entity gather between nearby moves
+
 ///////////////////////////////////////////////
 //
 // sv_savegame.cpp
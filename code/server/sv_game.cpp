@@ -926,6 +926,7 @@ void SV_InitGameProgs()
 	import.EntitiesInBox = SV_AreaEntities;
 	import.EntityContact = SV_EntityContact;
 	import.trace = SV_Trace;
+	import.traceBatch = SV_TraceBatch;
 	import.pointcontents = SV_PointContents;
 	import.totalMapContents = CM_TotalMapContents;
 	import.SetBrushModel = SV_SetBrushModel;
@@ -613,17 +613,15 @@ using moveclip_t = struct
 
 /*
 ====================
-SV_ClipMoveToEntities
+SV_ClipMoveToTouchList
 
 ====================
 */
-void SV_ClipMoveToEntities(moveclip_t* clip)
+static void SV_ClipMoveToTouchList(moveclip_t* clip, gentity_t** touchlist, const int num)
 {
-	gentity_t* touchlist[MAX_GENTITIES], * owner;
+	gentity_t* owner;
 	trace_t trace, oldTrace;
 
-	const int num = SV_AreaEntities(clip->boxmins, clip->boxmaxs, touchlist, MAX_GENTITIES);
-
 	if (clip->pass_entity_num != ENTITYNUM_NONE)
 	{
 		owner = (SV_GentityNum(clip->pass_entity_num))->owner;
@@ -860,22 +858,33 @@ void SV_ClipMoveToEntities(moveclip_t* clip)
 }
 
 /*
-==================
-SV_Trace
+====================
+SV_ClipMoveToEntities
 
-Moves the given mins/maxs volume through the world from start to end.
-pass_entity_num and entities owned by pass_entity_num are explicitly not checked.
-==================
+====================
 */
+void SV_ClipMoveToEntities(moveclip_t* clip)
+{
+	gentity_t* touchlist[MAX_GENTITIES];
+
+	const int num = SV_AreaEntities(clip->boxmins, clip->boxmaxs, touchlist, MAX_GENTITIES);
+
+	SV_ClipMoveToTouchList(clip, touchlist, num);
+}
+
 /*
-Ghoul2 Insert Start
+==================
+SV_TraceEntities
+
+The guts of SV_Trace.  If shared is set it is a list of the entities around a
+whole batch of moves, and only the ones that touch this move are clipped
+against, so the sector tree isn't walked again for every trace in the batch.
+==================
 */
-void SV_Trace(trace_t* results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end,
-	const int pass_entity_num, const int contentmask, const EG2_Collision e_g2_trace_type, const int use_lod)
+static void SV_TraceEntities(trace_t* results, const vec3_t start, const vec3_t mins, const vec3_t maxs,
+	const vec3_t end, const int pass_entity_num, const int contentmask, const EG2_Collision e_g2_trace_type,
+	const int use_lod, gentity_t** shared, const int num_shared)
 {
-	/*
-	Ghoul2 Insert End
-	*/
 #ifdef _DEBUG
 	assert(
 		!Q_isnan(start[0]) && !Q_isnan(start[1]) && !Q_isnan(start[2]) && !Q_isnan(end[0]) && !Q_isnan(end[1]) && !
@@ -974,7 +983,34 @@ void SV_Trace(trace_t* results, const vec3_t start, const vec3_t mins, const vec
 	}
 
 	// clip to other solid entities
-	SV_ClipMoveToEntities(&clip);
+	if (shared)
+	{
+		// the shared entities that touch this move, in the same order the
+		// sector walk for this move on its own would have returned them
+		gentity_t* touchlist[MAX_GENTITIES];
+		int num = 0;
+
+		for (int i = 0; i < num_shared; i++)
+		{
+			const gentity_t* touch = shared[i];
+
+			if (touch->absmin[0] > clip.boxmaxs[0]
+				|| touch->absmin[1] > clip.boxmaxs[1]
+				|| touch->absmin[2] > clip.boxmaxs[2]
+				|| touch->absmax[0] < clip.boxmins[0]
+				|| touch->absmax[1] < clip.boxmins[1]
+				|| touch->absmax[2] < clip.boxmins[2])
+			{
+				continue;
+			}
+			touchlist[num++] = shared[i];
+		}
+		SV_ClipMoveToTouchList(&clip, touchlist, num);
+	}
+	else
+	{
+		SV_ClipMoveToEntities(&clip);
+	}
 
 	//scale the trace back down by the previous fraction
 	clip.trace.fraction *= world_frac;
@@ -988,6 +1024,100 @@ void SV_Trace(trace_t* results, const vec3_t start, const vec3_t mins, const vec
 	*/
 }
 
+/*
+==================
+SV_Trace
+
+Moves the given mins/maxs volume through the world from start to end.
+pass_entity_num and entities owned by pass_entity_num are explicitly not checked.
+==================
+*/
+/*
+Ghoul2 Insert Start
+*/
+void SV_Trace(trace_t* results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end,
+	const int pass_entity_num, const int contentmask, const EG2_Collision e_g2_trace_type, const int use_lod)
+{
+	/*
+	Ghoul2 Insert End
+	*/
+	SV_TraceEntities(results, start, mins, maxs, end, pass_entity_num, contentmask, e_g2_trace_type, use_lod,
+		nullptr, 0);
+}
+
+#define	TRACEBATCH_MAX_EXTENT	1024	// widest group of moves that shares one entity gather
+
+/*
+==================
+SV_TraceBatch
+
+Runs a batch of traces, each giving the same result as SV_Trace would.  Neighbouring
+jobs whose moves fit together in a box no wider than TRACEBATCH_MAX_EXTENT share one
+walk of the sector tree for the linked entities, so the step probes of a move or a
+volley of missiles only gather them once.
+==================
+*/
+void SV_TraceBatch(traceJob_t* jobs, const int num_jobs)
+{
+	gentity_t* shared[MAX_GENTITIES];
+
+	for (int first = 0; first < num_jobs;)
+	{
+		vec3_t group_mins, group_maxs;
+		int last;
+
+		// grow the group while the moves still fit in one small box
+		for (last = first; last < num_jobs; last++)
+		{
+			const traceJob_t* job = &jobs[last];
+			vec3_t job_mins, job_maxs;
+			int i;
+
+			for (i = 0; i < 3; i++)
+			{
+				job_mins[i] = Q_min(job->start[i], job->end[i]) + job->mins[i] - 1;
+				job_maxs[i] = Q_max(job->start[i], job->end[i]) + job->maxs[i] + 1;
+				if (last != first)
+				{
+					job_mins[i] = Q_min(job_mins[i], group_mins[i]);
+					job_maxs[i] = Q_max(job_maxs[i], group_maxs[i]);
+					if (job_maxs[i] - job_mins[i] > TRACEBATCH_MAX_EXTENT)
+					{
+						break;
+					}
+				}
+			}
+			if (i < 3)
+			{
+				break;
+			}
+			VectorCopy(job_mins, group_mins);
+			VectorCopy(job_maxs, group_maxs);
+		}
+
+		if (last - first == 1)
+		{
+			traceJob_t* job = &jobs[first];
+
+			SV_TraceEntities(&job->trace, job->start, job->mins, job->maxs, job->end, job->pass_entity_num,
+				job->contentmask, job->e_g2_trace_type, job->use_lod, nullptr, 0);
+		}
+		else
+		{
+			const int num_shared = SV_AreaEntities(group_mins, group_maxs, shared, MAX_GENTITIES);
+
+			for (int j = first; j < last; j++)
+			{
+				traceJob_t* job = &jobs[j];
+
+				SV_TraceEntities(&job->trace, job->start, job->mins, job->maxs, job->end, job->pass_entity_num,
+					job->contentmask, job->e_g2_trace_type, job->use_lod, shared, num_shared);
+			}
+		}
+		first = last;
+	}
+}
+
 /*
 =============
 SV_PointContents
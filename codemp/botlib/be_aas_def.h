@@ -268,6 +268,9 @@ typedef struct aas_s
 	//cache list sorted on time
 	aas_routingcache_t* oldestcache;		// start of cache list sorted on time
 	aas_routingcache_t* newestcache;		// end of cache list sorted on time
+	//route cache file loaded as a single block, the caches in it are never freed separately
+	byte* routecachefile;
+	int routecachefilesize;
 	//maximum travel time through portal areas
 	int* portalmaxtraveltimes;
 	//areas the reachabilities go through
@@ -183,9 +183,13 @@ int AAS_StartFrame(float time)
 	//
 	if (saveroutingcache->value)
 	{
+		//calculate the cache for all areas so the whole map is in the route cache file
+		if (aasworld.initialized) AAS_CreateAllRoutingCache();
 		AAS_WriteRouteCache();
 		LibVarSet("saveroutingcache", "0");
 	} //end if
+	//evict after any route cache file is written so it holds every cache
+	if (aasworld.initialized) AAS_LimitRoutingCache();
 	//
 	aasworld.numframes++;
 	return BLERR_NOERROR;
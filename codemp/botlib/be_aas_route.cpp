@@ -50,6 +50,12 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "be_interface.h"
 #include "be_aas_def.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #define ROUTING_DEBUG
 
  //travel time in hundreths of a second = distance * 100 / speed
@@ -63,6 +69,9 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 //maximum number of routing updates each frame
 #define MAX_FRAMEROUTINGUPDATES		10
 
+//maximum number of routing worker threads
+#define MAX_ROUTINGWORKERS			8
+
 /*
 
   area routing cache:
@@ -86,6 +95,7 @@ int numportalcacheupdates;
 #endif //ROUTING_DEBUG
 
 int routingcachesize;
+int routingcacheevictable;	//part of routingcachesize in caches that can be evicted
 int max_routingcachesize;
 
 //===========================================================================
@@ -193,8 +203,37 @@ int AAS_TravelFlagForType(int traveltype)
 // Returns:				-
 // Changes Globals:		-
 //===========================================================================
+static qboolean AAS_IsMappedRoutingCache(const aas_routingcache_t* cache)
+{
+	return static_cast<qboolean>((const byte*)cache >= aasworld.routecachefile &&
+		(const byte*)cache < aasworld.routecachefile + aasworld.routecachefilesize);
+} //end of the function AAS_IsMappedRoutingCache
+//===========================================================================
+// only cache that can be evicted is kept in the list sorted on time so the
+// least recently used cache is always at the start of the list
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static qboolean AAS_IsEvictableRoutingCache(const aas_routingcache_t* cache)
+{
+	//never free area cache leading towards a portal
+	if (cache->type == CACHETYPE_AREA && aasworld.areasettings[cache->areanum].cluster < 0) return qfalse;
+	//cache from the route cache file doesn't use any pool memory
+	if (AAS_IsMappedRoutingCache(cache)) return qfalse;
+	return qtrue;
+} //end of the function AAS_IsEvictableRoutingCache
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
 void AAS_UnlinkCache(aas_routingcache_t* cache)
 {
+	if (!AAS_IsEvictableRoutingCache(cache)) return;
+	if (cache->time_prev || aasworld.oldestcache == cache) routingcacheevictable -= cache->size;
 	if (cache->time_next) cache->time_next->time_prev = cache->time_prev;
 	else aasworld.newestcache = cache->time_prev;
 	if (cache->time_prev) cache->time_prev->time_next = cache->time_next;
@@ -210,6 +249,12 @@ void AAS_UnlinkCache(aas_routingcache_t* cache)
 //===========================================================================
 void AAS_LinkCache(aas_routingcache_t* cache)
 {
+	if (!AAS_IsEvictableRoutingCache(cache))
+	{
+		cache->time_prev = cache->time_next = NULL;
+		return;
+	} //end if
+	routingcacheevictable += cache->size;
 	if (aasworld.newestcache)
 	{
 		aasworld.newestcache->time_next = cache;
@@ -232,8 +277,10 @@ void AAS_LinkCache(aas_routingcache_t* cache)
 void AAS_FreeRoutingCache(aas_routingcache_t* cache)
 {
 	AAS_UnlinkCache(cache);
+	//caches read from the route cache file live in one block that is freed as a whole
+	if (AAS_IsMappedRoutingCache(cache)) return;
 	routingcachesize -= cache->size;
-	FreeMemory(cache);
+	FreePoolMemory(cache);
 } //end of the function AAS_FreeRoutingCache
 //===========================================================================
 //
@@ -676,15 +723,8 @@ int AAS_FreeOldestCache(void)
 //===========================================================================
 int AAS_FreeOldestCache(void)
 {
-	aas_routingcache_t* cache;
-
-	for (cache = aasworld.oldestcache; cache; cache = cache->time_next) {
-		// never free area cache leading towards a portal
-		if (cache->type == CACHETYPE_AREA && aasworld.areasettings[cache->areanum].cluster < 0) {
-			continue;
-		}
-		break;
-	}
+	// only cache that can be evicted is linked in the time list
+	aas_routingcache_t* cache = aasworld.oldestcache;
 	if (cache) {
 		// unlink the cache
 		if (cache->type == CACHETYPE_AREA) {
@@ -702,11 +742,75 @@ int AAS_FreeOldestCache(void)
 			if (cache->next) cache->next->prev = cache->prev;
 		}
 		AAS_FreeRoutingCache(cache);
+		CountPoolMemoryEviction(MEMPOOL_ROUTINGCACHE);
 		return qtrue;
 	}
 	return qfalse;
 } //end of the function AAS_FreeOldestCache
 //===========================================================================
+// called once a frame, only the caches that can be evicted and the free
+// pool blocks count against the budget, the pinned portal area caches and
+// the route cache file don't. free blocks on the pool free lists are
+// returned first and the least recently used cache is only evicted when
+// there are none left
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_LimitRoutingCache(void)
+{
+	if (max_routingcachesize <= 0) return;
+	while (routingcacheevictable + PoolMemoryFree(MEMPOOL_ROUTINGCACHE) > max_routingcachesize)
+	{
+		if (!ReleasePoolMemory(MEMPOOL_ROUTINGCACHE) && !AAS_FreeOldestCache()) break;
+	} //end while
+} //end of the function AAS_LimitRoutingCache
+//===========================================================================
+// the budget used when max_routingcache is 0, enough for the area caches of
+// every area in every cluster plus the portal caches of every area for one
+// set of travel flags, so bots that all use the default travel flags never
+// evict each other's caches. never less than the old 4 MB default
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static int AAS_DefaultRoutingCacheSize(void)
+{
+	const int cachesize = sizeof(aas_routingcache_t);
+	const int traveltimesize = sizeof(unsigned short int) + sizeof(unsigned char);
+	double size = 0;
+
+	for (int i = 1; i < aasworld.numclusters; i++)
+	{
+		const aas_cluster_t* cluster = &aasworld.clusters[i];
+		size += static_cast<double>(cluster->numareas) * (cachesize + cluster->numreachabilityareas * traveltimesize);
+	} //end for
+	size += static_cast<double>(aasworld.numareas) * (cachesize + aasworld.numportals * traveltimesize);
+	//
+	if (size < 4096 * 1024) return 4096 * 1024;
+	if (size > 0x40000000) return 0x40000000;
+	return static_cast<int>(size);
+} //end of the function AAS_DefaultRoutingCacheSize
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_MemoryStats(void)
+{
+	botimport.Print(PRT_MESSAGE, "routing cache budget: %d KB, %d KB evictable, %d KB pinned\n", max_routingcachesize >> 10,
+		routingcacheevictable >> 10, (routingcachesize - routingcacheevictable) >> 10);
+	PrintPoolMemoryStats();
+	if (aasworld.routecachefile)
+	{
+		botimport.Print(PRT_MESSAGE, "route cache file: %d KB\n", aasworld.routecachefilesize >> 10);
+	} //end if
+	AAS_AASLinkHeapStats();
+} //end of the function AAS_MemoryStats
+//===========================================================================
 //
 // Parameter:			-
 // Returns:				-
@@ -721,7 +825,7 @@ aas_routingcache_t* AAS_AllocRoutingCache(int numtraveltimes)
 	//
 	routingcachesize += size;
 	//
-	aas_routingcache_t* cache = static_cast<aas_routingcache_t*>(GetClearedMemory(size));
+	aas_routingcache_t* cache = static_cast<aas_routingcache_t*>(GetClearedPoolMemory(MEMPOOL_ROUTINGCACHE, size));
 	cache->reachabilities = (unsigned char*)cache + sizeof(aas_routingcache_t)
 		+ numtraveltimes * sizeof(unsigned short int);
 	cache->size = size;
@@ -860,6 +964,7 @@ void AAS_CreateAllRoutingCache(void)
 {
 	//int t;
 
+	const int initialized = aasworld.initialized;
 	aasworld.initialized = qtrue;
 	botimport.Print(PRT_MESSAGE, "AAS_CreateAllRoutingCache\n");
 	for (int i = 1; i < aasworld.numareas; i++)
@@ -874,7 +979,7 @@ void AAS_CreateAllRoutingCache(void)
 			//Log_Write("traveltime from %d to %d is %d", i, j, t);
 		} //end for
 	} //end for
-	aasworld.initialized = qfalse;
+	aasworld.initialized = initialized;
 } //end of the function AAS_CreateAllRoutingCache
 //===========================================================================
 //
@@ -884,8 +989,9 @@ void AAS_CreateAllRoutingCache(void)
 //===========================================================================
 
 //the route cache header
-//this header is followed by numportalcache + numareacache aas_routingcache_t
-//structures that store routing cache
+//this header is followed by datasize bytes holding numportalcache + numareacache
+//aas_routingcache_t structures, each padded to RCALIGN bytes and stored with the
+//list and reachability pointers cleared so the whole block can be used in place
 typedef struct routecacheheader_s
 {
 	int ident;
@@ -894,13 +1000,99 @@ typedef struct routecacheheader_s
 	int numclusters;
 	int areacrc;
 	int clustercrc;
+	int bspchecksum;				//checksum of the BSP the AAS file was created for
+	int aascrc;						//checksum of the AAS routing data the cache was calculated with
+	int cachestructsize;			//size of aas_routingcache_t, differs between 32 and 64 bit builds
 	int numportalcache;
 	int numareacache;
+	int datasize;					//number of bytes of cache data following the header
+	int datacrc;					//checksum of the cache data
 } routecacheheader_t;
 
 #define RCID						(('C'<<24)+('R'<<16)+('E'<<8)+'M')
-#define RCVERSION					2
+#define RCVERSION					3
+#define RCALIGN						8
+
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static void AAS_RouteCacheCRC(unsigned short* crc, const void* data, int length)
+{
+	const byte* bytes = static_cast<const byte*>(data);
+
+	for (int i = 0; i < length; i++)
+	{
+		CRC_ProcessByte(crc, bytes[i]);
+	} //end for
+} //end of the function AAS_RouteCacheCRC
+//===========================================================================
+// checksum of the AAS data the routing cache depends on
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static int AAS_RouteCacheAASChecksum(void)
+{
+	unsigned short crc;
+
+	CRC_Init(&crc);
+	AAS_RouteCacheCRC(&crc, aasworld.areasettings, aasworld.numareas * sizeof(aas_areasettings_t));
+	AAS_RouteCacheCRC(&crc, aasworld.reachability, aasworld.reachabilitysize * sizeof(aas_reachability_t));
+	AAS_RouteCacheCRC(&crc, aasworld.portals, aasworld.numportals * sizeof(aas_portal_t));
+	return CRC_Value(crc);
+} //end of the function AAS_RouteCacheAASChecksum
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static int AAS_RouteCacheRecordSize(int size)
+{
+	return (size + RCALIGN - 1) & ~(RCALIGN - 1);
+} //end of the function AAS_RouteCacheRecordSize
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static void AAS_WriteCache(fileHandle_t fp, const aas_routingcache_t* cache, unsigned short* crc)
+{
+	static const byte padding[RCALIGN] = { 0 };
+	aas_routingcache_t header;
 
+	//clear everything that is only valid in memory
+	Com_Memcpy(&header, cache, sizeof(aas_routingcache_t));
+	header.time = 0;
+	header.prev = header.next = NULL;
+	header.time_prev = header.time_next = NULL;
+	header.reachabilities = NULL;
+	botimport.FS_Write(&header, sizeof(aas_routingcache_t), fp);
+	AAS_RouteCacheCRC(crc, &header, sizeof(aas_routingcache_t));
+	//the travel times and reachabilities following the structure
+	const byte* data = (const byte*)cache + sizeof(aas_routingcache_t);
+	const int datasize = cache->size - sizeof(aas_routingcache_t);
+	botimport.FS_Write(data, datasize, fp);
+	AAS_RouteCacheCRC(crc, data, datasize);
+	//pad so the next cache is aligned when the file is used in place
+	const int padsize = AAS_RouteCacheRecordSize(cache->size) - cache->size;
+	if (padsize > 0)
+	{
+		botimport.FS_Write(padding, padsize, fp);
+		AAS_RouteCacheCRC(crc, padding, padsize);
+	} //end if
+} //end of the function AAS_WriteCache
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
 void AAS_WriteRouteCache(void)
 {
 	int i, j;
@@ -909,13 +1101,16 @@ void AAS_WriteRouteCache(void)
 	fileHandle_t fp;
 	char filename[MAX_QPATH];
 	routecacheheader_t routecacheheader;
+	unsigned short datacrc;
 
 	int numportalcache = 0;
+	int datasize = 0;
 	for (i = 0; i < aasworld.numareas; i++)
 	{
 		for (cache = aasworld.portalcache[i]; cache; cache = cache->next)
 		{
 			numportalcache++;
+			datasize += AAS_RouteCacheRecordSize(cache->size);
 		} //end for
 	} //end for
 	int numareacache = 0;
@@ -927,6 +1122,7 @@ void AAS_WriteRouteCache(void)
 			for (cache = aasworld.clusterareacache[i][j]; cache; cache = cache->next)
 			{
 				numareacache++;
+				datasize += AAS_RouteCacheRecordSize(cache->size);
 			} //end for
 		} //end for
 	} //end for
@@ -939,25 +1135,29 @@ void AAS_WriteRouteCache(void)
 		return;
 	} //end if
 	//create the header
+	Com_Memset(&routecacheheader, 0, sizeof(routecacheheader_t));
 	routecacheheader.ident = RCID;
 	routecacheheader.version = RCVERSION;
 	routecacheheader.numareas = aasworld.numareas;
 	routecacheheader.numclusters = aasworld.numclusters;
 	routecacheheader.areacrc = CRC_ProcessString((unsigned char*)aasworld.areas, sizeof(aas_area_t) * aasworld.numareas);
 	routecacheheader.clustercrc = CRC_ProcessString((unsigned char*)aasworld.clusters, sizeof(aas_cluster_t) * aasworld.numclusters);
+	routecacheheader.bspchecksum = aasworld.bspchecksum;
+	routecacheheader.aascrc = AAS_RouteCacheAASChecksum();
+	routecacheheader.cachestructsize = sizeof(aas_routingcache_t);
 	routecacheheader.numportalcache = numportalcache;
 	routecacheheader.numareacache = numareacache;
-	//write the header
+	routecacheheader.datasize = datasize;
+	//write the header, the data checksum is filled in once the cache is written
 	botimport.FS_Write(&routecacheheader, sizeof(routecacheheader_t), fp);
 	//
-	int totalsize = 0;
+	CRC_Init(&datacrc);
 	//write all the cache
 	for (i = 0; i < aasworld.numareas; i++)
 	{
 		for (cache = aasworld.portalcache[i]; cache; cache = cache->next)
 		{
-			botimport.FS_Write(cache, cache->size, fp);
-			totalsize += cache->size;
+			AAS_WriteCache(fp, cache, &datacrc);
 		} //end for
 	} //end for
 	for (i = 0; i < aasworld.numclusters; i++)
@@ -967,50 +1167,60 @@ void AAS_WriteRouteCache(void)
 		{
 			for (cache = aasworld.clusterareacache[i][j]; cache; cache = cache->next)
 			{
-				botimport.FS_Write(cache, cache->size, fp);
-				totalsize += cache->size;
+				AAS_WriteCache(fp, cache, &datacrc);
 			} //end for
 		} //end for
 	} //end for
-	// write the visareas
-	/*
-	for (i = 0; i < aasworld.numareas; i++)
-	{
-		if (!aasworld.areavisibility[i]) {
-			size = 0;
-			botimport.FS_Write(&size, sizeof(int), fp);
-			continue;
-		}
-		AAS_DecompressVis( aasworld.areavisibility[i], aasworld.numareas, aasworld.decompressedvis );
-		size = AAS_CompressVis( aasworld.decompressedvis, aasworld.numareas, aasworld.decompressedvis );
-		botimport.FS_Write(&size, sizeof(int), fp);
-		botimport.FS_Write(aasworld.decompressedvis, size, fp);
-	}
-	*/
+	//rewrite the header with the data checksum
+	routecacheheader.datacrc = CRC_Value(datacrc);
+	botimport.FS_Seek(fp, 0, FS_SEEK_SET);
+	botimport.FS_Write(&routecacheheader, sizeof(routecacheheader_t), fp);
 	//
 	botimport.FS_FCloseFile(fp);
 	botimport.Print(PRT_MESSAGE, "\nroute cache written to %s\n", filename);
-	botimport.Print(PRT_MESSAGE, "written %d bytes of routing cache\n", totalsize);
+	botimport.Print(PRT_MESSAGE, "written %d portal and %d area caches, %d bytes of routing cache\n",
+		numportalcache, numareacache, datasize);
 } //end of the function AAS_WriteRouteCache
 //===========================================================================
+// sets up a routing cache stored in the route cache file in place
 //
 // Parameter:			-
-// Returns:				-
+// Returns:				size of the cache record or 0 if the record is invalid
 // Changes Globals:		-
 //===========================================================================
-aas_routingcache_t* AAS_ReadCache(fileHandle_t fp)
+static int AAS_SetupMappedCache(aas_routingcache_t* cache, int available, int type)
 {
-	int size;
-
-	botimport.FS_Read(&size, sizeof(size), fp);
-	aas_routingcache_t* cache = static_cast<aas_routingcache_t*>(GetMemory(size));
-	cache->size = size;
-	botimport.FS_Read((unsigned char*)cache + sizeof(size), size - sizeof(size), fp);
-	cache->reachabilities = (unsigned char*)cache + sizeof(aas_routingcache_t) - sizeof(unsigned short) +
-		(size - sizeof(aas_routingcache_t) + sizeof(unsigned short)) / 3 * 2;
-	return cache;
-} //end of the function AAS_ReadCache
-//===========================================================================
+	if (available < static_cast<int>(sizeof(aas_routingcache_t))) return 0;
+	if (cache->size < static_cast<int>(sizeof(aas_routingcache_t))) return 0;
+	const int recordsize = AAS_RouteCacheRecordSize(cache->size);
+	if (recordsize > available) return 0;
+	//travel times and reachabilities follow the structure
+	const int datasize = cache->size - sizeof(aas_routingcache_t);
+	if (datasize % (sizeof(unsigned short int) + sizeof(unsigned char))) return 0;
+	const int numtraveltimes = datasize / (sizeof(unsigned short int) + sizeof(unsigned char));
+	if (cache->type != type) return 0;
+	if (cache->areanum <= 0 || cache->areanum >= aasworld.numareas) return 0;
+	if (type == CACHETYPE_AREA)
+	{
+		if (cache->cluster <= 0 || cache->cluster >= aasworld.numclusters) return 0;
+		if (numtraveltimes != aasworld.clusters[cache->cluster].numreachabilityareas) return 0;
+		const int clusterareanum = AAS_ClusterAreaNum(cache->cluster, cache->areanum);
+		if (clusterareanum < 0 || clusterareanum >= aasworld.clusters[cache->cluster].numareas) return 0;
+	} //end if
+	else
+	{
+		if (numtraveltimes != aasworld.numportals) return 0;
+	} //end else
+	cache->reachabilities = (unsigned char*)cache + sizeof(aas_routingcache_t)
+		+ numtraveltimes * sizeof(unsigned short int);
+	cache->time = 0;
+	cache->prev = cache->next = NULL;
+	cache->time_prev = cache->time_next = NULL;
+	return recordsize;
+} //end of the function AAS_SetupMappedCache
+//===========================================================================
+// the route cache file is read as one block and the caches are used in
+// place so no memory is allocated per cache
 //
 // Parameter:			-
 // Returns:				-
@@ -1018,90 +1228,136 @@ aas_routingcache_t* AAS_ReadCache(fileHandle_t fp)
 //===========================================================================
 int AAS_ReadRouteCache(void)
 {
-	int i;//, size;
+	int i;
 	fileHandle_t fp;
 	char filename[MAX_QPATH];
 	routecacheheader_t routecacheheader;
 	aas_routingcache_t* cache;
+	unsigned short datacrc;
 
 	Com_sprintf(filename, MAX_QPATH, "maps/%s.rcd", aasworld.mapname);
-	botimport.FS_FOpenFile(filename, &fp, FS_READ);
+	const int filesize = botimport.FS_FOpenFile(filename, &fp, FS_READ);
 	if (!fp)
 	{
 		return qfalse;
 	} //end if
+	if (filesize < static_cast<int>(sizeof(routecacheheader_t)))
+	{
+		botimport.Print(PRT_WARNING, "%s is too small\n", filename);
+		botimport.FS_FCloseFile(fp);
+		return qfalse;
+	} //end if
 	botimport.FS_Read(&routecacheheader, sizeof(routecacheheader_t), fp);
 	if (routecacheheader.ident != RCID)
 	{
 		AAS_Error("%s is not a route cache dump\n", filename);
+		botimport.FS_FCloseFile(fp);
 		return qfalse;
 	} //end if
+	//an outdated route cache is ignored, it can simply be written again
 	if (routecacheheader.version != RCVERSION)
 	{
-		AAS_Error("route cache dump has wrong version %d, should be %d", routecacheheader.version, RCVERSION);
+		botimport.Print(PRT_WARNING, "%s has wrong version %d, should be %d\n", filename, routecacheheader.version, RCVERSION);
+		botimport.FS_FCloseFile(fp);
 		return qfalse;
 	} //end if
-	if (routecacheheader.numareas != aasworld.numareas)
+	if (routecacheheader.cachestructsize != static_cast<int>(sizeof(aas_routingcache_t)))
 	{
-		//AAS_Error("route cache dump has wrong number of areas\n");
+		botimport.Print(PRT_WARNING, "%s was written by an incompatible build\n", filename);
+		botimport.FS_FCloseFile(fp);
 		return qfalse;
 	} //end if
-	if (routecacheheader.numclusters != aasworld.numclusters)
-	{
-		//AAS_Error("route cache dump has wrong number of clusters\n");
+	//the cache has to be calculated for the loaded AAS file
+	if (routecacheheader.numareas != aasworld.numareas ||
+		routecacheheader.numclusters != aasworld.numclusters ||
+		routecacheheader.bspchecksum != aasworld.bspchecksum ||
+		routecacheheader.areacrc != CRC_ProcessString((unsigned char*)aasworld.areas, sizeof(aas_area_t) * aasworld.numareas) ||
+		routecacheheader.clustercrc != CRC_ProcessString((unsigned char*)aasworld.clusters, sizeof(aas_cluster_t) * aasworld.numclusters) ||
+		routecacheheader.aascrc != AAS_RouteCacheAASChecksum())
+	{
+		botimport.Print(PRT_WARNING, "%s does not match the AAS file\n", filename);
+		botimport.FS_FCloseFile(fp);
 		return qfalse;
 	} //end if
-	if (routecacheheader.areacrc !=
-		CRC_ProcessString((unsigned char*)aasworld.areas, sizeof(aas_area_t) * aasworld.numareas))
+	if (routecacheheader.numportalcache < 0 || routecacheheader.numareacache < 0 ||
+		routecacheheader.datasize <= 0 ||
+		routecacheheader.datasize != filesize - static_cast<int>(sizeof(routecacheheader_t)))
 	{
-		//AAS_Error("route cache dump area CRC incorrect\n");
+		botimport.Print(PRT_WARNING, "%s is truncated\n", filename);
+		botimport.FS_FCloseFile(fp);
 		return qfalse;
 	} //end if
-	if (routecacheheader.clustercrc !=
-		CRC_ProcessString((unsigned char*)aasworld.clusters, sizeof(aas_cluster_t) * aasworld.numclusters))
+	//read all the cache at once
+	byte* data = static_cast<byte*>(GetMemory(routecacheheader.datasize));
+	botimport.FS_Read(data, routecacheheader.datasize, fp);
+	botimport.FS_FCloseFile(fp);
+	CRC_Init(&datacrc);
+	AAS_RouteCacheCRC(&datacrc, data, routecacheheader.datasize);
+	if (routecacheheader.datacrc != CRC_Value(datacrc))
 	{
-		//AAS_Error("route cache dump cluster CRC incorrect\n");
+		botimport.Print(PRT_WARNING, "%s is corrupt\n", filename);
+		FreeMemory(data);
 		return qfalse;
 	} //end if
-	//read all the portal cache
-	for (i = 0; i < routecacheheader.numportalcache; i++)
-	{
-		cache = AAS_ReadCache(fp);
-		cache->next = aasworld.portalcache[cache->areanum];
-		cache->prev = NULL;
-		if (aasworld.portalcache[cache->areanum])
-			aasworld.portalcache[cache->areanum]->prev = cache;
-		aasworld.portalcache[cache->areanum] = cache;
+	//validate all the caches before any of them is linked in
+	int offset = 0;
+	const int numcache = routecacheheader.numportalcache + routecacheheader.numareacache;
+	for (i = 0; i < numcache; i++)
+	{
+		cache = reinterpret_cast<aas_routingcache_t*>(data + offset);
+		const int recordsize = AAS_SetupMappedCache(cache, routecacheheader.datasize - offset,
+			i < routecacheheader.numportalcache ? CACHETYPE_PORTAL : CACHETYPE_AREA);
+		if (!recordsize)
+		{
+			botimport.Print(PRT_WARNING, "%s has an invalid cache at offset %d\n", filename, offset);
+			FreeMemory(data);
+			return qfalse;
+		} //end if
+		offset += recordsize;
 	} //end for
-	//read all the cluster area cache
-	for (i = 0; i < routecacheheader.numareacache; i++)
-	{
-		cache = AAS_ReadCache(fp);
-		const int clusterareanum = AAS_ClusterAreaNum(cache->cluster, cache->areanum);
-		cache->next = aasworld.clusterareacache[cache->cluster][clusterareanum];
-		cache->prev = NULL;
-		if (aasworld.clusterareacache[cache->cluster][clusterareanum])
-			aasworld.clusterareacache[cache->cluster][clusterareanum]->prev = cache;
-		aasworld.clusterareacache[cache->cluster][clusterareanum] = cache;
+	aasworld.routecachefile = data;
+	aasworld.routecachefilesize = routecacheheader.datasize;
+	//link in all the cache
+	offset = 0;
+	for (i = 0; i < numcache; i++)
+	{
+		cache = reinterpret_cast<aas_routingcache_t*>(data + offset);
+		offset += AAS_RouteCacheRecordSize(cache->size);
+		if (cache->type == CACHETYPE_PORTAL)
+		{
+			cache->next = aasworld.portalcache[cache->areanum];
+			if (aasworld.portalcache[cache->areanum])
+				aasworld.portalcache[cache->areanum]->prev = cache;
+			aasworld.portalcache[cache->areanum] = cache;
+		} //end if
+		else
+		{
+			const int clusterareanum = AAS_ClusterAreaNum(cache->cluster, cache->areanum);
+			cache->next = aasworld.clusterareacache[cache->cluster][clusterareanum];
+			if (aasworld.clusterareacache[cache->cluster][clusterareanum])
+				aasworld.clusterareacache[cache->cluster][clusterareanum]->prev = cache;
+			aasworld.clusterareacache[cache->cluster][clusterareanum] = cache;
+		} //end else
 	} //end for
-	// read the visareas
-	/*
-	aasworld.areavisibility = (byte **) GetClearedMemory(aasworld.numareas * sizeof(byte *));
-	aasworld.decompressedvis = (byte *) GetClearedMemory(aasworld.numareas * sizeof(byte));
-	for (i = 0; i < aasworld.numareas; i++)
-	{
-		botimport.FS_Read(&size, sizeof(size), fp );
-		if (size) {
-			aasworld.areavisibility[i] = (byte *) GetMemory(size);
-			botimport.FS_Read(aasworld.areavisibility[i], size, fp );
-		}
-	}
-	*/
-	//
-	botimport.FS_FCloseFile(fp);
+	botimport.Print(PRT_MESSAGE, "loaded %d portal and %d area caches from %s\n",
+		routecacheheader.numportalcache, routecacheheader.numareacache, filename);
 	return qtrue;
 } //end of the function AAS_ReadRouteCache
 //===========================================================================
+// frees the block the route cache file was read into, all the caches in
+// it must have been unlinked already
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static void AAS_FreeRouteCacheFile(void)
+{
+	if (aasworld.routecachefile) FreeMemory(aasworld.routecachefile);
+	aasworld.routecachefile = NULL;
+	aasworld.routecachefilesize = 0;
+} //end of the function AAS_FreeRouteCacheFile
+//===========================================================================
 //
 // Parameter:			-
 // Returns:				-
@@ -1203,9 +1459,19 @@ void AAS_InitRouting(void)
 #endif //ROUTING_DEBUG
 	//
 	routingcachesize = 0;
-	max_routingcachesize = 1024 * static_cast<int>(LibVarValue("max_routingcache", "4096"));
+	routingcacheevictable = 0;
+	max_routingcachesize = 1024 * static_cast<int>(LibVarValue("max_routingcache", "0"));
+	if (!max_routingcachesize) max_routingcachesize = AAS_DefaultRoutingCacheSize();
 	// read any routing cache if available
 	AAS_ReadRouteCache();
+	// start the routing workers and get the portal area caches ready
+	AAS_InitRoutingWorkers();
+	const int numwarmed = AAS_WarmPortalAreaRoutingCaches(TFL_DEFAULT);
+	if (numwarmed)
+	{
+		botimport.Print(PRT_MESSAGE, "%d portal area routing caches created on %d threads\n", numwarmed,
+			AAS_NumRoutingWorkers() + 1);
+	} //end if
 } //end of the function AAS_InitRouting
 //===========================================================================
 //
@@ -1215,10 +1481,16 @@ void AAS_InitRouting(void)
 //===========================================================================
 void AAS_FreeRoutingCaches(void)
 {
+	// stop the routing workers
+	AAS_ShutdownRoutingWorkers();
 	// free all the existing cluster area cache
 	AAS_FreeAllClusterAreaCache();
 	// free all the existing portal cache
 	AAS_FreeAllPortalCache();
+	// free the route cache file the remaining cache was read from
+	AAS_FreeRouteCacheFile();
+	// return the pooled routing cache memory
+	DumpPoolMemory(MEMPOOL_ROUTINGCACHE);
 	// free cached travel times within areas
 	if (aasworld.areatraveltimes) FreeMemory(aasworld.areatraveltimes);
 	aasworld.areatraveltimes = NULL;
@@ -1244,13 +1516,17 @@ void AAS_FreeRoutingCaches(void)
 	aasworld.areacontentstravelflags = NULL;
 } //end of the function AAS_FreeRoutingCaches
 //===========================================================================
-// update the given routing cache
+// update the given routing cache using the given routing update fields
+// only reads the aas world so it can run on a routing worker thread as
+// long as every thread has its own update fields
 //
 // Parameter:			areacache		: routing cache to update
+//						areaupdate		: routing update fields, at least
+//										  numreachabilityareas of the cluster
 // Returns:				-
 // Changes Globals:		-
 //===========================================================================
-void AAS_UpdateAreaRoutingCache(aas_routingcache_t* areacache)
+static void AAS_UpdateAreaRoutingCacheWith(aas_routingcache_t* areacache, aas_routingupdate_t* areaupdate)
 {
 	int i, nextareanum, cluster, badtravelflags, clusterareanum, linknum;
 	int numreachabilityareas;
@@ -1260,13 +1536,8 @@ void AAS_UpdateAreaRoutingCache(aas_routingcache_t* areacache)
 	aas_reversedreachability_t* revreach;
 	aas_reversedlink_t* revlink;
 
-#ifdef ROUTING_DEBUG
-	numareacacheupdates++;
-#endif //ROUTING_DEBUG
 	//number of reachability areas within this cluster
 	numreachabilityareas = aasworld.clusters[areacache->cluster].numreachabilityareas;
-	//
-	aasworld.frameroutingupdates++;
 	//clear the routing update fields
 //	Com_Memset(aasworld.areaupdate, 0, aasworld.numareas * sizeof(aas_routingupdate_t));
 	//
@@ -1277,7 +1548,7 @@ void AAS_UpdateAreaRoutingCache(aas_routingcache_t* areacache)
 	//
 	Com_Memset(startareatraveltimes, 0, sizeof(startareatraveltimes));
 	//
-	curupdate = &aasworld.areaupdate[clusterareanum];
+	curupdate = &areaupdate[clusterareanum];
 	curupdate->areanum = areacache->areanum;
 	//VectorCopy(areacache->origin, curupdate->start);
 	curupdate->areatraveltimes = startareatraveltimes;
@@ -1333,7 +1604,7 @@ void AAS_UpdateAreaRoutingCache(aas_routingcache_t* areacache)
 			{
 				areacache->traveltimes[clusterareanum] = t;
 				areacache->reachabilities[clusterareanum] = linknum - aasworld.areasettings[nextareanum].firstreachablearea;
-				nextupdate = &aasworld.areaupdate[clusterareanum];
+				nextupdate = &areaupdate[clusterareanum];
 				nextupdate->areanum = nextareanum;
 				nextupdate->tmptraveltime = t;
 				//VectorCopy(reach->start, nextupdate->start);
@@ -1354,8 +1625,315 @@ void AAS_UpdateAreaRoutingCache(aas_routingcache_t* areacache)
 			} //end if
 		} //end for
 	} //end while
+} //end of the function AAS_UpdateAreaRoutingCacheWith
+//===========================================================================
+// update the given routing cache
+//
+// Parameter:			areacache		: routing cache to update
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_UpdateAreaRoutingCache(aas_routingcache_t* areacache)
+{
+#ifdef ROUTING_DEBUG
+	numareacacheupdates++;
+#endif //ROUTING_DEBUG
+	aasworld.frameroutingupdates++;
+	AAS_UpdateAreaRoutingCacheWith(areacache, aasworld.areaupdate);
 } //end of the function AAS_UpdateAreaRoutingCache
 //===========================================================================
+// routing worker pool
+//
+// the worker threads only ever fill in the travel times of area caches that
+// were allocated and linked in on the main thread, the cache lists and the
+// botlib memory are never touched off the main thread. the main thread
+// works on the batch too and waits for it to be finished. workers take the
+// batch under the mutex when they wake and a new batch is only handed out
+// once every worker has left the previous one.
+//===========================================================================
+typedef struct aas_routeworkers_s
+{
+	std::vector<std::thread> threads;
+	std::vector<aas_routingupdate_t*> areaupdates;	//routing update fields per worker
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+	aas_routingcache_t** jobs;
+	int numjobs;
+	std::atomic<int> nextjob;
+	std::atomic<int> finishedjobs;
+	int active;										//workers still working on a batch
+	int batch;
+	bool quit;
+
+	~aas_routeworkers_s()
+	{
+		//botlib wasn't shut down, don't leave the threads running
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			quit = true;
+		}
+		wake.notify_all();
+		for (std::thread& thread : threads)
+		{
+			if (thread.joinable()) thread.join();
+		} //end for
+	}
+} aas_routeworkers_t;
+
+static aas_routeworkers_t routeworkers;
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static void AAS_RunRoutingJobs(aas_routingcache_t** jobs, int numjobs, aas_routingupdate_t* areaupdate)
+{
+	int job;
+
+	while ((job = routeworkers.nextjob.fetch_add(1)) < numjobs)
+	{
+		AAS_UpdateAreaRoutingCacheWith(jobs[job], areaupdate);
+		if (routeworkers.finishedjobs.fetch_add(1) + 1 == numjobs)
+		{
+			std::lock_guard<std::mutex> lock(routeworkers.mutex);
+			routeworkers.done.notify_all();
+		} //end if
+	} //end while
+} //end of the function AAS_RunRoutingJobs
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static void AAS_RoutingWorker(int worker)
+{
+	int batch = 0;
+
+	for (;;)
+	{
+		aas_routingcache_t** jobs;
+		int numjobs;
+		{
+			std::unique_lock<std::mutex> lock(routeworkers.mutex);
+			routeworkers.wake.wait(lock, [&batch] { return routeworkers.quit || routeworkers.batch != batch; });
+			if (routeworkers.quit) return;
+			batch = routeworkers.batch;
+			jobs = routeworkers.jobs;
+			numjobs = routeworkers.numjobs;
+			routeworkers.active++;
+		}
+		AAS_RunRoutingJobs(jobs, numjobs, routeworkers.areaupdates[worker]);
+		{
+			std::lock_guard<std::mutex> lock(routeworkers.mutex);
+			if (--routeworkers.active == 0) routeworkers.done.notify_all();
+		}
+	} //end for
+} //end of the function AAS_RoutingWorker
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_ShutdownRoutingWorkers(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(routeworkers.mutex);
+		routeworkers.quit = true;
+	}
+	routeworkers.wake.notify_all();
+	for (std::thread& thread : routeworkers.threads)
+	{
+		thread.join();
+	} //end for
+	routeworkers.threads.clear();
+	for (aas_routingupdate_t* areaupdate : routeworkers.areaupdates)
+	{
+		FreeMemory(areaupdate);
+	} //end for
+	routeworkers.areaupdates.clear();
+	routeworkers.quit = false;
+} //end of the function AAS_ShutdownRoutingWorkers
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_InitRoutingWorkers(void)
+{
+	AAS_ShutdownRoutingWorkers();
+	//negative means one worker per additional hardware thread
+	int numworkers = static_cast<int>(LibVarValue("routing_threads", "-1"));
+	if (numworkers < 0)
+	{
+		numworkers = static_cast<int>(std::thread::hardware_concurrency()) - 1;
+	} //end if
+	if (numworkers > MAX_ROUTINGWORKERS) numworkers = MAX_ROUTINGWORKERS;
+	if (numworkers <= 0) return;
+	//
+	int maxreachabilityareas = 0;
+	for (int i = 0; i < aasworld.numclusters; i++)
+	{
+		if (aasworld.clusters[i].numreachabilityareas > maxreachabilityareas)
+		{
+			maxreachabilityareas = aasworld.clusters[i].numreachabilityareas;
+		} //end if
+	} //end for
+	for (int i = 0; i < numworkers; i++)
+	{
+		routeworkers.areaupdates.push_back(static_cast<aas_routingupdate_t*>(GetClearedMemory(
+			maxreachabilityareas * sizeof(aas_routingupdate_t))));
+	} //end for
+	for (int i = 0; i < numworkers; i++)
+	{
+		routeworkers.threads.emplace_back(AAS_RoutingWorker, i);
+	} //end for
+} //end of the function AAS_InitRoutingWorkers
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+int AAS_NumRoutingWorkers(void)
+{
+	return static_cast<int>(routeworkers.threads.size());
+} //end of the function AAS_NumRoutingWorkers
+//===========================================================================
+// update a batch of area routing caches, spread over the routing workers
+//
+// Parameter:			caches		: allocated and linked caches to update
+//						numcaches	: number of caches
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_UpdateAreaRoutingCaches(aas_routingcache_t** caches, int numcaches)
+{
+	if (numcaches <= 0) return;
+#ifdef ROUTING_DEBUG
+	numareacacheupdates += numcaches;
+#endif //ROUTING_DEBUG
+	aasworld.frameroutingupdates += numcaches;
+	//
+	if (routeworkers.threads.empty() || numcaches == 1)
+	{
+		for (int i = 0; i < numcaches; i++)
+		{
+			AAS_UpdateAreaRoutingCacheWith(caches[i], aasworld.areaupdate);
+		} //end for
+		return;
+	} //end if
+	{
+		std::unique_lock<std::mutex> lock(routeworkers.mutex);
+		//a worker still on its way out of the last batch would take jobs from this one
+		routeworkers.done.wait(lock, [] { return routeworkers.active == 0; });
+		routeworkers.jobs = caches;
+		routeworkers.numjobs = numcaches;
+		routeworkers.finishedjobs = 0;
+		routeworkers.nextjob = 0;
+		routeworkers.batch++;
+	}
+	routeworkers.wake.notify_all();
+	//help out with the batch
+	AAS_RunRoutingJobs(caches, numcaches, aasworld.areaupdate);
+	//
+	std::unique_lock<std::mutex> lock(routeworkers.mutex);
+	routeworkers.done.wait(lock, [] { return routeworkers.finishedjobs >= routeworkers.numjobs; });
+	routeworkers.numjobs = 0;
+} //end of the function AAS_UpdateAreaRoutingCaches
+//===========================================================================
+// find the area routing cache with exactly the given travel flags
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static aas_routingcache_t* AAS_FindAreaRoutingCache(int clusternum, int areanum, int travelflags)
+{
+	const int clusterareanum = AAS_ClusterAreaNum(clusternum, areanum);
+	for (aas_routingcache_t* cache = aasworld.clusterareacache[clusternum][clusterareanum]; cache; cache = cache->next)
+	{
+		if (cache->travelflags == travelflags) return cache;
+	} //end for
+	return NULL;
+} //end of the function AAS_FindAreaRoutingCache
+//===========================================================================
+// allocate a new area routing cache and link it into the cluster area
+// cache, the travel times still have to be calculated
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static aas_routingcache_t* AAS_NewAreaRoutingCache(int clusternum, int areanum, int travelflags)
+{
+	const int clusterareanum = AAS_ClusterAreaNum(clusternum, areanum);
+	aas_routingcache_t* clustercache = aasworld.clusterareacache[clusternum][clusterareanum];
+	//
+	aas_routingcache_t* cache = AAS_AllocRoutingCache(aasworld.clusters[clusternum].numreachabilityareas);
+	cache->cluster = clusternum;
+	cache->areanum = areanum;
+	VectorCopy(aasworld.areas[areanum].center, cache->origin);
+	cache->starttraveltime = 1;
+	cache->travelflags = travelflags;
+	cache->prev = NULL;
+	cache->next = clustercache;
+	if (clustercache) clustercache->prev = cache;
+	aasworld.clusterareacache[clusternum][clusterareanum] = cache;
+	return cache;
+} //end of the function AAS_NewAreaRoutingCache
+//===========================================================================
+// create the missing area routing caches of every portal area towards the
+// clusters on both sides of the portal, these are needed by every route
+// that leaves a cluster, and update them in parallel. portal area caches
+// are never evicted so warming stops once they take up as much as the
+// routing cache budget, any others are created when asked for as before
+//
+// Parameter:			-
+// Returns:				number of caches created
+// Changes Globals:		-
+//===========================================================================
+int AAS_WarmPortalAreaRoutingCaches(int travelflags)
+{
+	int numcaches = 0;
+	qboolean full = qfalse;
+
+	if (!AAS_NumRoutingWorkers()) return 0;
+	//
+	aas_routingcache_t** caches = static_cast<aas_routingcache_t**>(GetMemory(
+		aasworld.numportals * 2 * sizeof(aas_routingcache_t*)));
+	for (int i = 1; i < aasworld.numportals && !full; i++)
+	{
+		const aas_portal_t* portal = &aasworld.portals[i];
+		const int clusters[2] = { portal->frontcluster, portal->backcluster };
+		for (int j = 0; j < 2; j++)
+		{
+			if (clusters[j] <= 0) continue;
+			if (AAS_ClusterAreaNum(clusters[j], portal->areanum) >= aasworld.clusters[clusters[j]].numreachabilityareas) continue;
+			if (AAS_FindAreaRoutingCache(clusters[j], portal->areanum, travelflags)) continue;
+			//don't warm past the routing memory budget
+			if (AvailableMemory() < 2 * 1024 * 1024 ||
+				(max_routingcachesize > 0 && routingcachesize - routingcacheevictable >= max_routingcachesize))
+			{
+				full = qtrue;
+				break;
+			} //end if
+			aas_routingcache_t* cache = AAS_NewAreaRoutingCache(clusters[j], portal->areanum, travelflags);
+			cache->time = AAS_RoutingTime();
+			cache->type = CACHETYPE_AREA;
+			AAS_LinkCache(cache);
+			caches[numcaches++] = cache;
+		} //end for
+	} //end for
+	AAS_UpdateAreaRoutingCaches(caches, numcaches);
+	FreeMemory(caches);
+	return numcaches;
+} //end of the function AAS_WarmPortalAreaRoutingCaches
+//===========================================================================
 //
 // Parameter:			-
 // Returns:				-
@@ -1378,16 +1956,7 @@ aas_routingcache_t* AAS_GetAreaRoutingCache(int clusternum, int areanum, int tra
 	//if there was no cache
 	if (!cache)
 	{
-		cache = AAS_AllocRoutingCache(aasworld.clusters[clusternum].numreachabilityareas);
-		cache->cluster = clusternum;
-		cache->areanum = areanum;
-		VectorCopy(aasworld.areas[areanum].center, cache->origin);
-		cache->starttraveltime = 1;
-		cache->travelflags = travelflags;
-		cache->prev = NULL;
-		cache->next = clustercache;
-		if (clustercache) clustercache->prev = cache;
-		aasworld.clusterareacache[clusternum][clusterareanum] = cache;
+		cache = AAS_NewAreaRoutingCache(clusternum, areanum, travelflags);
 		AAS_UpdateAreaRoutingCache(cache);
 	} //end if
 	else
@@ -1420,6 +1989,10 @@ void AAS_UpdatePortalRoutingCache(aas_routingcache_t* portalcache)
 #endif //ROUTING_DEBUG
 	//clear the routing update fields
 //	Com_Memset(aasworld.portalupdate, 0, (aasworld.numportals+1) * sizeof(aas_routingupdate_t));
+	//
+	//the update below asks for the area cache of nearly every portal area,
+	//calculate any that are missing all at once on the routing workers
+	AAS_WarmPortalAreaRoutingCaches(portalcache->travelflags);
 	//
 	curupdate = &aasworld.portalupdate[aasworld.numportals];
 	curupdate->cluster = portalcache->cluster;
@@ -1580,9 +2153,10 @@ int AAS_AreaRouteToGoalArea(int areanum, vec3_t origin, int goalareanum, int tra
 		return qfalse;
 	} //end if
 	// make sure the routing cache doesn't grow to large
-	while (AvailableMemory() < 1 * 1024 * 1024) {
-		if (!AAS_FreeOldestCache()) break;
-	}
+	while (AvailableMemory() < 1 * 1024 * 1024)
+	{
+		if (!ReleasePoolMemory(MEMPOOL_ROUTINGCACHE) && !AAS_FreeOldestCache()) break;
+	} //end while
 	//
 	if (AAS_AreaDoNotEnter(areanum) || AAS_AreaDoNotEnter(goalareanum))
 	{
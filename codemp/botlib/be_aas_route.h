@@ -46,10 +46,22 @@ unsigned short int AAS_AreaTravelTime(int areanum, vec3_t start, vec3_t end);
 //
 void AAS_CreateAllRoutingCache(void);
 void AAS_WriteRouteCache(void);
+//evict routing cache to stay within the memory budget, once a frame
+void AAS_LimitRoutingCache(void);
+//start and stop the threads that help calculate area routing caches
+void AAS_InitRoutingWorkers(void);
+void AAS_ShutdownRoutingWorkers(void);
+int AAS_NumRoutingWorkers(void);
+//calculate the travel times of a batch of new area routing caches
+void AAS_UpdateAreaRoutingCaches(struct aas_routingcache_s** caches, int numcaches);
+//create and calculate any missing portal area routing caches
+int AAS_WarmPortalAreaRoutingCaches(int travelflags);
 //
 void AAS_RoutingInfo(void);
 #endif //AASINTERN
 
+//prints the routing cache memory usage
+void AAS_MemoryStats(void);
 //returns the travel flag for the given travel type
 int AAS_TravelFlagForType(int traveltype);
 //return the travel flag(s) for traveling through this area
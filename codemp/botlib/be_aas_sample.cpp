@@ -68,6 +68,8 @@ typedef struct aas_tracestack_s
 } aas_tracestack_t;
 
 int numaaslinks;
+int minaaslinks;		//fewest free links since the heap was initialized
+int numaaslinkfailures;	//allocations that found the heap empty
 
 //===========================================================================
 //
@@ -127,6 +129,8 @@ void AAS_InitAASLinkHeap(void)
 	aasworld.freelinks = &aasworld.linkheap[0];
 	//
 	numaaslinks = max_aaslinks;
+	minaaslinks = max_aaslinks;
+	numaaslinkfailures = 0;
 } //end of the function AAS_InitAASLinkHeap
 //===========================================================================
 //
@@ -146,11 +150,24 @@ void AAS_FreeAASLinkHeap(void)
 // Returns:					-
 // Changes Globals:		-
 //===========================================================================
+void AAS_AASLinkHeapStats(void)
+{
+	botimport.Print(PRT_MESSAGE, "aas links: %d of %d used, %d peak, %d failed\n",
+		aasworld.linkheapsize - numaaslinks, aasworld.linkheapsize, aasworld.linkheapsize - minaaslinks,
+		numaaslinkfailures);
+} //end of the function AAS_AASLinkHeapStats
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
 aas_link_t* AAS_AllocAASLink(void)
 {
 	aas_link_t* link = aasworld.freelinks;
 	if (!link)
 	{
+		numaaslinkfailures++;
 #ifndef BSPC
 		if (botDeveloper)
 #endif
@@ -162,6 +179,7 @@ aas_link_t* AAS_AllocAASLink(void)
 	if (aasworld.freelinks) aasworld.freelinks = aasworld.freelinks->next_ent;
 	if (aasworld.freelinks) aasworld.freelinks->prev_ent = NULL;
 	numaaslinks--;
+	if (numaaslinks < minaaslinks) minaaslinks = numaaslinks;
 	return link;
 } //end of the function AAS_AllocAASLink
 //===========================================================================
@@ -49,6 +49,7 @@ aas_link_t* AAS_LinkEntityClientBBox(vec3_t absmins, vec3_t absmaxs, int entnum,
 qboolean AAS_PointInsideFace(int facenum, vec3_t point, float epsilon);
 qboolean AAS_InsideFace(aas_face_t* face, vec3_t pnormal, vec3_t point, float epsilon);
 void AAS_UnlinkFromAreas(aas_link_t* areas);
+void AAS_AASLinkHeapStats(void);
 #endif //AASINTERN
 
 //returns the mins and maxs of the bounding box for the given presence type
@@ -276,6 +276,17 @@ int Export_BotLibStartFrame(float time)
 // Returns:					-
 // Changes Globals:		-
 //===========================================================================
+void Export_BotLibMemoryStats(void)
+{
+	if (!BotLibSetup("BotLibMemoryStats")) return;
+	AAS_MemoryStats();
+} //end of the function Export_BotLibMemoryStats
+//===========================================================================
+//
+// Parameter:				-
+// Returns:					-
+// Changes Globals:		-
+//===========================================================================
 int Export_BotLibLoadMap(const char* mapname)
 {
 #ifdef DEBUG
@@ -897,6 +908,7 @@ botlib_export_t* GetBotLibAPI(int apiVersion, botlib_import_t* import) {
 	be_botlib_export.BotLibLoadMap = Export_BotLibLoadMap;
 	be_botlib_export.BotLibUpdateEntity = Export_BotLibUpdateEntity;
 	be_botlib_export.Test = BotExportTest;
+	be_botlib_export.BotLibMemoryStats = Export_BotLibMemoryStats;
 
 	return &be_botlib_export;
 }
\ No newline at end of file
@@ -442,6 +442,8 @@ typedef struct botlib_export_s
 	int (*BotLibUpdateEntity)(int ent, bot_entitystate_t* state);
 	//just for testing
 	int (*Test)(int parm0, char* parm1, vec3_t parm2, vec3_t parm3);
+	//print the pooled memory usage
+	void (*BotLibMemoryStats)(void);
 } botlib_export_t;
 
 //linking of bot library
@@ -459,4 +459,236 @@ void PrintMemoryLabels(void)
 {
 } //end of the function PrintMemoryLabels
 
-#endif
\ No newline at end of file
+#endif
+
+//===========================================================================
+// pooled memory
+//
+// blocks are rounded up to one of four size classes per power of two and
+// freed blocks are kept on a free list per size class, so the memory that
+// is constantly allocated and freed, like the routing cache, is reused
+// instead of fragmenting the zone
+//===========================================================================
+
+#define POOL_ID				0x13572468l
+#define POOL_MINSIZE		64
+#define POOL_NUMBUCKETS		84		//up to 64 << 20 bytes
+
+typedef struct poolblock_s
+{
+	unsigned long int id;					//POOL_ID
+	short bucket;							//size class or -1 when too large to pool
+	short category;							//memory category
+	int size;								//size of the block
+	struct poolblock_s* next;				//next free block in the size class
+} poolblock_t;
+
+static_assert(sizeof(poolblock_t) <= sizeof(qmax_align_t), "pool block header too large");
+
+typedef struct mempoolstats_s
+{
+	poolblock_t* freelist[POOL_NUMBUCKETS];
+	int usedbytes;							//bytes in blocks handed out
+	int freebytes;							//bytes in blocks on the free lists
+	int peakbytes;							//peak of used plus free bytes
+	int usedblocks;
+	int freeblocks;
+	int allocs;								//blocks allocated from the system
+	int reuses;								//allocations served from a free list
+	int releases;							//free blocks returned to the system
+	int evictions;							//blocks evicted to stay within budget
+} mempoolstats_t;
+
+static mempoolstats_t mempools[MEMPOOL_MAX];
+
+static const char* mempoolnames[MEMPOOL_MAX] =
+{
+	"routing cache"
+};
+
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static int PoolBucketSize(int bucket)
+{
+	const int base = POOL_MINSIZE << (bucket >> 2);
+	return base + (base >> 2) * (bucket & 3);
+} //end of the function PoolBucketSize
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				size class for the given size or -1 if too large
+// Changes Globals:		-
+//===========================================================================
+static int PoolBucketForSize(unsigned long size)
+{
+	int bucket = 0;
+	unsigned long base = POOL_MINSIZE;
+	while (base * 2 < size)
+	{
+		base <<= 1;
+		bucket += 4;
+	} //end while
+	while (static_cast<unsigned long>(PoolBucketSize(bucket)) < size) bucket++;
+	if (bucket >= POOL_NUMBUCKETS) return -1;
+	return bucket;
+} //end of the function PoolBucketForSize
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void* GetPoolMemory(int category, unsigned long size)
+{
+	mempoolstats_t* pool = &mempools[category];
+	poolblock_t* block;
+
+	const int bucket = PoolBucketForSize(size);
+	if (bucket >= 0 && pool->freelist[bucket])
+	{
+		block = pool->freelist[bucket];
+		pool->freelist[bucket] = block->next;
+		pool->freebytes -= block->size;
+		pool->freeblocks--;
+		pool->reuses++;
+	} //end if
+	else
+	{
+		const int blocksize = bucket >= 0 ? PoolBucketSize(bucket) : size;
+		block = static_cast<poolblock_t*>(botimport.GetMemory(blocksize + sizeof(qmax_align_t)));
+		if (!block) return NULL;
+		block->id = POOL_ID;
+		block->bucket = bucket;
+		block->category = category;
+		block->size = blocksize;
+		pool->allocs++;
+	} //end else
+	block->next = NULL;
+	pool->usedbytes += block->size;
+	pool->usedblocks++;
+	if (pool->usedbytes + pool->freebytes > pool->peakbytes)
+	{
+		pool->peakbytes = pool->usedbytes + pool->freebytes;
+	} //end if
+	return reinterpret_cast<char*>(block) + sizeof(qmax_align_t);
+} //end of the function GetPoolMemory
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void* GetClearedPoolMemory(int category, unsigned long size)
+{
+	void* ptr = GetPoolMemory(category, size);
+	if (ptr) Com_Memset(ptr, 0, size);
+	return ptr;
+} //end of the function GetClearedPoolMemory
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void FreePoolMemory(void* ptr)
+{
+	poolblock_t* block = reinterpret_cast<poolblock_t*>(static_cast<char*>(ptr) - sizeof(qmax_align_t));
+
+	if (block->id != POOL_ID)
+	{
+		botimport.Print(PRT_FATAL, "FreePoolMemory: invalid memory block\n");
+		return;
+	} //end if
+	mempoolstats_t* pool = &mempools[block->category];
+	pool->usedblocks--;
+	pool->usedbytes -= block->size;
+	//blocks too large to pool go straight back to the system
+	if (block->bucket < 0)
+	{
+		botimport.FreeMemory(block);
+		return;
+	} //end if
+	pool->freebytes += block->size;
+	pool->freeblocks++;
+	block->next = pool->freelist[block->bucket];
+	pool->freelist[block->bucket] = block;
+} //end of the function FreePoolMemory
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+int PoolMemoryFree(int category)
+{
+	return mempools[category].freebytes;
+} //end of the function PoolMemoryFree
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+int ReleasePoolMemory(int category)
+{
+	mempoolstats_t* pool = &mempools[category];
+
+	if (!pool->freeblocks) return qfalse;
+	//release the largest blocks first
+	for (int i = POOL_NUMBUCKETS - 1; i >= 0; i--)
+	{
+		poolblock_t* block = pool->freelist[i];
+		if (!block) continue;
+		pool->freelist[i] = block->next;
+		pool->freebytes -= block->size;
+		pool->freeblocks--;
+		pool->releases++;
+		botimport.FreeMemory(block);
+		return qtrue;
+	} //end for
+	return qfalse;
+} //end of the function ReleasePoolMemory
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void DumpPoolMemory(int category)
+{
+	while (ReleasePoolMemory(category))
+	{
+	} //end while
+} //end of the function DumpPoolMemory
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void CountPoolMemoryEviction(int category)
+{
+	mempools[category].evictions++;
+} //end of the function CountPoolMemoryEviction
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void PrintPoolMemoryStats(void)
+{
+	for (int i = 0; i < MEMPOOL_MAX; i++)
+	{
+		const mempoolstats_t* pool = &mempools[i];
+		botimport.Print(PRT_MESSAGE, "%s: %d KB in %d blocks used, %d KB in %d blocks free, %d KB peak\n",
+			mempoolnames[i], pool->usedbytes >> 10, pool->usedblocks, pool->freebytes >> 10, pool->freeblocks,
+			pool->peakbytes >> 10);
+		botimport.Print(PRT_MESSAGE, "%s: %d allocated, %d reused, %d released, %d evicted\n",
+			mempoolnames[i], pool->allocs, pool->reuses, pool->releases, pool->evictions);
+	} //end for
+} //end of the function PrintPoolMemoryStats
@@ -81,3 +81,27 @@ void PrintMemoryLabels(void);
 int MemoryByteSize(void* ptr);
 //free all allocated memory
 void DumpMemory(void);
+
+//categories of pooled memory
+typedef enum
+{
+	MEMPOOL_ROUTINGCACHE,
+	MEMPOOL_MAX
+} mempool_t;
+
+//allocate a memory block from the size class pool of the given category
+void* GetPoolMemory(int category, unsigned long size);
+//allocate a pooled memory block and clear it
+void* GetClearedPoolMemory(int category, unsigned long size);
+//put a pooled memory block back on the free list of its size class
+void FreePoolMemory(void* ptr);
+//returns the number of bytes kept on the free lists of the category
+int PoolMemoryFree(int category);
+//returns one free block of the category to the system, returns false if there was none
+int ReleasePoolMemory(int category);
+//returns all free blocks of the category to the system
+void DumpPoolMemory(int category);
+//counts a block of the category that was evicted to stay within the memory budget
+void CountPoolMemoryEviction(int category);
+//prints the per category pool memory usage
+void PrintPoolMemoryStats(void);
@@ -872,9 +872,9 @@ but we simulate all unacknowledged commands each time, not just the new ones.
 This means that on an internet connection, quite a few pmoves may be issued
 each frame.
 
-OPTIMIZE: don't re-simulate unless the newly arrived snapshot playerState_t
-differs from the predicted one.  Would require saving all intermediate
-playerState_t during prediction.
+The predicted playerState_t after every command is saved as a checkpoint, so
+when the newly arrived snapshot playerState_t matches what was predicted for
+it, only the commands after the newest checkpoint are simulated.
 
 We detect prediction errors and allow them to be decayed off over several frames
 to ease the jerk.
@@ -885,6 +885,232 @@ extern	vmCvar_t		cg_showVehBounds;
 pmove_t cg_vehPmove;
 qboolean cg_vehPmoveSet = qfalse;
 
+/*
+=================
+Prediction checkpoints
+
+The predicted state after every command is saved, keyed by the command number.
+When a new snapshot agrees with the state that was predicted for its command
+time, everything predicted after it is still good and prediction carries on
+from the newest checkpoint instead of running all the unacknowledged commands
+again. Any disagreement starts a new generation from the snapshot.
+=================
+*/
+typedef struct predictCheckpoint_s {
+	int				cmdNum;
+	int				generation;
+	playerState_t	ps;
+	playerState_t	vps;
+} predictCheckpoint_t;
+
+static predictCheckpoint_t cg_checkpoints[CMD_BACKUP];
+static int cg_checkpointGeneration;
+static int cg_checkpointNewest;		// command number of the newest checkpoint, 0 if there is none
+static int cg_checkpointSnapTime;	// serverTime of the snapshot the checkpoints were checked against
+
+static void CG_ClearPredictCheckpoints(void) {
+	cg_checkpointGeneration++;
+	cg_checkpointNewest = 0;
+	cg_checkpointSnapTime = 0;
+}
+
+static void CG_SavePredictCheckpoint(const int cmdNum) {
+	predictCheckpoint_t* cp = &cg_checkpoints[cmdNum & CMD_MASK];
+
+	cp->cmdNum = cmdNum;
+	cp->generation = cg_checkpointGeneration;
+	cp->ps = cg.predictedPlayerState;
+	if (CG_Piloting(cg.predictedPlayerState.m_iVehicleNum)) {
+		cp->vps = cg.predictedVehicleState;
+	}
+	cg_checkpointNewest = cmdNum;
+}
+
+/*
+=================
+CG_PredictionMatches
+
+Compares the fields pmove works from, anything the server changed
+on its own means the saved prediction can't be trusted
+=================
+*/
+static qboolean CG_PredictionMatches(const playerState_t* snap, const playerState_t* saved) {
+	if (snap->commandTime != saved->commandTime
+		|| snap->pm_type != saved->pm_type
+		|| snap->pm_flags != saved->pm_flags
+		|| snap->pm_time != saved->pm_time
+		|| !VectorCompare(snap->origin, saved->origin)
+		|| !VectorCompare(snap->velocity, saved->velocity)
+		|| !VectorCompare(snap->viewangles, saved->viewangles)
+		|| !VectorCompare(snap->vehOrientation, saved->vehOrientation)
+		|| snap->delta_angles[0] != saved->delta_angles[0]
+		|| snap->delta_angles[1] != saved->delta_angles[1]
+		|| snap->delta_angles[2] != saved->delta_angles[2]
+		|| snap->weaponTime != saved->weaponTime
+		|| snap->weaponChargeTime != saved->weaponChargeTime
+		|| snap->weapon != saved->weapon
+		|| snap->weaponstate != saved->weaponstate
+		|| snap->gravity != saved->gravity
+		|| snap->speed != saved->speed
+		|| snap->basespeed != saved->basespeed
+		|| snap->groundEntityNum != saved->groundEntityNum
+		|| snap->legsTimer != saved->legsTimer
+		|| snap->legsAnim != saved->legsAnim
+		|| snap->torsoTimer != saved->torsoTimer
+		|| snap->torsoAnim != saved->torsoAnim
+		|| snap->eFlags != saved->eFlags
+		|| snap->eFlags2 != saved->eFlags2
+		|| snap->eventSequence != saved->eventSequence
+		|| snap->viewheight != saved->viewheight
+		|| snap->saber_move != saved->saber_move
+		|| snap->saberBlocked != saved->saberBlocked
+		|| snap->saberHolstered != saved->saberHolstered
+		|| snap->saberInFlight != saved->saberInFlight
+		|| snap->saberLockTime != saved->saberLockTime
+		|| snap->forceHandExtend != saved->forceHandExtend
+		|| snap->m_iVehicleNum != saved->m_iVehicleNum
+		|| snap->jetpackFuel != saved->jetpackFuel
+		|| snap->cloakFuel != saved->cloakFuel
+		|| snap->fd.forcePowersActive != saved->fd.forcePowersActive
+		|| snap->fd.forcePower != saved->fd.forcePower
+		|| snap->fd.forceJumpZStart != saved->fd.forceJumpZStart
+		|| snap->fd.forceGripEntityNum != saved->fd.forceGripEntityNum
+		|| snap->fd.saber_anim_level != saved->fd.saber_anim_level
+		|| snap->fd.forcePowersKnown != saved->fd.forcePowersKnown
+		|| snap->fd.forcePowerLevel[FP_LEVITATION] != saved->fd.forcePowerLevel[FP_LEVITATION]
+		|| snap->fd.forcePowerLevel[FP_SEE] != saved->fd.forcePowerLevel[FP_SEE]
+		|| snap->zoomMode != saved->zoomMode
+		|| snap->zoomLocked != saved->zoomLocked
+		|| snap->duelInProgress != saved->duelInProgress
+		|| memcmp(snap->stats, saved->stats, sizeof snap->stats)
+		|| memcmp(snap->ammo, saved->ammo, sizeof snap->ammo)
+		|| memcmp(snap->powerups, saved->powerups, sizeof snap->powerups)) {
+		return qfalse;
+	}
+	return qtrue;
+}
+
+/*
+=================
+CG_CopyServerState
+
+Takes the state pmove doesn't predict from the snapshot, the server is
+the only one changing it so the checkpoint's copy may be out of date
+=================
+*/
+static void CG_CopyServerState(playerState_t* ps, const playerState_t* snap) {
+	memcpy(ps->persistant, snap->persistant, sizeof ps->persistant);
+	memcpy(ps->fd.forcePowerLevel, snap->fd.forcePowerLevel, sizeof ps->fd.forcePowerLevel);
+	ps->fd.forcePowersKnown = snap->fd.forcePowersKnown;
+	ps->fd.forcePowerSelected = snap->fd.forcePowerSelected;
+	ps->fd.forceSide = snap->fd.forceSide;
+	ps->fd.forceRageRecoveryTime = snap->fd.forceRageRecoveryTime;
+	ps->fd.forceMindtrickTargetIndex = snap->fd.forceMindtrickTargetIndex;
+	ps->fd.forceMindtrickTargetIndex2 = snap->fd.forceMindtrickTargetIndex2;
+	ps->fd.forceMindtrickTargetIndex3 = snap->fd.forceMindtrickTargetIndex3;
+	ps->fd.forceMindtrickTargetIndex4 = snap->fd.forceMindtrickTargetIndex4;
+	ps->fd.sentryDeployed = snap->fd.sentryDeployed;
+	ps->damageEvent = snap->damageEvent;
+	ps->damageYaw = snap->damageYaw;
+	ps->damagePitch = snap->damagePitch;
+	ps->damageCount = snap->damageCount;
+	ps->damageType = snap->damageType;
+	ps->externalEvent = snap->externalEvent;
+	ps->externalEventParm = snap->externalEventParm;
+	ps->generic1 = snap->generic1;
+	ps->loopSound = snap->loopSound;
+	ps->duelIndex = snap->duelIndex;
+	ps->duelTime = snap->duelTime;
+	ps->duelInProgress = snap->duelInProgress;
+	ps->zoomMode = snap->zoomMode;
+	ps->zoomTime = snap->zoomTime;
+	ps->zoomLocked = snap->zoomLocked;
+	ps->zoomFov = snap->zoomFov;
+	ps->rocketLockIndex = snap->rocketLockIndex;
+	ps->rocketLockTime = snap->rocketLockTime;
+	ps->rocketTargetTime = snap->rocketTargetTime;
+	ps->emplacedIndex = snap->emplacedIndex;
+	ps->isJediMaster = snap->isJediMaster;
+	ps->forceRestricted = snap->forceRestricted;
+	ps->trueJedi = snap->trueJedi;
+	ps->trueNonJedi = snap->trueNonJedi;
+	ps->genericEnemyIndex = snap->genericEnemyIndex;
+	ps->activeForcePass = snap->activeForcePass;
+	ps->hasDetPackPlanted = snap->hasDetPackPlanted;
+	ps->holocronBits = snap->holocronBits;
+	ps->electrifyTime = snap->electrifyTime;
+	ps->fallingToDeath = snap->fallingToDeath;
+	ps->heldByClient = snap->heldByClient;
+	ps->hasLookTarget = snap->hasLookTarget;
+	ps->lookTarget = snap->lookTarget;
+	ps->saberEntityNum = snap->saberEntityNum;
+	ps->saberLockEnemy = snap->saberLockEnemy;
+}
+
+/*
+=================
+CG_RestorePredictCheckpoint
+
+Called with the snapshot state in cg.predictedPlayerState, replaces it
+with the newest checkpoint if the snapshot confirms the prediction
+=================
+*/
+static qboolean CG_RestorePredictCheckpoint(const int current) {
+	if (!cg_predictCheckpoints.integer || cg_pmove.pmove_fixed
+		|| cg.thisFrameTeleport || cg.nextFrameTeleport || !cg_checkpointNewest) {
+		CG_ClearPredictCheckpoints();
+		return qfalse;
+	}
+
+	const predictCheckpoint_t* newest = &cg_checkpoints[cg_checkpointNewest & CMD_MASK];
+
+	if (newest->cmdNum != cg_checkpointNewest || newest->generation != cg_checkpointGeneration
+		|| newest->cmdNum > current || newest->cmdNum <= current - CMD_BACKUP) {
+		CG_ClearPredictCheckpoints();
+		return qfalse;
+	}
+
+	if (cg.physicsTime != cg_checkpointSnapTime) {
+		//a new snapshot, find what we predicted for its command time
+		const predictCheckpoint_t* match = NULL;
+
+		for (int cmdNum = cg_checkpointNewest; cmdNum > current - CMD_BACKUP; cmdNum--) {
+			const predictCheckpoint_t* cp = &cg_checkpoints[cmdNum & CMD_MASK];
+
+			if (cp->cmdNum != cmdNum || cp->generation != cg_checkpointGeneration
+				|| cp->ps.commandTime < cg.predictedPlayerState.commandTime) {
+				break;
+			}
+			if (cp->ps.commandTime == cg.predictedPlayerState.commandTime) {
+				match = cp;
+				break;
+			}
+		}
+
+		if (!match || !CG_PredictionMatches(&cg.predictedPlayerState, &match->ps)
+			|| (CG_Piloting(cg.predictedPlayerState.m_iVehicleNum)
+				&& !CG_PredictionMatches(&cg.predictedVehicleState, &match->vps))) {
+			CG_ClearPredictCheckpoints();
+			cg_checkpointSnapTime = cg.physicsTime;
+			return qfalse;
+		}
+
+		cg_checkpointSnapTime = cg.physicsTime;
+	}
+
+	const playerState_t snap = cg.predictedPlayerState;
+
+	cg.predictedPlayerState = newest->ps;
+	CG_CopyServerState(&cg.predictedPlayerState, &snap);
+	if (CG_Piloting(cg.predictedPlayerState.m_iVehicleNum)) {
+		const playerState_t vehSnap = cg.predictedVehicleState;
+
+		cg.predictedVehicleState = newest->vps;
+		CG_CopyServerState(&cg.predictedVehicleState, &vehSnap);
+	}
+	return qtrue;
+}
+
 void CG_PredictPlayerState(void) {
 	int i;
 	playerState_t	oldPlayerState;
@@ -908,6 +1134,7 @@ void CG_PredictPlayerState(void) {
 
 	// demo playback just copies the moves
 	if (cg.demoPlayback || (cg.snap->ps.pm_flags & PMF_FOLLOW)) {
+		CG_ClearPredictCheckpoints();
 		CG_InterpolatePlayerState(qfalse);
 		if (CG_Piloting(cg.predictedPlayerState.m_iVehicleNum))
 		{
@@ -918,6 +1145,7 @@ void CG_PredictPlayerState(void) {
 
 	// non-predicting local movement will grab the latest angles
 	if (cg_noPredict.integer || g_synchronousClients.integer || CG_UsingEWeb()) {
+		CG_ClearPredictCheckpoints();
 		CG_InterpolatePlayerState(qtrue);
 		if (CG_Piloting(cg.predictedPlayerState.m_iVehicleNum))
 		{
@@ -986,6 +1214,7 @@ void CG_PredictPlayerState(void) {
 		if (cg_showMiss.integer) {
 			trap->Print("exceeded PACKET_BACKUP on commands\n");
 		}
+		CG_ClearPredictCheckpoints();
 		return;
 	}
 
@@ -1026,6 +1255,10 @@ void CG_PredictPlayerState(void) {
 	cg_pmove.pmove_float = pmove_float.integer;
 	cg_pmove.pmove_msec = pmove_msec.integer;
 
+	// carry on from the newest checkpoint if the snapshot agrees with it,
+	// the commands up to it are skipped by their command time below
+	const qboolean resumed = CG_RestorePredictCheckpoint(current);
+
 	for (i = 0; i < MAX_GENTITIES; i++)
 	{
 		//Written this way for optimal speed, even though it doesn't look pretty.
@@ -1061,6 +1294,7 @@ void CG_PredictPlayerState(void) {
 
 	// run cmds
 	qboolean moved = qfalse;
+	int moves = 0;
 	for (cmdNum = current - CMD_BACKUP + 1; cmdNum <= current; cmdNum++) {
 		// get the command
 		trap->GetUserCmd(cmdNum, &cg_pmove.cmd);
@@ -1100,8 +1334,14 @@ void CG_PredictPlayerState(void) {
 			}
 			else {
 				vec3_t	adjusted;
-				CG_AdjustPositionForMover(cg.predictedVehicleState.origin,
-					cg.predictedVehicleState.groundEntityNum, cg.physicsTime, cg.oldTime, adjusted);
+				if (resumed) {
+					// the checkpoint was predicted on the mover as it was last frame already
+					VectorCopy(cg.predictedVehicleState.origin, adjusted);
+				}
+				else {
+					CG_AdjustPositionForMover(cg.predictedVehicleState.origin,
+						cg.predictedVehicleState.groundEntityNum, cg.physicsTime, cg.oldTime, adjusted);
+				}
 
 				if (cg_showVehMiss.integer) {
 					if (!VectorCompare(oldVehicleState.origin, adjusted)) {
@@ -1157,8 +1397,14 @@ void CG_PredictPlayerState(void) {
 			}
 			else {
 				vec3_t	adjusted;
-				CG_AdjustPositionForMover(cg.predictedPlayerState.origin,
-					cg.predictedPlayerState.groundEntityNum, cg.physicsTime, cg.oldTime, adjusted);
+				if (resumed) {
+					// the checkpoint was predicted on the mover as it was last frame already
+					VectorCopy(cg.predictedPlayerState.origin, adjusted);
+				}
+				else {
+					CG_AdjustPositionForMover(cg.predictedPlayerState.origin,
+						cg.predictedPlayerState.groundEntityNum, cg.physicsTime, cg.oldTime, adjusted);
+				}
 
 				if (cg_showMiss.integer) {
 					if (!VectorCompare(oldPlayerState.origin, adjusted)) {
@@ -1340,10 +1586,13 @@ void CG_PredictPlayerState(void) {
 		}
 
 		moved = qtrue;
+		moves++;
 
 		// add push trigger movement effects
 		CG_TouchTriggerPrediction();
 
+		CG_SavePredictCheckpoint(cmdNum);
+
 		// check for predictable events that changed from previous predictions
 		//CG_CheckChangedPredictableEvents(&cg.predictedPlayerState);
 	}
@@ -1352,6 +1601,10 @@ void CG_PredictPlayerState(void) {
 		trap->Print("[%i : %i] ", cg_pmove.cmd.serverTime, cg.time);
 	}
 
+	if (cg_showPredictMoves.integer) {
+		trap->Print("%i: %i moves predicted%s\n", cg.time, moves, resumed ? " from checkpoint" : "");
+	}
+
 	if (!moved) {
 		if (cg_showMiss.integer) {
 			trap->Print("not moved\n");
@@ -106,6 +106,7 @@ XCVAR_DEF(cg_noPredict, "0", NULL, CVAR_ARCHIVE)
 XCVAR_DEF(cg_noProjectileTrail, "0", NULL, CVAR_ARCHIVE)
 XCVAR_DEF(cg_noTaunt, "0", NULL, CVAR_ARCHIVE)
 XCVAR_DEF(cg_oldPainSounds, "0", NULL, CVAR_ARCHIVE)
+XCVAR_DEF(cg_predictCheckpoints, "1", NULL, CVAR_NONE)
 XCVAR_DEF(cg_predictItems, "1", NULL, CVAR_ARCHIVE)
 XCVAR_DEF(cg_renderToTextureFX, "1", NULL, CVAR_ARCHIVE)
 XCVAR_DEF(cg_repeaterOrb, "0", NULL, CVAR_ARCHIVE)
@@ -123,6 +124,7 @@ XCVAR_DEF(cg_stereoSeparation, "0.4", NULL, CVAR_ARCHIVE)
 XCVAR_DEF(cg_shadows, "1", NULL, CVAR_ARCHIVE)
 XCVAR_DEF(cg_simpleItems, "0", NULL, CVAR_ARCHIVE)
 XCVAR_DEF(cg_showMiss, "0", NULL, CVAR_NONE)
+XCVAR_DEF(cg_showPredictMoves, "0", NULL, CVAR_NONE)
 XCVAR_DEF(cg_showVehBounds, "0", NULL, CVAR_NONE)
 XCVAR_DEF(cg_showVehMiss, "0", NULL, CVAR_NONE)
 XCVAR_DEF(cg_smoothCamera, "0", NULL, CVAR_ARCHIVE)
@@ -94,6 +94,7 @@ vmCvar_t bot_camp;
 
 vmCvar_t bot_wp_info;
 vmCvar_t bot_wp_edit;
+vmCvar_t bot_wp_binary;
 vmCvar_t bot_wp_clearweight;
 vmCvar_t bot_wp_distconnect;
 vmCvar_t bot_wp_visconnect;
@@ -989,7 +990,7 @@ int OrgVisible(vec3_t org1, vec3_t org2, int ignore)
 {
 	trace_t tr;
 
-	trap->Trace(&tr, org1, NULL, NULL, org2, ignore, MASK_SOLID, qfalse, 0, 0);
+	trap->BotTrace(&tr, org1, NULL, NULL, org2, ignore, MASK_SOLID);
 
 	if (tr.fraction == 1)
 	{
@@ -1004,11 +1005,11 @@ int WPOrgVisible(gentity_t* bot, vec3_t org1, vec3_t org2, int ignore)
 {
 	trace_t tr;
 
-	trap->Trace(&tr, org1, NULL, NULL, org2, ignore, MASK_SOLID, qfalse, 0, 0);
+	trap->BotTrace(&tr, org1, NULL, NULL, org2, ignore, MASK_SOLID);
 
 	if (tr.fraction == 1)
 	{
-		trap->Trace(&tr, org1, NULL, NULL, org2, ignore, MASK_PLAYERSOLID, qfalse, 0, 0);
+		trap->BotTrace(&tr, org1, NULL, NULL, org2, ignore, MASK_PLAYERSOLID);
 
 		if (tr.fraction != 1 && tr.entity_num != ENTITYNUM_NONE && g_entities[tr.entity_num].s.eType == ET_SPECIAL)
 		{
@@ -1037,11 +1038,11 @@ int OrgVisibleBox(vec3_t org1, vec3_t mins, vec3_t maxs, vec3_t org2, int ignore
 
 	if (RMG.integer)
 	{
-		trap->Trace(&tr, org1, NULL, NULL, org2, ignore, MASK_SOLID, qfalse, 0, 0);
+		trap->BotTrace(&tr, org1, NULL, NULL, org2, ignore, MASK_SOLID);
 	}
 	else
 	{
-		trap->Trace(&tr, org1, mins, maxs, org2, ignore, MASK_SOLID, qfalse, 0, 0);
+		trap->BotTrace(&tr, org1, mins, maxs, org2, ignore, MASK_SOLID);
 	}
 
 	if (tr.fraction == 1 && !tr.startsolid && !tr.allsolid)
@@ -1064,7 +1065,7 @@ int CheckForFunc(vec3_t org, int ignore)
 
 	under[2] -= 64;
 
-	trap->Trace(&tr, org, NULL, NULL, under, ignore, MASK_SOLID, qfalse, 0, 0);
+	trap->BotTrace(&tr, org, NULL, NULL, under, ignore, MASK_SOLID);
 
 	if (tr.fraction == 1)
 	{
@@ -1294,7 +1295,39 @@ void CheckForShorterRoutes(bot_state_t* bs, int newwpindex)
 
 	//get the trail distance for our wp
 	int bestindex = newwpindex;
-	float bestlen = TotalTrailDistance(newwpindex, bs->wpDestination->index, bs);
+	float bestlen;
+	const int hop = WPNextHop(newwpindex, bs->wpDestination->index);
+
+	if (hop != -1)
+	{ //the precomputed shortest path says where to go, only the neighbors need checking
+		bestlen = 0;
+
+		while (i < gWPArray[newwpindex]->neighbornum)
+		{
+			if (gWPArray[newwpindex]->neighbors[i].num == hop &&
+				bs->cur_ps.fd.forcePowerLevel[FP_LEVITATION] >= gWPArray[newwpindex]->neighbors[i].forceJumpTo)
+			{
+				bestindex = hop;
+				fj = gWPArray[newwpindex]->neighbors[i].forceJumpTo;
+				break;
+			}
+			i++;
+		}
+
+		if (bestindex == hop || hop == newwpindex + 1 || hop == newwpindex - 1)
+		{ //taking the neighbor or following the trail is the shortest path
+			i = gWPArray[newwpindex]->neighbornum;
+		}
+		else
+		{ //we can't make the jump, look for another way
+			bestlen = TotalTrailDistance(newwpindex, bs->wpDestination->index, bs);
+			i = 0;
+		}
+	}
+	else
+	{
+		bestlen = TotalTrailDistance(newwpindex, bs->wpDestination->index, bs);
+	}
 
 	while (i < gWPArray[newwpindex]->neighbornum)
 	{ //now go through the neighbors and check the distance to the desired point from each neighbor
@@ -2739,7 +2772,7 @@ void GetNewFlagPoint(wpobject_t* wp, gentity_t* flagEnt, int team)
 
 	if (bestdist <= WP_KEEP_FLAG_DIST)
 	{
-		trap->Trace(&tr, wp->origin, mins, maxs, flagEnt->s.pos.trBase, flagEnt->s.number, MASK_SOLID, qfalse, 0, 0);
+		trap->BotTrace(&tr, wp->origin, mins, maxs, flagEnt->s.pos.trBase, flagEnt->s.number, MASK_SOLID);
 
 		if (tr.fraction == 1)
 		{ //this point is good
@@ -2754,7 +2787,7 @@ void GetNewFlagPoint(wpobject_t* wp, gentity_t* flagEnt, int team)
 
 		if (testdist < bestdist)
 		{
-			trap->Trace(&tr, gWPArray[i]->origin, mins, maxs, flagEnt->s.pos.trBase, flagEnt->s.number, MASK_SOLID, qfalse, 0, 0);
+			trap->BotTrace(&tr, gWPArray[i]->origin, mins, maxs, flagEnt->s.pos.trBase, flagEnt->s.number, MASK_SOLID);
 
 			if (tr.fraction == 1)
 			{
@@ -4228,12 +4261,10 @@ void CommanderBotAI(bot_state_t* bs)
 void MeleeCombatHandling(bot_state_t* bs)
 {
 	vec3_t usethisvec;
-	vec3_t downvec;
 	vec3_t midorg;
 	vec3_t a;
 	vec3_t fwd;
 	vec3_t mins, maxs;
-	trace_t tr;
 
 	if (!bs->currentEnemy)
 	{
@@ -4270,20 +4301,6 @@ void MeleeCombatHandling(bot_state_t* bs)
 	maxs[1] = 15;
 	maxs[2] = 32;
 
-	VectorCopy(usethisvec, downvec);
-	downvec[2] -= 4096;
-
-	trap->Trace(&tr, usethisvec, mins, maxs, downvec, -1, MASK_SOLID, qfalse, 0, 0);
-
-	const int en_down = (int)tr.endpos[2];
-
-	VectorCopy(bs->origin, downvec);
-	downvec[2] -= 4096;
-
-	trap->Trace(&tr, bs->origin, mins, maxs, downvec, -1, MASK_SOLID, qfalse, 0, 0);
-
-	const int me_down = (int)tr.endpos[2];
-
 	VectorSubtract(usethisvec, bs->origin, a);
 	vectoangles(a, a);
 	AngleVectors(a, fwd, NULL, NULL);
@@ -4292,12 +4309,26 @@ void MeleeCombatHandling(bot_state_t* bs)
 	midorg[1] = bs->origin[1] + fwd[1] * bs->frame_Enemy_Len / 2;
 	midorg[2] = bs->origin[2] + fwd[2] * bs->frame_Enemy_Len / 2;
 
-	VectorCopy(midorg, downvec);
-	downvec[2] -= 4096;
+	//trace down from the enemy, from us and from between us in one go
+	botTraceJob_t jobs[3];
+	VectorCopy(usethisvec, jobs[0].start);
+	VectorCopy(bs->origin, jobs[1].start);
+	VectorCopy(midorg, jobs[2].start);
+	for (int i = 0; i < 3; i++)
+	{
+		VectorCopy(mins, jobs[i].mins);
+		VectorCopy(maxs, jobs[i].maxs);
+		VectorCopy(jobs[i].start, jobs[i].end);
+		jobs[i].end[2] -= 4096;
+		jobs[i].passEntityNum = -1;
+		jobs[i].contentmask = MASK_SOLID;
+	}
 
-	trap->Trace(&tr, midorg, mins, maxs, downvec, -1, MASK_SOLID, qfalse, 0, 0);
+	trap->BotTraceBatch(jobs, 3);
 
-	const int mid_down = (int)tr.endpos[2];
+	const int en_down = (int)jobs[0].trace.endpos[2];
+	const int me_down = (int)jobs[1].trace.endpos[2];
+	const int mid_down = (int)jobs[2].trace.endpos[2];
 
 	if (me_down == en_down &&
 		en_down == mid_down)
@@ -7543,5 +7574,6 @@ int BotAIShutdown(int restart) {
 	else {
 		trap->BotLibShutdown();
 	}
+	FreeNextHops();
 	return qtrue;
 }
\ No newline at end of file
@@ -374,6 +374,8 @@ int OrgVisibleBox(vec3_t org1, vec3_t mins, vec3_t maxs, vec3_t org2, int ignore
 int BotIsAChickenWuss(bot_state_t* bs);
 int GetNearestVisibleWP(vec3_t org, int ignore);
 int GetBestIdleGoal(bot_state_t* bs);
+int WPNextHop(int from, int to);
+void FreeNextHops(void);
 
 char* ConcatArgs(int start);
 
@@ -392,6 +394,7 @@ extern vmCvar_t bot_wp_info;
 extern vmCvar_t bot_wp_edit;
 extern vmCvar_t bot_wp_clearweight;
 extern vmCvar_t bot_wp_distconnect;
+extern vmCvar_t bot_wp_binary;
 extern vmCvar_t bot_wp_visconnect;
 
 extern wpobject_t* flagRed;
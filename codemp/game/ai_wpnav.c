@@ -2420,6 +2420,473 @@ int SavePathData(const char* filename)
 	return 1;
 }
 
+//binary path data, built offline from the ascii .wnt with botbuildpathdata.
+//it holds the waypoints with everything that is normally calculated at map
+//start (weight goals, siege goals and jump routes) plus a table with the next
+//waypoint on the shortest path between any two waypoints
+#define WPBIN_IDENT			(('B'<<24)+('N'<<16)+('P'<<8)+'W')
+#define WPBIN_VERSION		1
+#define WPBIN_MAXHOPS		1024	//next hop tables are only built up to this many waypoints
+#define WPBIN_NOHOP			0xffff
+
+typedef struct wpbinheader_s
+{
+	int ident;
+	int version;
+	int mapChecksum;		//sv_mapChecksum of the bsp
+	int sourceChecksum;		//checksum of the .wnt the data was built from
+	int gametype;			//weight and siege goals depend on the entities of the gametype
+	int levelFlags;
+	int numWaypoints;
+	int numHops;			//number of waypoints in the next hop table, 0 if there is none
+	int dataChecksum;		//checksum of everything following the header
+} wpbinheader_t;
+
+static unsigned short* gWPNextHop = NULL;
+static int gWPNextHopNum = 0;
+
+static int WP_Checksum(const void* data, int len, int hash)
+{
+	const byte* bytes = (const byte*)data;
+	unsigned int h = (unsigned int)hash;
+	int i = 0;
+
+	while (i < len)
+	{
+		h = (h ^ bytes[i]) * 16777619u;
+		i++;
+	}
+
+	return (int)h;
+}
+
+//checksum of the ascii path data, 0 if there is none
+static int WP_SourceChecksum(const char* mapname)
+{
+	fileHandle_t f;
+	char routePath[MAX_QPATH];
+
+	Com_sprintf(routePath, sizeof(routePath), "botroutes/%s.wnt", mapname);
+
+	const int len = trap->FS_Open(routePath, &f, FS_READ);
+
+	if (!f)
+	{
+		return 0;
+	}
+
+	if (len <= 0 || len >= 524288)
+	{
+		trap->FS_Close(f);
+		return 0;
+	}
+
+	char* fileString = (char*)B_TempAlloc(524288);
+
+	trap->FS_Read(fileString, len, f);
+	trap->FS_Close(f);
+
+	const int checksum = WP_Checksum(fileString, len, (int)2166136261u);
+
+	B_TempFree(524288); //fileString
+
+	return checksum;
+}
+
+void FreeNextHops(void)
+{
+	if (gWPNextHop)
+	{
+		trap->TrueFree((void**)&gWPNextHop);
+	}
+	gWPNextHop = NULL;
+	gWPNextHopNum = 0;
+}
+
+//next waypoint on the shortest path from one waypoint to another,
+//-1 when there's no table or the goal can't be reached
+int WPNextHop(int from, int to)
+{
+	if (!gWPNextHop || gWPNextHopNum != gWPNum || from < 0 || to < 0 || from >= gWPNextHopNum || to >= gWPNextHopNum)
+	{
+		return -1;
+	}
+
+	const int hop = gWPNextHop[from * gWPNextHopNum + to];
+
+	if (hop == WPBIN_NOHOP)
+	{
+		return -1;
+	}
+
+	return hop;
+}
+
+typedef struct wphopnode_s
+{
+	float dist;
+	int wp;
+} wphopnode_t;
+
+static void WP_HeapPush(wphopnode_t* heap, int* heapsize, float dist, int wp)
+{
+	int i = (*heapsize)++;
+
+	while (i > 0)
+	{
+		const int parent = (i - 1) / 2;
+
+		if (heap[parent].dist <= dist)
+		{
+			break;
+		}
+		heap[i] = heap[parent];
+		i = parent;
+	}
+	heap[i].dist = dist;
+	heap[i].wp = wp;
+}
+
+static wphopnode_t WP_HeapPop(wphopnode_t* heap, int* heapsize)
+{
+	const wphopnode_t top = heap[0];
+	const wphopnode_t last = heap[--(*heapsize)];
+	int i = 0;
+
+	while (1)
+	{
+		int child = i * 2 + 1;
+
+		if (child >= *heapsize)
+		{
+			break;
+		}
+		if (child + 1 < *heapsize && heap[child + 1].dist < heap[child].dist)
+		{
+			child++;
+		}
+		if (last.dist <= heap[child].dist)
+		{
+			break;
+		}
+		heap[i] = heap[child];
+		i = child;
+	}
+	heap[i] = last;
+
+	return top;
+}
+
+//shortest path next hops over the trail links (respecting one way points)
+//and the neighbor links, with a dijkstra search from every waypoint
+static qboolean CalculateNextHops(void)
+{
+	const int num = gWPNum;
+	int i = 0;
+
+	FreeNextHops();
+
+	if (num <= 0 || num > WPBIN_MAXHOPS)
+	{
+		return qfalse;
+	}
+
+	trap->TrueMalloc((void**)&gWPNextHop, num * num * sizeof(unsigned short));
+
+	if (!gWPNextHop)
+	{
+		return qfalse;
+	}
+
+	gWPNextHopNum = num;
+
+	float* dist = (float*)B_TempAlloc(num * sizeof(float));
+	//a waypoint is pushed once for every link to it at most
+	const int maxheap = num * (MAX_NEIGHBOR_SIZE + 2);
+	wphopnode_t* heap = NULL;
+
+	trap->TrueMalloc((void**)&heap, maxheap * sizeof(wphopnode_t));
+
+	while (i < num)
+	{
+		unsigned short* hops = &gWPNextHop[i * num];
+		int heapsize = 0;
+		int n = 0;
+
+		while (n < num)
+		{
+			dist[n] = -1;
+			hops[n] = WPBIN_NOHOP;
+			n++;
+		}
+
+		if (!gWPArray[i] || !gWPArray[i]->inuse)
+		{
+			i++;
+			continue;
+		}
+
+		dist[i] = 0;
+		hops[i] = i;
+		WP_HeapPush(heap, &heapsize, 0, i);
+
+		while (heapsize > 0)
+		{
+			const wphopnode_t node = WP_HeapPop(heap, &heapsize);
+			const wpobject_t* wp = gWPArray[node.wp];
+			int links[MAX_NEIGHBOR_SIZE + 2];
+			float lengths[MAX_NEIGHBOR_SIZE + 2];
+			int numlinks = 0;
+			vec3_t a;
+
+			if (node.dist > dist[node.wp])
+			{ //already reached over a shorter path
+				continue;
+			}
+
+			//the trail links, the same one way rules as TotalTrailDistance
+			if (node.wp + 1 < num && gWPArray[node.wp + 1] && gWPArray[node.wp + 1]->inuse &&
+				!(wp->flags & WPFLAG_ONEWAY_BACK))
+			{
+				links[numlinks] = node.wp + 1;
+				lengths[numlinks] = wp->disttonext;
+				numlinks++;
+			}
+			if (node.wp > 0 && gWPArray[node.wp - 1] && gWPArray[node.wp - 1]->inuse &&
+				!(gWPArray[node.wp - 1]->flags & WPFLAG_ONEWAY_FWD))
+			{
+				links[numlinks] = node.wp - 1;
+				lengths[numlinks] = gWPArray[node.wp - 1]->disttonext;
+				numlinks++;
+			}
+
+			n = 0;
+			while (n < wp->neighbornum && n < MAX_NEIGHBOR_SIZE)
+			{
+				const int nb = wp->neighbors[n].num;
+
+				if (nb >= 0 && nb < num && gWPArray[nb] && gWPArray[nb]->inuse)
+				{
+					VectorSubtract(wp->origin, gWPArray[nb]->origin, a);
+					links[numlinks] = nb;
+					lengths[numlinks] = VectorLength(a);
+					numlinks++;
+				}
+				n++;
+			}
+
+			n = 0;
+			while (n < numlinks)
+			{
+				const int to = links[n];
+				const float d = node.dist + lengths[n];
+
+				if ((dist[to] < 0 || d < dist[to]) && heapsize < maxheap)
+				{
+					dist[to] = d;
+					//the first step of the path is the link taken from the start
+					hops[to] = node.wp == i ? to : hops[node.wp];
+					WP_HeapPush(heap, &heapsize, d, to);
+				}
+				n++;
+			}
+		}
+
+		i++;
+	}
+
+	trap->TrueFree((void**)&heap);
+	B_TempFree(num * sizeof(float)); //dist
+
+	return qtrue;
+}
+
+int LoadPathDataBinary(const char* filename)
+{
+	fileHandle_t f;
+	wpbinheader_t header;
+	wpobject_t thiswp;
+	char routePath[MAX_QPATH];
+	int i = 0;
+
+	Com_sprintf(routePath, sizeof(routePath), "botroutes/%s.wnb", filename);
+
+	const int len = trap->FS_Open(routePath, &f, FS_READ);
+
+	if (!f)
+	{
+		return 0;
+	}
+
+	if (len < (int)sizeof(header))
+	{
+		trap->FS_Close(f);
+		return 0;
+	}
+
+	trap->FS_Read(&header, sizeof(header), f);
+
+	if (header.ident != WPBIN_IDENT || header.version != WPBIN_VERSION)
+	{
+		trap->Print(S_COLOR_YELLOW "Binary bot route data for %s is outdated\n", filename);
+		trap->FS_Close(f);
+		return 0;
+	}
+
+	if (header.mapChecksum != trap->Cvar_VariableIntegerValue("sv_mapChecksum") ||
+		header.gametype != level.gametype ||
+		header.sourceChecksum != WP_SourceChecksum(filename))
+	{
+		trap->Print(S_COLOR_YELLOW "Binary bot route data for %s does not match the map, using the ascii data\n", filename);
+		trap->FS_Close(f);
+		return 0;
+	}
+
+	const int hopsize = header.numHops * header.numHops * sizeof(unsigned short);
+
+	if (header.numWaypoints <= 0 || header.numWaypoints > MAX_WPARRAY_SIZE ||
+		(header.numHops && header.numHops != header.numWaypoints) ||
+		len != (int)sizeof(header) + header.numWaypoints * (int)sizeof(wpobject_t) + hopsize)
+	{
+		trap->Print(S_COLOR_RED "Binary bot route data for %s is truncated\n", filename);
+		trap->FS_Close(f);
+		return 0;
+	}
+
+	//read and check all the data before any waypoint is created
+	byte* data = NULL;
+
+	trap->TrueMalloc((void**)&data, len - sizeof(header));
+	trap->FS_Read(data, len - sizeof(header), f);
+	trap->FS_Close(f);
+
+	if (WP_Checksum(data, len - sizeof(header), (int)2166136261u) != header.dataChecksum)
+	{
+		trap->Print(S_COLOR_RED "Binary bot route data for %s is corrupt\n", filename);
+		trap->TrueFree((void**)&data);
+		return 0;
+	}
+
+	gLevelFlags = header.levelFlags;
+
+	while (i < header.numWaypoints)
+	{
+		memcpy(&thiswp, data + i * sizeof(wpobject_t), sizeof(wpobject_t));
+		if (thiswp.neighbornum < 0 || thiswp.neighbornum >= MAX_NEIGHBOR_SIZE)
+		{
+			thiswp.neighbornum = 0;
+		}
+		CreateNewWP_FromObject(&thiswp);
+		i++;
+	}
+
+	FreeNextHops();
+
+	if (header.numHops)
+	{
+		trap->TrueMalloc((void**)&gWPNextHop, hopsize);
+		memcpy(gWPNextHop, data + header.numWaypoints * sizeof(wpobject_t), hopsize);
+		gWPNextHopNum = header.numHops;
+	}
+
+	trap->TrueFree((void**)&data);
+
+	return 1;
+}
+
+int SavePathDataBinary(const char* filename)
+{
+	fileHandle_t f;
+	wpbinheader_t header;
+	char routePath[MAX_QPATH];
+	int i = 0;
+
+	if (!gWPNum)
+	{
+		return 0;
+	}
+
+	CalculateNextHops();
+
+	memset(&header, 0, sizeof(header));
+	header.ident = WPBIN_IDENT;
+	header.version = WPBIN_VERSION;
+	header.mapChecksum = trap->Cvar_VariableIntegerValue("sv_mapChecksum");
+	header.sourceChecksum = WP_SourceChecksum(filename);
+	header.gametype = level.gametype;
+	header.levelFlags = gLevelFlags;
+	header.numWaypoints = gWPNum;
+	header.numHops = gWPNextHop ? gWPNextHopNum : 0;
+	header.dataChecksum = (int)2166136261u;
+
+	while (i < gWPNum)
+	{
+		header.dataChecksum = WP_Checksum(gWPArray[i], sizeof(wpobject_t), header.dataChecksum);
+		i++;
+	}
+
+	const int hopsize = header.numHops * header.numHops * sizeof(unsigned short);
+
+	if (hopsize)
+	{
+		header.dataChecksum = WP_Checksum(gWPNextHop, hopsize, header.dataChecksum);
+	}
+
+	Com_sprintf(routePath, sizeof(routePath), "botroutes/%s.wnb", filename);
+
+	trap->FS_Open(routePath, &f, FS_WRITE);
+
+	if (!f)
+	{
+		trap->Print(S_COLOR_RED "ERROR: Could not open file to write binary path data\n");
+		return 0;
+	}
+
+	trap->FS_Write(&header, sizeof(header), f);
+
+	i = 0;
+	while (i < gWPNum)
+	{
+		trap->FS_Write(gWPArray[i], sizeof(wpobject_t), f);
+		i++;
+	}
+
+	if (hopsize)
+	{
+		trap->FS_Write(gWPNextHop, hopsize, f);
+	}
+
+	trap->FS_Close(f);
+
+	trap->Print("Binary path data with %i waypoints and %s next hop table written to %s\n", gWPNum,
+		header.numHops ? "a" : "no", routePath);
+
+	return 1;
+}
+
+//server command (botbuildpathdata) to build the binary path data for the current level from the
+//loaded ascii path data
+void Svcmd_BotBuildPathData_f(void)
+{
+	vmCvar_t mapname;
+
+	if (RMG.integer)
+	{
+		trap->Print("Random maps are pathed when they are created\n");
+		return;
+	}
+
+	if (!gWPNum)
+	{
+		trap->Print("No bot route data is loaded for this level\n");
+		return;
+	}
+
+	trap->Cvar_Register(&mapname, "mapname", "", CVAR_SERVERINFO | CVAR_ROM);
+
+	SavePathDataBinary(mapname.string);
+}
+
 #define MAX_SPAWNPOINT_ARRAY 64
 int gSpawnPointNum = 0;
 gentity_t* gSpawnPoints[MAX_SPAWNPOINT_ARRAY];
@@ -3209,9 +3676,15 @@ void LoadPath_ThisLevel(void)
 	}
 	else
 	{
-		if (LoadPathData(mapname.string) == 2)
+		trap->Cvar_Register(&bot_wp_binary, "bot_wp_binary", "1", 0);
+
+		//the binary path data has everything calculated already
+		if (!bot_wp_binary.integer || !LoadPathDataBinary(mapname.string))
 		{
-			//enter "edit" mode if cheats enabled?
+			if (LoadPathData(mapname.string) == 2)
+			{
+				//enter "edit" mode if cheats enabled?
+			}
 		}
 	}
 
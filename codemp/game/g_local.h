@@ -1397,6 +1397,7 @@ void G_RemoveQueuedBotBegin(int client_num);
 qboolean G_BotConnect(int client_num, qboolean restart);
 void Svcmd_AddBot_f(void);
 void Svcmd_BotList_f(void);
+void Svcmd_BotBuildPathData_f(void);
 void BotInterbreedEndMatch(void);
 qboolean G_DoesMapSupportGametype(const char* mapname, int gametype);
 const char* G_RefreshNextMap(int gametype, qboolean forced);
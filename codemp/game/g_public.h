@@ -29,7 +29,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 #define Q3_INFINITE			16777216
 
-#define	GAME_API_VERSION	1
+#define	GAME_API_VERSION	2
 
 // entity->svFlags
 // the server does not know how to interpret most of the values
@@ -756,6 +756,17 @@ typedef enum gameExportLegacy_e {
 	GAME_GETITEMINDEXBYTAG
 } gameExportLegacy_t;
 
+// one trace of a batch run with BotTraceBatch
+typedef struct botTraceJob_s {
+	vec3_t		start;
+	vec3_t		mins;
+	vec3_t		maxs;
+	vec3_t		end;
+	int			passEntityNum;
+	int			contentmask;
+	trace_t		trace;				// filled in with the result
+} botTraceJob_t;
+
 typedef struct gameImport_s {
 	// misc
 	void		(*Print)								(const char* msg, ...);
@@ -1092,6 +1103,10 @@ typedef struct gameImport_s {
 	void		(*G2API_CleanEntAttachments)			(void);
 	qboolean(*G2API_OverrideServer)					(void* serverInstance);
 	void		(*G2API_GetSurfaceName)					(void* ghoul2, int surf_number, int model_index, char* fillBuf);
+
+	// bot sensing, results are shared between bots during the bot frame
+	void		(*BotTrace)								(trace_t* results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int pass_entity_num, int contentmask);
+	void		(*BotTraceBatch)						(botTraceJob_t* jobs, int numJobs);
 } gameImport_t;
 
 typedef struct gameExport_s {
@@ -1012,6 +1012,11 @@ void SVSyscall_Trace(trace_t* results, const vec3_t start, const vec3_t mins, co
 	else
 		trap_Trace(results, start, mins, maxs, end, pass_entity_num, contentmask);
 }
+// the legacy syscalls have no bot trace cache, so bot traces are plain traces
+void SVSyscall_BotTraceBatch(botTraceJob_t* jobs, int numJobs) {
+	for (int i = 0; i < numJobs; i++)
+		trap_Trace(&jobs[i].trace, jobs[i].start, jobs[i].mins, jobs[i].maxs, jobs[i].end, jobs[i].passEntityNum, jobs[i].contentmask);
+}
 
 NORETURN void QDECL G_Error(int errorLevel, const char* error, ...) {
 	va_list argptr;
@@ -1356,4 +1361,6 @@ static void TranslateSyscalls(void) {
 	trap->G2API_CleanEntAttachments = trap_G2API_CleanEntAttachments;
 	trap->G2API_OverrideServer = trap_G2API_OverrideServer;
 	trap->G2API_GetSurfaceName = trap_G2API_GetSurfaceName;
+	trap->BotTrace = trap_Trace;
+	trap->BotTraceBatch = SVSyscall_BotTraceBatch;
 }
\ No newline at end of file
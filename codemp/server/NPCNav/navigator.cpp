@@ -33,6 +33,12 @@ unsigned int timeGetTime(void);
 
 #include "../sv_gameapi.h"
 
+#ifdef USE_INTERNAL_ZLIB
+#include "zlib/zlib.h"
+#else
+#include <zlib.h>
+#endif
+
 //Global navigator
 CNavigator		navigator;
 //this was in the game before. But now it's all handled in the engine, and we make navigator. calls
@@ -40,11 +46,15 @@ CNavigator		navigator;
 
 cvar_t* d_altRoutes;
 cvar_t* d_patched;
+cvar_t* d_navHopTable;
+cvar_t* d_navHopCompress;
 
 void NAV_CvarInit()
 {
 	d_altRoutes = Cvar_Get("d_altRoutes", "0", CVAR_CHEAT);
 	d_patched = Cvar_Get("d_patched", "0", CVAR_CHEAT);
+	d_navHopTable = Cvar_Get("d_navHopTable", "1", CVAR_CHEAT);
+	d_navHopCompress = Cvar_Get("d_navHopCompress", "1", CVAR_CHEAT);
 }
 
 void NAV_Free()
@@ -594,6 +604,7 @@ void CNavigator::Free(void)
 
 	m_nodes.clear();
 	m_edgeLookupMap.clear();
+	m_hopTable.clear();
 }
 
 /*
@@ -656,6 +667,18 @@ bool CNavigator::Load(const char* filename, int checksum)
 		m_edgeLookupMap.insert(std::pair<int, int>(failedEdges[j].startID, j));
 	}
 
+	//read in the next hop table, older files without one get it built from the ranks
+	const int hopTime = Sys_Milliseconds();
+	if (LoadHopTable(file))
+	{
+		ReportHopTable("loaded", Sys_Milliseconds() - hopTime);
+	}
+	else
+	{
+		BuildHopTable();
+		ReportHopTable("built", Sys_Milliseconds() - hopTime);
+	}
+
 	FS_FCloseFile(file);
 
 	return true;
@@ -701,6 +724,9 @@ bool CNavigator::Save(const char* filename, int checksum)
 	//write out failed edges
 	FS_Write(&failedEdges, sizeof(failedEdges), file);
 
+	//write out the next hop table
+	SaveHopTable(file);
+
 	FS_FCloseFile(file);
 
 	return true;
@@ -897,6 +923,10 @@ void CNavigator::CalculatePaths(qboolean recalc)
 		CalculatePath(m_nodes[i]);
 	}
 
+	const int hopTime = Sys_Milliseconds();
+	BuildHopTable();
+	ReportHopTable("built", Sys_Milliseconds() - hopTime);
+
 	if (!recalc)	//Mike says doesn't need to happen on recalc
 	{
 		GVM_NAV_FindCombatPointWaypoints();
@@ -2318,6 +2348,35 @@ GetBestNode
 */
 
 int CNavigator::GetBestNode(int startID, int endID, int rejectID) const
+{
+	//Dynamic obstacles or a missing table fall back to searching the ranks
+	if (rejectID == WAYPOINT_NONE && !m_hopTable.empty() && d_navHopTable->integer)
+	{
+		const int hopID = GetHopNode(startID, endID);
+
+		if (hopID < 0 || hopID == startID)
+			return hopID;
+
+		CNode* start = m_nodes[startID];
+		const int edgeNum = start->GetEdgeNumToNode(hopID);
+
+		//The precomputed edge is blocked right now, find the next best way around it
+		if (edgeNum >= 0 && start->GetEdgeFlags(edgeNum) & (EFLAG_BLOCKED | EFLAG_FAILED))
+			return GetBestNodeByRank(startID, endID, hopID);
+
+		return hopID;
+	}
+
+	return GetBestNodeByRank(startID, endID, rejectID);
+}
+
+/*
+-------------------------
+GetBestNodeByRank
+-------------------------
+*/
+
+int CNavigator::GetBestNodeByRank(int startID, int endID, int rejectID) const
 {
 	//Validate the start position
 	if ((startID < 0) || (startID >= static_cast<int>(m_nodes.size())))
@@ -2378,6 +2437,249 @@ int CNavigator::GetBestNode(int startID, int endID, int rejectID) const
 	return bestNode;
 }
 
+/*
+-------------------------
+GetHopNode
+
+O(1) next node on the way from startID to endID, straight out of the hop table.
+-------------------------
+*/
+
+int CNavigator::GetHopNode(int startID, int endID) const
+{
+	const int numNodes = static_cast<int>(m_nodes.size());
+
+	//Validate the start position
+	if ((startID < 0) || (startID >= numNodes))
+		return WAYPOINT_NONE;
+
+	//Validate the end position
+	if ((endID < 0) || (endID >= numNodes))
+		return WAYPOINT_NONE;
+
+	if (startID == endID)
+		return startID;
+
+	const unsigned short hop = m_hopTable[startID * numNodes + endID];
+
+	if (hop == NAV_HOP_NONE)
+		return NODE_NONE;
+
+	return m_nodes[startID]->GetEdge(hop >> NAV_HOP_SLOT_SHIFT);
+}
+
+/*
+-------------------------
+BuildHopTable
+
+Turns the per node ranks into a packed next hop table.  The hop chosen for each
+pair is exactly the one GetBestNodeByRank would pick.  Ranks are the order nodes
+came off the flood fill out of the end node, so walking them in rank order always
+reaches a node's next hop before the node itself, and the path costs fall out as
+a running sum.
+
+The table grows with the square of the node count, so past NAV_HOP_MAX_NODES it
+is left empty and GetBestNode keeps searching the ranks.
+-------------------------
+*/
+
+void CNavigator::BuildHopTable(void)
+{
+	const int numNodes = static_cast<int>(m_nodes.size());
+
+	if (numNodes > NAV_HOP_MAX_NODES)
+	{
+		m_hopTable.clear();
+		return;
+	}
+
+	m_hopTable.assign(numNodes * numNodes, NAV_HOP_NONE);
+
+	std::vector<int> order(numNodes);
+	std::vector<int> cost(numNodes);
+
+	for (int endID = 0; endID < numNodes; endID++)
+	{
+		const CNode* end = m_nodes[endID];
+
+		std::fill(order.begin(), order.end(), NODE_NONE);
+
+		for (int nodeID = 0; nodeID < numNodes; nodeID++)
+		{
+			const int rank = end->GetRank(nodeID);
+
+			if (rank >= 0 && rank < numNodes)
+				order[rank] = nodeID;
+		}
+
+		cost[endID] = 0;
+		m_hopTable[endID * numNodes + endID] = 0;
+
+		for (int rank = 1; rank < numNodes && order[rank] != NODE_NONE; rank++)
+		{
+			const int nodeID = order[rank];
+			CNode* node = m_nodes[nodeID];
+
+			int bestSlot = -1;
+			int bestRank = Q3_INFINITE;
+
+			for (int i = 0; i < node->GetNumEdges(); i++)
+			{
+				const int edgeID = node->GetEdge(i);
+
+				if (edgeID == endID)
+				{
+					bestSlot = i;
+					break;
+				}
+
+				const int testRank = end->GetRank(edgeID);
+
+				if (testRank <= 0)
+					continue;
+
+				if (testRank < bestRank)
+				{
+					bestSlot = i;
+					bestRank = testRank;
+				}
+			}
+
+			if (bestSlot == -1)
+				continue;
+
+			cost[nodeID] = cost[node->GetEdge(bestSlot)] + node->GetEdgeCost(bestSlot);
+
+			const int packedCost = std::min(cost[nodeID] >> NAV_HOP_COST_SHIFT, NAV_HOP_COST_MAX);
+			m_hopTable[nodeID * numNodes + endID] = static_cast<unsigned short>((bestSlot << NAV_HOP_SLOT_SHIFT) | packedCost);
+		}
+	}
+}
+
+/*
+-------------------------
+SaveHopTable
+-------------------------
+*/
+
+void CNavigator::SaveHopTable(fileHandle_t file) const
+{
+	const int	header = NAV_HOP_HEADER_ID;
+	const int	version = NAV_HOP_VERSION;
+	const int	numNodes = m_nodes.size();
+	const int	rawSize = m_hopTable.size() * sizeof(unsigned short);
+	int			compressed = 0;
+	int			dataSize = rawSize;
+
+	std::vector<byte> packed;
+
+	if (d_navHopCompress->integer && rawSize)
+	{
+		uLongf packedSize = compressBound(rawSize);
+		packed.resize(packedSize);
+
+		if (compress2(packed.data(), &packedSize, reinterpret_cast<const Bytef*>(m_hopTable.data()), rawSize, Z_BEST_COMPRESSION) == Z_OK
+			&& static_cast<int>(packedSize) < rawSize)
+		{
+			compressed = 1;
+			dataSize = packedSize;
+		}
+	}
+
+	FS_Write(&header, sizeof(header), file);
+	FS_Write(&version, sizeof(version), file);
+	FS_Write(&numNodes, sizeof(numNodes), file);
+	FS_Write(&compressed, sizeof(compressed), file);
+	FS_Write(&rawSize, sizeof(rawSize), file);
+	FS_Write(&dataSize, sizeof(dataSize), file);
+
+	if (compressed)
+	{
+		FS_Write(packed.data(), dataSize, file);
+	}
+	else if (rawSize)
+	{
+		FS_Write(m_hopTable.data(), rawSize, file);
+	}
+}
+
+/*
+-------------------------
+LoadHopTable
+-------------------------
+*/
+
+bool CNavigator::LoadHopTable(fileHandle_t file)
+{
+	int	header, version, numNodes, compressed, rawSize, dataSize;
+
+	if (FS_Read(&header, sizeof(header), file) != sizeof(header) || header != NAV_HOP_HEADER_ID)
+		return false;
+
+	FS_Read(&version, sizeof(version), file);
+	FS_Read(&numNodes, sizeof(numNodes), file);
+	FS_Read(&compressed, sizeof(compressed), file);
+	FS_Read(&rawSize, sizeof(rawSize), file);
+	FS_Read(&dataSize, sizeof(dataSize), file);
+
+	//Out of date, or not written for this set of nodes
+	if (version != NAV_HOP_VERSION
+		|| numNodes != static_cast<int>(m_nodes.size())
+		|| numNodes > NAV_HOP_MAX_NODES
+		|| rawSize != static_cast<int>(numNodes * numNodes * sizeof(unsigned short))
+		|| dataSize < 0 || dataSize > rawSize)
+	{
+		return false;
+	}
+
+	m_hopTable.resize(numNodes * numNodes);
+
+	if (!compressed)
+	{
+		if (FS_Read(m_hopTable.data(), rawSize, file) != rawSize)
+		{
+			m_hopTable.clear();
+			return false;
+		}
+		return true;
+	}
+
+	std::vector<byte> packed(dataSize);
+	uLongf unpackedSize = rawSize;
+
+	if (FS_Read(packed.data(), dataSize, file) != dataSize
+		|| uncompress(reinterpret_cast<Bytef*>(m_hopTable.data()), &unpackedSize, packed.data(), dataSize) != Z_OK
+		|| static_cast<int>(unpackedSize) != rawSize)
+	{
+		m_hopTable.clear();
+		return false;
+	}
+
+	return true;
+}
+
+/*
+-------------------------
+ReportHopTable
+-------------------------
+*/
+
+void CNavigator::ReportHopTable(const char* source, int msec) const
+{
+	const int numNodes = m_nodes.size();
+	const int hopBytes = m_hopTable.size() * sizeof(unsigned short);
+	const int rankBytes = numNodes * numNodes * sizeof(int);
+
+	if (m_hopTable.empty())
+	{
+		Com_Printf("Nav hop table skipped: %d nodes is over the %d node limit\n", numNodes, NAV_HOP_MAX_NODES);
+		return;
+	}
+
+	Com_Printf("Nav hop table %s: %d nodes in %d msec, %d KB (ranks %d KB)\n",
+		source, numNodes, msec, hopBytes / 1024, rankBytes / 1024);
+}
+
 /*
 -------------------------
 GetNodePosition
@@ -48,6 +48,18 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #define	NAV_HEADER_ID	INT_ID('J','N','V','5')
 #define	NODE_HEADER_ID	INT_ID('N','O','D','E')
 
+//Next hop table
+//Each entry packs the edge slot to take from the start node (top 3 bits) and the
+//remaining path cost in units of 1 << NAV_HOP_COST_SHIFT (low 13 bits)
+#define	NAV_HOP_HEADER_ID	INT_ID('N','H','O','P')
+#define	NAV_HOP_VERSION		1
+#define	NAV_HOP_NONE		0xFFFF
+#define	NAV_HOP_SLOT_SHIFT	13
+#define	NAV_HOP_COST_MASK	0x1FFF
+#define	NAV_HOP_COST_MAX	0x1FFE
+#define	NAV_HOP_COST_SHIFT	4
+#define	NAV_HOP_MAX_NODES	2048	//8 MB of table, bigger maps search the ranks instead
+
 typedef std::multimap<int, int> EdgeMultimap;
 typedef EdgeMultimap::iterator EdgeMultimapIt;
 
@@ -184,6 +196,7 @@ public:
 	int GetNearestNode(sharedEntity_t* ent, int lastID, int flags, int targetID);
 
 	int GetBestNode(int startID, int endID, int rejectID = NODE_NONE) const;
+	int GetHopNode(int startID, int endID) const;
 
 	int GetNodePosition(int nodeID, vec3_t out) const;
 	int GetNodeNumEdges(int nodeID) const;
@@ -246,6 +259,12 @@ protected:
 
 	void	CalculatePath(CNode* node) const;
 
+	void	BuildHopTable(void);
+	void	SaveHopTable(fileHandle_t file) const;
+	bool	LoadHopTable(fileHandle_t file);
+	void	ReportHopTable(const char* source, int msec) const;
+	int		GetBestNodeByRank(int startID, int endID, int rejectID) const;
+
 	//rww - made failedEdges private as it doesn't seem to need to be public.
 	//And I'd rather shoot myself than have to devise a way of setting/accessing this
 	//array via trap calls.
@@ -253,6 +272,8 @@ protected:
 
 	node_v			m_nodes;
 	EdgeMultimap	m_edgeLookupMap;
+
+	std::vector<unsigned short>	m_hopTable;
 };
 
 //////////////////////////////////////////////////////////////////////
@@ -387,6 +387,12 @@ int			SV_BotAllocateClient(void);
 void		SV_BotFreeClient(int client_num);
 
 void		SV_BotInitCvars(void);
+void		SV_BotWriteRouteCache_f(void);
+void		SV_BotMemStats_f(void);
+void		SV_BotTraceStats_f(void);
+void		SV_BotTrace(trace_t* results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask);
+void		SV_BotTraceBatch(botTraceJob_t* jobs, int numJobs);
+void		SV_BotInvalidateTraceCache(void);
 int			SV_BotGetSnapshotEntity(int client, int ent);
 int			SV_BotGetConsoleMessage(int client, char* buf, int size);
 
@@ -302,6 +302,229 @@ void QDECL BotImport_Print(int type, char* fmt, ...)
 	}
 }
 
+/*
+=============================================================================
+
+BOT TRACE CACHE
+
+Bots issue many identical visibility and movement traces while they think,
+both from the game and from the bot library. Trace results are cached from
+the start to the end of SV_BotFrame and shared between all bots. Bots move
+in their ClientThink during the bot frame, so linking or unlinking any
+entity throws away everything cached so far.
+
+=============================================================================
+*/
+
+#define BOT_TRACECACHE_SIZE		2048	// must be a power of two
+#define BOT_TRACECACHE_PROBES	8
+
+typedef struct botTraceKey_s {
+	vec3_t	start;
+	vec3_t	mins;
+	vec3_t	maxs;
+	vec3_t	end;
+	int		passEntityNum;
+	int		contentmask;
+} botTraceKey_t;
+
+typedef struct botTraceCacheEntry_s {
+	botTraceKey_t	key;
+	int				frame;		// bot frame the entry was stored in
+	trace_t			trace;
+} botTraceCacheEntry_t;
+
+typedef struct botTraceStats_s {
+	int		traces;
+	int		cached;
+} botTraceStats_t;
+
+static botTraceCacheEntry_t botTraceCache[BOT_TRACECACHE_SIZE];
+static int botTraceFrame;				// current bot frame, 0 when the cache is not in use
+static int botTraceFrameCount;
+static botTraceStats_t botTraceStats[MAX_CLIENTS];
+static botTraceStats_t botTraceStatsOther;
+static int botTraceStatsStart;
+static cvar_t* bot_tracecache;
+
+/*
+==================
+SV_BotTraceHash
+==================
+*/
+static unsigned int SV_BotTraceHash(const botTraceKey_t* key) {
+	const byte* data = reinterpret_cast<const byte*>(key);
+	unsigned int hash = 2166136261u;
+
+	for (size_t i = 0; i < sizeof(*key); i++) {
+		hash = (hash ^ data[i]) * 16777619u;
+	}
+	return hash;
+}
+
+/*
+==================
+SV_BotTrace
+
+Trace for bot sensing, identical traces within a bot frame are only done once
+==================
+*/
+void SV_BotTrace(trace_t* results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int passEntityNum, int contentmask) {
+	botTraceKey_t key;
+
+	if (!mins) {
+		mins = vec3_origin;
+	}
+	if (!maxs) {
+		maxs = vec3_origin;
+	}
+
+	// traces are counted for the bot they are done for
+	botTraceStats_t* stats = &botTraceStatsOther;
+	if (passEntityNum >= 0 && passEntityNum < sv_maxclients->integer &&
+		svs.clients[passEntityNum].netchan.remoteAddress.type == NA_BOT) {
+		stats = &botTraceStats[passEntityNum];
+	}
+	stats->traces++;
+
+	if (!botTraceFrame || !bot_tracecache || !bot_tracecache->integer) {
+		SV_Trace(results, start, mins, maxs, end, passEntityNum, contentmask, qfalse, 0, 10);
+		return;
+	}
+
+	Com_Memset(&key, 0, sizeof(key));
+	VectorCopy(start, key.start);
+	VectorCopy(mins, key.mins);
+	VectorCopy(maxs, key.maxs);
+	VectorCopy(end, key.end);
+	key.passEntityNum = passEntityNum;
+	key.contentmask = contentmask;
+
+	const unsigned int hash = SV_BotTraceHash(&key);
+	botTraceCacheEntry_t* slot = nullptr;
+	for (int i = 0; i < BOT_TRACECACHE_PROBES; i++) {
+		botTraceCacheEntry_t* entry = &botTraceCache[(hash + i) & (BOT_TRACECACHE_SIZE - 1)];
+		if (entry->frame != botTraceFrame) {
+			// entries from earlier bot frames are free
+			slot = entry;
+			break;
+		}
+		if (!memcmp(&entry->key, &key, sizeof(key))) {
+			*results = entry->trace;
+			stats->cached++;
+			return;
+		}
+	}
+
+	SV_Trace(results, start, mins, maxs, end, passEntityNum, contentmask, qfalse, 0, 10);
+
+	// when all probed entries are in use the result is simply not cached
+	if (slot) {
+		slot->key = key;
+		slot->frame = botTraceFrame;
+		slot->trace = *results;
+	}
+}
+
+/*
+==================
+SV_BotTraceBatch
+
+Runs a number of bot traces at once, this saves a call into the server per
+trace for the game module and shares the trace cache between the jobs
+==================
+*/
+void SV_BotTraceBatch(botTraceJob_t* jobs, int numJobs) {
+	for (int i = 0; i < numJobs; i++) {
+		botTraceJob_t* job = &jobs[i];
+		SV_BotTrace(&job->trace, job->start, job->mins, job->maxs, job->end, job->passEntityNum, job->contentmask);
+	}
+}
+
+/*
+==================
+SV_BotBeginTraceCache
+==================
+*/
+static void SV_BotBeginTraceCache(void) {
+	// entries of earlier frames are reused, skip 0 which marks the cache unused
+	botTraceFrameCount++;
+	if (botTraceFrameCount <= 0) {
+		Com_Memset(botTraceCache, 0, sizeof(botTraceCache));
+		botTraceFrameCount = 1;
+	}
+	botTraceFrame = botTraceFrameCount;
+}
+
+/*
+==================
+SV_BotEndTraceCache
+==================
+*/
+static void SV_BotEndTraceCache(void) {
+	botTraceFrame = 0;
+}
+
+/*
+==================
+SV_BotInvalidateTraceCache
+
+Called whenever an entity is linked or unlinked
+==================
+*/
+void SV_BotInvalidateTraceCache(void) {
+	if (botTraceFrame) {
+		SV_BotBeginTraceCache();
+	}
+}
+
+/*
+==================
+SV_BotTraceStats_f
+
+Prints the traces per second done for every bot
+==================
+*/
+void SV_BotTraceStats_f(void) {
+	if (!com_sv_running->integer) {
+		Com_Printf("Server is not running.\n");
+		return;
+	}
+
+	const int msec = svs.time - botTraceStatsStart;
+	if (msec > 0) {
+		int totalTraces = 0;
+		int totalCached = 0;
+
+		Com_Printf("client traces/s  cached/s  cached%%  name\n");
+		for (int i = 0; i < sv_maxclients->integer; i++) {
+			const client_t* cl = &svs.clients[i];
+			const botTraceStats_t* stats = &botTraceStats[i];
+
+			if (cl->state < CS_CONNECTED || cl->netchan.remoteAddress.type != NA_BOT) {
+				continue;
+			}
+			Com_Printf("%6i %8.1f %9.1f %7i%%  %s\n", i, stats->traces * 1000.0f / msec, stats->cached * 1000.0f / msec,
+				stats->traces ? stats->cached * 100 / stats->traces : 0, cl->name);
+			totalTraces += stats->traces;
+			totalCached += stats->cached;
+		}
+		Com_Printf(" other %8.1f %9.1f %7i%%\n", botTraceStatsOther.traces * 1000.0f / msec,
+			botTraceStatsOther.cached * 1000.0f / msec,
+			botTraceStatsOther.traces ? botTraceStatsOther.cached * 100 / botTraceStatsOther.traces : 0);
+		totalTraces += botTraceStatsOther.traces;
+		totalCached += botTraceStatsOther.cached;
+		Com_Printf("total  %8.1f %9.1f %7i%%  over %.1f seconds\n", totalTraces * 1000.0f / msec,
+			totalCached * 1000.0f / msec, totalTraces ? totalCached * 100 / totalTraces : 0, msec / 1000.0f);
+	}
+
+	if (Cmd_Argc() > 1 && !Q_stricmp(Cmd_Argv(1), "reset")) {
+		Com_Memset(botTraceStats, 0, sizeof(botTraceStats));
+		Com_Memset(&botTraceStatsOther, 0, sizeof(botTraceStatsOther));
+		botTraceStatsStart = svs.time;
+	}
+}
+
 /*
 ==================
 BotImport_Trace
@@ -310,7 +533,7 @@ BotImport_Trace
 void BotImport_Trace(bsp_trace_t* bsptrace, vec3_t start, vec3_t mins, vec3_t maxs, vec3_t end, int passent, int contentmask) {
 	trace_t trace;
 
-	SV_Trace(&trace, start, mins, maxs, end, passent, contentmask, qfalse, 0, 10);
+	SV_BotTrace(&trace, start, mins, maxs, end, passent, contentmask);
 	//copy the trace information
 	bsptrace->allsolid = static_cast<qboolean>(trace.allsolid);
 	bsptrace->startsolid = static_cast<qboolean>(trace.startsolid);
@@ -576,7 +799,9 @@ void SV_BotFrame(int time) {
 	//NOTE: maybe the game is already shutdown
 	if (!svs.gameStarted)
 		return;
+	SV_BotBeginTraceCache();
 	GVM_BotAIStartFrame(time);
+	SV_BotEndTraceCache();
 }
 
 /*
@@ -594,6 +819,8 @@ int SV_BotLibSetup(void) {
 		return -1;
 	}
 
+	botlib_export->BotLibVarSet("max_routingcache", Cvar_VariableString("bot_maxroutingcache"));
+
 	return botlib_export->BotLibSetup();
 }
 
@@ -613,6 +840,45 @@ int SV_BotLibShutdown(void) {
 	return botlib_export->BotLibShutdown();
 }
 
+/*
+==================
+SV_BotWriteRouteCache_f
+
+Calculates the routing cache for the whole map and writes it
+to maps/<mapname>.rcd on the next bot frame
+==================
+*/
+void SV_BotWriteRouteCache_f(void) {
+	if (!com_sv_running->integer) {
+		Com_Printf("Server is not running.\n");
+		return;
+	}
+
+	if (!bot_enable || !botlib_export) {
+		Com_Printf("Bots are not enabled.\n");
+		return;
+	}
+
+	botlib_export->BotLibVarSet("saveroutingcache", "1");
+	Com_Printf("Route cache will be written on the next bot frame.\n");
+}
+
+/*
+==================
+SV_BotMemStats_f
+
+Prints the pooled bot library memory usage
+==================
+*/
+void SV_BotMemStats_f(void) {
+	if (!bot_enable || !botlib_export) {
+		Com_Printf("Bots are not enabled.\n");
+		return;
+	}
+
+	botlib_export->BotLibMemoryStats();
+}
+
 /*
 ==================
 SV_BotInitCvars
@@ -631,6 +897,8 @@ void SV_BotInitCvars(void) {
 	Cvar_Get("bot_forcewrite", "0", 0);					//force writing aas file
 	Cvar_Get("bot_aasoptimize", "0", 0);				//no aas file optimisation
 	Cvar_Get("bot_saveroutingcache", "0", 0);			//save routing cache
+	Cvar_Get("bot_maxroutingcache", "0", CVAR_ARCHIVE);	//routing cache memory budget in KB, 0 sizes it to the map
+	bot_tracecache = Cvar_Get("bot_tracecache", "1", 0);	//share trace results between bots during a bot frame
 	Cvar_Get("bot_thinktime", "100", CVAR_CHEAT);		//msec the bots thinks
 	Cvar_Get("bot_reloadcharacters", "0", 0);			//reload the bot characters each time
 	Cvar_Get("bot_testichat", "0", 0);					//test ichats
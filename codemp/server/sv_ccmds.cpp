@@ -1937,6 +1937,11 @@ void SV_AddOperatorCommands(void) {
 	Cmd_AddCommand("sv_bandel", SV_BanDel_f, "Removes a ban");
 	Cmd_AddCommand("sv_exceptdel", SV_ExceptDel_f, "Removes a ban exception");
 	Cmd_AddCommand("sv_flushbans", SV_FlushBans_f, "Removes all bans and exceptions");
+	Cmd_AddCommand("botlib_memstats", SV_BotMemStats_f, "Prints the bot library memory usage");
+	Cmd_AddCommand("bot_tracestats", SV_BotTraceStats_f, "Prints the traces per second of every bot, 'reset' starts over");
+	if (com_dedicated->integer) {
+		Cmd_AddCommand("bot_writeroutecache", SV_BotWriteRouteCache_f, "Calculates and writes the bot route cache for the current map");
+	}
 }
 
 /*
@@ -3173,6 +3173,8 @@ void SV_BindGame(void) {
 		gi.G2API_CleanEntAttachments = SV_G2API_CleanEntAttachments;
 		gi.G2API_OverrideServer = SV_G2API_OverrideServer;
 		gi.G2API_GetSurfaceName = SV_G2API_GetSurfaceName;
+		gi.BotTrace = SV_BotTrace;
+		gi.BotTraceBatch = SV_BotTraceBatch;
 
 		const GetGameAPI_t GetGameAPI = (GetGameAPI_t)gvm->GetModuleAPI;
 		gameExport_t* ret = GetGameAPI(GAME_API_VERSION, &gi);
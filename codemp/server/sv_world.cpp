@@ -162,6 +162,9 @@ SV_UnlinkEntity
 void SV_UnlinkEntity(sharedEntity_t* gEnt) {
 	svEntity_t* ent = SV_SvEntityForGentity(gEnt);
 
+	// anything moving invalidates the traces bots have seen so far this frame
+	SV_BotInvalidateTraceCache();
+
 	gEnt->r.linked = qfalse;
 
 	worldSector_t* ws = ent->worldSector;
@@ -202,6 +205,9 @@ void SV_LinkEntity(sharedEntity_t* gEnt) {
 	if (ent->worldSector) {
 		SV_UnlinkEntity(gEnt);	// unlink from old position
 	}
+	else {
+		SV_BotInvalidateTraceCache();
+	}
 
 	// encode the size into the entityState_t for client prediction
 	if (gEnt->r.bmodel) {
@@ -891,4 +891,10 @@ void* WIN_GL_GetProcAddress(const char* proc)
 qboolean WIN_GL_ExtensionSupported(const char* extension)
 {
 	return SDL_GL_ExtensionSupported(extension) == SDL_TRUE ? qtrue : qfalse;
+}
+
+void WIN_GL_MakeCurrent(const qboolean current)
+{
+	// the renderer moves the context between the main and render threads
+	SDL_GL_MakeCurrent(screen, current ? opengl_context : nullptr);
 }
\ No newline at end of file
@@ -211,5 +211,6 @@ void WIN_SetGamma(glconfig_t* glConfig, byte red[256], byte green[256], byte blu
 void WIN_Shutdown();
 void* WIN_GL_GetProcAddress(const char* proc);
 qboolean WIN_GL_ExtensionSupported(const char* extension);
+void WIN_GL_MakeCurrent(qboolean current);
 
 uint8_t ConvertUTF32ToExpectedCharset(uint32_t utf32);
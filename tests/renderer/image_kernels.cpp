@@ -0,0 +1,107 @@
+#include "rd-vanilla/tr_simd.h"
+
+#include <random>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+	std::vector< unsigned char > RandomPixels( const int width, const int height )
+	{
+		std::mt19937 rng( width * 1000 + height );
+		std::uniform_int_distribution< int > byte( 0, 255 );
+		std::vector< unsigned char > pixels( width * height * 4 );
+
+		for( unsigned char& b : pixels )
+		{
+			b = static_cast< unsigned char >( byte( rng ) );
+		}
+		return pixels;
+	}
+
+	// every power of two size up to 256 on each side, square and not
+	template< typename Func >
+	void CompareLevels( const Func& run )
+	{
+		const imageKernels_t* scalar = R_ImageKernels( SIMD_SCALAR );
+		BOOST_REQUIRE( scalar );
+
+		for( int level = SIMD_SCALAR + 1; level <= R_SimdSupported(); level++ )
+		{
+			const imageKernels_t* kernels = R_ImageKernels( static_cast< simdLevel_t >( level ) );
+			BOOST_REQUIRE( kernels );
+			BOOST_TEST_MESSAGE( kernels->name );
+
+			for( int width = 1; width <= 256; width *= 2 )
+			{
+				for( int height = 1; height <= 256; height *= 2 )
+				{
+					const std::vector< unsigned char > in = RandomPixels( width, height );
+					std::vector< unsigned char > expected( in.size(), 0 );
+					std::vector< unsigned char > actual( in.size(), 0 );
+
+					run( *scalar, in, expected, width, height );
+					run( *kernels, in, actual, width, height );
+					BOOST_CHECK_EQUAL_COLLECTIONS( actual.begin(), actual.end(), expected.begin(), expected.end() );
+				}
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE( renderer )
+
+BOOST_AUTO_TEST_SUITE( image_kernels )
+
+BOOST_AUTO_TEST_CASE( levels )
+{
+	BOOST_CHECK( R_ImageKernels( SIMD_SCALAR ) );
+	BOOST_CHECK( R_ImageKernels( R_SimdSupported() ) );
+	BOOST_CHECK( !R_ImageKernels( NUM_SIMD_LEVELS ) );
+}
+
+BOOST_AUTO_TEST_CASE( box )
+{
+	const unsigned char in[ 4 * 4 ] = {
+		0, 10, 100, 255,	2, 20, 101, 255,
+		4, 30, 102, 0,		6, 41, 103, 0,
+	};
+	unsigned char out[ 4 ] = {};
+
+	R_ImageKernels( SIMD_SCALAR )->mipMapBox( in, out, 2, 2 );
+	BOOST_CHECK_EQUAL( out[ 0 ], 3 );
+	BOOST_CHECK_EQUAL( out[ 1 ], 25 );
+	BOOST_CHECK_EQUAL( out[ 2 ], 101 );
+	BOOST_CHECK_EQUAL( out[ 3 ], 127 );
+
+	CompareLevels( []( const imageKernels_t& k, const std::vector< unsigned char >& in,
+		std::vector< unsigned char >& out, int width, int height ) {
+		k.mipMapBox( in.data(), out.data(), width, height );
+	} );
+}
+
+BOOST_AUTO_TEST_CASE( box_in_place )
+{
+	CompareLevels( []( const imageKernels_t& k, const std::vector< unsigned char >& in,
+		std::vector< unsigned char >& out, int width, int height ) {
+		if( width == 1 && height == 1 )
+		{
+			return;
+		}
+		out = in;
+		k.mipMapBox( out.data(), out.data(), width, height );
+	} );
+}
+
+BOOST_AUTO_TEST_CASE( filter )
+{
+	CompareLevels( []( const imageKernels_t& k, const std::vector< unsigned char >& in,
+		std::vector< unsigned char >& out, int width, int height ) {
+		k.mipMapFilter( in.data(), out.data(), width, height );
+	} );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,172 @@
+#include "rd-vanilla/tr_simd.h"
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+	// odd count so the wide kernels leave some vertexes for the narrow ones
+	const int numVertexes = 1003;
+
+	struct TessBuffers
+	{
+		std::vector< float > xyz;
+		std::vector< float > normal;
+		std::vector< float > st;
+
+		TessBuffers()
+			: xyz( numVertexes * 4 ), normal( numVertexes * 4 ), st( numVertexes * 2 )
+		{
+			std::mt19937 rng( 1234 );
+			std::uniform_real_distribution< float > position( -4096.0f, 4096.0f );
+			std::uniform_real_distribution< float > unit( -1.0f, 1.0f );
+			std::uniform_real_distribution< float > texCoord( -2.0f, 2.0f );
+
+			for( int i = 0; i < numVertexes; i++ )
+			{
+				float n[ 3 ] = { unit( rng ), unit( rng ), unit( rng ) };
+				const float length = std::sqrt( n[ 0 ] * n[ 0 ] + n[ 1 ] * n[ 1 ] + n[ 2 ] * n[ 2 ] ) + 0.001f;
+
+				for( int j = 0; j < 3; j++ )
+				{
+					xyz[ i * 4 + j ] = position( rng );
+					normal[ i * 4 + j ] = n[ j ] / length;
+				}
+				xyz[ i * 4 + 3 ] = 1.0f;
+				normal[ i * 4 + 3 ] = 0.0f;
+				st[ i * 2 ] = texCoord( rng );
+				st[ i * 2 + 1 ] = texCoord( rng );
+			}
+		}
+	};
+
+	template< typename Func >
+	void CompareLevels( const Func& run )
+	{
+		const tessKernels_t* scalar = R_TessKernels( SIMD_SCALAR );
+		BOOST_REQUIRE( scalar );
+
+		TessBuffers expected;
+		run( *scalar, expected );
+
+		for( int level = SIMD_SCALAR + 1; level <= R_SimdSupported(); level++ )
+		{
+			const tessKernels_t* kernels = R_TessKernels( static_cast< simdLevel_t >( level ) );
+			BOOST_REQUIRE( kernels );
+			BOOST_TEST_MESSAGE( kernels->name );
+
+			TessBuffers actual;
+			run( *kernels, actual );
+			BOOST_CHECK_EQUAL_COLLECTIONS( actual.xyz.begin(), actual.xyz.end(), expected.xyz.begin(), expected.xyz.end() );
+			BOOST_CHECK_EQUAL_COLLECTIONS( actual.st.begin(), actual.st.end(), expected.st.begin(), expected.st.end() );
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE( renderer )
+
+BOOST_AUTO_TEST_SUITE( tess_kernels )
+
+BOOST_AUTO_TEST_CASE( levels )
+{
+	BOOST_CHECK( R_TessKernels( SIMD_SCALAR ) );
+	BOOST_CHECK( R_TessKernels( R_SimdSupported() ) );
+	BOOST_CHECK( !R_TessKernels( NUM_SIMD_LEVELS ) );
+}
+
+BOOST_AUTO_TEST_CASE( deform_normals )
+{
+	CompareLevels( []( const tessKernels_t& k, TessBuffers& b ) {
+		k.deformNormals( b.xyz.data(), b.normal.data(), numVertexes, 3.75f );
+	} );
+}
+
+BOOST_AUTO_TEST_CASE( deform_wave )
+{
+	std::vector< float > table( 1024 );
+	for( int i = 0; i < 1024; i++ )
+	{
+		table[ i ] = std::sin( i * 6.2831853f / 1024 );
+	}
+
+	CompareLevels( [&table]( const tessKernels_t& k, TessBuffers& b ) {
+		k.deformWave( b.xyz.data(), b.normal.data(), numVertexes, table.data(), 1024, 2.0f, 8.0f, 0.25f, 0.01f, 17.5f );
+	} );
+}
+
+BOOST_AUTO_TEST_CASE( move_vertexes )
+{
+	const float offset[ 3 ] = { 1.5f, -20.0f, 0.125f };
+
+	CompareLevels( [&offset]( const tessKernels_t& k, TessBuffers& b ) {
+		k.moveVertexes( b.xyz.data(), numVertexes, offset );
+	} );
+}
+
+BOOST_AUTO_TEST_CASE( environment_tex_coords )
+{
+	const float viewOrigin[ 3 ] = { 100.0f, -250.0f, 64.0f };
+
+	CompareLevels( [&viewOrigin]( const tessKernels_t& k, TessBuffers& b ) {
+		k.environmentTexCoords( b.xyz.data(), b.normal.data(), numVertexes, viewOrigin, b.st.data() );
+	} );
+}
+
+BOOST_AUTO_TEST_CASE( fog_tex_coords )
+{
+	const float distance[ 4 ] = { 0.001f, -0.002f, 0.0005f, 0.25f };
+	const float depth[ 4 ] = { 0.0f, 0.0f, 0.004f, -1.0f };
+
+	for( const bool eyeOutside : { false, true } )
+	{
+		CompareLevels( [&]( const tessKernels_t& k, TessBuffers& b ) {
+			// a broken vertex gets no fog instead of a nan
+			b.xyz[ 5 * 4 ] = std::numeric_limits< float >::quiet_NaN();
+			k.fogTexCoords( b.xyz.data(), numVertexes, distance, depth, -3.0f, eyeOutside, b.st.data() );
+			b.xyz[ 5 * 4 ] = 0.0f;
+		} );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( scale_bias_tex_coords )
+{
+	const float scale[ 2 ] = { 4.0f, 0.3f };
+	const float bias[ 2 ] = { 0.5f, -0.7f };
+
+	CompareLevels( [&]( const tessKernels_t& k, TessBuffers& b ) {
+		k.scaleBiasTexCoords( b.st.data(), numVertexes, scale, bias );
+	} );
+}
+
+BOOST_AUTO_TEST_CASE( transform_tex_coords )
+{
+	const float matrix[ 2 ][ 2 ] = { { 0.8f, -0.6f }, { 0.6f, 0.8f } };
+	const float translate[ 2 ] = { 0.1f, 0.4f };
+
+	CompareLevels( [&]( const tessKernels_t& k, TessBuffers& b ) {
+		k.transformTexCoords( b.st.data(), numVertexes, matrix, translate );
+	} );
+}
+
+BOOST_AUTO_TEST_CASE( fill_colors )
+{
+	for( int level = SIMD_SCALAR; level <= R_SimdSupported(); level++ )
+	{
+		std::vector< unsigned > colors( numVertexes + 1, 0 );
+
+		R_TessKernels( static_cast< simdLevel_t >( level ) )->fillColors( colors.data(), numVertexes, 0xff8040c0 );
+		for( int i = 0; i < numVertexes; i++ )
+		{
+			BOOST_REQUIRE_EQUAL( colors[ i ], 0xff8040c0 );
+		}
+		BOOST_CHECK_EQUAL( colors[ numVertexes ], 0 );
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE_END()